@@ -0,0 +1,116 @@
+#ifndef FLECHA_BENCH_HPP
+#define FLECHA_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace flecha {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief What a benchmark reports back to the runner
+ *
+ * The benchmark body repeats its work iterations times and sets the
+ * bytes and items handled by a single iteration, if any. Sized benchmarks
+ * read their input size from argument. Each benchmark is first called
+ * once with zero iterations, untimed, so it can build static inputs.
+ */
+struct State {
+    size_t iterations;
+    size_t argument = 0;
+    size_t bytes_per_iteration = 0;
+    size_t items_per_iteration = 0;
+
+    // Time spent paused, subtracted from the measured run
+    Clock::duration paused = Clock::duration::zero();
+    Clock::time_point pause_start{};
+
+    /**
+     * @brief Stops the clock, e.g. around per-iteration setup
+     */
+    void PauseTiming() { pause_start = Clock::now(); }
+
+    /**
+     * @brief Starts the clock again after PauseTiming
+     */
+    void ResumeTiming() { paused += Clock::now() - pause_start; }
+};
+
+using BenchmarkFunction = void (*)(State&);
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFunction function;
+    size_t argument = 0;
+};
+
+// Input sizes of FLECHA_BENCHMARK_SIZES benchmarks, 1 KB to 1 GB
+constexpr size_t KB = size_t(1) << 10;
+constexpr size_t MB = size_t(1) << 20;
+constexpr size_t GB = size_t(1) << 30;
+constexpr std::initializer_list<size_t> CORPUS_SIZES = {
+    KB, 64 * KB, MB, 16 * MB, 256 * MB, GB,
+};
+
+/**
+ * @brief Gets every benchmark registered so far
+ *
+ * @return The registry, in registration order
+ */
+std::vector<Benchmark>& Registry();
+
+/**
+ * @brief Adds a benchmark to the registry
+ *
+ * @param name - The reported name
+ * @param function - The benchmark body
+ *
+ * @return Always true, so it can initialize a static
+ */
+bool Register(const char* name, BenchmarkFunction function);
+
+/**
+ * @brief Adds a benchmark once per input size, named name/<size>
+ *
+ * @param name - The reported name prefix
+ * @param function - The benchmark body, reading state.argument
+ * @param sizes - The input sizes in bytes
+ *
+ * @return Always true, so it can initialize a static
+ */
+bool RegisterSizes(const char* name, BenchmarkFunction function,
+                   std::initializer_list<size_t> sizes = CORPUS_SIZES);
+
+/**
+ * @brief Keeps the compiler from discarding a computed value
+ *
+ * @param value - The value to keep alive
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bench
+}  // namespace flecha
+
+// Defines and registers a benchmark body taking a State& named state
+#define FLECHA_BENCHMARK(name)                                    \
+    static void name(flecha::bench::State& state);                \
+    static const bool name##_registered =                         \
+        flecha::bench::Register(#name, name);                     \
+    static void name(flecha::bench::State& state)
+
+// Like FLECHA_BENCHMARK, run once per CORPUS_SIZES entry
+#define FLECHA_BENCHMARK_SIZES(name)                              \
+    static void name(flecha::bench::State& state);                \
+    static const bool name##_registered =                         \
+        flecha::bench::RegisterSizes(#name, name);                \
+    static void name(flecha::bench::State& state)
+
+#endif  // FLECHA_BENCH_HPP
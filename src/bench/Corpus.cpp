@@ -0,0 +1,182 @@
+#include "Corpus.hpp"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+
+namespace flecha {
+namespace bench {
+
+static const char* const PRIMITIVES[] = {"int", "float", "bool"};
+static const char* const USER_TYPES[] = {"Node", "Point", "Buffer", "List"};
+static const char* const NAMES[] = {"count", "index", "total", "value",
+                                    "ptr",   "node",  "size",  "offset"};
+static const char* const STRINGS[] = {
+    "\"hello\"", "\"a somewhat longer string literal\"",
+    "\"with \\\"escapes\\\" and \\n newlines\"", "\"\""};
+
+/**
+ * @brief Builds statements from a seeded generator
+ */
+struct Generator {
+    std::mt19937 random;
+    std::string& out;
+    size_t pointers = 0;
+
+    size_t Pick(size_t count) {
+        return std::uniform_int_distribution<size_t>(0, count - 1)(random);
+    }
+
+    template <typename T, size_t N>
+    const char* Pick(T (&items)[N]) {
+        return items[Pick(N)];
+    }
+
+    void Name(const char* prefix) {
+        out += prefix;
+        out += std::to_string(Pick(1000));
+    }
+
+    void Declaration() {
+        const char* type = Pick(PRIMITIVES);
+        out += type;
+        out += ' ';
+        Name(Pick(NAMES));
+        out += " = ";
+        if (Pick(4) == 0) {
+            Name(Pick(NAMES));
+        } else if (type[0] == 'b') {
+            out += Pick(2) ? "true" : "false";
+        } else if (type[0] == 'f') {
+            out += std::to_string(Pick(100)) + "." + std::to_string(Pick(100));
+        } else {
+            out += std::to_string(Pick(100000));
+        }
+        out += ';';
+    }
+
+    void TextDeclaration() {
+        if (Pick(2)) {
+            out += "char ";
+            Name("c");
+            out += Pick(8) ? " = 'x';" : " = '\\n';";
+        } else {
+            out += "string ";
+            Name("s");
+            out += " = ";
+            out += Pick(STRINGS);
+            out += ';';
+        }
+    }
+
+    void Allocation() {
+        const char* type = Pick(PRIMITIVES);
+        out += type;
+        out += "! p";
+        out += std::to_string(pointers++);
+        out += " = allot(";
+        out += type;
+        out += ')';
+        if (Pick(3)) {
+            out += " -> ";
+            out += std::to_string(Pick(1000));
+        }
+        out += ';';
+    }
+
+    void UserPointer() {
+        const char* type = Pick(USER_TYPES);
+        out += type;
+        out += "! p";
+        out += std::to_string(pointers++);
+        out += " = allot(";
+        out += type;
+        out += ");";
+    }
+
+    void Operand(int depth) {
+        if (depth > 0 && Pick(3) == 0) {
+            out += '(';
+            Expression(depth - 1);
+            out += ')';
+        } else if (Pick(2)) {
+            Name(Pick(NAMES));
+        } else {
+            out += std::to_string(Pick(1000));
+        }
+    }
+
+    void Expression(int depth) {
+        static const char* const OPERATORS[] = {" + ", " - ", " * ", " / ",
+                                                " % ", " ** ", " < ", " == "};
+        if (Pick(6) == 0) out += '-';
+        Operand(depth);
+        for (size_t terms = Pick(4); terms > 0; terms--) {
+            out += Pick(OPERATORS);
+            Operand(depth);
+        }
+    }
+
+    void Arithmetic() {
+        out += "int ";
+        Name("e");
+        out += " = ";
+        Expression(4);
+        out += ';';
+    }
+
+    void Dellot() {
+        out += "dellot p";
+        out += std::to_string(pointers ? Pick(pointers) : 0);
+        out += ';';
+    }
+};
+
+std::string GenerateProgram(size_t bytes, const CorpusMix& mix,
+                            uint32_t seed) {
+    std::string out;
+    out.reserve(bytes + 128);
+
+    Generator generator{std::mt19937(seed), out};
+    std::discrete_distribution<int> kind(
+        {double(mix.declarations), double(mix.text_declarations),
+         double(mix.allocations), double(mix.user_pointers),
+         double(mix.dellots), double(mix.arithmetic)});
+
+    while (out.size() < bytes) {
+        // Some nesting-like indentation and the odd blank line
+        out.append(generator.Pick(4) * 4, ' ');
+
+        switch (kind(generator.random)) {
+            case 0: generator.Declaration(); break;
+            case 1: generator.TextDeclaration(); break;
+            case 2: generator.Allocation(); break;
+            case 3: generator.UserPointer(); break;
+            case 4: generator.Dellot(); break;
+            case 5: generator.Arithmetic(); break;
+        }
+
+        out += generator.Pick(16) ? "\n" : "\n\n";
+    }
+
+    return out;
+}
+
+const std::string& CachedProgram(size_t bytes, const CorpusMix& mix) {
+    using Key = std::tuple<size_t, unsigned, unsigned, unsigned, unsigned,
+                           unsigned, unsigned>;
+    static std::map<Key, std::unique_ptr<std::string>> cache;
+
+    Key key{bytes,           mix.declarations, mix.text_declarations,
+            mix.allocations, mix.user_pointers, mix.dellots, mix.arithmetic};
+    auto& program = cache[key];
+    if (!program) {
+        program = std::make_unique<std::string>(GenerateProgram(bytes, mix));
+    }
+
+    return *program;
+}
+
+}  // namespace bench
+}  // namespace flecha
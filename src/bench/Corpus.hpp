@@ -0,0 +1,69 @@
+#ifndef FLECHA_CORPUS_HPP
+#define FLECHA_CORPUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flecha {
+namespace bench {
+
+/**
+ * @brief Relative weights of the statement kinds in a generated corpus
+ */
+struct CorpusMix {
+    // int count = 42; float ratio = 0.5; int total = count;
+    unsigned declarations = 4;
+    // char c = 'x'; string s = "text with \"escapes\"";
+    unsigned text_declarations = 2;
+    // int! p = allot(int) -> 7;
+    unsigned allocations = 3;
+    // Node! n = allot(Node);
+    unsigned user_pointers = 2;
+    // dellot p; the parser does not accept these yet, keep them at 0 for
+    // corpora that are parsed
+    unsigned dellots = 0;
+    // int e = (a + 3) * -b ** 2; nested up to a few levels
+    unsigned arithmetic = 2;
+};
+
+// Pointer heavy programs, the shape the allocator paths care about
+constexpr CorpusMix POINTER_HEAVY = {1, 1, 5, 3, 0, 1};
+
+// The pointer heavy mix with matching dellots, for tokenizer only corpora
+constexpr CorpusMix POINTER_HEAVY_LEXICAL = {1, 1, 5, 3, 4, 1};
+
+// Arithmetic heavy programs for the expression parser
+constexpr CorpusMix ARITHMETIC = {1, 0, 1, 0, 0, 8};
+
+/**
+ * @brief Generates a synthetic Flecha program
+ *
+ * The same size, mix and seed always give the same program. Statements are
+ * spread over lines with varying indentation and occasional blank lines.
+ *
+ * @param bytes - The approximate program size, never exceeded by more than
+ * one statement
+ * @param mix - The statement weights
+ * @param seed - The random seed
+ *
+ * @return - The program text
+ */
+std::string GenerateProgram(size_t bytes, const CorpusMix& mix = CorpusMix(),
+                            uint32_t seed = 42);
+
+/**
+ * @brief Gets a cached program, generating it on first use
+ *
+ * @param bytes - The approximate program size
+ * @param mix - The statement weights, POINTER_HEAVY when omitted
+ *
+ * @return - The program text, alive until the process exits
+ */
+const std::string& CachedProgram(size_t bytes,
+                                 const CorpusMix& mix = POINTER_HEAVY);
+
+}  // namespace bench
+}  // namespace flecha
+
+#endif  // FLECHA_CORPUS_HPP
@@ -0,0 +1,250 @@
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "Bench.hpp"
+#include "Corpus.hpp"
+#include "core/AstCache.hpp"
+#include "core/Document.hpp"
+#include "core/Frontend.hpp"
+#include "core/Parser.hpp"
+#include "memory/Arena.hpp"
+
+using namespace flecha;
+using namespace flecha::core;
+
+/* TOKENIZER */
+
+// The token stream the parser pulls, one token at a time
+FLECHA_BENCHMARK_SIZES(BM_TokenizeStream) {
+    const std::string& source =
+        bench::CachedProgram(state.argument, bench::POINTER_HEAVY_LEXICAL);
+
+    size_t tokens = 0;
+    for (size_t i = 0; i < state.iterations; i++) {
+        Tokenizer tokenizer(source);
+        tokens = 0;
+        while (tokenizer.Next().type != TokenType::EOF_TOKEN) tokens++;
+    }
+    state.bytes_per_iteration = source.size();
+    state.items_per_iteration = tokens;
+}
+
+// Tokenize(), materializing every token in a vector
+FLECHA_BENCHMARK_SIZES(BM_Tokenize) {
+    const std::string& source =
+        bench::CachedProgram(state.argument, bench::POINTER_HEAVY_LEXICAL);
+
+    size_t tokens = 0;
+    for (size_t i = 0; i < state.iterations; i++) {
+        Tokenizer tokenizer(source);
+        vector<Token> result = tokenizer.Tokenize();
+        tokens = result.size();
+        bench::DoNotOptimize(result.data());
+    }
+    state.bytes_per_iteration = source.size();
+    state.items_per_iteration = tokens;
+}
+
+/* PARSER */
+
+// Tokenizing and parsing into a reused arena, statements as items
+FLECHA_BENCHMARK_SIZES(BM_Parse) {
+    const std::string& source = bench::CachedProgram(state.argument);
+
+    memory::Arena arena;
+    size_t statements = 0;
+    for (size_t i = 0; i < state.iterations; i++) {
+        arena.Reset();
+        Tokenizer tokenizer(source);
+        Parser parser(tokenizer, arena);
+        ProgramNode* program = parser.Parse();
+        statements = static_cast<BodyNode*>(program->body)->expressions.size();
+        bench::DoNotOptimize(program);
+    }
+    state.bytes_per_iteration = source.size();
+    state.items_per_iteration = statements;
+}
+
+// Expression heavy programs, mostly the precedence climbing loop
+FLECHA_BENCHMARK_SIZES(BM_ParseArithmetic) {
+    const std::string& source =
+        bench::CachedProgram(state.argument, bench::ARITHMETIC);
+
+    memory::Arena arena;
+    for (size_t i = 0; i < state.iterations; i++) {
+        arena.Reset();
+        Tokenizer tokenizer(source);
+        Parser parser(tokenizer, arena);
+        bench::DoNotOptimize(parser.Parse());
+    }
+    state.bytes_per_iteration = source.size();
+}
+
+// Parsing into a fresh arena every time, paying for the chunk allocations
+FLECHA_BENCHMARK_SIZES(BM_ParseFreshArena) {
+    const std::string& source = bench::CachedProgram(state.argument);
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        memory::Arena arena;
+        Tokenizer tokenizer(source);
+        Parser parser(tokenizer, arena);
+        bench::DoNotOptimize(parser.Parse());
+    }
+    state.bytes_per_iteration = source.size();
+}
+
+/* AST ALLOCATION AND TEARDOWN */
+
+// The nodes of one declaration, as the parser builds them
+static ASTNode* MakeDeclaration(memory::Arena& arena) {
+    ASTNode* location = arena.Make<LocationNode>(arena.Make<StartNode>(1, 1),
+                                                 arena.Make<EndNode>(1, 12));
+    ASTNode* type = arena.Make<PrimitiveTypeNode>("int");
+    ASTNode* value = arena.Make<ValueNode>("42", location, type);
+    ASTNode* variable = arena.Make<VariableNode>("count", location, value);
+    return arena.Make<VariableDeclarationNode>(location, variable);
+}
+
+constexpr size_t NODES_PER_DECLARATION = 7;
+constexpr size_t DECLARATIONS = 4096;
+
+FLECHA_BENCHMARK(BM_NodeAllocationArena) {
+    memory::Arena arena;
+    for (size_t i = 0; i < state.iterations; i++) {
+        arena.Reset();
+        for (size_t j = 0; j < DECLARATIONS; j++) {
+            bench::DoNotOptimize(MakeDeclaration(arena));
+        }
+    }
+    state.items_per_iteration = DECLARATIONS * NODES_PER_DECLARATION;
+}
+
+// The same nodes from the global heap, freed one by one
+FLECHA_BENCHMARK(BM_NodeAllocationHeap) {
+    std::vector<std::unique_ptr<StartNode>> starts(DECLARATIONS);
+    std::vector<std::unique_ptr<EndNode>> ends(DECLARATIONS);
+    std::vector<std::unique_ptr<LocationNode>> locations(DECLARATIONS);
+    std::vector<std::unique_ptr<PrimitiveTypeNode>> types(DECLARATIONS);
+    std::vector<std::unique_ptr<ValueNode>> values(DECLARATIONS);
+    std::vector<std::unique_ptr<VariableNode>> variables(DECLARATIONS);
+    std::vector<std::unique_ptr<VariableDeclarationNode>> declarations(
+        DECLARATIONS);
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (size_t j = 0; j < DECLARATIONS; j++) {
+            starts[j] = std::make_unique<StartNode>(1, 1);
+            ends[j] = std::make_unique<EndNode>(1, 12);
+            locations[j] =
+                std::make_unique<LocationNode>(starts[j].get(), ends[j].get());
+            types[j] = std::make_unique<PrimitiveTypeNode>("int");
+            values[j] = std::make_unique<ValueNode>("42", locations[j].get(),
+                                                    types[j].get());
+            variables[j] = std::make_unique<VariableNode>(
+                "count", locations[j].get(), values[j].get());
+            declarations[j] = std::make_unique<VariableDeclarationNode>(
+                locations[j].get(), variables[j].get());
+        }
+    }
+    state.items_per_iteration = DECLARATIONS * NODES_PER_DECLARATION;
+}
+
+// What dropping a parsed program costs, with parsing itself untimed
+FLECHA_BENCHMARK_SIZES(BM_TreeTeardown) {
+    const std::string& source = bench::CachedProgram(state.argument);
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        state.PauseTiming();
+        auto arena = std::make_unique<memory::Arena>();
+        Tokenizer tokenizer(source);
+        Parser parser(tokenizer, *arena);
+        bench::DoNotOptimize(parser.Parse());
+        state.ResumeTiming();
+
+        arena.reset();
+    }
+    state.bytes_per_iteration = source.size();
+}
+
+/* DOCUMENT */
+
+// A keystroke in the middle of a buffer and its undo, with the initial
+// parse untimed
+FLECHA_BENCHMARK_SIZES(BM_DocumentEdit) {
+    state.PauseTiming();
+    Document document(bench::CachedProgram(state.argument));
+    size_t offset = document.Text().find(" = ", document.Text().size() / 2);
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        document.Edit(offset, 0, " ");
+        document.Edit(offset, 1, "");
+        bench::DoNotOptimize(document.Program());
+    }
+    state.items_per_iteration = 2;
+}
+
+// The same with a new line, which moves every following line number
+FLECHA_BENCHMARK_SIZES(BM_DocumentNewLine) {
+    state.PauseTiming();
+    Document document(bench::CachedProgram(state.argument));
+    size_t offset = document.Text().find(" = ", document.Text().size() / 2);
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        document.Edit(offset, 0, "\n");
+        document.Edit(offset, 1, "");
+        bench::DoNotOptimize(document.Program());
+    }
+    state.items_per_iteration = 2;
+}
+
+/* AST CACHE */
+
+// Writes a corpus program to a fresh directory, removed on scope exit
+struct CorpusDirectory {
+    std::string path;
+    std::string file;
+
+    explicit CorpusDirectory(size_t bytes) {
+        char name[] = "/tmp/flecha_bench_XXXXXX";
+        path = mkdtemp(name);
+        file = path + "/main.fl";
+        std::ofstream(file) << bench::CachedProgram(bytes);
+    }
+
+    ~CorpusDirectory() { std::filesystem::remove_all(path); }
+};
+
+// Loading and parsing a file through the Frontend, no cache
+FLECHA_BENCHMARK_SIZES(BM_FrontendParse) {
+    state.PauseTiming();
+    CorpusDirectory corpus(state.argument);
+    Frontend frontend(1);
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        frontend.Reset();
+        bench::DoNotOptimize(frontend.ParseFiles({corpus.file})[0].program);
+    }
+    state.bytes_per_iteration = state.argument;
+}
+
+// The same file unchanged since its entry was stored: hash, map, rebuild
+FLECHA_BENCHMARK_SIZES(BM_FrontendWarmCache) {
+    state.PauseTiming();
+    CorpusDirectory corpus(state.argument);
+    AstCache cache(corpus.path + "/cache");
+    Frontend frontend(1, &cache);
+    frontend.ParseFiles({corpus.file});
+    state.ResumeTiming();
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        frontend.Reset();
+        bench::DoNotOptimize(frontend.ParseFiles({corpus.file})[0].program);
+    }
+    state.bytes_per_iteration = state.argument;
+}
@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "std/Kernels.hpp"
+
+using namespace flecha;
+using stdlib::Isa;
+
+/* STD KERNELS */
+
+// Fits in L2, so the kernels and not memory bandwidth are measured
+constexpr size_t BUFFER_BYTES = 64 * bench::KB;
+
+template <Isa isa>
+static void LengthBytes(bench::State& state) {
+    static const std::string bytes(BUFFER_BYTES - 1, 'a');
+    const stdlib::Kernels& kernels = stdlib::KernelsFor(isa);
+    for (size_t i = 0; i < state.iterations; i++) {
+        bench::DoNotOptimize(kernels.length(bytes.c_str()));
+    }
+    state.bytes_per_iteration = BUFFER_BYTES;
+}
+
+template <Isa isa>
+static void FindBytes(bench::State& state) {
+    static const std::vector<char> bytes(BUFFER_BYTES, 'a');
+    const stdlib::Kernels& kernels = stdlib::KernelsFor(isa);
+    for (size_t i = 0; i < state.iterations; i++) {
+        bench::DoNotOptimize(kernels.find(bytes.data(), bytes.size(), 'b'));
+    }
+    state.bytes_per_iteration = BUFFER_BYTES;
+}
+
+template <Isa isa>
+static void MinInts(bench::State& state) {
+    static const std::vector<int64_t> values(BUFFER_BYTES / 8, 42);
+    const stdlib::Kernels& kernels = stdlib::KernelsFor(isa);
+    for (size_t i = 0; i < state.iterations; i++) {
+        bench::DoNotOptimize(kernels.min_int(values.data(), values.size()));
+    }
+    state.bytes_per_iteration = BUFFER_BYTES;
+    state.items_per_iteration = values.size();
+}
+
+template <Isa isa>
+static void SumFloats(bench::State& state) {
+    static const std::vector<double> values(BUFFER_BYTES / 8, 1.5);
+    const stdlib::Kernels& kernels = stdlib::KernelsFor(isa);
+    for (size_t i = 0; i < state.iterations; i++) {
+        bench::DoNotOptimize(kernels.sum_float(values.data(), values.size()));
+    }
+    state.bytes_per_iteration = BUFFER_BYTES;
+    state.items_per_iteration = values.size();
+}
+
+// Registers name/<isa> per kernel, for the instruction sets this CPU has
+template <Isa isa>
+static bool RegisterIsa() {
+    if (!stdlib::Supports(isa)) return false;
+
+    std::string suffix = std::string("/") + stdlib::IsaName(isa);
+    bench::Register(("BM_StdLength" + suffix).c_str(), LengthBytes<isa>);
+    bench::Register(("BM_StdFind" + suffix).c_str(), FindBytes<isa>);
+    bench::Register(("BM_StdMinInt" + suffix).c_str(), MinInts<isa>);
+    bench::Register(("BM_StdSumFloat" + suffix).c_str(), SumFloats<isa>);
+    return true;
+}
+
+static const bool kernels_registered =
+    RegisterIsa<Isa::Scalar>() | RegisterIsa<Isa::Sse42>() |
+    RegisterIsa<Isa::Avx2>() | RegisterIsa<Isa::Avx512>() |
+    RegisterIsa<Isa::Neon>();
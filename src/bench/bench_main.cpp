@@ -0,0 +1,223 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include "Bench.hpp"
+
+#ifndef FLECHA_BUILD_TYPE
+#define FLECHA_BUILD_TYPE "unknown"
+#endif
+
+namespace flecha {
+namespace bench {
+
+std::vector<Benchmark>& Registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+bool Register(const char* name, BenchmarkFunction function) {
+    Registry().push_back({name, function});
+    return true;
+}
+
+/**
+ * @brief Formats a byte count with a binary suffix, e.g. 64K or 1G
+ *
+ * @param bytes - The byte count
+ *
+ * @return - The short form
+ */
+static std::string FormatSize(size_t bytes) {
+    if (bytes >= GB && bytes % GB == 0) return std::to_string(bytes / GB) + "G";
+    if (bytes >= MB && bytes % MB == 0) return std::to_string(bytes / MB) + "M";
+    if (bytes >= KB && bytes % KB == 0) return std::to_string(bytes / KB) + "K";
+    return std::to_string(bytes);
+}
+
+bool RegisterSizes(const char* name, BenchmarkFunction function,
+                   std::initializer_list<size_t> sizes) {
+    for (size_t size : sizes) {
+        std::string sized_name = std::string(name) + "/" + FormatSize(size);
+        Registry().push_back({sized_name, function, size});
+    }
+    return true;
+}
+
+/**
+ * @brief Parses a byte count with an optional K, M or G suffix
+ *
+ * @param text - The count, e.g. 16M
+ *
+ * @return - The byte count
+ */
+static size_t ParseSize(const std::string& text) {
+    char* suffix = nullptr;
+    size_t value = std::strtoull(text.c_str(), &suffix, 10);
+    switch (*suffix) {
+        case 'K': return value * KB;
+        case 'M': return value * MB;
+        case 'G': return value * GB;
+        default: return value;
+    }
+}
+
+/**
+ * @brief The figures of one measured benchmark
+ */
+struct Result {
+    std::string name;
+    size_t iterations;
+    double ns_per_iteration;
+    double bytes_per_second;
+    double items_per_second;
+};
+
+/**
+ * @brief Runs a benchmark with a given iteration count
+ *
+ * @param benchmark - The benchmark
+ * @param state - The state, with iterations set
+ *
+ * @return - The elapsed seconds, without paused time
+ */
+static double TimeRun(const Benchmark& benchmark, State& state) {
+    state.paused = Clock::duration::zero();
+    auto start = Clock::now();
+    benchmark.function(state);
+    auto end = Clock::now();
+    return std::chrono::duration<double>(end - start - state.paused).count();
+}
+
+/**
+ * @brief Grows the iteration count until a run lasts min_time
+ *
+ * @param benchmark - The benchmark
+ * @param min_time - The minimum seconds per measured run
+ *
+ * @return - The per-iteration figures of the last run
+ */
+static Result Run(const Benchmark& benchmark, double min_time) {
+    // Untimed, lets the benchmark build its inputs
+    State state{0, benchmark.argument};
+    benchmark.function(state);
+
+    state.iterations = 1;
+    double elapsed = TimeRun(benchmark, state);
+
+    while (elapsed < min_time && state.iterations < (size_t(1) << 40)) {
+        // Aim past min_time, at most 10x per step
+        double scale = elapsed > 0 ? min_time * 1.4 / elapsed : 10.0;
+        scale = scale < 2.0 ? 2.0 : (scale > 10.0 ? 10.0 : scale);
+        state.iterations = static_cast<size_t>(state.iterations * scale);
+        elapsed = TimeRun(benchmark, state);
+    }
+
+    double per_iteration = elapsed / state.iterations;
+    return Result{benchmark.name, state.iterations, per_iteration * 1e9,
+                  state.bytes_per_iteration / per_iteration,
+                  state.items_per_iteration / per_iteration};
+}
+
+/**
+ * @brief Prints one result as a table row
+ *
+ * @param result - The result
+ */
+static void PrintText(const Result& result) {
+    std::printf("%-40s %12zu %14.1f ns", result.name.c_str(),
+                result.iterations, result.ns_per_iteration);
+    if (result.bytes_per_second) {
+        std::printf(" %10.1f MB/s", result.bytes_per_second / 1e6);
+    }
+    if (result.items_per_second) {
+        std::printf(" %10.2f M items/s", result.items_per_second / 1e6);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Prints all results as one JSON document
+ *
+ * @param results - The results, in run order
+ */
+static void PrintJson(const std::vector<Result>& results) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::printf("{\n  \"context\": {\"date\": \"%s\", \"build_type\": \"%s\"},\n",
+                date, FLECHA_BUILD_TYPE);
+    std::printf("  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        std::printf(
+            "%s\n    {\"name\": \"%s\", \"iterations\": %zu, "
+            "\"ns_per_iteration\": %.1f, \"bytes_per_second\": %.0f, "
+            "\"items_per_second\": %.0f}",
+            i ? "," : "", result.name.c_str(), result.iterations,
+            result.ns_per_iteration, result.bytes_per_second,
+            result.items_per_second);
+    }
+    std::printf("\n  ]\n}\n");
+}
+
+}  // namespace bench
+}  // namespace flecha
+
+/*
+ * Usage: bench_flecha [--filter=<substring>] [--min-time=<seconds>]
+ *                     [--max-size=<bytes>] [--format=text|json]
+ *
+ * Sized benchmarks above --max-size (16M by default) are skipped, the
+ * largest corpora need several GB of memory.
+ */
+int main(int argc, char** argv) {
+    using namespace flecha::bench;
+
+    std::string filter;
+    std::string format = "text";
+    double min_time = 0.5;
+    size_t max_size = 16 * MB;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--min-time=", 0) == 0) {
+            min_time = std::atof(arg.c_str() + 11);
+        } else if (arg.rfind("--max-size=", 0) == 0) {
+            max_size = ParseSize(arg.substr(11));
+        } else if (arg == "--format=text" || arg == "--format=json") {
+            format = arg.substr(9);
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--filter=<substring>] "
+                         "[--min-time=<seconds>] [--max-size=<bytes>] "
+                         "[--format=text|json]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    bool json = format == "json";
+    if (!json) {
+        std::printf("Build: %s\n", FLECHA_BUILD_TYPE);
+        std::printf("%-40s %12s %17s\n", "Benchmark", "Iterations", "Time");
+    }
+
+    std::vector<Result> results;
+    for (const auto& benchmark : Registry()) {
+        if (benchmark.name.find(filter) == std::string::npos) continue;
+        if (benchmark.argument > max_size) continue;
+
+        results.push_back(Run(benchmark, min_time));
+        if (!json) PrintText(results.back());
+    }
+
+    if (json) PrintJson(results);
+    return 0;
+}
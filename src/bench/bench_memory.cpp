@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Bench.hpp"
+#include "memory/Collector.hpp"
+#include "memory/Heap.hpp"
+
+using namespace flecha;
+
+/* ALLOT AND DELLOT */
+
+constexpr size_t LIVE_BLOCKS = 4096;
+
+// Sizes of int, char, bool, float and a few small user types
+static const size_t SIZES[] = {4, 1, 1, 4, 16, 24, 40};
+
+// Allot a batch of objects, then dellot them in a shuffled order
+template <typename Allocate, typename Free>
+static void AllotAndDellot(bench::State& state, Allocate allocate, Free free) {
+    std::vector<size_t> order(LIVE_BLOCKS);
+    for (size_t i = 0; i < LIVE_BLOCKS; i++) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (size_t j = 0; j < LIVE_BLOCKS; j++) {
+            allocate(j, SIZES[j % (sizeof(SIZES) / sizeof(SIZES[0]))]);
+        }
+        for (size_t j : order) free(j);
+    }
+    state.items_per_iteration = LIVE_BLOCKS;
+}
+
+FLECHA_BENCHMARK(BM_AllotHeapCache) {
+    memory::HeapCache& cache = memory::HeapCache::Local();
+    std::vector<memory::Block> blocks(LIVE_BLOCKS);
+
+    AllotAndDellot(
+        state,
+        [&](size_t j, size_t size) {
+            blocks[j] = cache.Allocate(size);
+            bench::DoNotOptimize(blocks[j].address);
+        },
+        [&](size_t j) { cache.Free(blocks[j]); });
+}
+
+// The --gc collector, dellots are hints and the blocks are its roots
+FLECHA_BENCHMARK(BM_AllotCollector) {
+    memory::Collector collector;
+    std::vector<void*> blocks(LIVE_BLOCKS);
+    std::vector<uint16_t> indices(LIVE_BLOCKS);
+    for (size_t i = 0; i < LIVE_BLOCKS; i++) indices[i] = i;
+    memory::Roots roots{blocks.data(), indices.data(), LIVE_BLOCKS};
+
+    AllotAndDellot(
+        state,
+        [&](size_t j, size_t size) {
+            blocks[j] = collector.Allocate(size, false, roots);
+            bench::DoNotOptimize(blocks[j]);
+        },
+        [&](size_t j) { collector.Free(blocks[j]); });
+}
+
+// The malloc and free per MemoryNode used before, for comparison
+FLECHA_BENCHMARK(BM_AllotMalloc) {
+    std::vector<void*> blocks(LIVE_BLOCKS);
+
+    AllotAndDellot(
+        state,
+        [&](size_t j, size_t size) {
+            blocks[j] = std::malloc(size);
+            bench::DoNotOptimize(blocks[j]);
+        },
+        [&](size_t j) { std::free(blocks[j]); });
+}
@@ -0,0 +1,198 @@
+#include <string>
+
+#include "Bench.hpp"
+#include "core/Optimizer.hpp"
+#include "core/Parser.hpp"
+#include "memory/Heap.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/Jit.hpp"
+#include "runtime/Scheduler.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+
+// A straight-line program of dependent integer and float arithmetic
+static std::string MakeProgram() {
+    std::string source = "int i0 = 1;\nfloat f0 = 0.5;\n";
+    for (int n = 1; n < 4000; n++) {
+        std::string i = std::to_string(n), p = std::to_string(n - 1);
+        source += "int i" + i + " = (i" + p + " * 7 + " + i + ") % 1009;\n";
+        source += "float f" + i + " = f" + p + " * 0.5 + i" + i + " / 3;\n";
+    }
+    return source;
+}
+
+static const runtime::Chunk& CachedChunk() {
+    static const runtime::Chunk chunk = [] {
+        static const std::string source = MakeProgram();
+        memory::Arena arena;
+        core::Tokenizer tokenizer(source);
+        core::Parser parser(tokenizer, arena);
+        return runtime::Compile(parser.Parse());
+    }();
+    return chunk;
+}
+
+FLECHA_BENCHMARK(BM_CompileBytecode) {
+    static const std::string source = MakeProgram();
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    core::ProgramNode* program = parser.Parse();
+
+    size_t instructions = 0;
+    for (size_t i = 0; i < state.iterations; i++) {
+        runtime::Chunk chunk = runtime::Compile(program);
+        instructions = chunk.code.size();
+        bench::DoNotOptimize(chunk.code.data());
+    }
+    state.items_per_iteration = instructions;
+}
+
+// Instructions per second of the dispatch loop
+FLECHA_BENCHMARK(BM_RunVM) {
+    const runtime::Chunk& chunk = CachedChunk();
+    runtime::VM vm;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        vm.Run(chunk);
+        bench::DoNotOptimize(vm.Registers().data());
+    }
+    state.items_per_iteration = chunk.code.size();
+}
+
+// The same program as machine code, compiled before the first run
+FLECHA_BENCHMARK(BM_RunVMJit) {
+    const runtime::Chunk& chunk = CachedChunk();
+    runtime::Jit jit(runtime::JitOptions{0});
+    runtime::VM vm(nullptr, nullptr, &jit);
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        vm.Run(chunk);
+        bench::DoNotOptimize(vm.Registers().data());
+    }
+    state.items_per_iteration = chunk.code.size();
+}
+
+// Short lived pointers that are only ever written through
+static std::string MakeAllotProgram() {
+    std::string source = "int v = 0;\n";
+    for (int n = 0; n < 2000; n++) {
+        std::string i = std::to_string(n);
+        source += "int! p" + i + " = allot(int) -> " + i + ";\n";
+        source += "int v = p" + i + " -> v + 1;\n";
+    }
+    return source;
+}
+
+static void RunAllots(bench::State& state, bool promote) {
+    static const std::string source = MakeAllotProgram();
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    runtime::Chunk chunk =
+        runtime::Compile(parser.Parse(), runtime::CompileOptions{promote});
+    runtime::VM vm;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        vm.Run(chunk);
+        bench::DoNotOptimize(vm.Registers().data());
+        // Nothing dellots yet, so the heap blocks are given back here
+        for (const runtime::Global& global : chunk.globals) {
+            if (global.kind != runtime::ValueKind::Pointer) continue;
+            if (global.slot >= 0) continue;
+            memory::HeapCache::Local().Free(memory::Block{
+                vm.Registers()[global.reg].p, memory::Heap::ClassOf(8)});
+        }
+    }
+    state.items_per_iteration = 2000;
+}
+
+FLECHA_BENCHMARK(BM_RunAllotsPromoted) { RunAllots(state, true); }
+
+FLECHA_BENCHMARK(BM_RunAllotsOnHeap) { RunAllots(state, false); }
+
+// Generated code with constant subexpressions and overwritten settings
+static std::string MakeConstantProgram() {
+    std::string source = "int v = 0;\n";
+    for (int n = 1; n < 2000; n++) {
+        std::string i = std::to_string(n);
+        source += "int scale = " + i + " * 4 + 2 ** 3;\n";
+        source += "int v = v + (" + i + " % 7) * (1024 / 16) - scale;\n";
+    }
+    return source;
+}
+
+static void RunConstants(bench::State& state, bool optimize) {
+    static const std::string source = MakeConstantProgram();
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    core::ProgramNode* program = parser.Parse();
+    if (optimize) core::Optimizer().Run(program, arena);
+    runtime::Chunk chunk = runtime::Compile(program);
+    runtime::VM vm;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        vm.Run(chunk);
+        bench::DoNotOptimize(vm.Registers().data());
+    }
+    state.items_per_iteration = 2000;
+}
+
+FLECHA_BENCHMARK(BM_RunConstantsFolded) { RunConstants(state, true); }
+
+FLECHA_BENCHMARK(BM_RunConstantsUnfolded) { RunConstants(state, false); }
+
+// Folding rewrites the tree, so every iteration parses it again
+FLECHA_BENCHMARK(BM_ParseAndOptimize) {
+    static const std::string source = MakeConstantProgram();
+    memory::Arena arena;
+    memory::Arena folded;
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        arena.Reset();
+        folded.Reset();
+        core::Tokenizer tokenizer(source);
+        core::Parser parser(tokenizer, arena);
+        core::ProgramNode* program = parser.Parse();
+        bench::DoNotOptimize(core::Optimizer().Run(program, folded).Eliminated());
+    }
+    state.items_per_iteration = 4000;
+}
+
+// Tasks that each send one number to the main task, on a channel of eight
+static runtime::Chunk MakeFanIn(uint16_t tasks) {
+    using runtime::Instruction;
+    using runtime::Op;
+
+    runtime::Chunk chunk;
+    chunk.registers = 4;
+    chunk.constants = {runtime::Value{8}};
+    chunk.code = {
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::MakeChannel, 0, 1, 0},
+    };
+    auto entry = static_cast<uint16_t>(2 + 3 * tasks + 1);
+    for (uint16_t i = 0; i < tasks; i++) {
+        chunk.code.push_back(Instruction{Op::Spawn, 0, entry, 0});
+    }
+    for (uint16_t i = 0; i < tasks; i++) {
+        chunk.code.push_back(Instruction{Op::Receive, 2, 0, 0});
+        chunk.code.push_back(Instruction{Op::AddInt, 3, 3, 2});
+    }
+    chunk.code.push_back(Instruction{Op::Halt, 0, 0, 0});
+    chunk.code.push_back(Instruction{Op::Send, 0, 1, 0});
+    chunk.code.push_back(Instruction{Op::Halt, 0, 0, 0});
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{1, 1});
+    return chunk;
+}
+
+// Spawns, parks and wakes per second, on every hardware thread
+FLECHA_BENCHMARK(BM_RunTasks) {
+    static const runtime::Chunk chunk = MakeFanIn(1000);
+    static runtime::Scheduler scheduler;
+
+    for (size_t i = 0; i < state.iterations; i++) scheduler.Run(chunk);
+    state.items_per_iteration = 1000;
+}
@@ -0,0 +1,83 @@
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Bench.hpp"
+#include "core/Keywords.hpp"
+#include "core/Tokenizer.hpp"
+
+using namespace flecha;
+
+// Keywords mixed with identifier-shaped words of similar lengths
+static const std::vector<std::string_view> WORDS = {
+    "int",     "char",      "bool",      "float",    "string", "void",
+    "strict",  "method",    "class",     "construct", "destruct",
+    "return",  "allot",     "dellot",    "x",        "idx",    "count",
+    "my_var",  "buffer",    "strings",   "strict_mode", "node_ptr",
+    "classic", "constructs", "allotted", "dell",     "ret",    "value",
+};
+
+// A pseudo-random sequence of WORDS, the same on every run
+static std::vector<std::string_view> MakeWordStream(size_t count) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> pick(0, WORDS.size() - 1);
+    std::vector<std::string_view> stream;
+    stream.reserve(count);
+    for (size_t i = 0; i < count; i++) stream.push_back(WORDS[pick(random)]);
+    return stream;
+}
+
+FLECHA_BENCHMARK(BM_KeywordLookup) {
+    static const auto stream = MakeWordStream(4096);
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (auto word : stream) {
+            bench::DoNotOptimize(core::LookupKeyword(word));
+        }
+    }
+    state.items_per_iteration = stream.size();
+}
+
+// The unordered_map lookup the tokenizer used before, for comparison
+FLECHA_BENCHMARK(BM_KeywordLookupUnorderedMap) {
+    static const auto stream = MakeWordStream(4096);
+    static const std::unordered_map<std::string, TokenType> keywords = {
+        {"int", TokenType::Int},           {"char", TokenType::Char},
+        {"bool", TokenType::Bool},         {"float", TokenType::Float},
+        {"string", TokenType::String},     {"void", TokenType::Void},
+        {"strict", TokenType::Strict},     {"method", TokenType::Method},
+        {"class", TokenType::Class},       {"construct", TokenType::Construct},
+        {"destruct", TokenType::Destruct}, {"return", TokenType::Return},
+        {"allot", TokenType::Allot},       {"dellot", TokenType::Dellot},
+    };
+
+    for (size_t i = 0; i < state.iterations; i++) {
+        for (auto word : stream) {
+            auto it = keywords.find(std::string(word));
+            bench::DoNotOptimize(it == keywords.end() ? TokenType::Identifier
+                                                      : it->second);
+        }
+    }
+    state.items_per_iteration = stream.size();
+}
+
+FLECHA_BENCHMARK(BM_LexIdentifierHeavy) {
+    static const std::string source = [] {
+        std::string text;
+        for (auto word : MakeWordStream(1 << 16)) {
+            text += word;
+            text += ' ';
+        }
+        return text;
+    }();
+
+    size_t tokens = 0;
+    for (size_t i = 0; i < state.iterations; i++) {
+        core::Tokenizer tokenizer(source);
+        tokens = 0;
+        while (tokenizer.Next().type != TokenType::EOF_TOKEN) tokens++;
+    }
+    state.bytes_per_iteration = source.size();
+    state.items_per_iteration = tokens;
+}
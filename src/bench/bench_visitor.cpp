@@ -0,0 +1,153 @@
+#include <string>
+
+#include "Bench.hpp"
+#include "core/Parser.hpp"
+#include "core/StaticVisitor.hpp"
+
+using namespace flecha;
+using namespace flecha::core;
+
+// Declarations and allocations, repeated into a program of ~1000 statements
+static std::string MakeProgram() {
+    std::string source;
+    for (int i = 0; i < 250; i++) {
+        std::string n = std::to_string(i);
+        source += "int a" + n + " = " + n + ";\n";
+        source += "char c" + n + " = 'x';\n";
+        source += "int! p" + n + " = allot(int) -> 7;\n";
+        source += "Point! q" + n + " = allot(Point);\n";
+    }
+    return source;
+}
+
+static ProgramNode* ParseOnce(memory::Arena& arena) {
+    static const std::string source = MakeProgram();
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer, arena);
+    return parser.Parse();
+}
+
+// Counts nodes through Accept and the virtual Visitor, two indirect calls each
+struct VirtualCounter : Visitor {
+    size_t count = 0;
+
+    void Child(ASTNode* node) {
+        if (node) node->Accept(*this);
+    }
+
+    void Visit(VariableNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.value);
+    }
+    void Visit(ValueNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.type);
+    }
+    void Visit(StartNode&) override { count++; }
+    void Visit(EndNode&) override { count++; }
+    void Visit(LocationNode& n) override {
+        count++;
+        Child(n.start);
+        Child(n.end);
+    }
+    void Visit(RangeNode&) override { count++; }
+    void Visit(ProgramNode& n) override {
+        count++;
+        Child(n.body);
+        Child(n.location);
+        Child(n.range);
+    }
+    void Visit(ProgramInitializationNode&) override { count++; }
+    void Visit(BodyNode& n) override {
+        count++;
+        Child(n.program_init);
+        for (ASTNode* expression : n.expressions) Child(expression);
+    }
+    void Visit(AllocationStatementNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.allocation);
+        Child(n.initialization);
+    }
+    void Visit(VariableDeclarationNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.assignment);
+        Child(n.type);
+    }
+    void Visit(UnaryNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.operand);
+    }
+    void Visit(BinaryNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.left);
+        Child(n.right);
+    }
+    void Visit(InitializationStatementNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.pointer_node);
+    }
+    void Visit(PointerNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.type);
+        Child(n.memory);
+        Child(n.variable);
+    }
+    void Visit(MemoryNode& n) override {
+        count++;
+        Child(n.location);
+    }
+    void Visit(AllocationNode& n) override {
+        count++;
+        Child(n.location);
+        Child(n.pointer_node);
+    }
+    void Visit(PrimitiveTypeNode&) override { count++; }
+    void Visit(UserDefinedTypeNode&) override { count++; }
+};
+
+// The same walk, dispatched on the node kind
+struct StaticCounter : StaticVisitor<StaticCounter> {
+    using StaticVisitor<StaticCounter>::Visit;
+
+    size_t count = 0;
+
+    template <typename Node>
+    void Visit(Node& node) {
+        count++;
+        VisitChildren(node);
+    }
+};
+
+FLECHA_BENCHMARK(BM_VirtualVisitor) {
+    memory::Arena arena;
+    ProgramNode* program = ParseOnce(arena);
+
+    VirtualCounter counter;
+    for (size_t i = 0; i < state.iterations; i++) {
+        counter.count = 0;
+        program->Accept(counter);
+        bench::DoNotOptimize(counter.count);
+    }
+    state.items_per_iteration = counter.count;
+}
+
+FLECHA_BENCHMARK(BM_StaticVisitor) {
+    memory::Arena arena;
+    ProgramNode* program = ParseOnce(arena);
+
+    StaticCounter counter;
+    for (size_t i = 0; i < state.iterations; i++) {
+        counter.count = 0;
+        counter.Dispatch(*program);
+        bench::DoNotOptimize(counter.count);
+    }
+    state.items_per_iteration = counter.count;
+}
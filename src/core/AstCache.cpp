@@ -0,0 +1,231 @@
+#include "core/AstCache.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief The fixed start of every entry
+ */
+struct EntryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    uint32_t nodes;
+    uint32_t slots;
+    uint32_t text;
+    // ContentHash of every byte after the header, cut to 32 bits
+    uint32_t checksum;
+};
+
+static_assert(sizeof(EntryHeader) == 32, "EntryHeader must stay 32 bytes");
+static_assert(sizeof(NodeKind) == 1, "Entries store one byte per kind");
+
+constexpr char MAGIC[4] = {'F', 'A', 'S', 'T'};
+
+static size_t Padded(size_t bytes) { return (bytes + 3) & ~size_t{3}; }
+
+/**
+ * @brief Gets where each array starts in an entry
+ */
+struct EntryLayout {
+    size_t kinds, data0, data1, first_child, children, text, size;
+
+    EntryLayout(uint32_t nodes, uint32_t slots, uint32_t text_size) {
+        kinds = sizeof(EntryHeader);
+        data0 = kinds + Padded(nodes);
+        data1 = data0 + nodes * sizeof(uint32_t);
+        first_child = data1 + nodes * sizeof(uint32_t);
+        children = first_child + (nodes + size_t{1}) * sizeof(uint32_t);
+        text = children + slots * sizeof(NodeIndex);
+        size = text + text_size;
+    }
+};
+
+/**
+ * @brief Writes a whole buffer, retrying short writes
+ *
+ * @param fd - The descriptor
+ * @param data - The bytes
+ * @param size - How many
+ *
+ * @return False on error
+ */
+static bool WriteAll(int fd, const void* data, size_t size) {
+    auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t wrote = write(fd, bytes, size);
+        if (wrote < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += wrote;
+        size -= static_cast<size_t>(wrote);
+    }
+    return true;
+}
+
+AstCache::AstCache(string directory) : _directory(std::move(directory)) {
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    if (error) {
+        throw std::runtime_error("Cache Error: Could not create " +
+                                 _directory + ": " + error.message());
+    }
+}
+
+/**
+ * @brief Hashes eight bytes at a time, then mixes the tail and the length
+ *
+ * @param text - The source text
+ *
+ * @return - The hash
+ */
+uint64_t AstCache::ContentHash(std::string_view text) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+    auto mix = [](uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 33);
+    };
+
+    uint64_t hash = text.size() * MULTIPLIER;
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, 8);
+        hash = (hash ^ mix(word)) * MULTIPLIER;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, text.data() + i, text.size() - i);
+    return mix(hash ^ mix(tail ^ MULTIPLIER));
+}
+
+string AstCache::EntryPath(const string& path) const {
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    string key = error ? path : absolute.lexically_normal().string();
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.fast",
+                  static_cast<unsigned long long>(ContentHash(key)));
+    return (std::filesystem::path(_directory) / name).string();
+}
+
+// The checksum of an entry's arrays
+static uint32_t Checksum(std::string_view payload) {
+    return static_cast<uint32_t>(AstCache::ContentHash(payload));
+}
+
+/**
+ * @brief Maps an entry and points a view into it
+ *
+ * The header, the array sizes and the checksum are checked here, so a
+ * damaged entry is parsed again; the indices and child kinds are checked
+ * by Unflatten as the tree is rebuilt.
+ *
+ * @param path - The source path
+ * @param hash - The ContentHash of its current text
+ *
+ * @return - The entry, nothing if missing, stale or malformed
+ */
+std::optional<CachedAST> AstCache::Load(const string& path,
+                                        uint64_t hash) const {
+    std::optional<utils::SourceFile> file;
+    try {
+        file.emplace(EntryPath(path));
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+
+    std::string_view bytes = file->Text();
+    if (!file->IsMapped() || bytes.size() < sizeof(EntryHeader)) {
+        return std::nullopt;
+    }
+
+    EntryHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(EntryHeader));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION || header.hash != hash) {
+        return std::nullopt;
+    }
+
+    EntryLayout layout(header.nodes, header.slots, header.text);
+    if (layout.size != bytes.size()) return std::nullopt;
+    if (Checksum(bytes.substr(sizeof(EntryHeader))) != header.checksum) {
+        return std::nullopt;
+    }
+
+    // Mappings are page aligned, so every 4 byte aligned offset is too
+    const char* base = bytes.data();
+    FlatASTView view{
+        reinterpret_cast<const NodeKind*>(base + layout.kinds),
+        reinterpret_cast<const uint32_t*>(base + layout.data0),
+        reinterpret_cast<const uint32_t*>(base + layout.data1),
+        reinterpret_cast<const uint32_t*>(base + layout.first_child),
+        reinterpret_cast<const NodeIndex*>(base + layout.children),
+        std::string_view(base + layout.text, header.text),
+        header.nodes,
+    };
+    if (view.first_child[header.nodes] != header.slots) return std::nullopt;
+
+    return CachedAST(std::move(*file), view);
+}
+
+bool AstCache::Store(const string& path, uint64_t hash,
+                     const FlatAST& flat) const {
+    EntryHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.hash = hash;
+    header.nodes = static_cast<uint32_t>(flat.Size());
+    header.slots = static_cast<uint32_t>(flat.children.size());
+    header.text = static_cast<uint32_t>(flat.text.size());
+
+    // The arrays are laid out in memory first, to be checksummed
+    EntryLayout layout(header.nodes, header.slots, header.text);
+    string payload(layout.size - sizeof(EntryHeader), '\0');
+    auto put = [&](size_t offset, const void* data, size_t size) {
+        if (size) {
+            std::memcpy(&payload[offset - sizeof(EntryHeader)], data, size);
+        }
+    };
+    put(layout.kinds, flat.kinds.data(), flat.kinds.size());
+    put(layout.data0, flat.data0.data(), flat.data0.size() * sizeof(uint32_t));
+    put(layout.data1, flat.data1.data(), flat.data1.size() * sizeof(uint32_t));
+    put(layout.first_child, flat.first_child.data(),
+        flat.first_child.size() * sizeof(uint32_t));
+    put(layout.children, flat.children.data(),
+        flat.children.size() * sizeof(NodeIndex));
+    put(layout.text, flat.text.data(), flat.text.size());
+    header.checksum = Checksum(payload);
+
+    string entry = EntryPath(path);
+    string temporary = entry + ".XXXXXX";
+    int fd = mkstemp(&temporary[0]);
+    if (fd < 0) return false;
+
+    bool written = WriteAll(fd, &header, sizeof(header)) &&
+                   WriteAll(fd, payload.data(), payload.size());
+    written = close(fd) == 0 && written;
+
+    if (!written || std::rename(temporary.c_str(), entry.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace core
+}  // namespace flecha
@@ -0,0 +1,75 @@
+#include "core/Diagnostics.hpp"
+
+#include <algorithm>
+
+namespace flecha {
+namespace core {
+
+void Diagnostics::Sort() {
+    std::stable_sort(_entries.begin(), _entries.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) {
+                         return a.offset < b.offset;
+                     });
+}
+
+const char* MessageOf(DiagnosticCode code) {
+    switch (code) {
+        case DiagnosticCode::UnterminatedString:
+            return "Unterminated string literal.";
+        case DiagnosticCode::UnterminatedChar:
+            return "Unterminated character literal.";
+        case DiagnosticCode::InvalidEscape:
+            return "Invalid escape sequence in character literal.";
+        case DiagnosticCode::NumberOutOfRange:
+            return "Number literal out of range.";
+        case DiagnosticCode::ExpectedDeclaration:
+            return "Expected declaration.";
+        case DiagnosticCode::ExpectedVariableName:
+            return "Expected variable name.";
+        case DiagnosticCode::ExpectedEqual:
+            return "Expected '=' after variable name.";
+        case DiagnosticCode::ExpectedSemiColon:
+            return "Expected ';' after value.";
+        case DiagnosticCode::ExpectedExpression:
+            return "Expected expression.";
+        case DiagnosticCode::ExpectedCloseParen:
+            return "Expected ')' after expression.";
+        case DiagnosticCode::ExpectedAllot:
+            return "Expected 'allot' for pointer.";
+        case DiagnosticCode::ExpectedAllotOpenParen:
+            return "Expected '(' after 'allot'.";
+        case DiagnosticCode::ExpectedAllotCloseParen:
+            return "Expected ')' after type.";
+        case DiagnosticCode::AllotTypeMismatch:
+            return "Allotted type does not match the declared type";
+        case DiagnosticCode::NestingTooDeep:
+            return "Expression nested too deeply.";
+    }
+
+    return "Unknown error.";
+}
+
+string Format(const Diagnostic& diagnostic, SourceLocation location) {
+    auto number = static_cast<unsigned>(diagnostic.code);
+    string message = number < 200 ? "Lexer Error [E" : "Parser Error [E";
+    message += std::to_string(number);
+    message += "]: ";
+    message += MessageOf(diagnostic.code);
+
+    if (!diagnostic.detail.empty()) {
+        message += " ";
+        message += diagnostic.detail;
+        message += ".";
+    }
+    if (!diagnostic.found.empty()) {
+        message += " Found: ";
+        message += diagnostic.found;
+    }
+
+    message += " at line " + std::to_string(location.line) + ", column " +
+               std::to_string(location.column);
+    return message;
+}
+
+}  // namespace core
+}  // namespace flecha
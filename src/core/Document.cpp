@@ -0,0 +1,405 @@
+#include "core/Document.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "core/Parser.hpp"
+#include "core/StaticVisitor.hpp"
+
+namespace flecha {
+namespace core {
+
+// Full reparses wait for at least this many replaced statements
+static constexpr size_t MIN_GARBAGE = 64;
+
+/**
+ * @brief How an edit moves the locations after it
+ */
+struct Shift {
+    // The old line the edit ended on, columns move only there
+    int line;
+    int lines;
+    int columns;
+
+    void Apply(int& at_line, int& at_column) const {
+        if (at_line == line) at_column += columns;
+        at_line += lines;
+    }
+};
+
+/**
+ * @brief Collects the start and end nodes of a subtree
+ *
+ * @param node - The subtree root, may be null
+ * @param out - Receives the nodes
+ */
+static void CollectLocations(ASTNode* node, vector<ASTNode*>& out) {
+    if (!node) return;
+
+    if (node->kind == NodeKind::Start || node->kind == NodeKind::End) {
+        out.push_back(node);
+    }
+    ForEachChild(*node, [&](ASTNode* child) { CollectLocations(child, out); });
+}
+
+/**
+ * @brief Moves collected start and end nodes
+ *
+ * @param locations - The nodes
+ * @param shift - How to move them
+ */
+static void ShiftLocations(const NodeList& locations, const Shift& shift) {
+    for (ASTNode* node : locations) {
+        if (node->kind == NodeKind::Start) {
+            auto* start = static_cast<StartNode*>(node);
+            shift.Apply(start->line, start->column);
+        } else {
+            auto* end = static_cast<EndNode*>(node);
+            shift.Apply(end->line, end->column);
+        }
+    }
+}
+
+/**
+ * @brief Finds where a text ends when it starts at a location
+ *
+ * @param from - The location of the text's first byte
+ * @param text - The text
+ *
+ * @return The location right after it
+ */
+static SourceLocation Advance(SourceLocation from, std::string_view text) {
+    const char* base = text.data();
+    const char* last = nullptr;
+    for (const char* newline = static_cast<const char*>(
+             std::memchr(base, '\n', text.size()));
+         newline;
+         newline = static_cast<const char*>(std::memchr(
+             newline + 1, '\n', text.size() - (newline + 1 - base)))) {
+        from.line++;
+        last = newline;
+    }
+
+    if (!last) {
+        from.column += static_cast<int>(text.size());
+    } else {
+        from.column = static_cast<int>(base + text.size() - last);
+    }
+    return from;
+}
+
+static bool IsLexical(DiagnosticCode code) {
+    return static_cast<unsigned>(code) < 200;
+}
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Parses the whole text again into the other arena
+ */
+void Document::_ParseAll() {
+    _live ^= 1;
+    _Arena().Reset();
+    _garbage = 0;
+
+    _program_start = _Arena().Make<StartNode>(1, 1);
+    _program_end = _Arena().Make<EndNode>(1, 1);
+    _program_range = _Arena().Make<RangeNode>(0, 0);
+    _body = _Arena().Make<BodyNode>(nullptr, NodeList{});
+    _program = _Arena().Make<ProgramNode>(
+        _body, _Arena().Make<LocationNode>(_program_start, _program_end),
+        _program_range);
+
+    vector<Statement> fresh;
+    _statements.clear();
+    _Reparse(0, 0, SourceLocation{1, 1}, 0, 0, 0, fresh);
+
+    _statements = std::move(fresh);
+    _moved_from = _statements.size();
+    _moved_by = 0;
+    _reparsed = _statements.size();
+    _Finish(true);
+}
+
+/**
+ * @brief Parses statements until they line up with the old ones again
+ *
+ * @param first - The first old statement that may be kept
+ * @param start - Where parsing starts, the start of a statement
+ * @param at - The location of start
+ * @param old_end - Where the edit ended in the old text
+ * @param removed - How many bytes the edit removed
+ * @param inserted - How many bytes the edit inserted
+ * @param fresh - Receives the parsed statements
+ *
+ * @return - The first old statement to keep, the count of old statements
+ * if parsing reached the end of the text
+ */
+size_t Document::_Reparse(size_t first, size_t start, SourceLocation at,
+                          size_t old_end, size_t removed, size_t inserted,
+                          vector<Statement>& fresh) {
+    Tokenizer tokenizer(_text, start, at);
+    Diagnostics diagnostics;
+    Parser parser(tokenizer, _Arena(), diagnostics);
+
+    // Where an old statement starts in the new text
+    auto moved = [&](size_t index) {
+        return _Begin(index) - removed + inserted;
+    };
+    auto keep = [&](const Diagnostic& diagnostic, size_t begin) {
+        return Diagnostic{diagnostic.code, diagnostic.offset - begin,
+                          _Arena().CopyString(diagnostic.found),
+                          _Arena().CopyString(diagnostic.detail)};
+    };
+
+    vector<ASTNode*> locations;
+    size_t next = first;
+    size_t stop;
+    while (true) {
+        const Token& token = tokenizer.Peek();
+        stop = token.offset;
+        if (token.type == TokenType::EOF_TOKEN) {
+            next = _statements.size();
+            _end = tokenizer.Locate(stop);
+            break;
+        }
+
+        // Only statements after the edit read the same text as before
+        while (next < _statements.size() &&
+               (_Begin(next) < old_end || moved(next) < stop)) {
+            next++;
+        }
+        if (next < _statements.size() && moved(next) == stop) break;
+
+        size_t reported = diagnostics.Count();
+        Statement statement{stop, tokenizer.Locate(stop),
+                            parser.ParseStatement(), {}, {}};
+
+        // Kept flat so moving the statement does not walk its tree
+        locations.clear();
+        CollectLocations(statement.node, locations);
+        statement.locations.data =
+            _Arena().MakeArray<ASTNode*>(locations.size());
+        statement.locations.count = locations.size();
+        std::copy(locations.begin(), locations.end(),
+                  statement.locations.data);
+        for (size_t i = reported; i < diagnostics.Count(); i++) {
+            if (!IsLexical(diagnostics[i].code)) {
+                statement.diagnostics.push_back(
+                    keep(diagnostics[i], statement.begin));
+            }
+        }
+        fresh.push_back(std::move(statement));
+    }
+
+    // Lexical errors can be found while peeking into the next statement,
+    // so they go to the statement holding them. Kept statements already
+    // have their own.
+    for (const Diagnostic& diagnostic : diagnostics.Entries()) {
+        if (!IsLexical(diagnostic.code) || diagnostic.offset >= stop) continue;
+
+        auto owner = std::upper_bound(
+            fresh.begin(), fresh.end(), diagnostic.offset,
+            [](size_t offset, const Statement& s) { return offset < s.begin; });
+        if (owner == fresh.begin()) continue;
+        --owner;
+        owner->diagnostics.push_back(keep(diagnostic, owner->begin));
+    }
+
+    return next;
+}
+
+/**
+ * @brief Points the program nodes at the current statements
+ *
+ * @param relist - Whether to collect the body list again, when statements
+ * were added, removed or broken
+ */
+void Document::_Finish(bool relist) {
+    if (relist) {
+        _nodes.clear();
+        for (const Statement& statement : _statements) {
+            if (statement.node) _nodes.push_back(statement.node);
+        }
+        _broken = _statements.size() - _nodes.size();
+    }
+    _body->expressions = NodeList{_nodes.data(), _nodes.size()};
+
+    SourceLocation first = _statements.empty() ? _end : _statements[0].at;
+    _program_start->line = first.line;
+    _program_start->column = first.column;
+    _program_end->line = _end.line;
+    _program_end->column = _end.column;
+    _program_range->range = {
+        static_cast<unsigned int>(_statements.empty() ? _text.size()
+                                                      : _Begin(0)),
+        static_cast<unsigned int>(_text.size())};
+}
+
+/* PUBLIC METHODS */
+
+Document::Document(string text)
+    : _text(std::move(text)),
+      _live(1),
+      _end{1, 1},
+      _reparsed(0),
+      _garbage(0),
+      _broken(0),
+      _moved_from(0),
+      _moved_by(0) {
+    _ParseAll();
+}
+
+/**
+ * @brief Replaces a range of the text and reparses around it
+ *
+ * @param offset - Where the replaced range starts
+ * @param removed - How many bytes are replaced
+ * @param inserted - The new text
+ */
+void Document::Edit(size_t offset, size_t removed, std::string_view inserted) {
+    if (offset > _text.size() || removed > _text.size() - offset) {
+        throw std::out_of_range("Document Error: Edit outside the text.");
+    }
+
+    // Start from the statement before the edited byte, its last token may
+    // run into the edit
+    size_t before = 0;
+    for (size_t count = _statements.size(); count > 0;) {
+        size_t half = count / 2;
+        if (_Begin(before + half) < offset) {
+            before += half + 1;
+            count -= half + 1;
+        } else {
+            count = half;
+        }
+    }
+    size_t first = before ? before - 1 : 0;
+
+    // A broken statement may have stopped only because the next one opens
+    // with a type keyword, which the edit can turn into something else
+    if (first > 0 && !_statements[first - 1].node) first--;
+
+    // An unterminated string looked for its quote up to the end of the
+    // text, so an edit anywhere after it may close it
+    for (size_t i = 0; i < first; i++) {
+        const auto& errors = _statements[i].diagnostics;
+        if (std::any_of(errors.begin(), errors.end(), [](const auto& d) {
+                return d.code == DiagnosticCode::UnterminatedString;
+            })) {
+            first = i;
+            break;
+        }
+    }
+
+    size_t start = before ? _Begin(first) : 0;
+    SourceLocation at = before ? _statements[first].at : SourceLocation{1, 1};
+
+    size_t old_end = offset + removed;
+    SourceLocation edit_at =
+        Advance(at, std::string_view(_text).substr(start, offset - start));
+    SourceLocation old_end_at =
+        Advance(edit_at, std::string_view(_text).substr(offset, removed));
+    SourceLocation new_end_at = Advance(edit_at, inserted);
+    Shift shift{old_end_at.line, new_end_at.line - old_end_at.line,
+                new_end_at.column - old_end_at.column};
+
+    _text.replace(offset, removed, inserted);
+
+    vector<Statement> fresh;
+    size_t kept = _Reparse(first, start, at, old_end, removed, inserted.size(),
+                           fresh);
+
+    // Move the locations of what follows, without new lines only the
+    // statements on the edited line change columns
+    for (size_t i = kept; i < _statements.size(); i++) {
+        Statement& statement = _statements[i];
+        if (shift.lines == 0 && statement.at.line != shift.line) break;
+
+        shift.Apply(statement.at.line, statement.at.column);
+        ShiftLocations(statement.locations, shift);
+    }
+    if (kept < _statements.size()) shift.Apply(_end.line, _end.column);
+
+    // Offsets move lazily: statements from _moved_from on are all off by
+    // _moved_by, so only those between the last edit and this one are
+    // updated. Unsigned wrap around makes negative moves work.
+    size_t delta = inserted.size() - removed;
+    if (_moved_from < kept) {
+        for (size_t i = _moved_from; i < first; i++) {
+            _statements[i].begin += _moved_by;
+        }
+        _moved_from = kept;
+    } else {
+        for (size_t i = kept; i < _moved_from; i++) {
+            _statements[i].begin += delta;
+        }
+    }
+    _moved_by += delta;
+
+    _reparsed = fresh.size();
+    _garbage += kept - first;
+
+    // Most edits keep the statement count, so the body list only changes
+    // in place when no statement is broken
+    bool in_place = fresh.size() == kept - first && _broken == 0;
+    for (size_t i = 0; in_place && i < fresh.size(); i++) {
+        in_place = fresh[i].node != nullptr;
+    }
+
+    if (fresh.size() == kept - first) {
+        std::move(fresh.begin(), fresh.end(), _statements.begin() + first);
+    } else {
+        _statements.erase(_statements.begin() + first,
+                          _statements.begin() + kept);
+        _statements.insert(_statements.begin() + first,
+                           std::make_move_iterator(fresh.begin()),
+                           std::make_move_iterator(fresh.end()));
+        _moved_from = _moved_from + fresh.size() - (kept - first);
+    }
+    if (_moved_from >= _statements.size()) {
+        _moved_from = _statements.size();
+        _moved_by = 0;
+    }
+
+    if (_garbage > std::max(_statements.size(), MIN_GARBAGE)) {
+        _ParseAll();
+        return;
+    }
+
+    if (in_place) {
+        for (size_t i = first; i < first + fresh.size(); i++) {
+            _nodes[i] = _statements[i].node;
+        }
+    }
+    _Finish(!in_place);
+}
+
+/**
+ * @brief Collects the errors of every statement
+ *
+ * @return - The diagnostics sorted by offset
+ */
+vector<Diagnostic> Document::Errors() const {
+    vector<Diagnostic> errors;
+    for (size_t i = 0; i < _statements.size(); i++) {
+        for (Diagnostic diagnostic : _statements[i].diagnostics) {
+            diagnostic.offset += _Begin(i);
+            errors.push_back(diagnostic);
+        }
+    }
+
+    // A token is lexed before the parser can complain about it, so at the
+    // same offset lexical errors come first, as in a full parse
+    std::stable_sort(errors.begin(), errors.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) {
+                         if (a.offset != b.offset) return a.offset < b.offset;
+                         return IsLexical(a.code) && !IsLexical(b.code);
+                     });
+    return errors;
+}
+
+}  // namespace core
+}  // namespace flecha
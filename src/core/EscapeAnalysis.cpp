@@ -0,0 +1,91 @@
+#include "core/EscapeAnalysis.hpp"
+
+namespace flecha {
+namespace core {
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Marks the pointers an expression lets escape
+ *
+ * @param expression - The expression
+ * @param written_through - Whether the expression is the pointer of a ->,
+ * the one use that does not escape
+ */
+void EscapeAnalysis::_Use(ASTNode* expression, bool written_through) {
+    if (!expression) return;
+
+    switch (expression->kind) {
+        case NodeKind::Variable: {
+            if (written_through) return;
+
+            auto& variable = static_cast<VariableNode&>(*expression);
+            auto binding = _bindings.find(variable.symbol);
+            if (binding != _bindings.end() && binding->second) {
+                _escaped.insert(binding->second);
+            }
+            return;
+        }
+        case NodeKind::Unary:
+            // ?p takes the pointer's own address, which escapes it too
+            _Use(static_cast<UnaryNode&>(*expression).operand, false);
+            return;
+        case NodeKind::Binary: {
+            auto& binary = static_cast<BinaryNode&>(*expression);
+            bool store = binary.op == TokenType::AssignVal &&
+                         binary.left->kind == NodeKind::Variable;
+            _Use(binary.left, store);
+            _Use(binary.right, false);
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+/* PUBLIC METHODS */
+
+/**
+ * @brief Walks the statements in order, then keeps the allots nothing let
+ * escape
+ *
+ * @param program - The program
+ */
+EscapeAnalysis::EscapeAnalysis(ProgramNode* program) : _allocations(0) {
+    auto* body = program ? static_cast<BodyNode*>(program->body) : nullptr;
+    if (!body) return;
+
+    vector<const AllocationStatementNode*> allocations;
+    for (ASTNode* statement : body->expressions) {
+        if (statement->kind == NodeKind::VariableDeclaration) {
+            auto& declaration =
+                static_cast<VariableDeclarationNode&>(*statement);
+            auto& variable = static_cast<VariableNode&>(*declaration.assignment);
+            _Use(variable.value, false);
+            _bindings[variable.symbol] = nullptr;
+        } else if (statement->kind == NodeKind::AllocationStatement) {
+            auto& allocation =
+                static_cast<AllocationStatementNode&>(*statement);
+            auto& pointer = static_cast<PointerNode&>(
+                *static_cast<AllocationNode&>(*allocation.allocation)
+                     .pointer_node);
+            auto& variable = static_cast<VariableNode&>(*pointer.variable);
+
+            // The initial value is written through the new pointer
+            _Use(variable.value, false);
+            _bindings[variable.symbol] = &allocation;
+            allocations.push_back(&allocation);
+        }
+    }
+
+    _allocations = allocations.size();
+    for (const AllocationStatementNode* allocation : allocations) {
+        if (!_escaped.count(allocation)) _local.insert(allocation);
+    }
+
+    _bindings.clear();
+    _escaped.clear();
+}
+
+}  // namespace core
+}  // namespace flecha
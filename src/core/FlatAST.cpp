@@ -0,0 +1,382 @@
+#include "core/FlatAST.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+
+#include "core/StaticVisitor.hpp"
+
+template <typename... Args>
+using umap = std::unordered_map<Args...>;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Walks a tree in pre-order, appending every node once
+ */
+struct Flattener {
+    FlatAST flat;
+    umap<const ASTNode*, NodeIndex> indices;
+    umap<std::string_view, uint32_t> texts;
+
+    /**
+     * @brief Stores a text payload, identical texts only once
+     *
+     * @param index - The node
+     * @param text - Its name or value
+     */
+    void SetText(NodeIndex index, std::string_view text) {
+        auto it = texts.find(text);
+        if (it == texts.end()) {
+            it = texts.emplace(text, flat.text.size()).first;
+            flat.text.append(text);
+        }
+
+        flat.data0[index] = it->second;
+        flat.data1[index] = static_cast<uint32_t>(text.size());
+    }
+
+    /**
+     * @brief Appends a node and, after it, its not yet seen descendants
+     *
+     * @param node - The node, may be null
+     *
+     * @return - Its index, NO_NODE for null and memory nodes
+     */
+    NodeIndex Add(ASTNode* node) {
+        if (!node || node->kind == NodeKind::Memory) return NO_NODE;
+
+        auto seen = indices.find(node);
+        if (seen != indices.end()) return seen->second;
+
+        auto index = static_cast<NodeIndex>(flat.kinds.size());
+        indices.emplace(node, index);
+        flat.kinds.push_back(node->kind);
+        flat.data0.push_back(0);
+        flat.data1.push_back(0);
+
+        switch (node->kind) {
+            case NodeKind::Start: {
+                auto* n = static_cast<StartNode*>(node);
+                flat.data0[index] = n->line;
+                flat.data1[index] = n->column;
+                break;
+            }
+            case NodeKind::End: {
+                auto* n = static_cast<EndNode*>(node);
+                flat.data0[index] = n->line;
+                flat.data1[index] = n->column;
+                break;
+            }
+            case NodeKind::Range: {
+                auto* n = static_cast<RangeNode*>(node);
+                flat.data0[index] = n->range.first;
+                flat.data1[index] = n->range.second;
+                break;
+            }
+            case NodeKind::Unary:
+                flat.data0[index] =
+                    static_cast<uint32_t>(static_cast<UnaryNode*>(node)->op);
+                break;
+            case NodeKind::Binary:
+                flat.data0[index] =
+                    static_cast<uint32_t>(static_cast<BinaryNode*>(node)->op);
+                break;
+            case NodeKind::Variable:
+                SetText(index, static_cast<VariableNode*>(node)->name);
+                break;
+            case NodeKind::Value: {
+                auto* n = static_cast<ValueNode*>(node);
+                if (n->value.size() > TEXT_LENGTH_MASK) {
+                    throw std::length_error(
+                        "Flat AST Error: Literal too long to flatten");
+                }
+                SetText(index, n->value);
+                flat.data1[index] |= static_cast<uint32_t>(n->literal.kind)
+                                     << LITERAL_KIND_SHIFT;
+                break;
+            }
+            case NodeKind::ProgramInitialization:
+                SetText(index, static_cast<ProgramInitializationNode*>(node)
+                                   ->package_name);
+                break;
+            case NodeKind::PrimitiveType:
+            case NodeKind::UserDefinedType:
+                SetText(index, static_cast<TypeNode*>(node)->GetTypeName());
+                break;
+            default:
+                break;
+        }
+
+        // Reserve this node's slots before any descendant takes an index
+        vector<ASTNode*> slots;
+        ForEachChild(*node, [&](ASTNode* child) { slots.push_back(child); });
+        auto first = static_cast<uint32_t>(flat.children.size());
+        flat.first_child.push_back(first);
+        flat.children.resize(first + slots.size(), NO_NODE);
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            NodeIndex child = Add(slots[i]);
+            flat.children[first + i] = child;
+        }
+
+        return index;
+    }
+};
+
+// The kinds a child slot accepts, one bit per NodeKind
+using KindMask = uint32_t;
+
+static_assert(static_cast<size_t>(NodeKind::UserDefinedType) < 31,
+              "NodeKind no longer fits a KindMask");
+
+static constexpr KindMask Bit(NodeKind kind) {
+    return KindMask{1} << static_cast<uint32_t>(kind);
+}
+
+// Set for slots that may hold NO_NODE
+static constexpr KindMask OPTIONAL = KindMask{1} << 31;
+static constexpr KindMask LOCATION = Bit(NodeKind::Location) | OPTIONAL;
+static constexpr KindMask EXPRESSION =
+    Bit(NodeKind::Variable) | Bit(NodeKind::Value) | Bit(NodeKind::Unary) |
+    Bit(NodeKind::Binary);
+static constexpr KindMask TYPE =
+    Bit(NodeKind::PrimitiveType) | Bit(NodeKind::UserDefinedType);
+static constexpr KindMask STATEMENT =
+    Bit(NodeKind::AllocationStatement) | Bit(NodeKind::VariableDeclaration);
+
+/**
+ * @brief Rebuilds nodes on demand, each flat node once
+ */
+struct Unflattener {
+    const FlatASTView& flat;
+    memory::Arena& arena;
+    utils::Interner& symbols;
+    vector<ASTNode*> built;
+    // Set while a node's subtree is being built, to catch cycles
+    vector<bool> building;
+    // Flatten stores each distinct text once, so a name is known by its
+    // offset: 1 + its index in names, 0 if not interned yet
+    vector<uint32_t> names_at;
+    vector<std::pair<utils::Symbol, std::string_view>> names;
+
+    [[noreturn]] static void Corrupt() {
+        throw std::invalid_argument("Flat AST Error: Malformed flat AST");
+    }
+
+    /**
+     * @brief Interns a node's name, the shared interner only once per name
+     *
+     * @param index - The node
+     * @param stored - Receives the interned copy of the name
+     *
+     * @return - The symbol
+     */
+    utils::Symbol Intern(NodeIndex index, std::string_view* stored) {
+        std::string_view text = flat.Text(index);
+        uint32_t& known = names_at[flat.data0[index]];
+        if (known && names[known - 1].second.size() == text.size()) {
+            *stored = names[known - 1].second;
+            return names[known - 1].first;
+        }
+
+        utils::Symbol symbol = symbols.Intern(text, stored);
+        if (!known) {
+            names.emplace_back(symbol, *stored);
+            known = static_cast<uint32_t>(names.size());
+        }
+        return symbol;
+    }
+
+    /**
+     * @brief Gets the node for an index, building its subtree if needed
+     *
+     * @param index - The node index, may be NO_NODE
+     *
+     * @return - The node, nullptr for NO_NODE
+     */
+    ASTNode* Build(NodeIndex index) {
+        if (index == NO_NODE) return nullptr;
+        // Views may come from files, so indices are checked before use
+        if (index >= flat.Size() ||
+            flat.first_child[index] > flat.first_child[index + 1] ||
+            flat.first_child[index + 1] > flat.first_child[flat.Size()]) {
+            Corrupt();
+        }
+        if (built[index]) return built[index];
+        // A child pointing back at an ancestor would recurse forever
+        if (building[index]) Corrupt();
+        building[index] = true;
+
+        ChildRange slots = flat.Children(index);
+        auto child = [&](size_t slot, KindMask kinds) {
+            if (slot >= slots.size()) Corrupt();
+            NodeIndex at = slots[slot];
+            if (at == NO_NODE) {
+                if (!(kinds & OPTIONAL)) Corrupt();
+                return static_cast<ASTNode*>(nullptr);
+            }
+            // Kinds past the enum are caught by the switch below
+            if (at < flat.Size() &&
+                static_cast<uint32_t>(flat.kinds[at]) < 31 &&
+                !(kinds & Bit(flat.kinds[at]))) {
+                Corrupt();
+            }
+            return Build(at);
+        };
+        auto text = [&]() { return arena.CopyString(flat.Text(index)); };
+        std::string_view name;
+        auto intern = [&]() { return Intern(index, &name); };
+        ASTNode* node = nullptr;
+
+        switch (flat.kinds[index]) {
+            case NodeKind::Variable: {
+                utils::Symbol symbol = intern();
+                node = arena.Make<VariableNode>(
+                    name, child(0, LOCATION), child(1, EXPRESSION | OPTIONAL),
+                    symbol);
+                break;
+            }
+            case NodeKind::Value: {
+                Literal::Kind kind = flat.LiteralKind(index);
+                if (kind > Literal::Kind::Bool) Corrupt();
+                std::string_view value = text();
+                node = arena.Make<ValueNode>(value, child(0, LOCATION),
+                                             child(1, TYPE | OPTIONAL),
+                                             DecodeLiteral(kind, value));
+                break;
+            }
+            case NodeKind::Start:
+                node = arena.Make<StartNode>(flat.data0[index],
+                                             flat.data1[index]);
+                break;
+            case NodeKind::End:
+                node =
+                    arena.Make<EndNode>(flat.data0[index], flat.data1[index]);
+                break;
+            case NodeKind::Location:
+                node = arena.Make<LocationNode>(
+                    child(0, Bit(NodeKind::Start) | OPTIONAL),
+                    child(1, Bit(NodeKind::End) | OPTIONAL));
+                break;
+            case NodeKind::Range:
+                node = arena.Make<RangeNode>(flat.data0[index],
+                                             flat.data1[index]);
+                break;
+            case NodeKind::Program:
+                node = arena.Make<ProgramNode>(
+                    child(0, Bit(NodeKind::Body) | OPTIONAL),
+                    child(1, LOCATION),
+                    child(2, Bit(NodeKind::Range) | OPTIONAL));
+                break;
+            case NodeKind::ProgramInitialization: {
+                utils::Symbol symbol = intern();
+                node = arena.Make<ProgramInitializationNode>(name, symbol);
+                break;
+            }
+            case NodeKind::Body: {
+                if (slots.size() == 0) Corrupt();
+                NodeList expressions;
+                expressions.count = slots.size() - 1;
+                expressions.data =
+                    arena.MakeArray<ASTNode*>(expressions.count);
+                for (size_t i = 0; i < expressions.count; i++) {
+                    expressions[i] = child(i + 1, STATEMENT);
+                }
+                node = arena.Make<BodyNode>(
+                    child(0, Bit(NodeKind::ProgramInitialization) | OPTIONAL),
+                    expressions);
+                break;
+            }
+            case NodeKind::AllocationStatement:
+                node = arena.Make<AllocationStatementNode>(
+                    child(0, LOCATION), child(1, Bit(NodeKind::Allocation)),
+                    child(2, Bit(NodeKind::InitializationStatement) |
+                                 OPTIONAL));
+                break;
+            case NodeKind::VariableDeclaration:
+                node = arena.Make<VariableDeclarationNode>(
+                    child(0, LOCATION), child(1, Bit(NodeKind::Variable)),
+                    child(2, TYPE | OPTIONAL));
+                break;
+            case NodeKind::Unary:
+                node = arena.Make<UnaryNode>(
+                    static_cast<TokenType>(flat.data0[index]),
+                    child(0, LOCATION), child(1, EXPRESSION));
+                break;
+            case NodeKind::Binary:
+                node = arena.Make<BinaryNode>(
+                    static_cast<TokenType>(flat.data0[index]),
+                    child(0, LOCATION), child(1, EXPRESSION),
+                    child(2, EXPRESSION));
+                break;
+            case NodeKind::InitializationStatement:
+                node = arena.Make<InitializationStatementNode>(
+                    child(0, LOCATION), child(1, Bit(NodeKind::Pointer)));
+                break;
+            case NodeKind::Pointer:
+                node = arena.Make<PointerNode>(
+                    child(0, LOCATION), child(1, TYPE), nullptr,
+                    child(3, Bit(NodeKind::Variable)));
+                break;
+            case NodeKind::Allocation:
+                node = arena.Make<AllocationNode>(
+                    child(0, LOCATION), child(1, Bit(NodeKind::Pointer)));
+                break;
+            case NodeKind::PrimitiveType: {
+                utils::Symbol symbol = intern();
+                node = arena.Make<PrimitiveTypeNode>(name, symbol);
+                break;
+            }
+            case NodeKind::UserDefinedType: {
+                utils::Symbol symbol = intern();
+                node = arena.Make<UserDefinedTypeNode>(name, symbol);
+                break;
+            }
+            case NodeKind::Memory:
+                throw std::invalid_argument(
+                    "Flat AST Error: Memory nodes are not flattened");
+        }
+        if (!node) Corrupt();
+
+        building[index] = false;
+        built[index] = node;
+        return node;
+    }
+};
+
+size_t FlatAST::MemoryBytes() const {
+    return kinds.size() * sizeof(NodeKind) +
+           (data0.size() + data1.size() + first_child.size()) *
+               sizeof(uint32_t) +
+           children.size() * sizeof(NodeIndex) + text.size();
+}
+
+FlatAST Flatten(ASTNode* root) {
+    Flattener flattener;
+    flattener.Add(root);
+
+    // Sentinel closing the last node's child range
+    flattener.flat.first_child.push_back(
+        static_cast<uint32_t>(flattener.flat.children.size()));
+    return std::move(flattener.flat);
+}
+
+ASTNode* Unflatten(const FlatAST& flat, memory::Arena& arena,
+                   utils::Interner& symbols) {
+    return Unflatten(flat.View(), arena, symbols);
+}
+
+ASTNode* Unflatten(const FlatASTView& flat, memory::Arena& arena,
+                   utils::Interner& symbols) {
+    if (flat.Size() == 0) return nullptr;
+
+    Unflattener unflattener{flat, arena, symbols,
+                            vector<ASTNode*>(flat.Size()),
+                            vector<bool>(flat.Size()),
+                            vector<uint32_t>(flat.text.size() + 1), {}};
+    return unflattener.Build(0);
+}
+
+}  // namespace core
+}  // namespace flecha
@@ -0,0 +1,107 @@
+#include "core/Frontend.hpp"
+
+#include <exception>
+
+#include "core/Parser.hpp"
+#include "utils/SourceFile.hpp"
+#include "utils/Trace.hpp"
+
+namespace flecha {
+namespace core {
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Rebuilds a file's tree from its cache entry
+ *
+ * @param path - The source path
+ * @param hash - The hash of its text
+ * @param worker - The worker whose arena gets the tree
+ *
+ * @return - The tree, nullptr on a miss or a malformed entry
+ */
+ProgramNode* Frontend::_Load(const string& path, uint64_t hash,
+                             size_t worker) {
+    FLECHA_TRACE_SCOPE(trace, "LoadCached", "core");
+    trace.Detail(path);
+    std::optional<CachedAST> entry = _cache->Load(path, hash);
+    if (!entry || entry->View().Size() == 0 ||
+        entry->View().kinds[0] != NodeKind::Program) {
+        return nullptr;
+    }
+
+    try {
+        return static_cast<ProgramNode*>(
+            Unflatten(entry->View(), _arenas[worker], _symbols));
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+/* PUBLIC METHODS */
+
+Frontend::Frontend(size_t threads, const AstCache* cache)
+    : _pool(threads), _arenas(_pool.Size()), _cache(cache) {}
+
+vector<ParsedFile> Frontend::ParseFiles(const vector<string>& paths) {
+    FLECHA_TRACE_SCOPE(trace, "ParseFiles", "core");
+    trace.Arg("files", paths.size());
+    vector<ParsedFile> results(paths.size());
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        // Every task writes only its own result slot
+        _pool.Submit([this, &paths, &results, i](size_t worker) {
+            ParsedFile& result = results[i];
+            result.path = paths[i];
+            FLECHA_TRACE_SCOPE(trace, "ParseFile", "core");
+            trace.Detail(paths[i]);
+
+            try {
+                utils::SourceFile file(paths[i]);
+                trace.Rate("bytes", file.Text().size());
+                bool cacheable = _cache && paths[i] != "-";
+                uint64_t hash = 0;
+                if (cacheable) {
+                    hash = AstCache::ContentHash(file.Text());
+                    result.program = _Load(paths[i], hash, worker);
+                    if (result.program) {
+                        trace.Arg("cached", 1);
+                        result.cached = true;
+                        return;
+                    }
+                }
+
+                Tokenizer tokenizer(file.Text());
+                Diagnostics diagnostics;
+                Parser parser(tokenizer, _arenas[worker], diagnostics,
+                              _symbols);
+                ProgramNode* program = parser.Parse();
+
+                // Formatted now, the found text points into the file
+                for (const Diagnostic& diagnostic : diagnostics.Entries()) {
+                    result.diagnostics.push_back(
+                        paths[i] + ": " +
+                        Format(diagnostic, tokenizer.Locate(diagnostic.offset)));
+                }
+                if (!diagnostics.HasErrors()) result.program = program;
+
+                // Only clean parses, a hit reports no diagnostics
+                if (cacheable && diagnostics.Entries().empty()) {
+                    _cache->Store(paths[i], hash, Flatten(program));
+                }
+            } catch (const std::exception& error) {
+                result.diagnostics.push_back(paths[i] + ": " + error.what());
+            }
+        });
+    }
+
+    _pool.Wait();
+    return results;
+}
+
+void Frontend::Reset() {
+    for (auto& arena : _arenas) arena.Reset();
+}
+
+}  // namespace core
+}  // namespace flecha
@@ -0,0 +1,64 @@
+#include "core/LineIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace flecha {
+namespace core {
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Collects the line starts up to an offset
+ *
+ * @param offset - Every line starting at or before it gets indexed
+ */
+void LineIndex::_ExtendTo(size_t offset) {
+    size_t end = std::min(offset, _source.size());
+    if (end <= _scanned) return;
+
+    const char* base = _source.data();
+    const char* newline = static_cast<const char*>(
+        std::memchr(base + _scanned, '\n', end - _scanned));
+    while (newline) {
+        size_t next = newline - base + 1;
+        _line_starts.push_back(next);
+        newline = static_cast<const char*>(
+            std::memchr(base + next, '\n', end - next));
+    }
+
+    _scanned = end;
+}
+
+/* PUBLIC METHODS */
+
+LineIndex::LineIndex(std::string_view source)
+    : _source(source), _line_starts{0}, _scanned(0), _first_line(1) {}
+
+LineIndex::LineIndex(std::string_view source, size_t offset,
+                     SourceLocation location)
+    : _source(source),
+      _line_starts{offset - (location.column - 1)},
+      _scanned(offset),
+      _first_line(location.line) {}
+
+/**
+ * @brief Resolves an offset with a binary search over the line starts
+ *
+ * @param offset - A byte offset, at most the source size
+ *
+ * @return - The line and column of that byte
+ */
+SourceLocation LineIndex::Locate(size_t offset) {
+    _ExtendTo(offset);
+
+    auto line = std::upper_bound(_line_starts.begin(), _line_starts.end(),
+                                 offset) -
+                1;
+    return SourceLocation{
+        static_cast<int>(line - _line_starts.begin()) + _first_line,
+        static_cast<int>(offset - *line) + 1};
+}
+
+}  // namespace core
+}  // namespace flecha
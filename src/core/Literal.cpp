@@ -0,0 +1,87 @@
+#include "core/Literal.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Decodes digits, with a loop for those that can not overflow
+ *
+ * @param text - The digits
+ * @param out_of_range - Set when the value does not fit in 64 bits
+ *
+ * @return - The value, INT64_MAX when it does not fit
+ */
+static int64_t DecodeInt(std::string_view text, bool* out_of_range) {
+    // 18 digits always fit
+    if (text.size() <= 18) {
+        int64_t value = 0;
+        for (char c : text) value = value * 10 + (c - '0');
+        return value;
+    }
+
+    int64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc::result_out_of_range) {
+        if (out_of_range) *out_of_range = true;
+        return std::numeric_limits<int64_t>::max();
+    }
+    return value;
+}
+
+/**
+ * @brief Decodes digits with a decimal point
+ *
+ * @param text - The number
+ * @param out_of_range - Set when it is too large for a double
+ *
+ * @return - The value, infinity when it is too large, the nearest
+ * denormal or zero when it is too small
+ */
+static double DecodeFloat(std::string_view text, bool* out_of_range) {
+    double value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc::result_out_of_range) {
+        // from_chars reports underflow the same way, which only a zero
+        // integer part can give; strtod rounds it
+        if (text.find_first_not_of('0') == text.find('.')) {
+            return std::strtod(std::string(text).c_str(), nullptr);
+        }
+        if (out_of_range) *out_of_range = true;
+        return HUGE_VAL;
+    }
+    return value;
+}
+
+Literal DecodeLiteral(Literal::Kind kind, std::string_view text,
+                      bool* out_of_range) {
+    Literal literal;
+    literal.kind = kind;
+    switch (kind) {
+        case Literal::Kind::Int:
+            literal.i = DecodeInt(text, out_of_range);
+            break;
+        case Literal::Kind::Float:
+            literal.f = DecodeFloat(text, out_of_range);
+            break;
+        case Literal::Kind::Bool:
+            literal.i = text == "1";
+            break;
+        case Literal::Kind::Char:
+            literal.i = 0;
+            literal.c = text.empty() ? '\0' : text[0];
+            break;
+        case Literal::Kind::None:
+            break;
+    }
+
+    return literal;
+}
+
+}  // namespace core
+}  // namespace flecha
@@ -0,0 +1,431 @@
+#include "core/Optimizer.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "core/Arithmetic.hpp"
+#include "core/StaticVisitor.hpp"
+#include "core/Types.hpp"
+#include "utils/Trace.hpp"
+
+template <typename... Args>
+using umap = std::unordered_map<Args...>;
+template <typename... Args>
+using uset = std::unordered_set<Args...>;
+
+namespace flecha {
+namespace core {
+
+using Kind = Literal::Kind;
+
+/**
+ * @brief Gets the variable a statement declares
+ *
+ * @param statement - A body statement
+ *
+ * @return - The VariableNode, nullptr for other statements
+ */
+static VariableNode* DeclaredVariable(ASTNode* statement) {
+    if (statement->kind == NodeKind::VariableDeclaration) {
+        return static_cast<VariableNode*>(
+            static_cast<VariableDeclarationNode*>(statement)->assignment);
+    }
+    if (statement->kind == NodeKind::AllocationStatement) {
+        auto* allocation = static_cast<AllocationNode*>(
+            static_cast<AllocationStatementNode*>(statement)->allocation);
+        return static_cast<VariableNode*>(
+            static_cast<PointerNode*>(allocation->pointer_node)->variable);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Gets the literal of an operand that can be folded
+ *
+ * @param node - An operand
+ *
+ * @return - Its literal, nullptr unless it is an untyped number, char or
+ * bool literal
+ */
+static const Literal* FoldableLiteral(ASTNode* node) {
+    if (!node || node->kind != NodeKind::Value) return nullptr;
+
+    auto& value = static_cast<ValueNode&>(*node);
+    if (value.type || value.literal.kind == Kind::None) return nullptr;
+    return &value.literal;
+}
+
+// Chars and bools run on the integer operations, as in the compiler
+static bool IsIntegral(const Literal& literal) {
+    return literal.kind != Kind::Float;
+}
+
+static int64_t IntOf(const Literal& literal) {
+    return literal.kind == Kind::Char ? static_cast<unsigned char>(literal.c)
+                                      : literal.i;
+}
+
+static double FloatOf(const Literal& literal) {
+    return literal.kind == Kind::Float ? literal.f
+                                       : static_cast<double>(IntOf(literal));
+}
+
+static Literal MakeInt(int64_t value, Kind kind = Kind::Int) {
+    Literal literal;
+    literal.kind = kind;
+    literal.i = value;
+    return literal;
+}
+
+static Literal MakeFloat(double value) {
+    Literal literal;
+    literal.kind = Kind::Float;
+    literal.f = value;
+    return literal;
+}
+
+/* CONSTANT FOLDING */
+
+/**
+ * @brief Swaps a folded expression for a literal node
+ *
+ * @param node - The expression
+ * @param location - Where the literal is reported at
+ * @param literal - Its value
+ *
+ * @return - The ValueNode, or the node when the value is not finite
+ */
+ASTNode* ConstantFolding::_Replace(ASTNode* node, ASTNode* location,
+                                   Literal literal) {
+    // to_chars writes inf and nan, which no literal decodes back from
+    if (literal.kind == Kind::Float && !std::isfinite(literal.f)) {
+        return node;
+    }
+
+    // The text is only read by messages and Flatten, which decodes it back,
+    // to_chars gives the shortest text that does
+    char text[32];
+    std::to_chars_result written =
+        literal.kind == Kind::Float
+            ? std::to_chars(text, text + sizeof(text), literal.f)
+            : std::to_chars(text, text + sizeof(text), literal.i);
+
+    auto* value = _arena->Make<ValueNode>(
+        _arena->CopyString(std::string_view(text, written.ptr - text)),
+        location, nullptr, literal);
+    _eliminated += CountNodes(node) - CountNodes(value);
+    return value;
+}
+
+/**
+ * @brief Folds a prefix operator on a literal
+ *
+ * @param node - The UnaryNode, its operand already folded
+ *
+ * @return - A ValueNode, or the node when it does not fold
+ */
+ASTNode* ConstantFolding::_FoldUnary(UnaryNode& node) {
+    const Literal* operand = FoldableLiteral(node.operand);
+    if (!operand) return &node;
+
+    switch (node.op) {
+        case TokenType::Not:
+            if (!IsIntegral(*operand)) return &node;
+            return _Replace(&node, node.location,
+                            MakeInt(IntOf(*operand) == 0, Kind::Bool));
+        case TokenType::Sub:
+            if (!IsIntegral(*operand)) {
+                return _Replace(&node, node.location, MakeFloat(-operand->f));
+            }
+            return _Replace(
+                &node, node.location,
+                MakeInt(WrapInt(0 - static_cast<uint64_t>(IntOf(*operand)))));
+        default:
+            return &node;
+    }
+}
+
+/**
+ * @brief Folds an infix operator on two literals
+ *
+ * @param node - The BinaryNode, its operands already folded
+ *
+ * @return - A ValueNode, or the node when it does not fold
+ */
+ASTNode* ConstantFolding::_FoldBinary(BinaryNode& node) {
+    const Literal* left = FoldableLiteral(node.left);
+    const Literal* right = FoldableLiteral(node.right);
+    if (!left || !right) return &node;
+
+    bool integral = IsIntegral(*left) && IsIntegral(*right);
+    auto replace = [&](Literal literal) {
+        return _Replace(&node, node.location, literal);
+    };
+
+    if (node.op == TokenType::And || node.op == TokenType::Or ||
+        node.op == TokenType::Xor) {
+        if (!integral) return &node;
+        int64_t x = IntOf(*left), y = IntOf(*right);
+        int64_t result = node.op == TokenType::And  ? x & y
+                         : node.op == TokenType::Or ? x | y
+                                                    : x ^ y;
+        bool bools = left->kind == Kind::Bool && right->kind == Kind::Bool;
+        return replace(MakeInt(result, bools ? Kind::Bool : Kind::Int));
+    }
+
+    if (!integral) {
+        double x = FloatOf(*left), y = FloatOf(*right);
+        switch (node.op) {
+            case TokenType::Add: return replace(MakeFloat(x + y));
+            case TokenType::Sub: return replace(MakeFloat(x - y));
+            case TokenType::Mul: return replace(MakeFloat(x * y));
+            case TokenType::Div: return replace(MakeFloat(x / y));
+            case TokenType::Mod: return replace(MakeFloat(std::fmod(x, y)));
+            case TokenType::Pow: return replace(MakeFloat(std::pow(x, y)));
+            case TokenType::Compare: return replace(MakeInt(x == y, Kind::Bool));
+            case TokenType::NotEqual: return replace(MakeInt(x != y, Kind::Bool));
+            case TokenType::Less: return replace(MakeInt(x < y, Kind::Bool));
+            case TokenType::LessEqual: return replace(MakeInt(x <= y, Kind::Bool));
+            case TokenType::Greater: return replace(MakeInt(x > y, Kind::Bool));
+            case TokenType::GreaterEqual: return replace(MakeInt(x >= y, Kind::Bool));
+            default: return &node;
+        }
+    }
+
+    int64_t x = IntOf(*left), y = IntOf(*right);
+    auto ux = static_cast<uint64_t>(x), uy = static_cast<uint64_t>(y);
+    switch (node.op) {
+        case TokenType::Add: return replace(MakeInt(WrapInt(ux + uy)));
+        case TokenType::Sub: return replace(MakeInt(WrapInt(ux - uy)));
+        case TokenType::Mul: return replace(MakeInt(WrapInt(ux * uy)));
+        case TokenType::Div:
+            // Left for the VM to raise
+            if (y == 0) return &node;
+            return replace(MakeInt(y == -1 ? WrapInt(0 - ux) : x / y));
+        case TokenType::Mod:
+            if (y == 0) return &node;
+            return replace(MakeInt(y == -1 ? 0 : x % y));
+        case TokenType::Pow: return replace(MakeInt(PowInt(x, y)));
+        case TokenType::Compare: return replace(MakeInt(x == y, Kind::Bool));
+        case TokenType::NotEqual: return replace(MakeInt(x != y, Kind::Bool));
+        case TokenType::Less: return replace(MakeInt(x < y, Kind::Bool));
+        case TokenType::LessEqual: return replace(MakeInt(x <= y, Kind::Bool));
+        case TokenType::Greater: return replace(MakeInt(x > y, Kind::Bool));
+        case TokenType::GreaterEqual: return replace(MakeInt(x >= y, Kind::Bool));
+        default: return &node;
+    }
+}
+
+/**
+ * @brief Folds an expression bottom up
+ *
+ * @param expression - The expression, may be null
+ *
+ * @return - What replaces it, itself when nothing folds
+ */
+ASTNode* ConstantFolding::_Fold(ASTNode* expression) {
+    if (!expression || expression->optimized) return expression;
+
+    ASTNode* result = expression;
+    if (expression->kind == NodeKind::Unary) {
+        auto& unary = static_cast<UnaryNode&>(*expression);
+        if (unary.op != TokenType::AddressRef) {
+            unary.operand = _Fold(unary.operand);
+            result = _FoldUnary(unary);
+        }
+    } else if (expression->kind == NodeKind::Binary) {
+        auto& binary = static_cast<BinaryNode&>(*expression);
+        binary.left = _Fold(binary.left);
+        binary.right = _Fold(binary.right);
+        // Writes through a pointer are never folded away
+        if (binary.op != TokenType::AssignVal) result = _FoldBinary(binary);
+    }
+
+    result->optimized = true;
+    return result;
+}
+
+size_t ConstantFolding::Run(ProgramNode& program, memory::Arena& arena) {
+    _arena = &arena;
+    _eliminated = 0;
+    _visited = 0;
+
+    auto* body = static_cast<BodyNode*>(program.body);
+    if (!body) return 0;
+
+    for (ASTNode* statement : body->expressions) {
+        if (statement->optimized) continue;
+        _visited++;
+
+        if (VariableNode* variable = DeclaredVariable(statement)) {
+            variable->value = _Fold(variable->value);
+        }
+        statement->optimized = true;
+    }
+
+    return _eliminated;
+}
+
+/* DEAD STORE ELIMINATION */
+
+/**
+ * @brief Marks the variables an expression reads as live
+ *
+ * @param expression - The expression, may be null
+ * @param pending - Unread declarations by symbol, read ones are erased
+ */
+static void MarkReads(ASTNode* expression,
+                      umap<utils::Symbol, size_t>& pending) {
+    if (!expression) return;
+
+    switch (expression->kind) {
+        case NodeKind::Variable:
+            pending.erase(static_cast<VariableNode&>(*expression).symbol);
+            return;
+        case NodeKind::Unary:
+            MarkReads(static_cast<UnaryNode&>(*expression).operand, pending);
+            return;
+        case NodeKind::Binary: {
+            auto& binary = static_cast<BinaryNode&>(*expression);
+            MarkReads(binary.left, pending);
+            MarkReads(binary.right, pending);
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+/**
+ * @brief Tells whether a declared value can be dropped without changing
+ * what compiles
+ *
+ * @param value - The declared value
+ * @param declared - The variables declared before it
+ *
+ * @return - True for literals the compiler accepts and known variables
+ */
+static bool IsDroppable(ASTNode* value, const uset<utils::Symbol>& declared) {
+    if (!value) return false;
+    if (value->kind == NodeKind::Variable) {
+        return declared.count(static_cast<VariableNode&>(*value).symbol) != 0;
+    }
+    if (value->kind != NodeKind::Value) return false;
+
+    // Mirrors the kinds Compiler::_Literal accepts for each declared type
+    auto& literal = static_cast<ValueNode&>(*value);
+    if (!literal.type) return true;
+    Kind kind = literal.literal.kind;
+    switch (PrimitiveOf(literal.type)) {
+        case Primitive::Int:
+        case Primitive::Bool:
+            return kind == Kind::Int || kind == Kind::Bool;
+        case Primitive::Float:
+            return kind == Kind::Int || kind == Kind::Float;
+        case Primitive::Char:
+            return kind == Kind::Char;
+        case Primitive::String:
+            return true;
+        case Primitive::None:
+            return false;
+    }
+    return false;
+}
+
+size_t DeadStoreElimination::Run(ProgramNode& program, memory::Arena& arena) {
+    auto* body = static_cast<BodyNode*>(program.body);
+    if (!body) return 0;
+
+    const NodeList& statements = body->expressions;
+    vector<bool> dead(statements.size(), false);
+    umap<utils::Symbol, size_t> pending;
+    uset<utils::Symbol> declared;
+
+    for (size_t i = 0; i < statements.size(); i++) {
+        VariableNode* variable = DeclaredVariable(statements[i]);
+        if (!variable) continue;
+
+        // The value is read before the new variable hides the old one
+        MarkReads(variable->value, pending);
+        auto hidden = pending.find(variable->symbol);
+        if (hidden != pending.end()) {
+            dead[hidden->second] = true;
+            pending.erase(hidden);
+        }
+
+        if (statements[i]->kind == NodeKind::VariableDeclaration &&
+            IsDroppable(variable->value, declared)) {
+            pending.emplace(variable->symbol, i);
+        }
+        declared.insert(variable->symbol);
+    }
+
+    size_t kept = 0;
+    size_t eliminated = 0;
+    for (size_t i = 0; i < statements.size(); i++) {
+        if (dead[i]) {
+            eliminated += CountNodes(statements[i]);
+        } else {
+            kept++;
+        }
+    }
+    if (kept == statements.size()) return 0;
+
+    NodeList live;
+    live.count = kept;
+    live.data = arena.MakeArray<ASTNode*>(kept);
+    for (size_t i = 0, j = 0; i < statements.size(); i++) {
+        if (!dead[i]) live[j++] = statements[i];
+    }
+    body->expressions = live;
+    return eliminated;
+}
+
+/* OPTIMIZER */
+
+size_t OptimizeReport::Eliminated() const {
+    size_t total = 0;
+    for (const auto& pass : passes) total += pass.second;
+    return total;
+}
+
+Optimizer::Optimizer() {
+    Add(std::make_unique<ConstantFolding>());
+    Add(std::make_unique<DeadStoreElimination>());
+}
+
+Optimizer Optimizer::Empty() {
+    Optimizer optimizer;
+    optimizer._passes.clear();
+    return optimizer;
+}
+
+void Optimizer::Add(std::unique_ptr<Pass> pass) {
+    _passes.push_back(std::move(pass));
+}
+
+OptimizeReport Optimizer::Run(ProgramNode* program, memory::Arena& arena) {
+    OptimizeReport report;
+    if (!program) return report;
+
+    for (auto& pass : _passes) {
+        FLECHA_TRACE_SCOPE(trace, pass->Name(), "core");
+        size_t eliminated = pass->Run(*program, arena);
+        trace.Arg("eliminated", eliminated);
+        report.passes.emplace_back(pass->Name(), eliminated);
+    }
+    return report;
+}
+
+size_t CountNodes(ASTNode* node) {
+    if (!node) return 0;
+
+    size_t count = 1;
+    ForEachChild(*node, [&](ASTNode* child) { count += CountNodes(child); });
+    return count;
+}
+
+}  // namespace core
+}  // namespace flecha
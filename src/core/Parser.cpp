@@ -1,7 +1,12 @@
 #include "core/Parser.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 
+#include "utils/Trace.hpp"
+
 namespace flecha {
 namespace core {
 /**
@@ -12,22 +17,73 @@ static const uset<TokenType> TYPES = {
     TokenType::Float, TokenType::Bool,
 };
 
+/**
+ * @brief How tightly an infix operator binds
+ *
+ * Operators with no precedence are not infix operators.
+ */
+struct BindingPower {
+    uint8_t precedence = 0;
+    bool right_associative = false;
+};
+
+static constexpr size_t TOKEN_TYPES =
+    static_cast<size_t>(TokenType::NoToken) + 1;
+
+/**
+ * @brief Infix operators by token type, loosest first
+ */
+static constexpr std::array<BindingPower, TOKEN_TYPES> INFIX = [] {
+    std::array<BindingPower, TOKEN_TYPES> table{};
+    auto set = [&](TokenType type, uint8_t precedence, bool right = false) {
+        table[static_cast<size_t>(type)] = {precedence, right};
+    };
+
+    // Writing through a pointer, ptr -> value
+    set(TokenType::AssignVal, 1, true);
+    set(TokenType::Or, 2);
+    set(TokenType::And, 3);
+    set(TokenType::Xor, 4);
+    set(TokenType::Compare, 5);
+    set(TokenType::NotEqual, 5);
+    set(TokenType::Less, 6);
+    set(TokenType::LessEqual, 6);
+    set(TokenType::Greater, 6);
+    set(TokenType::GreaterEqual, 6);
+    set(TokenType::Add, 7);
+    set(TokenType::Sub, 7);
+    set(TokenType::Mul, 8);
+    set(TokenType::Div, 8);
+    set(TokenType::Mod, 8);
+    // Above the prefix operators, so -a ** b is -(a ** b)
+    set(TokenType::Pow, 10, true);
+    return table;
+}();
+
+// Operands of prefix operators bind tighter than every infix but **
+static constexpr int PREFIX_PRECEDENCE = 9;
+
+// Keeps pathological nesting from exhausting the stack
+static constexpr size_t MAX_EXPRESSION_DEPTH = 2048;
+
 /* PRIVATE METHODS  */
 
 /**
- * @brief Advances and gets next token
+ * @brief Gets the token being looked at without consuming it
  *
- * @return - The current token at _current_token private
- * variable
+ * @return - The next token of the stream, valid until _Advance
  */
-Token Parser::_Advance() {
-    if (_index < _tokens.size() - 1) {
-        // More tokens to retrieve
-        _index++;
-        _current_token = _tokens[_index];
-    }
+const Token& Parser::_Current() { return _tokenizer.Peek(); }
 
-    return _current_token;
+/**
+ * @brief Consumes the current token
+ *
+ * @return - The consumed token
+ */
+Token Parser::_Advance() {
+    Token token = _tokenizer.Next();
+    _last_offset = token.offset;
+    return token;
 }
 
 /**
@@ -48,51 +104,440 @@ bool Parser::_Match(TokenType type) {
 }
 
 /**
- * @brief Checks whether _current_token matches passed token type
+ * @brief Checks whether the current token matches passed token type
  *
  * @param type - The expected token type
  *
- * @return - True if they match and _tokens is not empty / false otherwise
+ * @return - True if they match / false otherwise
  */
-bool Parser::_Check(TokenType type) {
-    return !_tokens.empty() && _current_token.type == type;
-}
+bool Parser::_Check(TokenType type) { return _Current().type == type; }
 
 /**
- * @brief Consumes current token by calling _Match and advances to next
+ * @brief Consumes current token if it matches, reports an error otherwise
  *
  * @param type - The expected token type
+ * @param code - The error to report
+ * @param token - Receives the consumed token, if given
  *
- * @param err - The error message
+ * @return - True if the token matched
  */
-void Parser::_Consume(TokenType type, const string& err) {
-    if (!_Match(type)) {
-        throw std::runtime_error(
-            "Parser Error: " + err + " Found: " + _current_token.value +
-            " at line " + std::to_string(_current_token.line) + ", column " +
-            std::to_string(_current_token.column));
+bool Parser::_Consume(TokenType type, DiagnosticCode code, Token* token) {
+    if (!_Check(type)) {
+        _Error(code, _Current());
+        return false;
     }
+
+    Token consumed = _Advance();
+    if (token) *token = consumed;
+    return true;
+}
+
+/**
+ * @brief Reports an error at a token
+ *
+ * @param code - What went wrong
+ * @param token - The offending token
+ * @param detail - Extra context for the message
+ */
+void Parser::_Error(DiagnosticCode code, const Token& token,
+                    std::string_view detail) {
+    std::string_view found =
+        token.type == TokenType::EOF_TOKEN ? "end of file"
+                                           : _tokenizer.Text(token);
+    _diagnostics.Report(code, token.offset, found, detail);
 }
 
 /**
- * @brief Parse expressions like int! var
+ * @brief Skips the rest of a broken statement
+ *
+ * Stops after the next ';' or '}', or before a type keyword that can start
+ * the next declaration, but never without moving past the statement's
+ * first token.
  *
- * @return
+ * @param start - Where the broken statement starts
  */
-std::unique_ptr<ASTNode> Parser::_ParseExpression() {
-    if (_Check(TokenType::NumberLiteral) || _Check(TokenType::StringLiteral) ||
-        _Check(TokenType::CharLiteral)) {
+void Parser::_Synchronize(size_t start) {
+    while (!_Check(TokenType::EOF_TOKEN)) {
+        if (_Match(TokenType::SemiColon) || _Match(TokenType::RCurly)) return;
+        if (TYPES.count(_Current().type) && _Current().offset != start) return;
+        _Advance();
+    }
+}
+
+/**
+ * @brief Checks whether the current token starts a declaration such as
+ * int! var or MyType var
+ *
+ * @return - True for a primitive type, or for an identifier followed by
+ * a bang or another identifier
+ */
+bool Parser::_IsDeclaration() {
+    if (TYPES.count(_Current().type)) return true;
+
+    if (!_Check(TokenType::Identifier)) return false;
+
+    // User defined types need one token of lookahead
+    TokenType next = _tokenizer.Peek(1).type;
+    return next == TokenType::Bang || next == TokenType::Identifier;
+}
+
+/**
+ * @brief Copies collected nodes into an arena list
+ *
+ * @param nodes - The nodes, in order
+ *
+ * @return - The NodeList
+ */
+NodeList Parser::_MakeList(const vector<ASTNode*>& nodes) {
+    NodeList list;
+    list.data = _arena.MakeArray<ASTNode*>(nodes.size());
+    list.count = nodes.size();
+    std::copy(nodes.begin(), nodes.end(), list.data);
+    return list;
+}
+
+/**
+ * @brief Builds a location node spanning two tokens
+ *
+ * @param start - The first token
+ * @param end - The last token
+ *
+ * @return - The LocationNode
+ */
+ASTNode* Parser::_MakeLocation(const Token& start, const Token& end) {
+    return _MakeLocation(start.offset, end.offset);
+}
+
+/**
+ * @brief Builds a location node spanning two source offsets
+ *
+ * @param start - Where the first token starts
+ * @param end - Where the last token starts
+ *
+ * @return - The LocationNode
+ */
+ASTNode* Parser::_MakeLocation(size_t start, size_t end) {
+    SourceLocation first = _tokenizer.Locate(start);
+    SourceLocation last = _tokenizer.Locate(end);
+    return _arena.Make<LocationNode>(
+        _arena.Make<StartNode>(first.line, first.column),
+        _arena.Make<EndNode>(last.line, last.column));
+}
+
+/**
+ * @brief Builds the type node named by a token
+ *
+ * @param token - A primitive type keyword or a user defined type name
+ *
+ * @return - The PrimitiveTypeNode or UserDefinedTypeNode
+ */
+ASTNode* Parser::_MakeType(const Token& token) {
+    std::string_view name;
+    utils::Symbol symbol = _symbols.Intern(_tokenizer.Text(token), &name);
+    if (TYPES.count(token.type)) {
+        return _arena.Make<PrimitiveTypeNode>(name, symbol);
+    }
+
+    return _arena.Make<UserDefinedTypeNode>(name, symbol);
+}
+
+/**
+ * @brief Builds a variable node named by a token
+ *
+ * @param name - The identifier token
+ * @param location - The location node
+ * @param value - The value node
+ *
+ * @return - The VariableNode
+ */
+ASTNode* Parser::_MakeVariable(const Token& name, ASTNode* location,
+                               ASTNode* value) {
+    std::string_view stored;
+    utils::Symbol symbol = _symbols.Intern(_tokenizer.Text(name), &stored);
+    return _arena.Make<VariableNode>(stored, location, value, symbol);
+}
+
+/**
+ * @brief Parses an expression with precedence climbing
+ *
+ * Operators binding looser than min_precedence are left to the caller, so
+ * every token is looked at once and chains like a + b + c loop instead of
+ * recursing.
+ *
+ * @param min_precedence - The loosest operator this call may consume
+ *
+ * @return - The expression node, nullptr after an error
+ */
+ASTNode* Parser::_ParseExpression(int min_precedence) {
+    if (_depth >= MAX_EXPRESSION_DEPTH) {
+        _Error(DiagnosticCode::NestingTooDeep, _Current());
+        return nullptr;
+    }
+
+    _depth++;
+    size_t start = _Current().offset;
+    ASTNode* left = _ParsePrefix();
+
+    while (left) {
+        BindingPower power = INFIX[static_cast<size_t>(_Current().type)];
+        if (power.precedence == 0 || power.precedence < min_precedence) break;
+
+        // Right associative operators let the operand take the same operator
+        TokenType op = _Advance().type;
+        ASTNode* right = _ParseExpression(
+            power.right_associative ? power.precedence : power.precedence + 1);
+        left = right ? _arena.Make<BinaryNode>(
+                           op, _MakeLocation(start, _last_offset), left, right)
+                     : nullptr;
+    }
+
+    _depth--;
+    return left;
+}
+
+/**
+ * @brief Parses the operand of an expression: a prefix operator, a
+ * parenthesized expression, a literal or a variable
+ *
+ * @return - A UnaryNode, the inner expression, a ValueNode without type for
+ * literals, a VariableNode for identifiers, or nullptr after an error
+ */
+ASTNode* Parser::_ParsePrefix() {
+    if (_Check(TokenType::Sub) || _Check(TokenType::Not) ||
+        _Check(TokenType::AddressRef)) {
+        Token op = _Advance();
+        ASTNode* operand = _ParseExpression(PREFIX_PRECEDENCE);
+        if (!operand) return nullptr;
+        return _arena.Make<UnaryNode>(
+            op.type, _MakeLocation(op.offset, _last_offset), operand);
+    } else if (_Match(TokenType::LParen)) {
+        ASTNode* inner = _ParseExpression();
+        if (!inner ||
+            !_Consume(TokenType::RParen, DiagnosticCode::ExpectedCloseParen)) {
+            return nullptr;
+        }
+        return inner;
+    } else if (_Check(TokenType::NumberLiteral) ||
+               _Check(TokenType::FloatLiteral) ||
+               _Check(TokenType::StringLiteral) ||
+               _Check(TokenType::CharLiteral)) {
         // Gets next token
         Token token = _Advance();
-        return std::make_unique<LiteralNode>(token.value);
+        return _arena.Make<ValueNode>(_arena.CopyString(_tokenizer.Text(token)),
+                                      _MakeLocation(token, token), nullptr,
+                                      _tokenizer.Value(token));
     } else if (_Check(TokenType::Identifier)) {
         // If its an identifier (variable)
         Token token = _Advance();
-        return std::make_unique<VariableNode>(token.value);
+        return _MakeVariable(token, _MakeLocation(token, token), nullptr);
+    }
+
+    _Error(DiagnosticCode::ExpectedExpression, _Current());
+    return nullptr;
+}
+
+/**
+ * @brief Parses a declaration statement, either plain or pointer
+ *
+ * @return - The VariableDeclarationNode or AllocationStatementNode,
+ * nullptr after an error
+ */
+ASTNode* Parser::_ParseExpressionStatement() {
+    if (!_IsDeclaration()) {
+        _Error(DiagnosticCode::ExpectedDeclaration, _Current());
+        return nullptr;
+    }
+
+    Token type = _Advance();
+    bool is_pointer = _Match(TokenType::Bang);
+    Token name;
+    if (!_Consume(TokenType::Identifier, DiagnosticCode::ExpectedVariableName,
+                  &name) ||
+        !_Consume(TokenType::Equal, DiagnosticCode::ExpectedEqual)) {
+        return nullptr;
+    }
+
+    if (is_pointer) {
+        return _ParseAllocationStatement(type, name);
+    }
+
+    return _ParseVariableDeclaration(type, name);
+}
+
+/**
+ * @brief Parses the rest of a declaration like int var = 42;
+ *
+ * @param type - The type token
+ * @param name - The variable name token
+ *
+ * @return - The VariableDeclarationNode, nullptr after an error
+ */
+ASTNode* Parser::_ParseVariableDeclaration(const Token& type,
+                                           const Token& name) {
+    ASTNode* value = _ParseExpression();
+    Token end;
+    if (!value ||
+        !_Consume(TokenType::SemiColon, DiagnosticCode::ExpectedSemiColon,
+                  &end)) {
+        return nullptr;
+    }
+
+    // Literal values also carry the declared type, to be decoded as it
+    ASTNode* declared = _MakeType(type);
+    if (auto* literal = dynamic_cast<ValueNode*>(value)) {
+        literal->type = declared;
+    }
+
+    ASTNode* variable = _MakeVariable(name, _MakeLocation(name, name), value);
+
+    return _arena.Make<VariableDeclarationNode>(_MakeLocation(type, end),
+                                                variable, declared);
+}
+
+/**
+ * @brief Parses the rest of a pointer declaration like
+ * int! var = allot(int)->42;
+ *
+ * @param type - The pointee type token
+ * @param name - The pointer name token
+ *
+ * @return - The AllocationStatementNode, nullptr after an error
+ */
+ASTNode* Parser::_ParseAllocationStatement(const Token& type,
+                                           const Token& name) {
+    Token allot;
+    if (!_Consume(TokenType::Allot, DiagnosticCode::ExpectedAllot, &allot) ||
+        !_Consume(TokenType::LParen, DiagnosticCode::ExpectedAllotOpenParen)) {
+        return nullptr;
+    }
+
+    // Consumed either way so a mismatched type keyword is not taken for the
+    // start of the next statement
+    Token allotted = _Advance();
+    std::string_view expected = _tokenizer.Text(type);
+    if (allotted.type != type.type || _tokenizer.Text(allotted) != expected) {
+        _Error(DiagnosticCode::AllotTypeMismatch, allotted, expected);
+        return nullptr;
+    }
+
+    Token rparen;
+    if (!_Consume(TokenType::RParen, DiagnosticCode::ExpectedAllotCloseParen,
+                  &rparen)) {
+        return nullptr;
+    }
+
+    // The initial value is written through the pointer
+    Token arrow = _Current();
+    ASTNode* value = nullptr;
+    if (_Match(TokenType::AssignVal)) {
+        value = _ParseExpression();
+        if (!value) return nullptr;
+    }
+
+    Token end;
+    if (!_Consume(TokenType::SemiColon, DiagnosticCode::ExpectedSemiColon,
+                  &end)) {
+        return nullptr;
+    }
+
+    // The pointer shares its type node with a literal pointee value
+    ASTNode* pointee_type = _MakeType(type);
+    if (auto* literal = dynamic_cast<ValueNode*>(value)) {
+        literal->type = pointee_type;
+    }
+
+    ASTNode* variable = _MakeVariable(name, _MakeLocation(name, name), value);
+    ASTNode* pointer = _arena.Make<PointerNode>(
+        _MakeLocation(type, name), pointee_type, nullptr, variable);
+    ASTNode* allocation =
+        _arena.Make<AllocationNode>(_MakeLocation(allot, rparen), pointer);
+    ASTNode* initialization =
+        value ? _arena.Make<InitializationStatementNode>(
+                    _MakeLocation(arrow, end), pointer)
+              : nullptr;
+
+    return _arena.Make<AllocationStatementNode>(_MakeLocation(type, end),
+                                                allocation, initialization);
+}
+
+/* PUBLIC METHODS */
+
+Parser::Parser(Tokenizer& tokenizer, memory::Arena& arena)
+    : _tokenizer(tokenizer),
+      _arena(arena),
+      _diagnostics(_own_diagnostics),
+      _symbols(utils::Interner::Global()) {
+    _tokenizer.ReportTo(&_diagnostics);
+}
+
+Parser::Parser(Tokenizer& tokenizer, memory::Arena& arena,
+               Diagnostics& diagnostics, utils::Interner& symbols)
+    : _tokenizer(tokenizer),
+      _arena(arena),
+      _diagnostics(diagnostics),
+      _symbols(symbols) {
+    _tokenizer.ReportTo(&_diagnostics);
+}
+
+/**
+ * @brief Parses one top-level statement, skipping it on errors
+ *
+ * @return - The statement node, nullptr if it was broken
+ */
+ASTNode* Parser::ParseStatement() {
+    size_t start = _Current().offset;
+    ASTNode* statement = _ParseExpressionStatement();
+    if (!statement) _Synchronize(start);
+    return statement;
+}
+
+/**
+ * @brief Parses the whole program, pulling tokens as it goes
+ *
+ * Broken statements are reported, skipped and left out of the tree.
+ *
+ * @return - The ProgramNode root
+ */
+ProgramNode* Parser::Parse() {
+    FLECHA_TRACE_SCOPE(trace, "Parse", "core");
+    size_t tokens = _tokenizer.Consumed();
+    size_t nodes = _arena.ObjectsMade();
+
+    Token first = _Current();
+    vector<ASTNode*> statements;
+
+    while (!_Check(TokenType::EOF_TOKEN)) {
+        if (ASTNode* statement = ParseStatement()) {
+            statements.push_back(statement);
+        }
+    }
+
+    auto* body = _arena.Make<BodyNode>(nullptr, _MakeList(statements));
+    ASTNode* location = _MakeLocation(first, _Current());
+    ASTNode* range =
+        _arena.Make<RangeNode>(first.offset, _Current().offset);
+
+    ProgramNode* program = _arena.Make<ProgramNode>(body, location, range);
+
+    trace.Rate("bytes", _Current().offset - first.offset);
+    trace.Rate("tokens", _tokenizer.Consumed() - tokens);
+    trace.Rate("nodes", _arena.ObjectsMade() - nodes);
+    trace.Arg("statements", statements.size());
+
+    // Lexing errors can be reported ahead of earlier syntax errors
+    _diagnostics.Sort();
+
+    // Without a caller's engine, fail the way a single error always did
+    if (&_diagnostics == &_own_diagnostics) {
+        _tokenizer.ReportTo(nullptr);
+        if (_diagnostics.HasErrors()) {
+            const Diagnostic& error = _diagnostics[0];
+            throw std::runtime_error(
+                Format(error, _tokenizer.Locate(error.offset)));
+        }
     }
 
-    throw std::runtime_error("Parser Error: Expected expression at line " +
-                             std::to_string(_current_token.line));
+    return program;
 }
 
 }  // namespace core
@@ -0,0 +1,156 @@
+#include "core/Scan.hpp"
+
+#include <cstdint>
+
+#include "core/CharClass.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FLECHA_SCAN_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FLECHA_SCAN_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FLECHA_SCAN_NEON
+#endif
+
+namespace flecha {
+namespace core {
+
+/*
+ * Every vector backend provides the same handful of byte-wise helpers.
+ * A predicate builds a "continues the run" mask from them, and StopBits
+ * turns that into bits set where the run stops, so FirstStop can find the
+ * first such byte.
+ */
+
+#if defined(FLECHA_SCAN_AVX2)
+
+using Vec = __m256i;
+static constexpr long STRIDE = 32;
+
+static inline Vec Load(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+static inline Vec Splat(char c) { return _mm256_set1_epi8(c); }
+static inline Vec Eq(Vec v, char c) { return _mm256_cmpeq_epi8(v, Splat(c)); }
+static inline Vec InRange(Vec v, char lo, char hi) {
+    // Clamping leaves v unchanged only inside [lo, hi]
+    Vec clamped = _mm256_min_epu8(_mm256_max_epu8(v, Splat(lo)), Splat(hi));
+    return _mm256_cmpeq_epi8(clamped, v);
+}
+static inline Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+static inline Vec Not(Vec v) { return _mm256_xor_si256(v, Splat(-1)); }
+static inline uint64_t StopBits(Vec match) {
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(match));
+}
+static inline long FirstStop(uint64_t bits) { return __builtin_ctzll(bits); }
+
+#elif defined(FLECHA_SCAN_SSE2)
+
+using Vec = __m128i;
+static constexpr long STRIDE = 16;
+
+static inline Vec Load(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+static inline Vec Splat(char c) { return _mm_set1_epi8(c); }
+static inline Vec Eq(Vec v, char c) { return _mm_cmpeq_epi8(v, Splat(c)); }
+static inline Vec InRange(Vec v, char lo, char hi) {
+    // Clamping leaves v unchanged only inside [lo, hi]
+    Vec clamped = _mm_min_epu8(_mm_max_epu8(v, Splat(lo)), Splat(hi));
+    return _mm_cmpeq_epi8(clamped, v);
+}
+static inline Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+static inline Vec Not(Vec v) { return _mm_xor_si128(v, Splat(-1)); }
+static inline uint64_t StopBits(Vec match) {
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(match)) & 0xFFFF;
+}
+static inline long FirstStop(uint64_t bits) { return __builtin_ctzll(bits); }
+
+#elif defined(FLECHA_SCAN_NEON)
+
+using Vec = uint8x16_t;
+static constexpr long STRIDE = 16;
+
+static inline Vec Load(const char* p) {
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+}
+static inline Vec Splat(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+static inline Vec Eq(Vec v, char c) { return vceqq_u8(v, Splat(c)); }
+static inline Vec InRange(Vec v, char lo, char hi) {
+    return vandq_u8(vcgeq_u8(v, Splat(lo)), vcleq_u8(v, Splat(hi)));
+}
+static inline Vec Or(Vec a, Vec b) { return vorrq_u8(a, b); }
+static inline Vec Not(Vec v) { return vmvnq_u8(v); }
+static inline uint64_t StopBits(Vec match) {
+    // NEON has no movemask, narrow every byte to a nibble instead
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+    return ~vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+}
+static inline long FirstStop(uint64_t bits) {
+    return __builtin_ctzll(bits) >> 2;
+}
+
+#endif
+
+/**
+ * @brief Scans a run in vector strides, then finishes it byte by byte
+ *
+ * @param p - Where the run may start
+ * @param end - The end of the text
+ * @param vector_match - Builds the mask of bytes that continue the run
+ * @param scalar_match - Checks a single byte
+ *
+ * @return - The first byte that stops the run, or end
+ */
+template <typename VectorMatch, typename ScalarMatch>
+static inline const char* ScanRun(const char* p, const char* end,
+                                  VectorMatch vector_match,
+                                  ScalarMatch scalar_match) {
+#if defined(FLECHA_SCAN_AVX2) || defined(FLECHA_SCAN_SSE2) || \
+    defined(FLECHA_SCAN_NEON)
+    while (end - p >= STRIDE) {
+        uint64_t stops = StopBits(vector_match(Load(p)));
+        if (stops) return p + FirstStop(stops);
+        p += STRIDE;
+    }
+#else
+    (void)vector_match;
+#endif
+
+    while (p < end && scalar_match(*p)) p++;
+    return p;
+}
+
+const char* ScanWhitespace(const char* begin, const char* end) {
+    return ScanRun(
+        begin, end,
+        [](auto v) { return Or(Eq(v, ' '), InRange(v, '\t', '\r')); },
+        IsSpace);
+}
+
+const char* ScanIdentifier(const char* begin, const char* end) {
+    return ScanRun(
+        begin, end,
+        [](auto v) {
+            return Or(Or(InRange(v, 'a', 'z'), InRange(v, 'A', 'Z')),
+                      Or(InRange(v, '0', '9'), Eq(v, '_')));
+        },
+        IsIdentBody);
+}
+
+const char* ScanDigits(const char* begin, const char* end) {
+    return ScanRun(
+        begin, end, [](auto v) { return InRange(v, '0', '9'); }, IsDigit);
+}
+
+const char* ScanStringBody(const char* begin, const char* end) {
+    return ScanRun(
+        begin, end, [](auto v) { return Not(Or(Eq(v, '"'), Eq(v, '\\'))); },
+        [](char c) { return c != '"' && c != '\\'; });
+}
+
+}  // namespace core
+}  // namespace flecha
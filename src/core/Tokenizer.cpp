@@ -1,30 +1,13 @@
 #include "core/Tokenizer.hpp"
-#include <unordered_map>
 #include <stdexcept>
-
-template <typename ...Args> using umap = std::unordered_map<Args...>;
+#include "core/CharClass.hpp"
+#include "core/Keywords.hpp"
+#include "core/Scan.hpp"
+#include "utils/Trace.hpp"
 
 namespace flecha {
 namespace core {
 
-    // Keywords mapping
-    static const umap<string, TokenType> KEYWORDS = {
-        {"int", TokenType::Int},
-        {"char", TokenType::Char},
-        {"bool", TokenType::Bool},
-        {"float", TokenType::Float},
-        {"string", TokenType::String},
-        {"void", TokenType::Void},
-        {"strict", TokenType::Strict},
-        {"method", TokenType::Method},
-        {"class", TokenType::Class},
-        {"construct", TokenType::Construct},
-        {"destruct", TokenType::Destruct},
-        {"return", TokenType::Return},
-        {"allot", TokenType::Allot},
-        {"dellot", TokenType::Dellot},
-    };
-
     /* PRIVATE METHODS */
 
     // Gets the current character
@@ -32,34 +15,37 @@ namespace core {
         return _source[_index]; 
     }
 
-    // Advance to next character
+    // Advance to next character, lines are resolved later from offsets
     void Tokenizer::_Advance() {
-        if (_GetCurrentChar() == '\n') {
-            // It's a new-line, so we increment line
-            // and set column to initial position
-            _line++;
-            _column = 0;
-        } else {
-            // We are still in the same line, so we 
-            // go to next column
-            _column++;
-        }
+        if (_IsAtEnd()) return;
 
         // Implement the index to keep track of the position
         _index++;
     }
 
+    // Advance over a whole run at once, up to (not including) run_end
+    void Tokenizer::_AdvanceTo(const char* run_end) {
+        _index = run_end - _source.data();
+    }
+
     // Checks whether we reached end of source
     bool Tokenizer::_IsAtEnd() const {
         return _index >= _source.size();
     }
 
+    // Pointer to the current character, for the run scanners
+    const char* Tokenizer::_Cursor() const {
+        return _source.data() + _index;
+    }
+
+    // Pointer past the last character, for the run scanners
+    const char* Tokenizer::_End() const {
+        return _source.data() + _source.size();
+    }
+
     // Skips whitespace
     void Tokenizer::_SkipWhiteSpace() {
-        while (!_IsAtEnd() && std::isspace(_GetCurrentChar())) {
-            // If we're not at end and current char is whitespace, we advance
-            _Advance();
-        }
+        _AdvanceTo(ScanWhitespace(_Cursor(), _End()));
     }
 
     // Gets next token
@@ -67,94 +53,125 @@ namespace core {
         _SkipWhiteSpace();
 
         if (_IsAtEnd())
-            return Token(TokenType::EOF_TOKEN, "", _line, _column);
+            return Token(TokenType::EOF_TOKEN, static_cast<uint32_t>(_index));
 
         char curr_ch = _GetCurrentChar();
         Token token;
+        token.offset = static_cast<uint32_t>(_index);
 
         _Advance();
-        token.line = _line;
-        token.column = _column;
 
         // Match chars
         switch (curr_ch) {
             case '"': {
                 size_t start = _index; // Position after the opening "
-                string value;
+                // Literals without escapes are viewed straight out of the
+                // source; only the first escape forces a decoded copy
+                string* decoded = nullptr;
+                size_t decoded_index = 0;
 
                 while (!_IsAtEnd() && _GetCurrentChar() != '"') {
+                    // Plain characters are consumed a stride at a time
+                    const char* run_end = ScanStringBody(_Cursor(), _End());
+                    if (run_end != _Cursor()) {
+                        if (decoded) decoded->append(_Cursor(), run_end);
+                        _AdvanceTo(run_end);
+                        continue;
+                    }
+
                     if (_GetCurrentChar() == '\\') {
+                        if (!decoded) {
+                            decoded_index = _literals.size();
+                            decoded = &_literals.emplace_back(_source.substr(start, _index - start));
+                        }
                         _Advance(); // Skip the backslash
                         if (_IsAtEnd()) break; // Avoid out-of-bounds errors
                         // Handle escape sequences
                         char escaped = _GetCurrentChar();
                         switch (escaped) {
-                            case 'n': value += '\n'; break;
-                            case 't': value += '\t'; break;
-                            case '\\': value += '\\'; break;
-                            case '"': value += '"'; break;
-                            default: value += escaped; break; // Unknown escape, keep as is
+                            case 'n': *decoded += '\n'; break;
+                            case 't': *decoded += '\t'; break;
+                            case '\\': *decoded += '\\'; break;
+                            case '"': *decoded += '"'; break;
+                            default: *decoded += escaped; break; // Unknown escape, keep as is
                         }
-                    } else {
-                        value += _GetCurrentChar();
                     }
                     _Advance();
                 }
 
                 if (_IsAtEnd() || _GetCurrentChar() != '"') {
-                    throw std::runtime_error("Unterminated string literal at line " + std::to_string(_line));
+                    // Recovers with the rest of the line, so later lines
+                    // still tokenize and report their own errors
+                    _Error(DiagnosticCode::UnterminatedString, token.offset);
+                    size_t newline = _source.find('\n', start);
+                    _index = newline == std::string_view::npos
+                                 ? _source.size()
+                                 : newline;
+                    // The decoded copy ran past the line, spell it instead
+                    decoded = nullptr;
                 }
 
-                _Advance(); // Skip closing "
                 token.type = TokenType::StringLiteral;
-                token.value = value;
-                break;
+                if (decoded) {
+                    _SetLiteral(token, decoded_index);
+                } else {
+                    _SetSpelling(token, start, _index - start);
+                }
+                _Advance(); // Skip closing "
+                return token;
             }
             case '\'': {
+                token.type = TokenType::CharLiteral;
                 if (_IsAtEnd()) {
-                    throw std::runtime_error("Unterminated character literal at line " + std::to_string(_line));
+                    _Error(DiagnosticCode::UnterminatedChar, token.offset);
+                    return token;
                 }
 
+                // Escapes decode into the literal table
                 char val;
                 if (_GetCurrentChar() == '\\') {
                     _Advance(); // Skip backslash
-                    if (_IsAtEnd()) break;
+                    if (_IsAtEnd()) {
+                        _Error(DiagnosticCode::UnterminatedChar, token.offset);
+                        return token;
+                    }
                     switch (_GetCurrentChar()) {
                         case 'n': val = '\n'; break;
                         case 't': val = '\t'; break;
                         case '\\': val = '\\'; break;
                         case '\'': val = '\''; break;
                         default:
-                            throw std::runtime_error("Invalid escape sequence in character literal at line " + std::to_string(_line));
+                            // Recovers with the character as written
+                            _Error(DiagnosticCode::InvalidEscape, token.offset);
+                            val = _GetCurrentChar();
+                            break;
                     }
+                    _literals.emplace_back(1, val);
+                    _SetLiteral(token, _literals.size() - 1);
                 } else {
-                    val = _GetCurrentChar();
+                    _SetSpelling(token, _index, 1);
                 }
                 _Advance(); // Consume the character
 
                 if (_IsAtEnd() || _GetCurrentChar() != '\'') {
-                    throw std::runtime_error("Unterminated character literal at line " + std::to_string(_line));
+                    _Error(DiagnosticCode::UnterminatedChar, token.offset);
+                    _SkipPast('\'');
+                    return token;
                 }
                 _Advance(); // Skip closing '
-                token.type = TokenType::CharLiteral;
-                token.value = string(1, val); // Store as a single-character string
-                break;
+                return token;
             }
             case ';':
                 token.type = TokenType::SemiColon;
-                token.value = ";";
                 break;
             case '(':
                 token.type = TokenType::LParen;
-                token.value = "(";
                 break;
             case ')':
                 token.type = TokenType::RParen;
-                token.value = ")";
                 break;
             case '+':
                 token.type = TokenType::Add;
-                token.value = "+";
                 break;
             case '-':
                 // Can be subtraction or assign val of pointer
@@ -163,10 +180,8 @@ namespace core {
                     // Found assignval operator
                     _Advance();
                     token.type = TokenType::AssignVal;
-                    token.value = "->";
                 } else {
                     token.type = TokenType::Sub;
-                    token.value = "-";
                 }
                 break;
             case '*':
@@ -176,23 +191,18 @@ namespace core {
                     // Found "**"
                     _Advance();
                     token.type = TokenType::Pow;
-                    token.value = "**";
                 } else {
                     token.type = TokenType::Mul;
-                    token.value = "*";
                 }
                 break;
             case '/':
                 token.type = TokenType::Div;
-                token.value = "/";
                 break;
             case '^':
                 token.type = TokenType::Xor;
-                token.value = "^";
                 break;
             case '%':
                 token.type = TokenType::Mod;
-                token.value = "%";
                 break;
             case '=':
                 // Can be equal or compare token, must check
@@ -201,11 +211,9 @@ namespace core {
                     // Found compare "=="
                     _Advance();
                     token.type = TokenType::Compare;
-                    token.value = "==";
                 } else {
                     // Equal found "="
                     token.type = TokenType::Equal;
-                    token.value = "=";
                 }
                 break;
             case '<':
@@ -215,11 +223,9 @@ namespace core {
                     // Found less than or equal token
                     _Advance();
                     token.type = TokenType::LessEqual;
-                    token.value = "<=";
                 } else {
                     // Found less than
                     token.type = TokenType::Less;
-                    token.value = "<";
                 }
                 break;
             case '>': 
@@ -229,11 +235,9 @@ namespace core {
                     // Found greater than or equal
                     _Advance();
                     token.type = TokenType::GreaterEqual;
-                    token.value = ">=";
                 } else {
                     // Found greater than
                     token.type = TokenType::Greater;
-                    token.value = ">";
                 }
                 break;
             case '&':
@@ -242,7 +246,6 @@ namespace core {
                     // Found and operator
                     _Advance();
                     token.type = TokenType::And;
-                    token.value = "&&";
                 } else {
                     // Handle
                 }
@@ -254,111 +257,210 @@ namespace core {
                     // Found not equal op
                     _Advance();
                     token.type = TokenType::NotEqual;
-                    token.value = "|=";
                 } else if (_index + 1 <= _source.size() && _source[_index] == '|') {
                     // Found Or operator
                     _Advance(); 
                     token.type = TokenType::Or;
-                    token.value = "||";
                 } else {
                     // Found not op
                     token.type = TokenType::Not;
-                    token.value = "|";
                 }
                 break;
             case '[':
                 token.type = TokenType::LBracket;
-                token.value = "[";
                 break;
             case ']':
                 token.type = TokenType::RBracket;
-                token.value = "]";
                 break;
             case '{':
                 token.type = TokenType::LCurly;
-                token.value = "{";
                 break;
             case '}':
                 token.type = TokenType::RCurly;
-                token.value = "}";
                 break;
             case '!':
                 token.type = TokenType::Bang;
-                token.value = "!";
                 break;
             case '?':
                 token.type = TokenType::AddressRef;
-                token.value = "?";
                 break;
         }
 
         if (token.type != TokenType::NoToken) {
+            token.length = _index - token.offset;
             return token;
         }
 
         // Match numbers:
-        if (std::isdigit(curr_ch)) {
+        if (IsDigit(curr_ch)) {
             size_t start = _index - 1;
             bool has_decimal_point = false;
 
-            while (!_IsAtEnd() && (std::isdigit(_GetCurrentChar()) || _GetCurrentChar() == '.')) {
-                if (_GetCurrentChar() == '.') {
-                    if (has_decimal_point) break; // Only one decimal point allowed
-                    has_decimal_point = true;
-                }
+            _AdvanceTo(ScanDigits(_Cursor(), _End()));
+            if (!_IsAtEnd() && _GetCurrentChar() == '.') {
+                // Only one decimal point allowed
+                has_decimal_point = true;
                 _Advance();
+                _AdvanceTo(ScanDigits(_Cursor(), _End()));
             }
-            token.line = _line;
-            token.column = _column;
             token.type = has_decimal_point ? TokenType::FloatLiteral : TokenType::NumberLiteral;
-            token.value = _source.substr(start, _index - start);
+            _SetSpelling(token, start, _index - start);
+
+            // Up to 18 digits always fit, longer numbers are range checked
+            // now so the error is lexical
+            if (_index - start > 18) {
+                bool out_of_range = false;
+                DecodeLiteral(has_decimal_point ? Literal::Kind::Float : Literal::Kind::Int,
+                              _source.substr(start, _index - start), &out_of_range);
+                if (out_of_range) _Error(DiagnosticCode::NumberOutOfRange, token.offset);
+            }
             return token;
         }
 
         // Match identifier and keywords
-         if (std::isalpha(curr_ch) || curr_ch == '_') {
+         if (IsIdentStart(curr_ch)) {
             size_t start = _index - 1; // Include the current character
-            while (!_IsAtEnd() && (std::isalnum(_GetCurrentChar()) || _GetCurrentChar() == '_')) {
-                _Advance();
-            }
-            string word = _source.substr(start, _index - start);
-            auto it = KEYWORDS.find(word);
-            token.line = _line;
-            token.column = _column - (word.length() - 1);
-            token.value = word;
-            if (it != KEYWORDS.end()) {
-                token.type = it->second;
-                return token;
-            }
-            token.type = TokenType::Identifier;
+            _AdvanceTo(ScanIdentifier(_Cursor(), _End()));
+            token.type = LookupKeyword(_source.substr(start, _index - start));
+            _SetSpelling(token, start, _index - start);
             return token;
         }
                
-        // Unkown token
-        _Advance();
-        token.value = string(1, curr_ch);
-        token.line = _line;
-        token.column = _column;
+        // Unkown token, already consumed above
+        token.length = 1;
         return token;
     }
 
+    // Rejects sources whose offsets do not fit in Token::offset
+    std::string_view Tokenizer::_Checked(std::string_view src) {
+        if (src.size() > UINT32_MAX) {
+            throw std::length_error("Tokenizer Error: Sources over 4 GiB are not supported");
+        }
+        return src;
+    }
+
+    // Points a token at its spelling, which starts at start; spellings
+    // too long for Token::length are copied into the literal table
+    void Tokenizer::_SetSpelling(Token& token, size_t start, size_t length) {
+        if (length <= Token::MAX_LENGTH) {
+            token.length = static_cast<uint32_t>(length);
+            return;
+        }
+
+        _literals.emplace_back(_source.substr(start, length));
+        _SetLiteral(token, _literals.size() - 1);
+    }
+
+    // Points a token at an entry of the literal table
+    void Tokenizer::_SetLiteral(Token& token, size_t index) {
+        if (index > Token::MAX_LENGTH) {
+            throw std::length_error("Tokenizer Error: Too many decoded literals");
+        }
+
+        token.length = static_cast<uint32_t>(index);
+        token.in_table = 1;
+    }
+
+    // Reports a lexical error, or throws it when nobody collects them
+    void Tokenizer::_Error(DiagnosticCode code, size_t offset) {
+        if (!_diagnostics) {
+            throw std::runtime_error(Format(Diagnostic{code, offset, "", ""}, Locate(offset)));
+        }
+
+        _diagnostics->Report(code, offset);
+    }
+
+    // Recovers from a broken literal: skips past close if it shows up on
+    // the same line, otherwise stops at the line end
+    void Tokenizer::_SkipPast(char close) {
+        while (!_IsAtEnd() && _GetCurrentChar() != '\n') {
+            char c = _GetCurrentChar();
+            _Advance();
+            if (c == close) return;
+        }
+    }
+
+    // Lexes into the lookahead ring until it holds count tokens
+    void Tokenizer::_Fill(size_t count) {
+        while (_buffered < count) {
+            _lookahead[(_head + _buffered) % LOOKAHEAD] = _NextToken();
+            _buffered++;
+        }
+    }
+
 
 
     /* PUBLIC METHODS */
 
-    Tokenizer::Tokenizer(const string& src)
-        : _source(src), _index(0), _line(1), _column(1) {}
+    Tokenizer::Tokenizer(std::string_view src)
+        : _source(_Checked(src)), _index(0), _lines(src), _diagnostics(nullptr), _head(0), _buffered(0), _consumed(0) {}
+
+    Tokenizer::Tokenizer(std::string_view src, size_t start, SourceLocation at)
+        : _source(_Checked(src)), _index(start), _lines(src, start, at), _diagnostics(nullptr), _head(0), _buffered(0), _consumed(0) {}
+
+    // Pulls the next token, from the lookahead ring if anything was peeked
+    Token Tokenizer::Next() {
+        _consumed++;
+        if (_buffered == 0) return _NextToken();
+
+        Token token = _lookahead[_head];
+        _head = (_head + 1) % LOOKAHEAD;
+        _buffered--;
+        return token;
+    }
+
+    // Peeks k tokens ahead of the next one
+    const Token& Tokenizer::Peek(size_t k) {
+        if (k >= LOOKAHEAD) {
+            throw std::out_of_range("Tokenizer lookahead is limited to " + std::to_string(LOOKAHEAD) + " tokens");
+        }
+
+        _Fill(k + 1);
+        return _lookahead[(_head + k) % LOOKAHEAD];
+    }
 
     // Tokenizer
     vector<Token> Tokenizer::Tokenize() {
+        FLECHA_TRACE_SCOPE(trace, "Tokenize", "core");
+        size_t start = _index;
         vector<Token> tokens;
         while (true) {
-            Token token = _NextToken();
+            Token token = Next();
             tokens.push_back(token);
             if (token.type == TokenType::EOF_TOKEN) break;
         }
 
+        trace.Rate("tokens", tokens.size());
+        trace.Rate("bytes", _index - start);
         return tokens;
     }
+
+    // Literal tokens skip their opening quote
+    std::string_view Tokenizer::Text(const Token& token) const {
+        if (token.in_table) return _literals[token.length];
+
+        bool quoted = token.type == TokenType::StringLiteral || token.type == TokenType::CharLiteral;
+        return _source.substr(token.offset + quoted, token.length);
+    }
+
+    // Decodes number and char literals from their text
+    Literal Tokenizer::Value(const Token& token) const {
+        switch (token.type) {
+            case TokenType::NumberLiteral: return DecodeLiteral(Literal::Kind::Int, Text(token));
+            case TokenType::FloatLiteral: return DecodeLiteral(Literal::Kind::Float, Text(token));
+            case TokenType::CharLiteral: return DecodeLiteral(Literal::Kind::Char, Text(token));
+            default: return Literal();
+        }
+    }
+
+    // Errors go to the engine from now on, or throw again without one
+    void Tokenizer::ReportTo(Diagnostics* diagnostics) {
+        _diagnostics = diagnostics;
+    }
+
+    // Resolves offsets through the lazily built line index
+    SourceLocation Tokenizer::Locate(size_t offset) {
+        return _lines.Locate(offset);
+    }
 }
 }
@@ -1,9 +1,20 @@
 #ifndef FLECHA_AST_HPP
 #define FLECHA_AST_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Literal.hpp"
+#include "TokenType.hpp"
+#include "memory/Heap.hpp"
+#include "memory/MemStats.hpp"
+#include "utils/Interner.hpp"
+
 // Aliases
 template <typename... Args>
 using vector = std::vector<Args...>;
@@ -12,6 +23,46 @@ using string = std::string;
 namespace flecha {
 namespace core {
 
+/**
+ * @brief Tags every concrete node type, in Visitor order
+ */
+enum class NodeKind : uint8_t {
+    // Variables
+    Variable,
+    Value,
+
+    // Location
+    Start,
+    End,
+    Location,
+    Range,
+
+    // Program
+    Program,
+    ProgramInitialization,
+    Body,
+
+    // Expressions
+    AllocationStatement,
+    VariableDeclaration,
+
+    // Operators
+    Unary,
+    Binary,
+
+    // Initializations
+    InitializationStatement,
+
+    // Memory
+    Pointer,
+    Memory,
+    Allocation,
+
+    // Types
+    PrimitiveType,
+    UserDefinedType,
+};
+
 /**
  * @brief Visitor class to help traverse AST
  */
@@ -36,6 +87,10 @@ class Visitor {
     virtual void Visit(class AllocationStatementNode& node) = 0;
     virtual void Visit(class VariableDeclarationNode& node) = 0;
 
+    // Operators
+    virtual void Visit(class UnaryNode& node) = 0;
+    virtual void Visit(class BinaryNode& node) = 0;
+
     // Initializations
     virtual void Visit(class InitializationStatementNode& node) = 0;
 
@@ -56,16 +111,50 @@ class Visitor {
 
 /**
  * @brief Main AST node
+ *
+ * Nodes live in the arena of their compilation unit, which releases them
+ * all at once, so they are trivially destructible: children are plain
+ * non-owning pointers, values are views into arena copies, and names are
+ * views into the interner that gave them their symbol. A node may be
+ * shared by several parents.
  */
 struct ASTNode {
+    NodeKind kind;
+    // Set once the Optimizer has been through the subtree, so running it
+    // again after an edit only visits new nodes
+    bool optimized;
+
     /**
-     * @brief Default destructor
+     * @brief The ASTNode constructor
+     *
+     * @param kind - The concrete node type
      */
-    virtual ~ASTNode() = default;
+    explicit ASTNode(NodeKind kind) : kind(kind), optimized(false) {}
+
     /**
      * @brief Default accept method
      */
     virtual void Accept(class Visitor& visitor) = 0;
+
+   protected:
+    /**
+     * @brief Trivial destructor, nodes are never deleted through the base
+     */
+    ~ASTNode() = default;
+};
+
+/**
+ * @brief A fixed list of child nodes, stored in the arena with them
+ */
+struct NodeList {
+    ASTNode** data = nullptr;
+    size_t count = 0;
+
+    ASTNode** begin() const { return data; }
+    ASTNode** end() const { return data + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    ASTNode*& operator[](size_t i) const { return data[i]; }
 };
 
 /* Location Nodes */
@@ -80,7 +169,7 @@ struct StartNode : ASTNode {
      * @param l - The line
      * @param c - The column
      */
-    StartNode(int l, int c) : line(l), column(c) {}
+    StartNode(int l, int c) : ASTNode(NodeKind::Start), line(l), column(c) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -100,7 +189,7 @@ struct EndNode : ASTNode {
      * @param l - The line
      * @param c - The column
      */
-    EndNode(int l, int c) : line(l), column(c) {}
+    EndNode(int l, int c) : ASTNode(NodeKind::End), line(l), column(c) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -120,22 +209,8 @@ struct LocationNode : ASTNode {
      * @param st - The start node
      * @param end - The end node
      */
-    LocationNode(ASTNode* st, ASTNode* end) : start(st), end(end) {}
-
-    /**
-     * @brief Destructs and frees memory
-     */
-    ~LocationNode() {
-        if (start) {
-            delete start;
-            start = nullptr;
-        }
-
-        if (end) {
-            delete end;
-            end = nullptr;
-        }
-    }
+    LocationNode(ASTNode* st, ASTNode* end)
+        : ASTNode(NodeKind::Location), start(st), end(end) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -154,7 +229,9 @@ struct RangeNode : ASTNode {
      * @param start - the start of file
      * @param end - the end of file
      */
-    RangeNode(int start, int end) { range = std::make_pair(start, end); }
+    RangeNode(int start, int end) : ASTNode(NodeKind::Range) {
+        range = std::make_pair(start, end);
+    }
 
     /**
      * @brief The Accept visitor for traversal
@@ -168,32 +245,16 @@ struct RangeNode : ASTNode {
 
 struct BodyNode : ASTNode {
     ASTNode* program_init;
-    vector<ASTNode*> expressions;
+    NodeList expressions;
 
     /**
      * @brief The BodyNode constructor
      *
      * @param p_init - The ProgramInitializationNode
-     * @param exps - A vector contaning all ExpressionNodes
+     * @param exps - A list contaning all ExpressionNodes
      */
-    BodyNode(ASTNode* p_init, const vector<ASTNode*>& exps)
-        : program_init(p_init), expressions(exps) {}
-
-    ~BodyNode() {
-        if (program_init) {
-            delete program_init;
-            program_init = nullptr;
-        }
-
-        for (auto& node : expressions) {
-            if (node) {
-                delete node;
-                node = nullptr;
-            }
-        }
-
-        expressions.clear();
-    }
+    BodyNode(ASTNode* p_init, NodeList exps)
+        : ASTNode(NodeKind::Body), program_init(p_init), expressions(exps) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -206,9 +267,14 @@ struct BodyNode : ASTNode {
 /* Program Node */
 
 struct ProgramInitializationNode : ASTNode {
-    string package_name;
+    utils::Symbol package;
+    std::string_view package_name;
 
-    ProgramInitializationNode(const string& name) : package_name(name) {}
+    ProgramInitializationNode(std::string_view name,
+                              utils::Symbol package = utils::Symbol())
+        : ASTNode(NodeKind::ProgramInitialization),
+          package(package),
+          package_name(name) {}
 
     void Accept(Visitor& visitor) override { visitor.Visit(*this); }
 };
@@ -226,27 +292,7 @@ struct ProgramNode : ASTNode {
      * @param range - The range node
      */
     ProgramNode(ASTNode* body, ASTNode* loc, ASTNode* range)
-        : body(body), location(loc), range(range) {}
-
-    /**
-     * @brief Destructs ProgramNode and free memory
-     */
-    ~ProgramNode() {
-        if (body) {
-            delete body;
-            body = nullptr;
-        }
-
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (range) {
-            delete range;
-            range = nullptr;
-        }
-    }
+        : ASTNode(NodeKind::Program), body(body), location(loc), range(range) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -262,7 +308,7 @@ struct ProgramNode : ASTNode {
  * @brief Expression Node Interface
  */
 struct ExpressionNode : ASTNode {
-    virtual ~ExpressionNode() = default;
+    using ASTNode::ASTNode;
 };
 
 /**
@@ -283,27 +329,10 @@ struct AllocationStatementNode : ExpressionNode {
      * @param init -  The initialization node
      */
     AllocationStatementNode(ASTNode* loc, ASTNode* alloc, ASTNode* init)
-        : location(loc), allocation(alloc), initialization(init) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~AllocationStatementNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (allocation) {
-            delete allocation;
-            allocation = nullptr;
-        }
-
-        if (initialization) {
-            delete initialization;
-            initialization = nullptr;
-        }
-    }
+        : ExpressionNode(NodeKind::AllocationStatement),
+          location(loc),
+          allocation(alloc),
+          initialization(init) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -316,30 +345,85 @@ struct AllocationStatementNode : ExpressionNode {
 struct VariableDeclarationNode : ExpressionNode {
     ASTNode* location;
     ASTNode* assignment;
+    // The declared type, null for declarations made without one
+    ASTNode* type;
 
     /**
      * @brief The VariableDeclarationNode constructor
      *
      * @param loc - The location node
      * @param assg - The assignment node
+     * @param t - The declared type node
      */
-    VariableDeclarationNode(ASTNode* loc, ASTNode* assg)
-        : location(loc), assignment(assg) {}
+    VariableDeclarationNode(ASTNode* loc, ASTNode* assg, ASTNode* t = nullptr)
+        : ExpressionNode(NodeKind::VariableDeclaration),
+          location(loc),
+          assignment(assg),
+          type(t) {}
 
     /**
-     * @brief Destructs and free memory
+     * @brief The Accept visitor for traversal
+     *
+     * @param visitor - The visitor class object
      */
-    ~VariableDeclarationNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
+    void Accept(Visitor& visitor) override { visitor.Visit(*this); }
+};
 
-        if (assignment) {
-            delete assignment;
-            assignment = nullptr;
-        }
-    }
+/* Operator Nodes */
+
+/**
+ * @brief A prefix operator applied to one operand
+ *
+ * @example: -x, |done, ?var
+ */
+struct UnaryNode : ASTNode {
+    TokenType op;
+    ASTNode* location;
+    ASTNode* operand;
+
+    /**
+     * @brief The UnaryNode constructor
+     *
+     * @param op - The operator token type
+     * @param loc - The location node
+     * @param operand - The operand expression
+     */
+    UnaryNode(TokenType op, ASTNode* loc, ASTNode* operand)
+        : ASTNode(NodeKind::Unary), op(op), location(loc), operand(operand) {}
+
+    /**
+     * @brief The Accept visitor for traversal
+     *
+     * @param visitor - The visitor class object
+     */
+    void Accept(Visitor& visitor) override { visitor.Visit(*this); }
+};
+
+/**
+ * @brief An infix operator applied to two operands
+ *
+ * @example: a + b * 2, ptr -> 42
+ */
+struct BinaryNode : ASTNode {
+    TokenType op;
+    ASTNode* location;
+    ASTNode* left;
+    ASTNode* right;
+
+    /**
+     * @brief The BinaryNode constructor
+     *
+     * @param op - The operator token type
+     * @param loc - The location node
+     * @param left - The left operand
+     * @param right - The right operand
+     */
+    BinaryNode(TokenType op, ASTNode* loc, ASTNode* left, ASTNode* right)
+        : ASTNode(NodeKind::Binary),
+          op(op),
+          location(loc),
+          left(left),
+          right(right) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -352,7 +436,7 @@ struct VariableDeclarationNode : ExpressionNode {
 /* General Nodes */
 
 struct InitializationNode : ASTNode {
-    virtual ~InitializationNode() = default;
+    using ASTNode::ASTNode;
 };
 
 struct InitializationStatementNode : InitializationNode {
@@ -366,22 +450,9 @@ struct InitializationStatementNode : InitializationNode {
      * @param ptr - The pointer node
      */
     InitializationStatementNode(ASTNode* loc, ASTNode* ptr)
-        : location(loc), pointer_node(ptr) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~InitializationStatementNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (pointer_node) {
-            delete pointer_node;
-            pointer_node = nullptr;
-        }
-    }
+        : InitializationNode(NodeKind::InitializationStatement),
+          location(loc),
+          pointer_node(ptr) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -394,27 +465,34 @@ struct InitializationStatementNode : InitializationNode {
 /* Type nodes */
 
 struct TypeNode : ASTNode {
-    virtual ~TypeNode() = default;
-    virtual string GetTypeName() const = 0;
+    using ASTNode::ASTNode;
+    virtual std::string_view GetTypeName() const = 0;
+    virtual utils::Symbol GetTypeSymbol() const = 0;
     virtual bool IsPrimitive() const = 0;
 };
 
 struct PrimitiveTypeNode : TypeNode {
-    string name;
+    utils::Symbol symbol;
+    std::string_view name;
 
     /**
      * @brief The PrimitiveTypeNode constructor
      *
      * @param name - The type name
+     * @param symbol - The interned type name
      */
-    PrimitiveTypeNode(const string& name) : name(name) {}
+    PrimitiveTypeNode(std::string_view name,
+                      utils::Symbol symbol = utils::Symbol())
+        : TypeNode(NodeKind::PrimitiveType), symbol(symbol), name(name) {}
 
     /**
      * @brief Gets the type name of primitive type
      *
      * @return the type name
      */
-    string GetTypeName() const override { return name; }
+    std::string_view GetTypeName() const override { return name; }
+
+    utils::Symbol GetTypeSymbol() const override { return symbol; }
 
     /**
      * @brief Check if type is primitive
@@ -427,21 +505,27 @@ struct PrimitiveTypeNode : TypeNode {
 };
 
 struct UserDefinedTypeNode : TypeNode {
-    string name;
+    utils::Symbol symbol;
+    std::string_view name;
 
     /**
      * @brief The UserDefinedTypeNode constructor
      *
      * @param name - The type name
+     * @param symbol - The interned type name
      */
-    UserDefinedTypeNode(const string& name) : name(name) {}
+    UserDefinedTypeNode(std::string_view name,
+                        utils::Symbol symbol = utils::Symbol())
+        : TypeNode(NodeKind::UserDefinedType), symbol(symbol), name(name) {}
 
     /**
      * @brief Gets the type name of user defined type
      *
      * @return The type name
      */
-    string GetTypeName() const override { return name; }
+    std::string_view GetTypeName() const override { return name; }
+
+    utils::Symbol GetTypeSymbol() const override { return symbol; }
 
     /**
      * @brief Check if type is primitive
@@ -466,22 +550,7 @@ struct AllocationNode : ASTNode {
      * @param ptr - The pointer node
      */
     AllocationNode(ASTNode* loc, ASTNode* ptr)
-        : location(loc), pointer_node(ptr) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~AllocationNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (pointer_node) {
-            delete pointer_node;
-            pointer_node = nullptr;
-        }
-    }
+        : ASTNode(NodeKind::Allocation), location(loc), pointer_node(ptr) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -505,30 +574,11 @@ struct PointerNode : ASTNode {
      * @param mem - The memory node
      */
     PointerNode(ASTNode* loc, ASTNode* type, ASTNode* mem, ASTNode* var)
-        : location(loc), type(type), memory(mem), variable(var) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~PointerNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        // We don't delete the type node because
-        // its shared with the variable->value node
-
-        if (memory) {
-            delete memory;
-            memory = nullptr;
-        }
-
-        if (variable) {
-            delete variable;
-            variable = nullptr;
-        }
-    }
+        : ASTNode(NodeKind::Pointer),
+          location(loc),
+          type(type),
+          memory(mem),
+          variable(var) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -538,33 +588,74 @@ struct PointerNode : ASTNode {
     void Accept(Visitor& visitor) override { visitor.Visit(*this); }
 };
 
-struct MemoryNode : ASTNode {
+/**
+ * @brief The memory behind a pointer at run time
+ *
+ * A handle to a block of the global memory::Heap, taken and given back
+ * through the calling thread's cache. Unlike the syntax nodes it owns a
+ * resource, so it is created and deleted by whoever runs the program
+ * instead of living in the AST arena. Builds with FLECHA_MEM_STATS record
+ * every allot and dellot, by the line and column of its location.
+ */
+struct MemoryNode final : ASTNode {
     ASTNode* location;
     void* address;
+    uint32_t size_class;
+#ifdef FLECHA_MEM_STATS
+    size_t size;
+
+    /**
+     * @brief Finds where the allot is in the source
+     *
+     * @return The line and column of the location's start, if it has one
+     */
+    memory::AllotSite Site() const {
+        ASTNode* start = location;
+        if (start && start->kind == NodeKind::Location) {
+            start = static_cast<LocationNode*>(start)->start;
+        }
+        if (!start || start->kind != NodeKind::Start) return {};
+
+        auto* at = static_cast<StartNode*>(start);
+        return {at->line, at->column};
+    }
+#endif
 
     /**
-     * @brief Allocates memory for a given size and stores the address
+     * @brief Allots memory for a given size and stores the address
      *
      * @param loc - The AST location node
      * @param size - The size of memory to allocate
      */
-    MemoryNode(ASTNode* loc, size_t size) : location(loc), address(nullptr) {
-        address = malloc(size);  // Allocate memory
-        if (!address) {
-            throw std::bad_alloc();  // Handle allocation failure
-        }
+    MemoryNode(ASTNode* loc, size_t size)
+        : ASTNode(NodeKind::Memory), location(loc) {
+        memory::Block block = memory::HeapCache::Local().Allocate(size);
+        address = block.address;
+        size_class = block.size_class;
+#ifdef FLECHA_MEM_STATS
+        this->size = size;
+        memory::MemStats::Global().RecordAllot(size, size_class, Site());
+#endif
     }
 
+    MemoryNode(const MemoryNode&) = delete;
+    MemoryNode& operator=(const MemoryNode&) = delete;
+
     /**
-     * @brief Frees the allocated memory
+     * @brief Dellots the memory, in O(1), the location is arena owned
      */
-    ~MemoryNode() {
-        free(address);
+    ~MemoryNode() { Release(); }
 
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
+    /**
+     * @brief Dellots the memory before the node goes away
+     */
+    void Release() {
+        if (!address) return;
+#ifdef FLECHA_MEM_STATS
+        memory::MemStats::Global().RecordDellot(size, Site());
+#endif
+        memory::HeapCache::Local().Free(memory::Block{address, size_class});
+        address = nullptr;
     }
 
     /**
@@ -576,7 +667,8 @@ struct MemoryNode : ASTNode {
 };
 
 struct VariableNode : ASTNode {
-    string name;
+    utils::Symbol symbol;
+    std::string_view name;
     ASTNode* location;
     ASTNode* value;
 
@@ -586,24 +678,15 @@ struct VariableNode : ASTNode {
      * @param name - The variable name
      * @param loc - The location node
      * @param val - The value node
+     * @param symbol - The interned variable name
      */
-    VariableNode(const string& name, ASTNode* loc, ASTNode* val)
-        : name(name), location(loc), value(val) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~VariableNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (value) {
-            delete value;
-            value = nullptr;
-        }
-    }
+    VariableNode(std::string_view name, ASTNode* loc, ASTNode* val,
+                 utils::Symbol symbol = utils::Symbol())
+        : ASTNode(NodeKind::Variable),
+          symbol(symbol),
+          name(name),
+          location(loc),
+          value(val) {}
 
     /**
      * @brief The Accept visitor for traversal
@@ -614,9 +697,11 @@ struct VariableNode : ASTNode {
 };
 
 struct ValueNode : ASTNode {
-    string value;
+    std::string_view value;
     ASTNode* location;
     ASTNode* type;
+    // Decoded by the tokenizer, None for strings
+    Literal literal;
 
     /**
      * @brief The ValueNode constructor
@@ -624,24 +709,15 @@ struct ValueNode : ASTNode {
      * @param val - The value as string
      * @param loc - The location node
      * @param type - The type node
-     */
-    ValueNode(const string& val, ASTNode* loc, ASTNode* type)
-        : value(val), location(loc), type(type) {}
-
-    /**
-     * @brief Destructs and free memory
-     */
-    ~ValueNode() {
-        if (location) {
-            delete location;
-            location = nullptr;
-        }
-
-        if (type) {
-            delete type;
-            type = nullptr;
-        }
-    }
+     * @param literal - The decoded number or char
+     */
+    ValueNode(std::string_view val, ASTNode* loc, ASTNode* type,
+              Literal literal = Literal())
+        : ASTNode(NodeKind::Value),
+          value(val),
+          location(loc),
+          type(type),
+          literal(literal) {}
 
     void Accept(Visitor& visitor) override { visitor.Visit(*this); }
 };
@@ -0,0 +1,44 @@
+#ifndef FLECHA_ARITHMETIC_HPP
+#define FLECHA_ARITHMETIC_HPP
+
+#include <cstdint>
+
+namespace flecha {
+namespace core {
+
+/*
+ * Integer arithmetic as Flecha defines it, shared by the VM and the
+ * constant folder so a folded expression gives what running it would.
+ */
+
+// Wraps on overflow instead of being undefined
+inline int64_t WrapInt(uint64_t value) { return static_cast<int64_t>(value); }
+
+/**
+ * @brief Raises an integer to an integer power by squaring
+ *
+ * @param base - The base
+ * @param exponent - The exponent, negative ones truncate towards zero
+ *
+ * @return The power, wrapped on overflow
+ */
+inline int64_t PowInt(int64_t base, int64_t exponent) {
+    if (exponent < 0) {
+        if (base == 1) return 1;
+        if (base == -1) return exponent % 2 ? -1 : 1;
+        return 0;
+    }
+
+    uint64_t result = 1;
+    uint64_t factor = static_cast<uint64_t>(base);
+    for (uint64_t e = static_cast<uint64_t>(exponent); e; e >>= 1) {
+        if (e & 1) result *= factor;
+        factor *= factor;
+    }
+    return WrapInt(result);
+}
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_ARITHMETIC_HPP
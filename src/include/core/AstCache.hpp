@@ -0,0 +1,118 @@
+#ifndef FLECHA_AST_CACHE_HPP
+#define FLECHA_AST_CACHE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "FlatAST.hpp"
+#include "utils/SourceFile.hpp"
+
+using string = std::string;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief A cache entry mapped into memory
+ *
+ * The arrays of the view point straight into the mapping, so loading an
+ * entry is an mmap and a header check, nothing is decoded or copied.
+ */
+class CachedAST {
+   private:
+    utils::SourceFile _file;
+    FlatASTView _view;
+
+   public:
+    CachedAST(utils::SourceFile file, FlatASTView view)
+        : _file(std::move(file)), _view(view) {}
+
+    /**
+     * @brief Gets the flat AST
+     *
+     * @return The view, valid as long as the CachedAST
+     */
+    const FlatASTView& View() const { return _view; }
+};
+
+/**
+ * @brief Stores the flat AST of parsed files to skip parsing them again
+ *
+ * Each source file has one entry in the cache directory, named after the
+ * source's absolute path and holding the hash of the text it was parsed
+ * from, so an edited file misses and its entry is overwritten. An entry is
+ * a fixed header followed by the FlatAST arrays, each 4 byte aligned in
+ * the file:
+ *
+ *     magic "FAST", version, content hash, node, child slot and text
+ *     sizes, checksum of the rest
+ *     kinds[nodes] (padded), data0[nodes], data1[nodes],
+ *     first_child[nodes + 1], children[slots], text[text]
+ *
+ * Integers are in host byte order, a cache is not meant to move between
+ * machines. Entries are written to a temporary file and renamed, so
+ * concurrent runs never see half an entry.
+ */
+class AstCache {
+   private:
+    string _directory;
+
+   public:
+    // Bumped whenever the entry layout or the AST changes
+    static constexpr uint32_t VERSION = 5;
+
+    /**
+     * @brief The AstCache constructor
+     *
+     * @param directory - Where entries go, created if missing
+     */
+    explicit AstCache(string directory);
+
+    /**
+     * @brief Hashes source text for cache keys
+     *
+     * @param text - The source text
+     *
+     * @return A 64 bit hash
+     */
+    static uint64_t ContentHash(std::string_view text);
+
+    /**
+     * @brief Gets the entry file of a source file
+     *
+     * @param path - The source path
+     *
+     * @return The entry path, whether or not it exists
+     */
+    string EntryPath(const string& path) const;
+
+    /**
+     * @brief Maps the entry of a source file
+     *
+     * @param path - The source path
+     * @param hash - The ContentHash of its current text
+     *
+     * @return The entry, nothing if missing, stale or malformed
+     */
+    std::optional<CachedAST> Load(const string& path, uint64_t hash) const;
+
+    /**
+     * @brief Writes the entry of a source file
+     *
+     * @param path - The source path
+     * @param hash - The ContentHash of the text the tree was parsed from
+     * @param flat - The flattened tree
+     *
+     * @return False if the entry could not be written
+     */
+    bool Store(const string& path, uint64_t hash, const FlatAST& flat) const;
+
+    const string& Directory() const { return _directory; }
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_AST_CACHE_HPP
@@ -0,0 +1,66 @@
+#ifndef FLECHA_CHARCLASS_HPP
+#define FLECHA_CHARCLASS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Character class bits, a character can belong to several
+ */
+enum CharClass : uint8_t {
+    CHAR_SPACE = 1 << 0,  // ' ', \t, \n, \v, \f, \r
+    CHAR_DIGIT = 1 << 1,  // 0-9
+    CHAR_ALPHA = 1 << 2,  // a-z, A-Z
+    CHAR_IDENT = 1 << 3,  // Identifier body: letters, digits and '_'
+};
+
+/**
+ * @brief Builds the class table for the ASCII range
+ *
+ * @return A table indexed by unsigned char, non-ASCII bytes have no class
+ */
+constexpr std::array<uint8_t, 256> BuildCharClasses() {
+    std::array<uint8_t, 256> table{};
+
+    for (int c : {' ', '\t', '\n', '\v', '\f', '\r'}) table[c] = CHAR_SPACE;
+
+    for (int c = '0'; c <= '9'; c++) table[c] = CHAR_DIGIT | CHAR_IDENT;
+
+    for (int c = 'a'; c <= 'z'; c++) {
+        table[c] = CHAR_ALPHA | CHAR_IDENT;
+        table[c - 'a' + 'A'] = CHAR_ALPHA | CHAR_IDENT;
+    }
+
+    table['_'] = CHAR_IDENT;
+    return table;
+}
+
+// Locale independent replacement for the <cctype> classifiers
+inline constexpr std::array<uint8_t, 256> CHAR_CLASSES = BuildCharClasses();
+
+/**
+ * @brief Checks a character against class bits
+ *
+ * @param c - The character
+ * @param classes - One or more CharClass bits
+ *
+ * @return True if the character has any of the bits
+ */
+constexpr bool IsCharClass(char c, uint8_t classes) {
+    return CHAR_CLASSES[static_cast<unsigned char>(c)] & classes;
+}
+
+constexpr bool IsSpace(char c) { return IsCharClass(c, CHAR_SPACE); }
+constexpr bool IsDigit(char c) { return IsCharClass(c, CHAR_DIGIT); }
+constexpr bool IsIdentStart(char c) {
+    return c == '_' || IsCharClass(c, CHAR_ALPHA);
+}
+constexpr bool IsIdentBody(char c) { return IsCharClass(c, CHAR_IDENT); }
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_CHARCLASS_HPP
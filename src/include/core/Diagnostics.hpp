@@ -0,0 +1,123 @@
+#ifndef FLECHA_DIAGNOSTICS_HPP
+#define FLECHA_DIAGNOSTICS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LineIndex.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Every error the front end reports, numbered by phase
+ *
+ * The numbers are stable: 1xx are lexical errors, 2xx syntax errors.
+ */
+enum class DiagnosticCode : uint16_t {
+    // Lexer
+    UnterminatedString = 101,
+    UnterminatedChar = 102,
+    InvalidEscape = 103,
+    NumberOutOfRange = 104,
+
+    // Parser
+    ExpectedDeclaration = 201,
+    ExpectedVariableName = 202,
+    ExpectedEqual = 203,
+    ExpectedSemiColon = 204,
+    ExpectedExpression = 205,
+    ExpectedCloseParen = 206,
+    ExpectedAllot = 207,
+    ExpectedAllotOpenParen = 208,
+    ExpectedAllotCloseParen = 209,
+    AllotTypeMismatch = 210,
+    NestingTooDeep = 211,
+};
+
+/**
+ * @brief One reported error, kept raw until someone formats it
+ *
+ * Reporting only records the code, where it happened and views of the
+ * offending text, so a file with many errors costs no string building
+ * unless the messages are printed. The views point into the source or
+ * the tokenizer, format the diagnostic while those are alive.
+ */
+struct Diagnostic {
+    DiagnosticCode code;
+    size_t offset;
+    // The offending token text, empty when there is none
+    std::string_view found;
+    // Extra context for some codes, e.g. the declared type of an allot
+    std::string_view detail;
+};
+
+/**
+ * @brief Collects diagnostics for one compilation unit
+ */
+class Diagnostics {
+   private:
+    vector<Diagnostic> _entries;
+
+   public:
+    /**
+     * @brief Records an error
+     *
+     * @param code - What went wrong
+     * @param offset - The source offset it is reported at
+     * @param found - The offending text
+     * @param detail - Extra context for the message
+     */
+    void Report(DiagnosticCode code, size_t offset,
+                std::string_view found = "", std::string_view detail = "") {
+        _entries.push_back(Diagnostic{code, offset, found, detail});
+    }
+
+    /**
+     * @brief Orders the diagnostics by source offset, keeping the report
+     * order of diagnostics at the same offset
+     */
+    void Sort();
+
+    /**
+     * @brief Forgets every diagnostic
+     */
+    void Clear() { _entries.clear(); }
+
+    bool HasErrors() const { return !_entries.empty(); }
+    size_t Count() const { return _entries.size(); }
+    const vector<Diagnostic>& Entries() const { return _entries; }
+    const Diagnostic& operator[](size_t i) const { return _entries[i]; }
+};
+
+/**
+ * @brief Gets the message text of a code, without found text or location
+ *
+ * @param code - The diagnostic code
+ *
+ * @return A static message
+ */
+const char* MessageOf(DiagnosticCode code);
+
+/**
+ * @brief Formats a diagnostic as
+ * "Parser Error [E204]: Expected ';' after value. Found: x at line 1,
+ * column 9"
+ *
+ * @param diagnostic - The diagnostic
+ * @param location - Its resolved location
+ *
+ * @return The message
+ */
+string Format(const Diagnostic& diagnostic, SourceLocation location);
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_DIAGNOSTICS_HPP
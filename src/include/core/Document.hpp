@@ -0,0 +1,134 @@
+#ifndef FLECHA_DOCUMENT_HPP
+#define FLECHA_DOCUMENT_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AST.hpp"
+#include "Diagnostics.hpp"
+#include "LineIndex.hpp"
+#include "memory/Arena.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief An editable source buffer that keeps its tree up to date
+ * incrementally, for editors
+ *
+ * The document remembers where every top-level statement starts. An edit
+ * re-lexes and re-parses from the statement before the edited text until
+ * the parser reaches the start of an old statement past the edit, outside
+ * any literal. From there the text, and so every token and statement, is
+ * the same as before, so the old statements are kept and only their
+ * offsets and locations are moved. Offsets move lazily, but edits that add
+ * or remove lines rewrite the line numbers of every following statement,
+ * which touches their location nodes but lexes and allocates nothing. The
+ * text stays one contiguous buffer, so an edit still moves the bytes after
+ * it once.
+ *
+ * Replaced statements stay in the arena until enough of them pile up,
+ * then the whole buffer is parsed again into a fresh one.
+ */
+class Document {
+   private:
+    /**
+     * @brief One top-level statement, it spans until the next one starts
+     */
+    struct Statement {
+        size_t begin;
+        SourceLocation at;
+        // nullptr when the statement was broken
+        ASTNode* node;
+        // Offsets relative to begin, so moving the statement keeps them
+        vector<Diagnostic> diagnostics;
+        // Every start and end node of the statement, moved by edits above
+        NodeList locations;
+    };
+
+    string _text;
+    memory::Arena _arenas[2];
+    size_t _live;
+    vector<Statement> _statements;
+    // The statement nodes BodyNode::expressions points into
+    vector<ASTNode*> _nodes;
+    SourceLocation _end;
+    size_t _reparsed;
+    size_t _garbage;
+    // Statements left out of the body list
+    size_t _broken;
+    // Statements from _moved_from on lag their begin by _moved_by
+    size_t _moved_from;
+    size_t _moved_by;
+
+    ProgramNode* _program;
+    BodyNode* _body;
+    StartNode* _program_start;
+    EndNode* _program_end;
+    RangeNode* _program_range;
+
+    memory::Arena& _Arena() { return _arenas[_live]; }
+    size_t _Begin(size_t index) const {
+        return _statements[index].begin +
+               (index >= _moved_from ? _moved_by : 0);
+    }
+    void _ParseAll();
+    size_t _Reparse(size_t first, size_t start, SourceLocation at,
+                    size_t old_end, size_t removed, size_t inserted,
+                    vector<Statement>& fresh);
+    void _Finish(bool relist);
+
+   public:
+    /**
+     * @brief The Document constructor, parses the whole text
+     *
+     * @param text - The initial contents
+     */
+    explicit Document(string text);
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    /**
+     * @brief Replaces a range of the text and updates the tree
+     *
+     * @param offset - Where the replaced range starts
+     * @param removed - How many bytes are replaced
+     * @param inserted - The new text
+     */
+    void Edit(size_t offset, size_t removed, std::string_view inserted);
+
+    /**
+     * @brief Gets the tree of the current text
+     *
+     * @return The ProgramNode, valid until the next edit
+     */
+    ProgramNode* Program() { return _program; }
+
+    const string& Text() const { return _text; }
+
+    /**
+     * @brief Collects the errors of the current text
+     *
+     * @return The diagnostics sorted by offset, their text valid until the
+     * next edit
+     */
+    vector<Diagnostic> Errors() const;
+
+    /**
+     * @brief Counts the statements parsed by the last edit or full parse
+     *
+     * @return How many statements were parsed
+     */
+    size_t Reparsed() const { return _reparsed; }
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_DOCUMENT_HPP
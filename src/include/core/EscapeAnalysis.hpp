@@ -0,0 +1,62 @@
+#ifndef FLECHA_ESCAPE_ANALYSIS_HPP
+#define FLECHA_ESCAPE_ANALYSIS_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "AST.hpp"
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Finds the allots whose pointer never leaves its variable
+ *
+ * A pointer escapes once its value is used other than by writing through
+ * it: copied into another variable, passed to an operator or having its
+ * own address taken with ?. Allots whose pointer never does are only ever
+ * reached through that one variable, so their pointee can live in a
+ * register or stack slot instead of the heap, and dellotting them does
+ * nothing. Names resolve by symbol as in the compiler, a redeclaration
+ * hides the older variable from then on.
+ */
+class EscapeAnalysis {
+   private:
+    std::unordered_set<const AllocationStatementNode*> _local;
+    size_t _allocations;
+
+    // Variables visible so far, pointing at their allot if they have one
+    std::unordered_map<utils::Symbol, const AllocationStatementNode*>
+        _bindings;
+    std::unordered_set<const AllocationStatementNode*> _escaped;
+
+    void _Use(ASTNode* expression, bool written_through);
+
+   public:
+    /**
+     * @brief Analyzes a program
+     *
+     * @param program - The program, may be null
+     */
+    explicit EscapeAnalysis(ProgramNode* program);
+
+    /**
+     * @brief Tells whether an allot can skip the heap
+     *
+     * @param allocation - A statement of the analyzed program
+     *
+     * @return True when the pointer never escapes
+     */
+    bool IsLocal(const AllocationStatementNode* allocation) const {
+        return _local.count(allocation) != 0;
+    }
+
+    size_t LocalCount() const { return _local.size(); }
+    size_t AllocationCount() const { return _allocations; }
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_ESCAPE_ANALYSIS_HPP
@@ -0,0 +1,200 @@
+#ifndef FLECHA_FLATAST_HPP
+#define FLECHA_FLATAST_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AST.hpp"
+#include "memory/Arena.hpp"
+#include "utils/Interner.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace core {
+
+using NodeIndex = uint32_t;
+
+// An empty child slot, like a null child pointer
+constexpr NodeIndex NO_NODE = UINT32_MAX;
+
+// Value nodes keep their Literal::Kind above the text length in data1
+constexpr uint32_t LITERAL_KIND_SHIFT = 29;
+constexpr uint32_t TEXT_LENGTH_MASK = (1u << LITERAL_KIND_SHIFT) - 1;
+
+/**
+ * @brief Gets the text length out of a node's data1
+ *
+ * @param kind - The node kind
+ * @param data1 - Its second payload word
+ *
+ * @return The length of its name or value
+ */
+inline uint32_t TextLength(NodeKind kind, uint32_t data1) {
+    return kind == NodeKind::Value ? data1 & TEXT_LENGTH_MASK : data1;
+}
+
+/**
+ * @brief A contiguous run of child slots
+ */
+struct ChildRange {
+    const NodeIndex* first;
+    const NodeIndex* last;
+
+    const NodeIndex* begin() const { return first; }
+    const NodeIndex* end() const { return last; }
+    size_t size() const { return last - first; }
+    NodeIndex operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * @brief A read-only flat AST over arrays owned elsewhere
+ *
+ * Lets a FlatAST and one mapped straight from an AstCache file be read
+ * the same way. The layout is FlatAST's.
+ */
+struct FlatASTView {
+    const NodeKind* kinds;
+    const uint32_t* data0;
+    const uint32_t* data1;
+    // size + 1 entries
+    const uint32_t* first_child;
+    const NodeIndex* children;
+    std::string_view text;
+    size_t size;
+
+    size_t Size() const { return size; }
+
+    ChildRange Children(NodeIndex node) const {
+        return ChildRange{children + first_child[node],
+                          children + first_child[node + 1]};
+    }
+
+    std::string_view Text(NodeIndex node) const {
+        return text.substr(data0[node], TextLength(kinds[node], data1[node]));
+    }
+
+    Literal::Kind LiteralKind(NodeIndex node) const {
+        return static_cast<Literal::Kind>(data1[node] >> LITERAL_KIND_SHIFT);
+    }
+};
+
+/**
+ * @brief The AST as parallel arrays, with children referenced by index
+ *
+ * Nodes are numbered in pre-order with the root at 0, so a pass over every
+ * node is a linear scan. Node i has kind kinds[i], two payload words
+ * data0[i] and data1[i], and the child slots
+ * children[first_child[i] .. first_child[i + 1]), in the same order as the
+ * pointer members of its ASTNode. A node shared by several parents is
+ * stored once.
+ *
+ * Payloads by kind: Start and End hold line and column, Range its bounds,
+ * Unary and Binary their operator's TokenType in data0, and Variable,
+ * Value, ProgramInitialization and the type nodes hold the offset and
+ * length of their name or value in text. Value nodes also keep their
+ * Literal::Kind in the top bits of data1, the literal is decoded again
+ * from the text when the tree is rebuilt. MemoryNodes are run time state
+ * rather than syntax, so they flatten to NO_NODE.
+ */
+struct FlatAST {
+    vector<NodeKind> kinds;
+    vector<uint32_t> data0;
+    vector<uint32_t> data1;
+    vector<uint32_t> first_child;
+    vector<NodeIndex> children;
+    string text;
+
+    /**
+     * @brief Gets the number of nodes
+     *
+     * @return The node count
+     */
+    size_t Size() const { return kinds.size(); }
+
+    /**
+     * @brief Gets a node's child slots
+     *
+     * @param node - The node index
+     *
+     * @return The slots, NO_NODE where the child is null
+     */
+    ChildRange Children(NodeIndex node) const {
+        return ChildRange{children.data() + first_child[node],
+                          children.data() + first_child[node + 1]};
+    }
+
+    /**
+     * @brief Gets the name or value of a node that has one
+     *
+     * @param node - The node index
+     *
+     * @return The text payload
+     */
+    std::string_view Text(NodeIndex node) const {
+        return std::string_view(text).substr(
+            data0[node], TextLength(kinds[node], data1[node]));
+    }
+
+    /**
+     * @brief Gets the memory held by the arrays
+     *
+     * @return The used bytes
+     */
+    size_t MemoryBytes() const;
+
+    /**
+     * @brief Gets a view of the arrays
+     *
+     * @return The view, valid until the FlatAST changes
+     */
+    FlatASTView View() const {
+        return FlatASTView{kinds.data(),       data0.data(),
+                           data1.data(),       first_child.data(),
+                           children.data(),    text,
+                           kinds.size()};
+    }
+};
+
+/**
+ * @brief Converts a tree into its flat form
+ *
+ * @param root - The root node, usually a ProgramNode
+ *
+ * @return The flat AST, root at index 0
+ */
+FlatAST Flatten(ASTNode* root);
+
+/**
+ * @brief Rebuilds the tree from a flat AST
+ *
+ * @param flat - The flat AST
+ * @param arena - Where the nodes and their values are allocated
+ * @param symbols - Interns the names
+ *
+ * @return The root node, nullptr for an empty flat AST
+ */
+ASTNode* Unflatten(const FlatAST& flat, memory::Arena& arena,
+                   utils::Interner& symbols = utils::Interner::Global());
+
+/**
+ * @brief Rebuilds the tree from a view of a flat AST
+ *
+ * @param flat - The view, like one of a cached file
+ * @param arena - Where the nodes and their values are allocated
+ * @param symbols - Interns the names
+ *
+ * @return The root node, nullptr for an empty flat AST. Throws on child
+ * indices out of range, cycles and children of the wrong kind.
+ */
+ASTNode* Unflatten(const FlatASTView& flat, memory::Arena& arena,
+                   utils::Interner& symbols = utils::Interner::Global());
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_FLATAST_HPP
@@ -0,0 +1,95 @@
+#ifndef FLECHA_FRONTEND_HPP
+#define FLECHA_FRONTEND_HPP
+
+#include <string>
+#include <vector>
+
+#include "AST.hpp"
+#include "AstCache.hpp"
+#include "memory/Arena.hpp"
+#include "utils/Interner.hpp"
+#include "utils/ThreadPool.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief The outcome of loading and parsing one input file
+ */
+struct ParsedFile {
+    string path;
+    // The tree, nullptr if loading or parsing failed
+    ProgramNode* program = nullptr;
+    // Errors as "<path>: <message>", in source order
+    vector<string> diagnostics;
+    // Whether the tree came from the AstCache rather than the parser
+    bool cached = false;
+};
+
+/**
+ * @brief Tokenizes and parses many files concurrently
+ *
+ * Files are parsed on a work-stealing ThreadPool, each into the arena of
+ * the worker that picked it up, so workers never share an allocator. The
+ * results come back in input order whatever order the files finished in,
+ * which keeps diagnostics deterministic. With an AstCache, files whose
+ * text is unchanged since they last parsed cleanly are rebuilt from their
+ * entry instead of being parsed.
+ */
+class Frontend {
+   private:
+    utils::ThreadPool _pool;
+    vector<memory::Arena> _arenas;
+    // Shared by every file, so a name has one symbol across the program
+    utils::Interner _symbols;
+    const AstCache* _cache;
+
+    ProgramNode* _Load(const string& path, uint64_t hash, size_t worker);
+
+   public:
+    /**
+     * @brief The Frontend constructor
+     *
+     * @param threads - The worker count, 0 for one per hardware thread
+     * @param cache - Where parsed trees are reused from, may be null
+     */
+    explicit Frontend(size_t threads = 0, const AstCache* cache = nullptr);
+
+    /**
+     * @brief Loads and parses every file
+     *
+     * @param paths - The input files
+     *
+     * @return One result per path, in the same order. The trees stay
+     * valid until Reset or the Frontend is destroyed.
+     */
+    vector<ParsedFile> ParseFiles(const vector<string>& paths);
+
+    /**
+     * @brief Releases every tree parsed so far
+     */
+    void Reset();
+
+    /**
+     * @brief Gets the number of workers
+     *
+     * @return The worker count
+     */
+    size_t Threads() const { return _pool.Size(); }
+
+    /**
+     * @brief Gets the interner of every parsed name
+     *
+     * @return The interner, names stay valid as long as the Frontend
+     */
+    utils::Interner& Symbols() { return _symbols; }
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_FRONTEND_HPP
@@ -0,0 +1,69 @@
+#ifndef FLECHA_KEYWORDS_HPP
+#define FLECHA_KEYWORDS_HPP
+
+#include <string_view>
+
+#include "TokenType.hpp"
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief Recognizes a keyword straight from the lexed characters
+ *
+ * The word's length and first character leave at most two candidates, so
+ * no string is built and nothing is hashed.
+ *
+ * @param word - The identifier-shaped word
+ *
+ * @return The keyword's token type, or Identifier
+ */
+constexpr TokenType LookupKeyword(std::string_view word) {
+    auto is = [word](std::string_view keyword, TokenType type) {
+        return word == keyword ? type : TokenType::Identifier;
+    };
+
+    switch (word.size()) {
+        case 3:
+            if (word[0] == 'i') return is("int", TokenType::Int);
+            break;
+        case 4:
+            switch (word[0]) {
+                case 'b': return is("bool", TokenType::Bool);
+                case 'c': return is("char", TokenType::Char);
+                case 'v': return is("void", TokenType::Void);
+            }
+            break;
+        case 5:
+            switch (word[0]) {
+                case 'a': return is("allot", TokenType::Allot);
+                case 'c': return is("class", TokenType::Class);
+                case 'f': return is("float", TokenType::Float);
+            }
+            break;
+        case 6:
+            switch (word[0]) {
+                case 'd': return is("dellot", TokenType::Dellot);
+                case 'm': return is("method", TokenType::Method);
+                case 'r': return is("return", TokenType::Return);
+                case 's':
+                    // "string" and "strict" only differ from the fifth on
+                    if (word[4] == 'n') return is("string", TokenType::String);
+                    return is("strict", TokenType::Strict);
+            }
+            break;
+        case 8:
+            if (word[0] == 'd') return is("destruct", TokenType::Destruct);
+            break;
+        case 9:
+            if (word[0] == 'c') return is("construct", TokenType::Construct);
+            break;
+    }
+
+    return TokenType::Identifier;
+}
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_KEYWORDS_HPP
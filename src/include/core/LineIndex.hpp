@@ -0,0 +1,70 @@
+#ifndef FLECHA_LINEINDEX_HPP
+#define FLECHA_LINEINDEX_HPP
+
+#include <string_view>
+#include <vector>
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief A 1-based line and column
+ */
+struct SourceLocation {
+    int line;
+    int column;
+};
+
+/**
+ * @brief Resolves byte offsets to lines and columns on demand
+ *
+ * Line starts are only collected when a location is asked for, and only
+ * as far into the source as that location, so sources that never report
+ * anything never pay for the index.
+ */
+class LineIndex {
+   private:
+    std::string_view _source;
+    vector<size_t> _line_starts;
+    size_t _scanned;
+    // The line number of _line_starts[0]
+    int _first_line;
+
+    void _ExtendTo(size_t offset);
+
+   public:
+    /**
+     * @brief The LineIndex constructor
+     *
+     * @param source - The indexed text, must outlive the index
+     */
+    explicit LineIndex(std::string_view source);
+
+    /**
+     * @brief A LineIndex that starts at a known location instead of the
+     * start of the source, so nothing before it is ever scanned
+     *
+     * @param source - The indexed text, must outlive the index
+     * @param offset - A byte offset into the source
+     * @param location - The line and column of that offset, offsets
+     * before its line cannot be resolved
+     */
+    LineIndex(std::string_view source, size_t offset, SourceLocation location);
+
+    /**
+     * @brief Resolves an offset
+     *
+     * @param offset - A byte offset, at most the source size
+     *
+     * @return The line and column of that byte
+     */
+    SourceLocation Locate(size_t offset);
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_LINEINDEX_HPP
@@ -0,0 +1,50 @@
+#ifndef FLECHA_LITERAL_HPP
+#define FLECHA_LITERAL_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief The decoded value of a number or char literal
+ *
+ * Decoded once, from the token, so nothing after the tokenizer parses
+ * numbers out of text again. String literals keep their text and have no
+ * payload, their kind is None.
+ */
+struct Literal {
+    // Bool literals only come out of constant folding
+    enum class Kind : uint8_t { None, Int, Float, Char, Bool };
+
+    Kind kind;
+    union {
+        int64_t i;
+        double f;
+        char c;
+    };
+
+    Literal() : kind(Kind::None), i(0) {}
+};
+
+static_assert(sizeof(Literal) == 16, "Literals are a tag and a word");
+
+/**
+ * @brief Decodes the text of a literal
+ *
+ * @param kind - What the text spells, None gives an empty literal
+ * @param text - Digits with at most one decimal point, one character, or
+ * 0 or 1 for bools
+ * @param out_of_range - Set when the number does not fit, the value is
+ * then clamped, may be null
+ *
+ * @return The literal
+ */
+Literal DecodeLiteral(Literal::Kind kind, std::string_view text,
+                      bool* out_of_range = nullptr);
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_LITERAL_HPP
@@ -0,0 +1,168 @@
+#ifndef FLECHA_OPTIMIZER_HPP
+#define FLECHA_OPTIMIZER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "AST.hpp"
+#include "memory/Arena.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace core {
+
+/**
+ * @brief One rewrite of a parsed program
+ *
+ * Passes rewrite the tree in place. Nodes they create come from the arena
+ * given to Run, which must outlive every later use of the tree.
+ */
+class Pass {
+   public:
+    virtual ~Pass() = default;
+
+    /**
+     * @brief Gets the pass name, for reports and traces
+     *
+     * @return A string literal
+     */
+    virtual const char* Name() const = 0;
+
+    /**
+     * @brief Rewrites a program
+     *
+     * @param program - The program, without parse errors
+     * @param arena - Where new nodes go
+     *
+     * @return The number of nodes removed from the tree
+     */
+    virtual size_t Run(ProgramNode& program, memory::Arena& arena) = 0;
+};
+
+/**
+ * @brief Replaces operators on literals with the literal they evaluate to
+ *
+ * Folds arithmetic, **, comparisons, the logical operators, | and unary -
+ * with the kinds and wrapping the compiler and VM give them, so a folded
+ * program computes exactly what the unfolded one would. Integer division
+ * and modulo by zero are left for the VM to report, as are operators the
+ * compiler rejects. Statements already folded carry ASTNode::optimized and
+ * are skipped, so after an edit only the new statements are visited.
+ */
+class ConstantFolding : public Pass {
+   private:
+    memory::Arena* _arena;
+    size_t _eliminated;
+    size_t _visited;
+
+    ASTNode* _Fold(ASTNode* expression);
+    ASTNode* _FoldUnary(UnaryNode& node);
+    ASTNode* _FoldBinary(BinaryNode& node);
+    ASTNode* _Replace(ASTNode* node, ASTNode* location, Literal literal);
+
+   public:
+    ConstantFolding() : _arena(nullptr), _eliminated(0), _visited(0) {}
+
+    const char* Name() const override { return "ConstantFolding"; }
+    size_t Run(ProgramNode& program, memory::Arena& arena) override;
+
+    /**
+     * @brief Counts the statements the last run had to visit
+     *
+     * @return The statements not folded by an earlier run
+     */
+    size_t Visited() const { return _visited; }
+};
+
+/**
+ * @brief Drops declarations whose value can never be read
+ *
+ * Programs are straight-line, so no statement is unreachable by control
+ * flow. A declaration is dead instead when its variable is declared again
+ * before anything reads it: the redeclaration hides it for good. Only
+ * declarations of a literal or of an already declared variable are
+ * dropped, whose compilation can not fail and whose evaluation has no
+ * effect, so removing them never turns an error into a success. The body
+ * gets a new expression list and the old one is left untouched.
+ */
+class DeadStoreElimination : public Pass {
+   public:
+    const char* Name() const override { return "DeadStoreElimination"; }
+    size_t Run(ProgramNode& program, memory::Arena& arena) override;
+};
+
+/**
+ * @brief How many nodes each pass removed
+ */
+struct OptimizeReport {
+    vector<std::pair<const char*, size_t>> passes;
+
+    /**
+     * @brief Sums the passes
+     *
+     * @return Every node removed
+     */
+    size_t Eliminated() const;
+};
+
+/**
+ * @brief Runs passes over programs between parsing and compilation
+ *
+ * The default pipeline folds constants, then drops dead stores, which
+ * folding turns more declarations into. Passes keep no state about a
+ * program other than ASTNode::optimized, so one optimizer serves any
+ * number of programs, and running it again over a partly edited tree
+ * redoes only the edited statements.
+ */
+class Optimizer {
+   private:
+    vector<std::unique_ptr<Pass>> _passes;
+
+   public:
+    /**
+     * @brief Builds the default pipeline
+     */
+    Optimizer();
+
+    /**
+     * @brief Builds an empty pipeline
+     *
+     * @return The optimizer, Add passes to it
+     */
+    static Optimizer Empty();
+
+    /**
+     * @brief Appends a pass
+     *
+     * @param pass - Runs after the passes added before it
+     */
+    void Add(std::unique_ptr<Pass> pass);
+
+    /**
+     * @brief Runs every pass in order
+     *
+     * @param program - The program, may be null
+     * @param arena - Where new nodes go, must outlive the tree's use
+     *
+     * @return What each pass removed
+     */
+    OptimizeReport Run(ProgramNode* program, memory::Arena& arena);
+};
+
+/**
+ * @brief Counts the nodes reachable from a node
+ *
+ * @param node - The root, may be null
+ *
+ * @return The count, a shared node once per path to it
+ */
+size_t CountNodes(ASTNode* node);
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_OPTIMIZER_HPP
@@ -1,12 +1,15 @@
 #ifndef FLECHA_PARSER_HPP
 #define FLECHA_PARSER_HPP
 
-#include <memory>
 #include <unordered_set>
 #include <vector>
 
 #include "AST.hpp"
+#include "Diagnostics.hpp"
 #include "Token.hpp"
+#include "Tokenizer.hpp"
+#include "memory/Arena.hpp"
+#include "utils/Interner.hpp"
 
 template <typename... Args>
 using vector = std::vector<Args...>;
@@ -18,22 +21,94 @@ namespace flecha {
 namespace core {
 class Parser {
    private:
-    vector<Token> _tokens;
-    size_t _index = 0;
-    Token _current_token;
+    Tokenizer& _tokenizer;
+    memory::Arena& _arena;
 
+    // Used when the caller passes no engine of its own
+    Diagnostics _own_diagnostics;
+    Diagnostics& _diagnostics;
+    utils::LocalInterner _symbols;
+
+    // Where the last consumed token starts, for node locations
+    size_t _last_offset = 0;
+    // How deeply the expression being parsed is nested
+    size_t _depth = 0;
+
+    const Token& _Current();
     Token _Advance();
     bool _Match(TokenType type);
     bool _Check(TokenType type);
-    void _Consume(TokenType type, const string& err = "");
+    bool _Consume(TokenType type, DiagnosticCode code, Token* token = nullptr);
+    void _Error(DiagnosticCode code, const Token& token,
+                std::string_view detail = "");
+    void _Synchronize(size_t start);
+    bool _IsDeclaration();
+
+    // Node builders
+    NodeList _MakeList(const vector<ASTNode*>& nodes);
+    ASTNode* _MakeLocation(const Token& start, const Token& end);
+    ASTNode* _MakeLocation(size_t start, size_t end);
+    ASTNode* _MakeType(const Token& token);
+    ASTNode* _MakeVariable(const Token& name, ASTNode* location,
+                           ASTNode* value);
 
     // Parsing methods
-    std::unique_ptr<ASTNode> _ParseExpression();
-    std::unique_ptr<ASTNode> _ParseExpressionStatement();
+    ASTNode* _ParseExpression(int min_precedence = 1);
+    ASTNode* _ParsePrefix();
+    ASTNode* _ParseExpressionStatement();
+    ASTNode* _ParseVariableDeclaration(const Token& type, const Token& name);
+    ASTNode* _ParseAllocationStatement(const Token& type, const Token& name);
 
    public:
-    explicit Parser(const vector<Token>& tokens);
-    std::unique_ptr<ASTNode> Parse();
+    /**
+     * @brief The Parser constructor, for callers that want the first error
+     * thrown
+     *
+     * @param tokenizer - The token stream, pulled lazily while parsing
+     * @param arena - Where every node is allocated, releasing it releases
+     * the whole tree
+     *
+     * Names are interned in utils::Interner::Global().
+     */
+    Parser(Tokenizer& tokenizer, memory::Arena& arena);
+
+    /**
+     * @brief The Parser constructor, collecting every error instead
+     *
+     * @param tokenizer - The token stream, its lexical errors are reported
+     * to diagnostics too
+     * @param arena - Where every node is allocated
+     * @param diagnostics - Receives the errors, sorted by offset
+     * @param symbols - Interns the names of the tree, it must outlive the
+     * tree
+     */
+    Parser(Tokenizer& tokenizer, memory::Arena& arena,
+           Diagnostics& diagnostics,
+           utils::Interner& symbols = utils::Interner::Global());
+
+    Parser(const Parser&) = delete;
+    Parser& operator=(const Parser&) = delete;
+
+    /**
+     * @brief Parses statements until the end of the token stream,
+     * resynchronizing after errors
+     *
+     * @return The ProgramNode root, owned by the arena. Without a
+     * diagnostics engine, throws std::runtime_error with the first error
+     * once the whole stream is parsed.
+     */
+    ProgramNode* Parse();
+
+    /**
+     * @brief Parses the next top-level statement, resynchronizing after
+     * an error
+     *
+     * Stops right before the first token of the following statement, so
+     * statements can be reparsed one at a time.
+     *
+     * @return The statement, nullptr if it was broken and skipped
+     */
+    ASTNode* ParseStatement();
 };
 }  // namespace core
 }  // namespace flecha
@@ -0,0 +1,30 @@
+#ifndef FLECHA_SCAN_HPP
+#define FLECHA_SCAN_HPP
+
+namespace flecha {
+namespace core {
+
+/*
+ * Run scanners for the tokenizer's long loops. Each one returns the first
+ * position in [begin, end) that does not continue the run, or end. They
+ * consume 32 (AVX2) or 16 (SSE2, NEON) bytes per step and finish the
+ * tail with the character class table, which is also the fallback on
+ * other targets.
+ */
+
+// Whitespace as in std::isspace under the C locale
+const char* ScanWhitespace(const char* begin, const char* end);
+
+// Identifier body: letters, digits and '_'
+const char* ScanIdentifier(const char* begin, const char* end);
+
+// Decimal digits
+const char* ScanDigits(const char* begin, const char* end);
+
+// String literal body, up to the next '"' or '\\'
+const char* ScanStringBody(const char* begin, const char* end);
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_SCAN_HPP
@@ -0,0 +1,284 @@
+#ifndef FLECHA_STATIC_VISITOR_HPP
+#define FLECHA_STATIC_VISITOR_HPP
+
+#include "AST.hpp"
+
+namespace flecha {
+namespace core {
+
+/*
+ * ForEachChild calls a function on each child slot of a node, in member
+ * order. Null children are passed through, so callers see every slot. The
+ * overloads for concrete nodes resolve at compile time; the ASTNode one
+ * switches on the kind first.
+ */
+
+template <typename Fn>
+inline void ForEachChild(VariableNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.value);
+}
+
+template <typename Fn>
+inline void ForEachChild(ValueNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.type);
+}
+
+template <typename Fn>
+inline void ForEachChild(LocationNode& n, Fn&& fn) {
+    fn(n.start);
+    fn(n.end);
+}
+
+template <typename Fn>
+inline void ForEachChild(ProgramNode& n, Fn&& fn) {
+    fn(n.body);
+    fn(n.location);
+    fn(n.range);
+}
+
+template <typename Fn>
+inline void ForEachChild(BodyNode& n, Fn&& fn) {
+    fn(n.program_init);
+    for (ASTNode* expression : n.expressions) fn(expression);
+}
+
+template <typename Fn>
+inline void ForEachChild(AllocationStatementNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.allocation);
+    fn(n.initialization);
+}
+
+template <typename Fn>
+inline void ForEachChild(VariableDeclarationNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.assignment);
+    fn(n.type);
+}
+
+template <typename Fn>
+inline void ForEachChild(UnaryNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.operand);
+}
+
+template <typename Fn>
+inline void ForEachChild(BinaryNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.left);
+    fn(n.right);
+}
+
+template <typename Fn>
+inline void ForEachChild(InitializationStatementNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.pointer_node);
+}
+
+template <typename Fn>
+inline void ForEachChild(PointerNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.type);
+    fn(n.memory);
+    fn(n.variable);
+}
+
+template <typename Fn>
+inline void ForEachChild(MemoryNode& n, Fn&& fn) {
+    fn(n.location);
+}
+
+template <typename Fn>
+inline void ForEachChild(AllocationNode& n, Fn&& fn) {
+    fn(n.location);
+    fn(n.pointer_node);
+}
+
+// Leaves have no child slots
+template <typename Fn>
+inline void ForEachChild(StartNode&, Fn&&) {}
+template <typename Fn>
+inline void ForEachChild(EndNode&, Fn&&) {}
+template <typename Fn>
+inline void ForEachChild(RangeNode&, Fn&&) {}
+template <typename Fn>
+inline void ForEachChild(ProgramInitializationNode&, Fn&&) {}
+template <typename Fn>
+inline void ForEachChild(PrimitiveTypeNode&, Fn&&) {}
+template <typename Fn>
+inline void ForEachChild(UserDefinedTypeNode&, Fn&&) {}
+
+/**
+ * @brief Calls a function on each child slot of a node of any kind
+ *
+ * @param node - The node
+ * @param fn - Called with each child pointer, null ones included
+ */
+template <typename Fn>
+inline void ForEachChild(ASTNode& node, Fn&& fn) {
+    switch (node.kind) {
+        case NodeKind::Variable:
+            return ForEachChild(static_cast<VariableNode&>(node), fn);
+        case NodeKind::Value:
+            return ForEachChild(static_cast<ValueNode&>(node), fn);
+        case NodeKind::Start:
+            return ForEachChild(static_cast<StartNode&>(node), fn);
+        case NodeKind::End:
+            return ForEachChild(static_cast<EndNode&>(node), fn);
+        case NodeKind::Location:
+            return ForEachChild(static_cast<LocationNode&>(node), fn);
+        case NodeKind::Range:
+            return ForEachChild(static_cast<RangeNode&>(node), fn);
+        case NodeKind::Program:
+            return ForEachChild(static_cast<ProgramNode&>(node), fn);
+        case NodeKind::ProgramInitialization:
+            return ForEachChild(static_cast<ProgramInitializationNode&>(node),
+                                fn);
+        case NodeKind::Body:
+            return ForEachChild(static_cast<BodyNode&>(node), fn);
+        case NodeKind::AllocationStatement:
+            return ForEachChild(static_cast<AllocationStatementNode&>(node),
+                                fn);
+        case NodeKind::VariableDeclaration:
+            return ForEachChild(static_cast<VariableDeclarationNode&>(node),
+                                fn);
+        case NodeKind::Unary:
+            return ForEachChild(static_cast<UnaryNode&>(node), fn);
+        case NodeKind::Binary:
+            return ForEachChild(static_cast<BinaryNode&>(node), fn);
+        case NodeKind::InitializationStatement:
+            return ForEachChild(static_cast<InitializationStatementNode&>(node),
+                                fn);
+        case NodeKind::Pointer:
+            return ForEachChild(static_cast<PointerNode&>(node), fn);
+        case NodeKind::Memory:
+            return ForEachChild(static_cast<MemoryNode&>(node), fn);
+        case NodeKind::Allocation:
+            return ForEachChild(static_cast<AllocationNode&>(node), fn);
+        case NodeKind::PrimitiveType:
+            return ForEachChild(static_cast<PrimitiveTypeNode&>(node), fn);
+        case NodeKind::UserDefinedType:
+            return ForEachChild(static_cast<UserDefinedTypeNode&>(node), fn);
+    }
+}
+
+/**
+ * @brief Statically dispatched visitor, switching on the node kind
+ *
+ * Derived classes overload Visit for the nodes they handle and bring the
+ * defaults in with `using StaticVisitor<Derived>::Visit;`. Dispatch then
+ * resolves to the most specific overload at compile time, with one switch
+ * instead of the two virtual calls of Accept and Visitor::Visit, so the
+ * handlers can be inlined.
+ *
+ * @example:
+ *     struct Counter : StaticVisitor<Counter> {
+ *         using StaticVisitor<Counter>::Visit;
+ *         int count = 0;
+ *         void Visit(VariableNode& node) { count++; VisitChildren(node); }
+ *     };
+ */
+template <typename Derived, typename Result = void>
+class StaticVisitor {
+   public:
+    /**
+     * @brief Visits a node through the derived class
+     *
+     * @param node - The node
+     *
+     * @return What the matching Visit overload returns
+     */
+    Result Dispatch(ASTNode& node) {
+        Derived& self = static_cast<Derived&>(*this);
+
+        switch (node.kind) {
+            case NodeKind::Variable:
+                return self.Visit(static_cast<VariableNode&>(node));
+            case NodeKind::Value:
+                return self.Visit(static_cast<ValueNode&>(node));
+            case NodeKind::Start:
+                return self.Visit(static_cast<StartNode&>(node));
+            case NodeKind::End:
+                return self.Visit(static_cast<EndNode&>(node));
+            case NodeKind::Location:
+                return self.Visit(static_cast<LocationNode&>(node));
+            case NodeKind::Range:
+                return self.Visit(static_cast<RangeNode&>(node));
+            case NodeKind::Program:
+                return self.Visit(static_cast<ProgramNode&>(node));
+            case NodeKind::ProgramInitialization:
+                return self.Visit(static_cast<ProgramInitializationNode&>(node));
+            case NodeKind::Body:
+                return self.Visit(static_cast<BodyNode&>(node));
+            case NodeKind::AllocationStatement:
+                return self.Visit(static_cast<AllocationStatementNode&>(node));
+            case NodeKind::VariableDeclaration:
+                return self.Visit(static_cast<VariableDeclarationNode&>(node));
+            case NodeKind::Unary:
+                return self.Visit(static_cast<UnaryNode&>(node));
+            case NodeKind::Binary:
+                return self.Visit(static_cast<BinaryNode&>(node));
+            case NodeKind::InitializationStatement:
+                return self.Visit(
+                    static_cast<InitializationStatementNode&>(node));
+            case NodeKind::Pointer:
+                return self.Visit(static_cast<PointerNode&>(node));
+            case NodeKind::Memory:
+                return self.Visit(static_cast<MemoryNode&>(node));
+            case NodeKind::Allocation:
+                return self.Visit(static_cast<AllocationNode&>(node));
+            case NodeKind::PrimitiveType:
+                return self.Visit(static_cast<PrimitiveTypeNode&>(node));
+            case NodeKind::UserDefinedType:
+                return self.Visit(static_cast<UserDefinedTypeNode&>(node));
+        }
+
+        __builtin_unreachable();
+    }
+
+    /**
+     * @brief Visits the node if there is one
+     *
+     * @param node - The node, may be null
+     */
+    void Dispatch(ASTNode* node) {
+        if (node) Dispatch(*node);
+    }
+
+    /**
+     * @brief Visits every non-null child of a node, in member order
+     *
+     * @param node - The parent node, a concrete type skips the kind switch
+     */
+    template <typename Node>
+    void VisitChildren(Node& node) {
+        ForEachChild(node, [this](ASTNode* child) { Dispatch(child); });
+    }
+
+    /**
+     * @brief The default for nodes without an overload, visits the children
+     *
+     * @param node - The node
+     *
+     * @return A value-initialized Result
+     */
+    template <typename Node>
+    Result Visit(Node& node) {
+        static_cast<Derived&>(*this).VisitChildren(node);
+        return Result();
+    }
+
+   protected:
+    /**
+     * @brief Only derived visitors are constructed or destroyed
+     */
+    StaticVisitor() = default;
+    ~StaticVisitor() = default;
+};
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_STATIC_VISITOR_HPP
@@ -1,6 +1,7 @@
 #ifndef FLECHA_TOKEN_HPP
 #define FLECHA_TOKEN_HPP
 
+#include <cstdint>
 #include <string>
 #include "TokenType.hpp"
 
@@ -9,18 +10,36 @@ using string = std::string;
 namespace flecha {
 namespace core {
 
+    /**
+     * @brief A lexed token, packed into 8 bytes
+     *
+     * A token holds no text. Its spelling is the length bytes of source at
+     * its offset, one past the opening quote for string and char literals,
+     * and Tokenizer::Text returns it. Literals whose value differs from
+     * their spelling, those with escapes, are decoded into the tokenizer's
+     * literal table instead and length is their index there. The tokenizer
+     * that produced a token must outlive it. Its position is the byte
+     * offset of its first character, resolved to a line and column only on
+     * demand.
+     */
     struct Token {
+        // Longer spellings go to the literal table
+        static constexpr uint32_t MAX_LENGTH = (1u << 23) - 1;
+
+        uint32_t offset;
         TokenType type;
-        string value;
-        int line;
-        int column;
+        uint32_t length : 23;
+        // Whether length indexes the literal table
+        uint32_t in_table : 1;
 
         Token()
-            : type(TokenType::NoToken), value(""), line(-1), column(-1) {}
-        Token(TokenType type, const string& value, int line, int col)
-            : type(type), value(value), line(line), column(col) {}
+            : offset(0), type(TokenType::NoToken), length(0), in_table(0) {}
+        Token(TokenType type, uint32_t offset, uint32_t length = 0)
+            : offset(offset), type(type), length(length), in_table(0) {}
     };
 
+    static_assert(sizeof(Token) == 8, "Tokens must stay 8 bytes");
+
 }   // namespace core
 }   // namespace flecha
 
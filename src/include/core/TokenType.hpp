@@ -5,7 +5,10 @@
 #ifndef FLECHA_TOKENTYPE_HPP
 #define FLECHA_TOKENTYPE_HPP
 
-enum class TokenType {
+#include <cstdint>
+
+// One byte, so a Token packs into 8
+enum class TokenType : uint8_t {
     Int,
     Char,
     Bool,
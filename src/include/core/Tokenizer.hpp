@@ -1,8 +1,14 @@
 #ifndef FLECHA_TOKENIZER_HPP
 #define FLECHA_TOKENIZER_HPP
 
+#include <array>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "Diagnostics.hpp"
+#include "LineIndex.hpp"
+#include "Literal.hpp"
 #include "Token.hpp"
 
 using string = std::string;
@@ -11,21 +17,130 @@ template <typename ...Args> using vector = std::vector<Args...>;
 namespace flecha {
 namespace core {
     class Tokenizer {
+    public:
+        // Number of tokens Peek can look ahead
+        static constexpr size_t LOOKAHEAD = 4;
+
     private:
-        string _source;
+        std::string_view _source;
+        std::deque<string> _literals; // Decoded literals, indexed by tokens
         size_t _index;
-        int _line;
-        int _column;
+        LineIndex _lines;
+        Diagnostics* _diagnostics; // Where errors go, throws when null
+
+        // Lookahead ring buffer filled by Peek and drained by Next
+        std::array<Token, LOOKAHEAD> _lookahead;
+        size_t _head;
+        size_t _buffered;
+        size_t _consumed; // Tokens returned by Next
 
         char _GetCurrentChar() const;
         void _Advance();
+        void _AdvanceTo(const char* run_end);
         bool _IsAtEnd() const;
+        const char* _Cursor() const;
+        const char* _End() const;
         void _SkipWhiteSpace();
         Token _NextToken();        
+        void _Fill(size_t count);
+        void _Error(DiagnosticCode code, size_t offset);
+        void _SkipPast(char close);
+        void _SetSpelling(Token& token, size_t start, size_t length);
+        void _SetLiteral(Token& token, size_t index);
+        static std::string_view _Checked(std::string_view src);
 
     public:
-        Tokenizer(const string& src);
+        /**
+         * @brief The Tokenizer constructor
+         *
+         * @param src - The source text, not copied, must outlive the
+         * tokenizer, at most 4 GiB so offsets fit in 32 bits
+         */
+        Tokenizer(std::string_view src);
+
+        /**
+         * @brief A Tokenizer that starts in the middle of a source
+         *
+         * @param src - The whole source text, must outlive the tokenizer
+         * @param start - Where lexing starts, a token boundary outside any
+         * literal
+         * @param at - The line and column of start
+         */
+        Tokenizer(std::string_view src, size_t start, SourceLocation at);
+
+        /**
+         * @brief Lexes and consumes the next token
+         *
+         * @return The next token, EOF_TOKEN forever once the source ends
+         */
+        Token Next();
+
+        /**
+         * @brief Looks ahead without consuming
+         *
+         * @param k - How many tokens past the next one, below LOOKAHEAD
+         *
+         * @return The token Next would return after k calls, valid until
+         * the next call to Next
+         */
+        const Token& Peek(size_t k = 0);
+
+        /**
+         * @brief Gets the text of a token
+         *
+         * @param token - A token this tokenizer produced
+         *
+         * @return Its spelling, or the decoded value of a literal without
+         * its quotes, valid as long as the tokenizer
+         */
+        std::string_view Text(const Token& token) const;
+
+        /**
+         * @brief Gets the value of a number or char literal
+         *
+         * Numbers too large to fit were reported when lexed and are
+         * clamped here.
+         *
+         * @param token - A token this tokenizer produced
+         *
+         * @return The decoded literal, of kind None for other tokens
+         */
+        Literal Value(const Token& token) const;
+
+        /**
+         * @brief Counts the tokens consumed so far
+         *
+         * @return The number of Next calls, EOF_TOKEN included
+         */
+        size_t Consumed() const { return _consumed; }
+
+        /**
+         * @brief Lexes the whole source at once
+         *
+         * @return Every remaining token, ending with EOF_TOKEN
+         */
         vector<Token> Tokenize();
+
+        /**
+         * @brief Sends lexical errors to a diagnostics engine
+         *
+         * Without one the first error throws std::runtime_error. With one
+         * the error is recorded and lexing recovers: an unterminated
+         * literal runs to its closing quote, the end of the line or the
+         * end of the source.
+         *
+         * @param diagnostics - The engine, nullptr to throw again
+         */
+        void ReportTo(Diagnostics* diagnostics);
+
+        /**
+         * @brief Resolves a source offset, such as Token::offset
+         *
+         * @param offset - The byte offset
+         *
+         * @return Its line and column
+         */
+        SourceLocation Locate(size_t offset);
     };
 }
 }
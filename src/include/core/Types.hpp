@@ -0,0 +1,44 @@
+#ifndef FLECHA_TYPES_HPP
+#define FLECHA_TYPES_HPP
+
+#include <cstdint>
+
+#include "AST.hpp"
+#include "utils/Interner.hpp"
+
+namespace flecha {
+namespace core {
+
+/*
+ * The declared types as Flecha reads them, shared by the compiler and the
+ * optimizer so both agree on what a type node names. Types are told apart
+ * by symbol: the primitive names are presets of every interner.
+ */
+
+// In the order of utils::Interner::PRESETS
+enum class Primitive : uint8_t { Int, Float, Bool, Char, String, None };
+
+/**
+ * @brief Gets the primitive a type node names
+ *
+ * @param type - A PrimitiveTypeNode or UserDefinedTypeNode
+ *
+ * @return The primitive, None for user defined types
+ */
+inline Primitive PrimitiveOf(ASTNode* type) {
+    auto* node = static_cast<TypeNode*>(type);
+    if (!node->IsPrimitive()) return Primitive::None;
+
+    utils::Symbol symbol = node->GetTypeSymbol();
+    for (size_t i = 0; i < utils::Interner::PRESET_COUNT; i++) {
+        if (symbol == utils::Interner::Preset(i)) {
+            return static_cast<Primitive>(i);
+        }
+    }
+    return Primitive::None;
+}
+
+}  // namespace core
+}  // namespace flecha
+
+#endif  // FLECHA_TYPES_HPP
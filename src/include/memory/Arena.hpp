@@ -0,0 +1,148 @@
+#ifndef FLECHA_ARENA_HPP
+#define FLECHA_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief A bump allocator that releases everything at once
+ *
+ * Allocations are carved front to back out of large chunks, so objects
+ * made one after another sit next to each other. Nothing is freed
+ * individually: Reset rewinds to the first chunk in O(1) and keeps every
+ * chunk for reuse, and the destructor returns the chunks to the system.
+ * Objects are never destroyed, so only trivially destructible types can
+ * be made in an arena.
+ */
+class Arena {
+   private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    Chunk* _first;
+    Chunk* _current;
+    char* _cursor;
+    char* _limit;
+    size_t _chunk_size;
+    size_t _used;
+    size_t _objects;
+
+    void* _AllocateSlow(size_t size, size_t alignment);
+    static char* _Data(Chunk* chunk);
+
+   public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief The Arena constructor, chunks are allocated on first use
+     *
+     * @param chunk_size - The usual chunk size, bigger requests get a
+     * chunk of their own
+     */
+    explicit Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Returns every chunk to the system
+     */
+    ~Arena();
+
+    /**
+     * @brief Allocates uninitialized memory
+     *
+     * @param size - The number of bytes
+     * @param alignment - A power of two
+     *
+     * @return The memory, valid until Reset or destruction
+     */
+    void* Allocate(size_t size,
+                   size_t alignment = alignof(std::max_align_t)) {
+        char* aligned = reinterpret_cast<char*>(
+            (reinterpret_cast<size_t>(_cursor) + alignment - 1) &
+            ~(alignment - 1));
+        if (_cursor && aligned + size <= _limit) {
+            _cursor = aligned + size;
+            _used += size;
+            return aligned;
+        }
+
+        return _AllocateSlow(size, alignment);
+    }
+
+    /**
+     * @brief Constructs an object in the arena
+     *
+     * @param args - The constructor arguments
+     *
+     * @return The object, never destroyed
+     */
+    template <typename T, typename... Args>
+    T* Make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena objects are never destroyed");
+        _objects++;
+        return new (Allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Allocates an array of value-initialized elements
+     *
+     * @param count - The number of elements
+     *
+     * @return The first element
+     */
+    template <typename T>
+    T* MakeArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena objects are never destroyed");
+        T* array = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) new (array + i) T();
+        return array;
+    }
+
+    /**
+     * @brief Copies characters into the arena
+     *
+     * @param text - The characters
+     *
+     * @return A view of the arena copy
+     */
+    std::string_view CopyString(std::string_view text);
+
+    /**
+     * @brief Releases every allocation in O(1), keeping the chunks
+     */
+    void Reset();
+
+    /**
+     * @brief Gets the bytes handed out since the last reset
+     *
+     * @return The requested bytes, without alignment padding
+     */
+    size_t BytesUsed() const { return _used; }
+
+    /**
+     * @brief Gets the objects made since the last reset
+     *
+     * @return The Make calls, arrays and strings not counted
+     */
+    size_t ObjectsMade() const { return _objects; }
+};
+
+}  // namespace memory
+}  // namespace flecha
+
+#endif  // FLECHA_ARENA_HPP
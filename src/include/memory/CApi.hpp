@@ -0,0 +1,32 @@
+#ifndef FLECHA_C_API_HPP
+#define FLECHA_C_API_HPP
+
+#include <cstddef>
+
+/*
+ * The heap behind C linkage, for programs built ahead of time. Their
+ * allots and dellots go through the calling thread's HeapCache, like the
+ * VM's, so both get the same size classes. The C backend declares these
+ * itself, the generated code needs no header.
+ */
+extern "C" {
+
+/**
+ * @brief Allocates a block
+ *
+ * @param size - The number of bytes
+ *
+ * @return The block, never null
+ */
+void* flecha_allot(size_t size);
+
+/**
+ * @brief Frees a block from flecha_allot
+ *
+ * @param address - The block, null is ignored
+ * @param size - The size it was allotted with
+ */
+void flecha_dellot(void* address, size_t size);
+}
+
+#endif  // FLECHA_C_API_HPP
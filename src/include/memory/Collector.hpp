@@ -0,0 +1,230 @@
+#ifndef FLECHA_COLLECTOR_HPP
+#define FLECHA_COLLECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+#include "Heap.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief The slots a collection reads and updates as roots
+ *
+ * Each listed slot holds a pointer or null. Pointers the collector does
+ * not own, like a register's address, are left alone.
+ */
+struct Roots {
+    void** slots = nullptr;
+    const uint16_t* indices = nullptr;
+    size_t count = 0;
+};
+
+/**
+ * @brief Tuning of a Collector
+ */
+struct CollectorOptions {
+    // Bump allocated young objects, DefaultNurseryBytes() if 0
+    size_t nursery_bytes = 0;
+    // Old generation bytes marked or swept per allocation in a major cycle
+    size_t step_bytes = 256 * 1024;
+    // A major cycle starts when the old generation reaches this many bytes
+    // and growth times what the last cycle left alive
+    size_t min_major_bytes = 8 * 1024 * 1024;
+    double growth = 2.0;
+};
+
+/**
+ * @brief What a Collector has done so far
+ */
+struct CollectorStats {
+    size_t allocations = 0;
+    size_t minor_collections = 0;
+    size_t major_cycles = 0;
+    size_t promoted_bytes = 0;
+    size_t swept_bytes = 0;
+    // Dellots that gave memory back before a collection had to
+    size_t early_frees = 0;
+    size_t old_bytes = 0;
+    // The longest a single allocation spent collecting
+    uint64_t max_pause_ns = 0;
+};
+
+/**
+ * @brief A precise, generational collector for allots, the opt-in
+ * alternative to dellot
+ *
+ * New objects are bump allocated in a nursery sized to fit in L2. When it
+ * fills, a minor collection copies the objects reachable from the roots
+ * and the remembered set into the old generation and moves the pointers
+ * to them, so the nursery is empty again. Old objects live in 1 MiB
+ * regions and are reused by the heap's size classes, bigger ones get
+ * their own block from the system.
+ *
+ * The old generation is collected by major cycles that never stop the
+ * program for a whole heap: marking and sweeping advance by step_bytes on
+ * every allocation. During marking a store of a pointer shades the stored
+ * object, and objects made in the cycle are already marked, so nothing
+ * reachable is missed. The roots are rescanned before sweeping, since
+ * registers change without a barrier.
+ *
+ * Objects hold either no pointers or only pointers, as the allot's
+ * pointee kind says. Every write of a pointer into an object must go
+ * through Write, and block writes through Dirty. The collector is single
+ * threaded and serves one program at a time.
+ */
+class Collector {
+   public:
+    static constexpr size_t REGION_SIZE = size_t(1) << 20;
+
+    enum class Phase : uint8_t { Idle, Marking, Sweeping };
+
+   private:
+    struct Header;
+
+    CollectorOptions _options;
+    CollectorStats _stats;
+
+    // The nursery
+    char* _young;
+    char* _top;
+    char* _end;
+
+    // The old generation
+    vector<char*> _regions;
+    std::unordered_set<uintptr_t> _owned;
+    // Objects past the biggest size class, by their address
+    std::unordered_set<uintptr_t> _large;
+    char* _cursor;
+    char* _limit;
+    void* _free[Heap::CLASSES];
+    // Deques grow without copying, which would pause for the whole heap
+    std::deque<Header*> _old;
+    vector<Header*> _remembered;
+
+    // Major cycles, an object is marked when its mark is the epoch
+    Phase _phase;
+    uint8_t _epoch;
+    std::deque<Header*> _gray;
+    size_t _sweep_cursor;
+    size_t _sweep_kept;
+    size_t _next_major;
+
+    vector<Header*> _promoted;
+
+    static Header* _HeaderOf(const void* object);
+    bool _IsYoung(const void* object) const;
+    bool _IsOld(const void* object) const;
+
+    Header* _AllocateOld(size_t size, uint8_t flags);
+    void _Release(Header* header);
+    void* _Evacuate(void* object);
+    bool _Shade(void* object);
+    void _Forward(void** slot);
+
+    void _Minor(const Roots& roots);
+    void _StartMajor(const Roots& roots);
+    void _Step(const Roots& roots, size_t budget);
+    bool _Mark(size_t budget);
+    bool _Sweep(size_t budget);
+
+   public:
+    /**
+     * @brief The Collector constructor
+     *
+     * @param options - The tuning
+     */
+    explicit Collector(CollectorOptions options = {});
+
+    Collector(const Collector&) = delete;
+    Collector& operator=(const Collector&) = delete;
+
+    /**
+     * @brief Frees every object, live or not
+     */
+    ~Collector();
+
+    /**
+     * @brief Allocates a zeroed object, collecting first if needed
+     *
+     * @param size - The payload bytes
+     * @param holds_pointers - Whether every word of it is a pointer
+     * @param roots - The slots live across the allocation
+     *
+     * @return The object, never null
+     */
+    void* Allocate(size_t size, bool holds_pointers, const Roots& roots);
+
+    /**
+     * @brief Takes a dellot as a hint that an object is dead
+     *
+     * The object is skipped by the next collection, which nulls pointers
+     * still left to it; its space is only reused after that.
+     *
+     * @param object - An object of this collector
+     */
+    void Free(void* object);
+
+    /**
+     * @brief The write barrier, after storing a pointer into an object
+     *
+     * @param object - Where the pointer was stored, may be unowned
+     * @param value - The pointer stored
+     */
+    void Write(void* object, void* value);
+
+    /**
+     * @brief The barrier for a write of the whole object, like a copy
+     *
+     * @param object - The written object, may be unowned
+     */
+    void Dirty(void* object);
+
+    /**
+     * @brief Collects the nursery, then runs a whole major cycle
+     *
+     * @param roots - The live slots
+     */
+    void Collect(const Roots& roots);
+
+    /**
+     * @brief Tells whether a pointer is an object of this collector
+     *
+     * @param object - Any pointer
+     *
+     * @return True for young and old objects
+     */
+    bool Owns(const void* object) const {
+        return _IsYoung(object) || _IsOld(object);
+    }
+
+    Phase CurrentPhase() const { return _phase; }
+    const CollectorStats& Stats() const { return _stats; }
+
+    /**
+     * @brief Writes the statistics, one per line
+     *
+     * @param out - The stream to write to
+     */
+    void Report(std::ostream& out) const;
+
+    /**
+     * @brief Sizes the nursery to the L2 cache
+     *
+     * @return Half the L2 cache, 256 KiB if it is unknown
+     */
+    static size_t DefaultNurseryBytes();
+};
+
+}  // namespace memory
+}  // namespace flecha
+
+#endif  // FLECHA_COLLECTOR_HPP
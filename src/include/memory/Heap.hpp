@@ -0,0 +1,246 @@
+#ifndef FLECHA_HEAP_HPP
+#define FLECHA_HEAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief Memory handed out by a Heap, freed by giving the block back
+ *
+ * The block remembers its size class, so freeing it needs no lookup.
+ */
+struct Block {
+    void* address = nullptr;
+    uint32_t size_class = 0;
+};
+
+/**
+ * @brief The allocator behind allot and dellot at run time
+ *
+ * Requests are rounded up to a size class. Every class has a free list of
+ * returned blocks and carves new ones from 64 KiB slabs, so blocks of one
+ * class sit next to each other. The four primitive types all fit the
+ * smallest class, user types get the nearest class to their size, and
+ * requests past the biggest class go straight to the system. Slabs are
+ * only returned to the system when the heap is destroyed.
+ *
+ * The heap locks a class for every call: threads allocate through their
+ * own HeapCache, which takes and returns blocks in batches.
+ */
+class Heap {
+   public:
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t MAX_SMALL = 4096;
+    static constexpr uint32_t CLASSES = 29;
+    // The class of requests bigger than MAX_SMALL
+    static constexpr uint32_t LARGE = CLASSES;
+
+   private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(64) Class {
+        std::mutex lock;
+        FreeBlock* free = nullptr;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    Class _classes[CLASSES];
+    std::mutex _slabs_lock;
+    Slab* _slabs;
+
+    char* _NewSlab();
+
+    friend class HeapCache;
+
+   public:
+    Heap();
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    /**
+     * @brief Returns every slab to the system, blocks still in use die
+     * with them
+     */
+    ~Heap();
+
+    /**
+     * @brief Gets the size class of a request
+     *
+     * Classes are 8 bytes, then steps of 16 up to 128, then four steps
+     * per power of two up to MAX_SMALL, so blocks waste under a fifth.
+     *
+     * @param size - The number of bytes
+     *
+     * @return The class, LARGE past MAX_SMALL
+     */
+    static uint32_t ClassOf(size_t size) {
+        if (size <= 8) return 0;
+        if (size <= 128) return static_cast<uint32_t>((size + 15) >> 4);
+        if (size > MAX_SMALL) return LARGE;
+
+        size_t last = size - 1;
+        int bit = 63 - __builtin_clzll(last);
+        return static_cast<uint32_t>(9 + (bit - 7) * 4 +
+                                     ((last >> (bit - 2)) - 4));
+    }
+
+    /**
+     * @brief Gets the block size of a class
+     *
+     * @param size_class - A class below LARGE
+     *
+     * @return The bytes every block of the class has
+     */
+    static size_t ClassSize(uint32_t size_class);
+
+    /**
+     * @brief Takes blocks of a class, from its free list or a slab
+     *
+     * @param size_class - A class below LARGE
+     * @param count - How many blocks to take
+     *
+     * @return The first block of a null terminated list linked through
+     * their first bytes
+     */
+    void* Take(uint32_t size_class, size_t count);
+
+    /**
+     * @brief Gives blocks of a class back
+     *
+     * @param size_class - A class below LARGE
+     * @param first - The first block of a list linked through their first
+     * bytes
+     * @param last - The last block of the list
+     */
+    void Give(uint32_t size_class, void* first, void* last);
+
+    /**
+     * @brief Allocates one block, locking its class
+     *
+     * @param size - The number of bytes
+     *
+     * @return The block, never null
+     */
+    Block Allocate(size_t size);
+
+    /**
+     * @brief Frees one block, locking its class
+     *
+     * @param block - A block from this heap
+     */
+    void Free(Block block);
+
+    /**
+     * @brief The process-wide heap behind MemoryNodes
+     *
+     * @return The heap, it is never destroyed
+     */
+    static Heap& Global();
+};
+
+/**
+ * @brief A single-threaded cache of free blocks in front of a heap
+ *
+ * Allocating and freeing only touch the cache's own lists. An empty list
+ * takes a batch from the heap, a list past twice a batch gives one batch
+ * back, and the destructor gives back everything. Blocks freed through a
+ * cache may come from any cache of the same heap.
+ */
+class HeapCache {
+   private:
+    struct List {
+        void* first = nullptr;
+        uint32_t count = 0;
+        uint32_t batch = 0;
+    };
+
+    Heap& _heap;
+    List _lists[Heap::CLASSES];
+
+    void* _Refill(uint32_t size_class);
+    void _Flush(uint32_t size_class, uint32_t keep);
+
+   public:
+    /**
+     * @brief The HeapCache constructor
+     *
+     * @param heap - The heap the blocks come from
+     */
+    explicit HeapCache(Heap& heap);
+
+    HeapCache(const HeapCache&) = delete;
+    HeapCache& operator=(const HeapCache&) = delete;
+
+    /**
+     * @brief Gives every cached block back to the heap
+     */
+    ~HeapCache();
+
+    /**
+     * @brief Allocates a block
+     *
+     * @param size - The number of bytes
+     *
+     * @return The block, never null
+     */
+    Block Allocate(size_t size) {
+        uint32_t size_class = Heap::ClassOf(size);
+        if (size_class == Heap::LARGE) return _heap.Allocate(size);
+
+        List& list = _lists[size_class];
+        void* address = list.first;
+        if (!address) address = _Refill(size_class);
+
+        list.first = *static_cast<void**>(address);
+        list.count--;
+        return Block{address, size_class};
+    }
+
+    /**
+     * @brief Frees a block in O(1)
+     *
+     * @param block - A block from the cache's heap
+     */
+    void Free(Block block) {
+        if (!block.address) return;
+        if (block.size_class == Heap::LARGE) return _heap.Free(block);
+
+        List& list = _lists[block.size_class];
+        *static_cast<void**>(block.address) = list.first;
+        list.first = block.address;
+        if (++list.count > 2 * list.batch) _Flush(block.size_class, list.batch);
+    }
+
+    /**
+     * @brief Gets how many blocks of a class move between a cache and its
+     * heap at a time
+     *
+     * @param size_class - A class below LARGE
+     *
+     * @return The batch size, about 8 KiB worth of blocks
+     */
+    static uint32_t BatchOf(uint32_t size_class);
+
+    /**
+     * @brief The calling thread's cache of the global heap
+     *
+     * @return The cache, flushed when the thread exits
+     */
+    static HeapCache& Local();
+};
+
+}  // namespace memory
+}  // namespace flecha
+
+#endif  // FLECHA_HEAP_HPP
@@ -0,0 +1,139 @@
+#ifndef FLECHA_MEM_STATS_HPP
+#define FLECHA_MEM_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+
+#include "Heap.hpp"
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief Where in the source an allot happened, line 0 when unknown
+ */
+struct AllotSite {
+    int line = 0;
+    int column = 0;
+
+    bool operator<(const AllotSite& other) const {
+        return line != other.line ? line < other.line : column < other.column;
+    }
+};
+
+/**
+ * @brief Counters for the allots and dellots of one site
+ */
+struct SiteStats {
+    size_t allots = 0;
+    size_t bytes = 0;
+    // Allotted and not dellotted yet
+    size_t live_allots = 0;
+    size_t live_bytes = 0;
+};
+
+/**
+ * @brief Counts what running programs allot and dellot
+ *
+ * MemoryNodes only record into the global instance when the build defines
+ * FLECHA_MEM_STATS, which CMake does for every profile but Release, so
+ * release builds pay nothing. Totals are atomic, sites share one lock.
+ */
+class MemStats {
+   private:
+    std::atomic<size_t> _live_bytes;
+    std::atomic<size_t> _peak_bytes;
+    std::atomic<size_t> _allots;
+    std::atomic<size_t> _dellots;
+    std::atomic<size_t> _class_allots[Heap::CLASSES + 1];
+
+    mutable std::mutex _sites_lock;
+    std::map<AllotSite, SiteStats> _sites;
+
+   public:
+    MemStats();
+    MemStats(const MemStats&) = delete;
+    MemStats& operator=(const MemStats&) = delete;
+
+    /**
+     * @brief Records an allot
+     *
+     * @param size - The requested bytes
+     * @param size_class - The class of the block, Heap::LARGE included
+     * @param site - Where the allot is in the source
+     */
+    void RecordAllot(size_t size, uint32_t size_class, AllotSite site);
+
+    /**
+     * @brief Records a dellot of an earlier allot
+     *
+     * @param size - The bytes the allot requested
+     * @param site - Where the allot was in the source
+     */
+    void RecordDellot(size_t size, AllotSite site);
+
+    size_t LiveBytes() const { return _live_bytes.load(); }
+    size_t PeakBytes() const { return _peak_bytes.load(); }
+    size_t Allots() const { return _allots.load(); }
+    size_t Dellots() const { return _dellots.load(); }
+
+    /**
+     * @brief Counts the allots of a size class
+     *
+     * @param size_class - A class, Heap::LARGE included
+     *
+     * @return How many blocks of the class were allotted
+     */
+    size_t ClassAllots(uint32_t size_class) const {
+        return _class_allots[size_class].load();
+    }
+
+    /**
+     * @brief Copies the per site counters
+     *
+     * @return The counters by site, in source order
+     */
+    std::map<AllotSite, SiteStats> Sites() const;
+
+    /**
+     * @brief Prints the totals, the size classes and sites used and the
+     * allots still outstanding
+     *
+     * @param out - The stream to print to
+     */
+    void Report(std::ostream& out) const;
+
+    /**
+     * @brief Forgets everything recorded
+     */
+    void Reset();
+
+    /**
+     * @brief The statistics MemoryNodes record into
+     *
+     * @return The instance, it is never destroyed
+     */
+    static MemStats& Global();
+
+    /**
+     * @brief Tells whether MemoryNodes record statistics in this build
+     *
+     * @return Whether FLECHA_MEM_STATS was defined
+     */
+    static constexpr bool Enabled() {
+#ifdef FLECHA_MEM_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+}  // namespace memory
+}  // namespace flecha
+
+#endif  // FLECHA_MEM_STATS_HPP
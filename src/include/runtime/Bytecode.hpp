@@ -0,0 +1,184 @@
+#ifndef FLECHA_BYTECODE_HPP
+#define FLECHA_BYTECODE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/LineIndex.hpp"
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace runtime {
+
+class NativeCode;
+
+// Every opcode, in dispatch table order, X(name) per entry
+#define FLECHA_OPCODES(X)                                                  \
+    X(Halt)                                                                \
+    X(LoadConst)                                                           \
+    X(Move)                                                                \
+    X(AddInt) X(SubInt) X(MulInt) X(DivInt) X(ModInt) X(PowInt) X(NegInt)  \
+    X(AddFloat) X(SubFloat) X(MulFloat) X(DivFloat) X(ModFloat)            \
+    X(PowFloat) X(NegFloat)                                                \
+    X(IntToFloat)                                                          \
+    X(EqInt) X(NeInt) X(LtInt) X(LeInt) X(GtInt) X(GeInt)                  \
+    X(EqFloat) X(NeFloat) X(LtFloat) X(LeFloat) X(GtFloat) X(GeFloat)      \
+    X(And) X(Or) X(Xor) X(Not)                                             \
+    X(Allot) X(Dellot) X(Store) X(Load) X(AddressOf)                       \
+    X(Length) X(Find) X(Compare) X(Copy) X(Fill)                           \
+    X(SumInt) X(MinInt) X(MaxInt) X(SumFloat) X(MinFloat) X(MaxFloat)      \
+    X(Spawn) X(MakeChannel) X(Send) X(Receive) X(AtomicAdd) X(AtomicSwap)
+
+/**
+ * @brief The operations of the register machine
+ *
+ * Operands name registers unless noted:
+ *   LoadConst a, k     a = constants[b | c << 16]
+ *   Move a, b          a = b
+ *   AddInt a, b, c     a = b + c, likewise for the other binary operators
+ *   NegInt a, b        a = -b, likewise NegFloat, IntToFloat and Not
+ *   Allot a, n, p      a = a new block of n bytes, of pointers if p
+ *   Dellot a, n        frees the n byte block in a, a = null
+ *   Store a, b, p      *a = b, the -> operator, b is a pointer if p
+ *   Load a, b          a = *b
+ *   AddressOf a, b     a = the address of register b, the ? operator
+ *   Length a, b        a = the bytes before the first zero byte at b
+ *   Find a, b, c       a = the index of byte c among the first a bytes at
+ *                      b, -1 if none
+ *   Compare a, b, c    a = -1, 0 or 1 as the first a bytes at b sort
+ *                      before, like or after those at c
+ *   Copy a, b, c       copies c bytes from b to a
+ *   Fill a, b, c       sets the c words from a on to b
+ *   SumInt a, b, c     a = the sum of the c ints from b on, likewise MinInt,
+ *                      MaxInt and the Float versions
+ *   Spawn e            starts a task at instruction e = b | c << 16, on a
+ *                      copy of the registers
+ *   MakeChannel a, b   a = a new channel holding up to b values
+ *   Send a, b          sends b on the channel in a
+ *   Receive a, b       a = the oldest value of the channel in b
+ *   AtomicAdd a, b, c  a = *b, then *b += c in one atomic step
+ *   AtomicSwap a, b, c a = *b, then *b = c in one atomic step
+ *
+ * Length up to MaxFloat are the standard library's intrinsics: each runs
+ * its kernel from stdlib::Active() directly, without a call. Counts are
+ * registers and must not be negative. Spawn and what follows need a
+ * Scheduler to run more than one task, a task ends at its Halt. A full
+ * Send or an empty Receive parks the task until another one gets it going
+ * again. The compiler has no syntax for any of them yet, so only hand
+ * assembled chunks use them.
+ */
+enum class Op : uint16_t {
+#define FLECHA_OPCODE_ENUM(name) name,
+    FLECHA_OPCODES(FLECHA_OPCODE_ENUM)
+#undef FLECHA_OPCODE_ENUM
+    Count
+};
+
+/**
+ * @brief Gets the name of an opcode
+ *
+ * @param op - The opcode
+ *
+ * @return The name, as in the enum
+ */
+std::string_view OpName(Op op);
+
+/**
+ * @brief One fixed size instruction, an opcode and three operands
+ */
+struct Instruction {
+    Op op;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+};
+
+static_assert(sizeof(Instruction) == 8, "Instructions are one word");
+
+/**
+ * @brief A register or constant, its kind is known at compile time
+ */
+union Value {
+    int64_t i;
+    double f;
+    void* p;
+};
+
+static_assert(sizeof(Value) == 8, "Values are one word");
+
+/**
+ * @brief The static kinds of values the compiler tracks
+ */
+enum class ValueKind : uint8_t {
+    Int,
+    Float,
+    Bool,
+    Char,
+    String,
+    Pointer,
+    // A user defined type, opaque until classes are compiled
+    Object
+};
+
+/**
+ * @brief A top-level variable and the register holding it
+ */
+struct Global {
+    string name;
+    uint16_t reg;
+    ValueKind kind;
+    // What a pointer points to
+    ValueKind pointee;
+    // The register holding the pointee of a promoted allot, -1 otherwise
+    int32_t slot = -1;
+};
+
+/**
+ * @brief A compiled program
+ *
+ * The first registers hold the variables, and the pointees of promoted
+ * allots, in declaration order; the rest are temporaries. Every instruction has its source location, for
+ * run time errors and allot sites.
+ */
+struct Chunk {
+    vector<Instruction> code;
+    vector<core::SourceLocation> locations;
+    vector<Value> constants;
+    // Storage of string constants, which point at its characters; the
+    // constant after a string's holds its length
+    std::deque<string> strings;
+    vector<Global> globals;
+    size_t registers = 0;
+
+    // Runs under a Jit, and the machine code it made once they were enough
+    mutable size_t runs = 0;
+    mutable std::shared_ptr<const NativeCode> native;
+
+    /**
+     * @brief Finds the latest variable with a name
+     *
+     * @param name - The variable name
+     *
+     * @return The variable, nullptr if there is none
+     */
+    const Global* Find(std::string_view name) const;
+
+    /**
+     * @brief Lists the instructions, one per line
+     *
+     * @return The listing
+     */
+    string Disassemble() const;
+};
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_BYTECODE_HPP
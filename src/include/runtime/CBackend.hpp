@@ -0,0 +1,58 @@
+#ifndef FLECHA_C_BACKEND_HPP
+#define FLECHA_C_BACKEND_HPP
+
+#include <string_view>
+
+#include "Bytecode.hpp"
+
+namespace flecha {
+namespace runtime {
+
+/**
+ * @brief How Build runs the host compiler
+ */
+struct BuildOptions {
+    // A C and C++ compiler driver, empty for the one flecha was built with
+    string compiler;
+    // The flecha_rt archive, empty for the one built with flecha
+    string runtime;
+    string optimization = "-O2";
+};
+
+/**
+ * @brief Lowers a chunk to one portable C translation unit
+ *
+ * The chunk is the program's typed form: every register becomes a local
+ * union and every instruction the statement the VM would run for it, so
+ * the host compiler sees through the unions and keeps values in machine
+ * registers. Runtime errors print what the flecha CLI prints and exit
+ * with 1. Allot and dellot call the heap through memory/CApi.hpp, and
+ * #line directives point debuggers at the flecha source.
+ *
+ * @param chunk - A chunk from Compile
+ * @param path - The source file, for errors and #line
+ *
+ * @return The C source, throws on instructions without a lowering
+ */
+string EmitC(const Chunk& chunk, std::string_view path);
+
+/**
+ * @brief Compiles a chunk to a native executable
+ *
+ * Writes the C of EmitC to a fresh temporary directory, builds it with
+ * the host compiler against flecha_rt, then removes the directory. If
+ * the compiler fails, the C is kept and the error names its path. An
+ * output ending in .c only gets the C.
+ *
+ * @param chunk - A chunk from Compile
+ * @param path - The source file
+ * @param output - The executable to write
+ * @param options - How to run the compiler
+ */
+void Build(const Chunk& chunk, std::string_view path, const string& output,
+           const BuildOptions& options = {});
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_C_BACKEND_HPP
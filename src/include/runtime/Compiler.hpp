@@ -0,0 +1,44 @@
+#ifndef FLECHA_COMPILER_HPP
+#define FLECHA_COMPILER_HPP
+
+#include "Bytecode.hpp"
+#include "core/AST.hpp"
+
+namespace flecha {
+namespace runtime {
+
+/**
+ * @brief Switches for the optional parts of compilation
+ */
+struct CompileOptions {
+    // Keep allots that never escape out of the heap, see EscapeAnalysis
+    bool promote_allots = true;
+};
+
+/**
+ * @brief Compiles a parsed program to register bytecode
+ *
+ * Every top-level variable gets a register of its own and expressions
+ * write straight into the register of the variable they initialize, using
+ * temporaries only for inner results. Kinds are checked statically, so the
+ * emitted operations are typed and the VM never looks at a kind. Literals
+ * take the declared type when the parser gave them one, others the kind
+ * their token was decoded as. A declared variable has its declared kind:
+ * integral values widen to floats, other mismatches are errors.
+ * Primitive pointees take one 8 byte value, user defined types one too
+ * until their layout is known. Allots proven not to escape get a register
+ * for their pointee instead of a heap block: the pointer is that
+ * register's address, -> through it is a Move into the register, and
+ * dellot is a no-op.
+ *
+ * @param program - The program, without parse errors
+ * @param options - What to optimize
+ *
+ * @return The chunk, throws on undefined variables and kind errors
+ */
+Chunk Compile(core::ProgramNode* program, CompileOptions options = {});
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_COMPILER_HPP
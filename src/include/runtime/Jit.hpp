@@ -0,0 +1,192 @@
+#ifndef FLECHA_JIT_HPP
+#define FLECHA_JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "Bytecode.hpp"
+
+namespace flecha {
+namespace runtime {
+
+class VM;
+
+/**
+ * @brief A chunk compiled to machine code, one template per instruction
+ *
+ * The code works on the VM's registers in memory, so the interpreter can
+ * take over at any instruction. Instructions without a template call back
+ * into the interpreter for one step. Guards on the values, a zero or -1
+ * divisor or a null pointer, stop the code before their instruction so
+ * the interpreter runs it and the rest of the run.
+ */
+class NativeCode {
+   private:
+    char* _memory;
+    // The mapping, whole pages, and the machine code at its start
+    size_t _size;
+    size_t _code_size;
+    // Where every instruction's code begins, from _memory, and the end
+    vector<uint32_t> _entries;
+    size_t _stepped;
+
+    NativeCode(char* memory, size_t size, size_t code_size,
+               vector<uint32_t> entries, size_t stepped)
+        : _memory(memory),
+          _size(size),
+          _code_size(code_size),
+          _entries(std::move(entries)),
+          _stepped(stepped) {}
+
+    friend class Jit;
+
+   public:
+    NativeCode(const NativeCode&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+
+    /**
+     * @brief Unmaps the code
+     */
+    ~NativeCode();
+
+    /**
+     * @brief Runs from an instruction until a Halt, a guard or a stop
+     *
+     * @param registers - The VM's registers
+     * @param constants - The chunk's constants
+     * @param vm - The VM, for the interpreter steps
+     * @param start - The first instruction
+     *
+     * @return The instruction it stopped at
+     */
+    size_t Run(Value* registers, const Value* constants, VM* vm,
+               size_t start) const;
+
+    /**
+     * @brief Gets the bytes of machine code
+     *
+     * @return The code size, without the rest of its last page
+     */
+    size_t Size() const { return _code_size; }
+
+    /**
+     * @brief Gets how many instructions step the interpreter
+     *
+     * @return The instructions without a template
+     */
+    size_t Stepped() const { return _stepped; }
+};
+
+/**
+ * @brief Tuning of a Jit
+ */
+struct JitOptions {
+    // Runs of a chunk through the interpreter before it is compiled
+    size_t threshold = 2;
+};
+
+/**
+ * @brief What a Jit has done so far
+ */
+struct JitStats {
+    size_t chunks_compiled = 0;
+    size_t instructions_compiled = 0;
+    // Compiled instructions that step the interpreter instead
+    size_t instructions_stepped = 0;
+    size_t code_bytes = 0;
+    uint64_t compile_ns = 0;
+
+    size_t interpreted_runs = 0;
+    size_t interpreted_instructions = 0;
+    uint64_t interpreted_ns = 0;
+    size_t native_runs = 0;
+    size_t native_instructions = 0;
+    uint64_t native_ns = 0;
+    // Native runs a guard handed to the interpreter
+    size_t deopts = 0;
+};
+
+/**
+ * @brief The tier above the interpreter: compiles chunks once they are hot
+ *
+ * Every run of a chunk by a VM with a Jit counts, and the run after the
+ * threshold compiles it to x86-64 machine code, kept with the chunk. The
+ * registers' kinds are fixed at compile time, so no guard checks them;
+ * guards only check the values an instruction cannot handle natively.
+ * On other machines nothing is compiled and the interpreter runs it all.
+ *
+ * A chunk must not change once it ran under a Jit. The Jit is single
+ * threaded, like the VMs using it.
+ */
+class Jit {
+   private:
+    JitOptions _options;
+    JitStats _stats;
+
+   public:
+    /**
+     * @brief The Jit constructor
+     *
+     * @param options - The tuning
+     */
+    explicit Jit(JitOptions options = {}) : _options(options) {}
+
+    /**
+     * @brief Counts a run of a chunk and compiles it once hot
+     *
+     * @param chunk - The chunk about to run
+     *
+     * @return Its code, null while it is interpreted
+     */
+    const NativeCode* Prepare(const Chunk& chunk);
+
+    /**
+     * @brief Compiles a chunk to machine code
+     *
+     * @param chunk - The chunk
+     *
+     * @return The code, null if this machine has no JIT
+     */
+    static std::unique_ptr<NativeCode> Compile(const Chunk& chunk);
+
+    /**
+     * @brief Tells whether Compile supports this machine
+     *
+     * @return True on x86-64
+     */
+    static bool Supported();
+
+    /**
+     * @brief Records the time of one run, for the speedup
+     *
+     * @param native - Whether it began in machine code
+     * @param instructions - The chunk's instruction count
+     * @param ns - The run's time
+     */
+    void RecordRun(bool native, size_t instructions, uint64_t ns);
+
+    void RecordDeopt() { _stats.deopts++; }
+    const JitStats& Stats() const { return _stats; }
+
+    /**
+     * @brief Gets how much faster an instruction runs natively
+     *
+     * @return The ratio of the tiers' times per instruction, 0 until both
+     * ran
+     */
+    double Speedup() const;
+
+    /**
+     * @brief Writes the statistics, one per line
+     *
+     * @param out - The stream to write to
+     */
+    void Report(std::ostream& out) const;
+};
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_JIT_HPP
@@ -0,0 +1,99 @@
+#ifndef FLECHA_SCHEDULER_HPP
+#define FLECHA_SCHEDULER_HPP
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "VM.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace flecha {
+namespace runtime {
+
+/**
+ * @brief Runs the tasks of a chunk on a work-stealing pool of threads
+ *
+ * The chunk starts as the main task and every Spawn adds a task with a
+ * VM of its own, so any number of tasks share the pool's workers. Tasks
+ * spawned by a task queue on its worker and are stolen by idle ones. A
+ * task blocked on a channel does not hold its worker: it parks on the
+ * channel and is queued again once woken.
+ *
+ * Allots come from the heap cache of the worker running the task, so
+ * allocating never takes a shared lock, and a block may be dellotted by
+ * another task than its allotter. Tasks get no collector, which is single
+ * threaded.
+ */
+class Scheduler {
+   private:
+    struct Task;
+
+    // Every task of the run, kept until the next run for their channels
+    vector<std::unique_ptr<Task>> _tasks;
+    std::mutex _lock;
+    const Chunk* _chunk;
+    // Tasks not halted yet, parked ones included
+    std::atomic<size_t> _live;
+    std::exception_ptr _error;
+
+    utils::ThreadPool _pool;
+
+    void _Queue(Task* task);
+    void _Resume(Task* task);
+    static void _Wake(stdlib::Waiter* waiter);
+
+   public:
+    /**
+     * @brief Starts the workers
+     *
+     * @param threads - The worker count, 0 for one per hardware thread
+     */
+    explicit Scheduler(size_t threads = 0);
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    ~Scheduler();
+
+    /**
+     * @brief Runs a chunk and the tasks it spawns until every one halted
+     *
+     * Throws the first run time error of any task, or an error if tasks
+     * are left waiting on channels no running task can get going.
+     *
+     * @param chunk - The chunk, it must outlive the registers' use
+     */
+    void Run(const Chunk& chunk);
+
+    /**
+     * @brief Adds a task to the running chunk, for Spawn
+     *
+     * @param entry - The task's first instruction
+     * @param registers - The spawner's registers, copied
+     */
+    void Spawn(size_t entry, const Value* registers);
+
+    /**
+     * @brief Gets the value of a variable of the main task after a run
+     *
+     * @param chunk - The chunk that ran
+     * @param name - The variable name
+     *
+     * @return The value, throws if there is no such variable
+     */
+    Value Get(const Chunk& chunk, std::string_view name) const;
+
+    /**
+     * @brief Gets the number of workers
+     *
+     * @return The worker count
+     */
+    size_t Size() const { return _pool.Size(); }
+};
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_SCHEDULER_HPP
@@ -0,0 +1,152 @@
+#ifndef FLECHA_VM_HPP
+#define FLECHA_VM_HPP
+
+#include <exception>
+#include <memory>
+
+#include "Bytecode.hpp"
+#include "memory/Collector.hpp"
+#include "std/Channel.hpp"
+
+namespace flecha {
+namespace runtime {
+
+class Jit;
+class NativeCode;
+class Scheduler;
+
+/**
+ * @brief Runs compiled chunks on a register file
+ *
+ * Instructions are dispatched with computed gotos where the compiler has
+ * them, so every handler ends in its own indirect jump, and with a switch
+ * elsewhere. Allots come from the calling thread's heap cache and are
+ * recorded in the memory statistics when those are compiled in. The
+ * intrinsics run the standard library kernels for the widest instruction
+ * set the CPU has, chosen once per process.
+ *
+ * With a collector, allots come from it instead and dellot is only a hint.
+ * Pointer variables are its roots: allots begin their statement, so no
+ * temporary is live across one.
+ *
+ * Under a Scheduler the VM runs one task: a Send or Receive that cannot go
+ * on stops it, and Resume carries on from that instruction once the
+ * channel is ready. The channels a VM makes live as long as the VM.
+ *
+ * With a Jit, chunks that ran often enough run as machine code, which
+ * steps the interpreter for the instructions it has no template for and
+ * hands the rest of a run to it when a guard fails.
+ */
+class VM {
+   public:
+    enum class Status : uint8_t { Halted, Blocked };
+
+   private:
+    vector<Value> _registers;
+    memory::Collector* _collector;
+    vector<uint16_t> _roots;
+
+    Scheduler* _scheduler;
+    vector<std::unique_ptr<stdlib::Channel>> _channels;
+    // Where Resume carries on, and the channel that stopped the task
+    size_t _ip;
+    stdlib::Channel* _blocked_on;
+    bool _blocked_sending;
+
+    Jit* _jit;
+    // The code of this run, null once the interpreter took over
+    const NativeCode* _native;
+    // The chunk and an error of the interpreter steps of native code
+    const Chunk* _running;
+    std::exception_ptr _error;
+
+    template <bool SINGLE>
+    Status _Execute(const Chunk& chunk);
+    static int _JitStep(VM* vm, uint32_t index);
+
+    friend class Jit;
+
+   public:
+    /**
+     * @brief The VM constructor
+     *
+     * @param collector - Where allots come from, the heap if null; it must
+     * outlive the registers' use
+     * @param scheduler - Where Spawn starts tasks, Spawn fails and channels
+     * never wait if null; a scheduled VM takes no collector
+     * @param jit - What compiles hot chunks, only the interpreter runs if
+     * null
+     */
+    explicit VM(memory::Collector* collector = nullptr,
+                Scheduler* scheduler = nullptr, Jit* jit = nullptr)
+        : _collector(collector),
+          _scheduler(scheduler),
+          _ip(0),
+          _blocked_on(nullptr),
+          _blocked_sending(false),
+          _jit(jit),
+          _native(nullptr),
+          _running(nullptr) {}
+
+    /**
+     * @brief Runs a chunk until it halts
+     *
+     * @param chunk - The chunk, it must outlive the registers' use
+     */
+    void Run(const Chunk& chunk);
+
+    /**
+     * @brief Sets up a run from an instruction, without running
+     *
+     * @param chunk - The chunk
+     * @param entry - The first instruction
+     * @param registers - chunk.registers values to start with, zeros if
+     * null
+     */
+    void Start(const Chunk& chunk, size_t entry, const Value* registers);
+
+    /**
+     * @brief Runs the chunk set up by Start until it halts or blocks
+     *
+     * @param chunk - The chunk given to Start
+     *
+     * @return Blocked if a channel stopped it, see BlockedOn
+     */
+    Status Resume(const Chunk& chunk);
+
+    /**
+     * @brief Gets the channel that stopped the last Resume
+     *
+     * @return The channel, null if it halted
+     */
+    stdlib::Channel* BlockedOn() const { return _blocked_on; }
+
+    /**
+     * @brief Tells whether the last Resume stopped at a Send
+     *
+     * @return True for a Send, false for a Receive
+     */
+    bool BlockedSending() const { return _blocked_sending; }
+
+    /**
+     * @brief Gets the registers left by the last run
+     *
+     * @return The registers, variables first
+     */
+    const vector<Value>& Registers() const { return _registers; }
+
+    /**
+     * @brief Gets the value of a variable after a run
+     *
+     * @param chunk - The chunk that ran
+     * @param name - The variable name
+     *
+     * @return The value, throws if the chunk has no such variable
+     */
+    Value Get(const Chunk& chunk, std::string_view name) const;
+};
+
+}  // namespace runtime
+}  // namespace flecha
+
+#endif  // FLECHA_VM_HPP
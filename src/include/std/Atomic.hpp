@@ -0,0 +1,42 @@
+#ifndef FLECHA_ATOMIC_HPP
+#define FLECHA_ATOMIC_HPP
+
+#include <cstdint>
+
+namespace flecha {
+namespace stdlib {
+
+/*
+ * Atomic read-modify-writes of ints in allot blocks, shared between tasks.
+ * They are sequentially consistent, like the defaults of std::atomic, and
+ * take a plain word since blocks are not std::atomic objects.
+ */
+
+/**
+ * @brief Adds to a word atomically, wrapping
+ *
+ * @param word - An 8 byte aligned word
+ * @param value - What to add
+ *
+ * @return The word before the add
+ */
+inline int64_t AtomicAdd(int64_t* word, int64_t value) {
+    return __atomic_fetch_add(word, value, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Replaces a word atomically
+ *
+ * @param word - An 8 byte aligned word
+ * @param value - The new value
+ *
+ * @return The word before the swap
+ */
+inline int64_t AtomicSwap(int64_t* word, int64_t value) {
+    return __atomic_exchange_n(word, value, __ATOMIC_SEQ_CST);
+}
+
+}  // namespace stdlib
+}  // namespace flecha
+
+#endif  // FLECHA_ATOMIC_HPP
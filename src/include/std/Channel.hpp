@@ -0,0 +1,103 @@
+#ifndef FLECHA_CHANNEL_HPP
+#define FLECHA_CHANNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace stdlib {
+
+/**
+ * @brief Something parked on a channel until it may go on
+ *
+ * A waiter is woken at most once per park, and may find the channel
+ * taken again by then, so woken waiters retry and park again.
+ */
+struct Waiter {
+    void (*wake)(Waiter* waiter) = nullptr;
+    Waiter* next = nullptr;
+};
+
+/**
+ * @brief A bounded first in, first out queue of words between tasks
+ *
+ * Values are 8 byte words, as registers hold them. Sending and receiving
+ * never block: a task that cannot go on parks a waiter instead and leaves
+ * its thread to other tasks. Parking checks again under the channel's
+ * lock, so a value sent in between is never missed, and the waiter is
+ * woken outside the lock. Every method is thread safe.
+ */
+class Channel {
+   private:
+    struct WaitList {
+        Waiter* first = nullptr;
+        Waiter* last = nullptr;
+
+        void Push(Waiter* waiter);
+        Waiter* Pop();
+    };
+
+    std::mutex _lock;
+    // A ring of the values sent and not received yet
+    vector<int64_t> _values;
+    size_t _head;
+    size_t _size;
+    WaitList _senders;
+    WaitList _receivers;
+
+   public:
+    /**
+     * @brief The Channel constructor
+     *
+     * @param capacity - The most values it holds, at least 1
+     */
+    explicit Channel(size_t capacity);
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    /**
+     * @brief Sends a value if there is room, waking a receiver
+     *
+     * @param value - The value
+     *
+     * @return True if it was sent, false if the channel is full
+     */
+    bool TrySend(int64_t value);
+
+    /**
+     * @brief Receives the oldest value if there is one, waking a sender
+     *
+     * @param value - Receives the value
+     *
+     * @return True if one was received, false if the channel is empty
+     */
+    bool TryReceive(int64_t& value);
+
+    /**
+     * @brief Parks a waiter until a Try call of its kind may succeed
+     *
+     * @param waiter - The waiter, it must stay alive until woken
+     * @param sending - Whether it waits to send rather than to receive
+     *
+     * @return False without parking if the call would succeed already
+     */
+    bool Park(Waiter* waiter, bool sending);
+
+    /**
+     * @brief Gets how many values it holds at most
+     *
+     * @return The capacity
+     */
+    size_t Capacity() const { return _values.size(); }
+};
+
+}  // namespace stdlib
+}  // namespace flecha
+
+#endif  // FLECHA_CHANNEL_HPP
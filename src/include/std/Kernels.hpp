@@ -0,0 +1,100 @@
+#ifndef FLECHA_KERNELS_HPP
+#define FLECHA_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flecha {
+namespace stdlib {
+
+/**
+ * @brief The instruction sets the kernels have versions for
+ */
+enum class Isa : uint8_t {
+    Scalar,
+    // SSE4.2 is the first x86 level with 64-bit compares, for min and max
+    Sse42,
+    Avx2,
+    // AVX-512F with BW, for the byte kernels
+    Avx512,
+    Neon
+};
+
+/**
+ * @brief Gets the name of an instruction set
+ *
+ * @param isa - The instruction set
+ *
+ * @return A string literal, lower case like "avx2"
+ */
+const char* IsaName(Isa isa);
+
+/**
+ * @brief Tells whether this build and CPU can run an instruction set
+ *
+ * @param isa - The instruction set
+ *
+ * @return True if its kernels are compiled in and the CPU has it
+ */
+bool Supports(Isa isa);
+
+/**
+ * @brief Picks the widest instruction set Supports allows
+ *
+ * @return The instruction set
+ */
+Isa BestIsa();
+
+/**
+ * @brief The string and buffer primitives of the standard library
+ *
+ * Strings are bytes, buffers are runs of 8 byte ints or floats, as allot
+ * blocks hold them. Every instruction set has a table computing the same
+ * results: ints wrap, float sums add lane k of sixteen from every element
+ * whose index is k modulo 16 and then combine the lanes in a fixed order,
+ * so they are the same on every table though not a sequential sum. The
+ * float min and max skip NaNs, and may give either zero for -0 and +0.
+ */
+struct Kernels {
+    Isa isa;
+
+    // The bytes before the first zero byte
+    size_t (*length)(const char* bytes);
+    // The index of the first byte equal to byte, count if there is none
+    size_t (*find)(const char* bytes, size_t count, char byte);
+    // The index of the first byte that differs, count if none does
+    size_t (*compare)(const char* a, const char* b, size_t count);
+    // Copies count bytes, the ranges may overlap
+    void (*copy)(char* to, const char* from, size_t count);
+    // Sets count words, a float fills through its bits
+    void (*fill)(int64_t* to, int64_t value, size_t count);
+
+    // Sums are 0, mins and maxes the far end of the range, for no values
+    int64_t (*sum_int)(const int64_t* values, size_t count);
+    int64_t (*min_int)(const int64_t* values, size_t count);
+    int64_t (*max_int)(const int64_t* values, size_t count);
+    double (*sum_float)(const double* values, size_t count);
+    double (*min_float)(const double* values, size_t count);
+    double (*max_float)(const double* values, size_t count);
+};
+
+/**
+ * @brief Gets the kernels of an instruction set
+ *
+ * @param isa - The instruction set, throws if Supports rejects it
+ *
+ * @return The table, it lives as long as the program
+ */
+const Kernels& KernelsFor(Isa isa);
+
+/**
+ * @brief Gets the kernels of BestIsa, chosen on the first call
+ *
+ * @return The table, it lives as long as the program
+ */
+const Kernels& Active();
+
+}  // namespace stdlib
+}  // namespace flecha
+
+#endif  // FLECHA_KERNELS_HPP
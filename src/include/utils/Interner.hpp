@@ -0,0 +1,212 @@
+#ifndef FLECHA_INTERNER_HPP
+#define FLECHA_INTERNER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief An interned name, equal symbols name equal strings
+ *
+ * The default symbol is no name at all.
+ */
+struct Symbol {
+    uint32_t id = 0;
+
+    constexpr Symbol() = default;
+    constexpr explicit Symbol(uint32_t id) : id(id) {}
+
+    constexpr explicit operator bool() const { return id != 0; }
+    constexpr bool operator==(Symbol other) const { return id == other.id; }
+    constexpr bool operator!=(Symbol other) const { return id != other.id; }
+    constexpr bool operator<(Symbol other) const { return id < other.id; }
+};
+
+/**
+ * @brief Maps names to 32-bit symbols, storing every distinct name once
+ *
+ * Names are split over shards by hash, each with its own lock and open
+ * addressed table, so threads parsing different files rarely wait on each
+ * other. A symbol encodes its shard, so resolving one only locks that
+ * shard. Stored names never move: views returned by Name and Intern stay
+ * valid for the interner's lifetime.
+ */
+class Interner {
+   public:
+    static constexpr size_t SHARDS = 16;
+    // Interned first by every interner, so each has the same symbol in
+    // all of them and can be compared without a lookup
+    static constexpr std::string_view PRESETS[] = {"int", "float", "bool",
+                                                   "char", "string"};
+    static constexpr size_t PRESET_COUNT = std::size(PRESETS);
+
+   private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex lock;
+        // Open addressed, a power of two in size, id 0 marks empty slots
+        vector<Slot> slots;
+        // Names by their index within the shard
+        vector<std::string_view> names;
+        vector<std::unique_ptr<char[]>> chunks;
+        char* cursor = nullptr;
+        size_t left = 0;
+    };
+
+    Shard _shards[SHARDS];
+
+    static std::string_view _Store(Shard& shard, std::string_view name);
+    static void _Grow(Shard& shard);
+    static uint32_t* _Find(Shard& shard, std::string_view name, size_t hash);
+    Symbol _Intern(std::string_view name, size_t hash,
+                   std::string_view* stored);
+
+    friend class LocalInterner;
+
+   public:
+    /**
+     * @brief The Interner constructor, the presets are already interned
+     */
+    Interner();
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    /**
+     * @brief Gets the symbol of a name, adding the name if it is new
+     *
+     * @param name - The name, copied if it is new
+     * @param stored - Receives the interner's copy of the name, if given
+     *
+     * @return The symbol
+     */
+    Symbol Intern(std::string_view name, std::string_view* stored = nullptr);
+
+    /**
+     * @brief Looks a name up without adding it
+     *
+     * @param name - The name
+     *
+     * @return Its symbol, or no symbol if it was never interned
+     */
+    Symbol Find(std::string_view name);
+
+    /**
+     * @brief Resolves a symbol
+     *
+     * @param symbol - A symbol of this interner
+     *
+     * @return Its name, empty for no symbol
+     */
+    std::string_view Name(Symbol symbol);
+
+    /**
+     * @brief Counts the distinct names
+     *
+     * @return How many names were interned, not counting the presets
+     */
+    size_t Size();
+
+    /**
+     * @brief Gets the symbol of a preset name, the same in every interner
+     *
+     * @param index - The index in PRESETS
+     *
+     * @return The symbol
+     */
+    static Symbol Preset(size_t index);
+
+    /**
+     * @brief The process-wide interner, used when no other one is given
+     *
+     * @return The interner, it is never destroyed
+     */
+    static Interner& Global();
+
+    /**
+     * @brief Hashes a name the way the interner does
+     *
+     * @param name - The name
+     *
+     * @return The hash
+     */
+    static size_t Hash(std::string_view name) {
+        // FNV-1a, names are short, then a mix so the top bits pick shards
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        hash ^= hash >> 32;
+        hash *= 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(hash ^ (hash >> 29));
+    }
+};
+
+/**
+ * @brief A single-threaded front for an interner that remembers the names
+ * it resolved, so repeated names never take the interner's locks
+ *
+ * One per parse: a file locks the shared interner once per distinct name.
+ */
+class LocalInterner {
+   private:
+    struct Slot {
+        size_t hash;
+        std::string_view name;
+        Symbol symbol;
+    };
+
+    Interner& _shared;
+    // Open addressed, a power of two in size, empty slots have no symbol
+    vector<Slot> _slots;
+    size_t _count;
+
+    void _Grow();
+
+   public:
+    /**
+     * @brief The LocalInterner constructor
+     *
+     * @param shared - The interner resolving new names
+     */
+    explicit LocalInterner(Interner& shared);
+
+    /**
+     * @brief Gets the symbol of a name, as Interner::Intern does
+     *
+     * @param name - The name
+     * @param stored - Receives the shared interner's copy of the name
+     *
+     * @return The symbol
+     */
+    Symbol Intern(std::string_view name, std::string_view* stored = nullptr);
+
+    Interner& Shared() { return _shared; }
+};
+
+}  // namespace utils
+}  // namespace flecha
+
+namespace std {
+template <>
+struct hash<flecha::utils::Symbol> {
+    size_t operator()(flecha::utils::Symbol symbol) const noexcept {
+        return symbol.id;
+    }
+};
+}  // namespace std
+
+#endif  // FLECHA_INTERNER_HPP
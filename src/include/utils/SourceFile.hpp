@@ -0,0 +1,73 @@
+#ifndef FLECHA_SOURCEFILE_HPP
+#define FLECHA_SOURCEFILE_HPP
+
+#include <string>
+#include <string_view>
+
+using string = std::string;
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief Read-only source text loaded from a file or descriptor
+ *
+ * Regular files are memory-mapped so lexing never copies their bytes,
+ * anything that can't be mapped (pipes, terminals, stdin) is read into a
+ * buffer instead. Either way Text() is one contiguous view that stays
+ * valid as long as the SourceFile lives.
+ */
+class SourceFile {
+   private:
+    const char* _mapping;
+    size_t _size;
+    string _buffer;
+
+    void _Load(int fd, const string& name);
+    void _Read(int fd, const string& name);
+    void _Release();
+
+   public:
+    /**
+     * @brief Opens and loads a file
+     *
+     * @param path - The file path, "-" reads stdin
+     */
+    explicit SourceFile(const string& path);
+
+    /**
+     * @brief Loads everything readable from an open descriptor
+     *
+     * @param fd - The descriptor, left open
+     */
+    explicit SourceFile(int fd);
+
+    SourceFile(SourceFile&& other) noexcept;
+    SourceFile& operator=(SourceFile&& other) noexcept;
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    /**
+     * @brief Unmaps the file if it was mapped
+     */
+    ~SourceFile();
+
+    /**
+     * @brief Gets the source text
+     *
+     * @return A view of the whole file
+     */
+    std::string_view Text() const;
+
+    /**
+     * @brief Checks whether the text is mapped rather than buffered
+     *
+     * @return True if the file was memory-mapped
+     */
+    bool IsMapped() const { return _mapping != nullptr; }
+};
+
+}  // namespace utils
+}  // namespace flecha
+
+#endif  // FLECHA_SOURCEFILE_HPP
@@ -0,0 +1,97 @@
+#ifndef FLECHA_THREADPOOL_HPP
+#define FLECHA_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief A fixed set of worker threads sharing work by stealing
+ *
+ * Every worker owns a task deque. It runs its own tasks newest first, which
+ * keeps a task's subtasks on the thread whose caches hold its data, and
+ * when it runs dry it steals the oldest task of another worker. Tasks
+ * submitted from outside the pool are dealt round-robin.
+ *
+ * Tasks get the index of the worker running them, so callers can keep
+ * per-worker state such as arenas without locking. Tasks must not throw.
+ */
+class ThreadPool {
+   public:
+    using Task = std::function<void(size_t worker)>;
+
+   private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    vector<std::unique_ptr<Worker>> _workers;
+    vector<std::thread> _threads;
+
+    // Tasks sitting in deques, and tasks submitted but not finished
+    std::atomic<size_t> _queued{0};
+    std::atomic<size_t> _pending{0};
+    std::atomic<size_t> _next{0};
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    bool _stopping = false;
+
+    void _Run(size_t index);
+    bool _Take(size_t index, Task& task);
+
+   public:
+    /**
+     * @brief Starts the workers
+     *
+     * @param threads - The worker count, 0 for one per hardware thread
+     */
+    explicit ThreadPool(size_t threads = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Finishes the queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Queues a task, on the calling worker's own deque when called
+     * from a task
+     *
+     * @param task - The task
+     */
+    void Submit(Task task);
+
+    /**
+     * @brief Blocks until every submitted task has finished, including
+     * tasks they submitted. Must not be called from a task.
+     */
+    void Wait();
+
+    /**
+     * @brief Gets the number of workers
+     *
+     * @return The worker count
+     */
+    size_t Size() const { return _threads.size(); }
+};
+
+}  // namespace utils
+}  // namespace flecha
+
+#endif  // FLECHA_THREADPOOL_HPP
@@ -0,0 +1,236 @@
+#ifndef FLECHA_TRACE_HPP
+#define FLECHA_TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+template <typename... Args>
+using vector = std::vector<Args...>;
+using string = std::string;
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief A named count attached to an event, like tokens or bytes
+ */
+struct TraceArg {
+    const char* key;
+    uint64_t value;
+    // Also written per second of the event
+    bool rate;
+};
+
+/**
+ * @brief One timed phase, a Chrome "complete" event
+ */
+struct TraceEvent {
+    static constexpr size_t MAX_ARGS = 4;
+
+    // Names and categories are string literals
+    const char* name;
+    const char* category;
+    // Nanoseconds since the tracer started
+    uint64_t start;
+    uint64_t duration;
+    uint32_t thread;
+    // What the phase worked on, like a file path, may be empty
+    string detail;
+    TraceArg args[MAX_ARGS];
+    size_t arg_count = 0;
+};
+
+/**
+ * @brief Collects timed phases and writes them as Chrome trace events
+ *
+ * Phases are recorded with TraceScope, usually through FLECHA_TRACE_SCOPE,
+ * which compiles to nothing unless the build defines FLECHA_TRACE. In
+ * builds that do, a scope costs one relaxed load while nothing records, so
+ * the hooks stay in release builds and --trace profiles real workloads.
+ * Scopes wrap whole phases, a file's parse or a program's run, never a
+ * single token or instruction, and events share one lock.
+ *
+ * The output loads in chrome://tracing and Perfetto. Counts added with
+ * TraceScope::Rate are also written per second, tokens gives
+ * tokens_per_second.
+ */
+class Tracer {
+   private:
+    std::atomic<bool> _recording;
+
+    mutable std::mutex _lock;
+    vector<TraceEvent> _events;
+    uint64_t _epoch;
+
+   public:
+    Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Forgets earlier events and starts recording
+     */
+    void Start();
+
+    /**
+     * @brief Stops recording, keeping the events
+     */
+    void Stop();
+
+    /**
+     * @brief Tells whether scopes record right now
+     *
+     * @return True between Start and Stop
+     */
+    bool Recording() const {
+        return _recording.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets a monotonic timestamp
+     *
+     * @return Nanoseconds since the tracer started
+     */
+    uint64_t Now() const;
+
+    /**
+     * @brief Adds a finished event
+     *
+     * @param event - The event
+     */
+    void Record(TraceEvent event);
+
+    /**
+     * @brief Copies the recorded events
+     *
+     * @return The events in the order they finished
+     */
+    vector<TraceEvent> Events() const;
+
+    /**
+     * @brief Writes the events as a Chrome trace JSON object
+     *
+     * @param out - The stream to write to
+     */
+    void WriteJson(std::ostream& out) const;
+
+    /**
+     * @brief Writes the events to a file
+     *
+     * @param path - The file path
+     *
+     * @return False if the file could not be written
+     */
+    bool WriteJson(const string& path) const;
+
+    /**
+     * @brief The tracer scopes record into
+     *
+     * @return The instance, it is never destroyed
+     */
+    static Tracer& Global();
+
+    /**
+     * @brief Tells whether FLECHA_TRACE_SCOPE records in this build
+     *
+     * @return Whether FLECHA_TRACE was defined
+     */
+    static constexpr bool Enabled() {
+#ifdef FLECHA_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+/**
+ * @brief Times the enclosing block into the global tracer
+ *
+ * Nothing is read or copied unless the tracer was recording when the
+ * scope began.
+ */
+class TraceScope {
+   private:
+    TraceEvent _event;
+    bool _active;
+
+    void _Add(const char* key, uint64_t value, bool rate) {
+        if (_active && _event.arg_count < TraceEvent::MAX_ARGS) {
+            _event.args[_event.arg_count++] = TraceArg{key, value, rate};
+        }
+    }
+
+   public:
+    /**
+     * @brief Starts timing
+     *
+     * @param name - The phase, a string literal
+     * @param category - Its module, a string literal
+     */
+    TraceScope(const char* name, const char* category);
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    /**
+     * @brief Records the event if timing started
+     */
+    ~TraceScope();
+
+    /**
+     * @brief Attaches a count, beyond TraceEvent::MAX_ARGS they are dropped
+     *
+     * @param key - The count's name, a string literal
+     * @param value - The count
+     */
+    void Arg(const char* key, uint64_t value) { _Add(key, value, false); }
+
+    /**
+     * @brief Attaches a count that is also written per second
+     *
+     * @param key - The count's name, a string literal
+     * @param value - The count
+     */
+    void Rate(const char* key, uint64_t value) { _Add(key, value, true); }
+
+    /**
+     * @brief Says what the phase works on
+     *
+     * @param detail - Like a file path
+     */
+    void Detail(const string& detail) {
+        if (_active) _event.detail = detail;
+    }
+
+    bool Active() const { return _active; }
+};
+
+/**
+ * @brief Stands in for TraceScope in builds without FLECHA_TRACE
+ */
+struct NullTraceScope {
+    void Arg(const char*, uint64_t) {}
+    void Rate(const char*, uint64_t) {}
+    void Detail(const string&) {}
+    bool Active() const { return false; }
+};
+
+}  // namespace utils
+}  // namespace flecha
+
+// Declares a scope named variable timing the rest of the block
+#ifdef FLECHA_TRACE
+#define FLECHA_TRACE_SCOPE(variable, name, category) \
+    ::flecha::utils::TraceScope variable(name, category)
+#else
+#define FLECHA_TRACE_SCOPE(variable, name, category) \
+    ::flecha::utils::NullTraceScope variable
+#endif
+
+#endif  // FLECHA_TRACE_HPP
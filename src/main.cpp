@@ -1,7 +1,202 @@
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-int main() {
-    std::cout << "Hi mom" << std::endl;
-    return 0;
-    
+#include "core/AstCache.hpp"
+#include "core/Frontend.hpp"
+#include "core/Optimizer.hpp"
+#include "memory/Collector.hpp"
+#include "memory/MemStats.hpp"
+#include "runtime/CBackend.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/Jit.hpp"
+#include "runtime/VM.hpp"
+#include "utils/Trace.hpp"
+
+/**
+ * @brief Prints the command line usage
+ *
+ * @param program - The executable name
+ */
+static void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--jobs=<n>] [--cache=<dir>] [--check] [--no-optimize] "
+                 "[--gc] [--jit] [--mem-stats] [--trace=<file>] <file>..."
+              << std::endl
+              << "       " << program
+              << " build -o <output> [--no-optimize] [--trace=<file>] <file>"
+              << std::endl
+              << "  build -o <out> Compile the program to a native "
+                 "executable, or to C if out ends in .c"
+              << std::endl
+              << "  --jobs=<n>     Parse with n threads, one per hardware "
+                 "thread by default"
+              << std::endl
+              << "  --cache=<dir>  Reuse the trees of unchanged files "
+                 "parsed before, stored in dir"
+              << std::endl
+              << "  --check        Only parse, do not run the programs"
+              << std::endl
+              << "  --no-optimize  Run the programs as written, without "
+                 "folding constants or dropping dead stores"
+              << std::endl
+              << "  --gc           Collect allots once unreachable, dellot "
+                 "only frees early"
+              << std::endl
+              << "  --jit          Run the programs as native code, report "
+                 "compile time; one run gives no speedup to report"
+              << std::endl
+              << "  --mem-stats    Report allots, dellots and outstanding "
+                 "allots at exit"
+              << std::endl
+              << "  --trace=<file> Write the time of every phase as Chrome "
+                 "trace JSON"
+              << std::endl;
+}
+
+/*
+ * Parses every input file concurrently and reports their diagnostics in
+ * input order, then optimizes, compiles and runs the programs that
+ * parsed, in the same order. Exits with 1 if any file failed. The build
+ * command compiles its one program ahead of time instead of running it.
+ */
+int main(int argc, char** argv) {
+    size_t jobs = 0;
+    bool check = false;
+    bool optimize = true;
+    bool mem_stats = false;
+    bool gc = false;
+    bool jit = false;
+    bool build = false;
+    std::string output;
+    std::string cache_directory;
+    std::string trace_path;
+    std::vector<std::string> paths;
+
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]) == "build") {
+        build = true;
+        first = 2;
+    }
+
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+        if (build && arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = std::strtoul(arg.c_str() + 7, nullptr, 10);
+        } else if (arg.rfind("--cache=", 0) == 0) {
+            cache_directory = arg.substr(8);
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            trace_path = arg.substr(8);
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--no-optimize") {
+            optimize = false;
+        } else if (arg == "--gc") {
+            gc = true;
+        } else if (arg == "--jit") {
+            jit = true;
+        } else if (arg == "--mem-stats") {
+            mem_stats = true;
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            return 0;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty() || (build && (paths.size() != 1 || output.empty()))) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<flecha::core::AstCache> cache;
+    if (!cache_directory.empty()) {
+        try {
+            cache = std::make_unique<flecha::core::AstCache>(cache_directory);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+
+    auto& tracer = flecha::utils::Tracer::Global();
+    if (!trace_path.empty()) tracer.Start();
+
+    flecha::core::Frontend frontend(jobs, cache.get());
+    flecha::core::Optimizer optimizer;
+    // The trees point at folded nodes, so they live as long as the frontend
+    flecha::memory::Arena folded;
+    std::unique_ptr<flecha::memory::Collector> collector;
+    if (gc) collector = std::make_unique<flecha::memory::Collector>();
+    // Every program runs once, so it is compiled before that; the
+    // interpreter never runs, so the speedup is reported as unknown
+    std::unique_ptr<flecha::runtime::Jit> compiler;
+    if (jit) {
+        compiler = std::make_unique<flecha::runtime::Jit>(
+            flecha::runtime::JitOptions{0});
+    }
+    size_t failed = 0;
+
+    for (const auto& file : frontend.ParseFiles(paths)) {
+        for (const auto& diagnostic : file.diagnostics) {
+            std::cerr << diagnostic << std::endl;
+        }
+        if (!file.program) {
+            failed++;
+            continue;
+        }
+        if (check) continue;
+
+        try {
+            if (optimize) optimizer.Run(file.program, folded);
+            auto chunk = flecha::runtime::Compile(file.program);
+            if (build) {
+                flecha::runtime::Build(chunk, file.path, output);
+            } else {
+                flecha::runtime::VM(collector.get(), nullptr, compiler.get())
+                    .Run(chunk);
+            }
+        } catch (const std::runtime_error& error) {
+            std::cerr << file.path << ": " << error.what() << std::endl;
+            failed++;
+        }
+    }
+
+    if (!trace_path.empty()) {
+        tracer.Stop();
+        if (!flecha::utils::Tracer::Enabled()) {
+            std::cerr << "Tracing is compiled out of this build, configure "
+                         "with -DFLECHA_TRACE=ON"
+                      << std::endl;
+        } else if (!tracer.WriteJson(trace_path)) {
+            std::cerr << "Could not write the trace to " << trace_path
+                      << std::endl;
+            failed++;
+        }
+    }
+
+    if (mem_stats) {
+        if (flecha::memory::MemStats::Enabled()) {
+            flecha::memory::MemStats::Global().Report(std::cerr);
+        } else {
+            std::cerr << "Memory statistics are compiled out of this build, "
+                         "configure with -DFLECHA_MEM_STATS=ON"
+                      << std::endl;
+        }
+        // Counted in every build
+        if (collector) collector->Report(std::cerr);
+    }
+    if (compiler) compiler->Report(std::cerr);
+
+    return failed ? 1 : 0;
 }
@@ -0,0 +1,123 @@
+#include "memory/Arena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace flecha {
+namespace memory {
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Gets where a chunk's usable memory starts
+ *
+ * @param chunk - The chunk
+ *
+ * @return - The first byte after its header
+ */
+char* Arena::_Data(Chunk* chunk) {
+    return reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+}
+
+/**
+ * @brief Moves on to the next chunk that fits, allocating one if needed
+ *
+ * @param size - The number of bytes
+ * @param alignment - A power of two
+ *
+ * @return - The memory
+ */
+void* Arena::_AllocateSlow(size_t size, size_t alignment) {
+    size_t needed = size + alignment;
+
+    // Chunks kept by Reset are reused in order
+    Chunk* next = _current ? _current->next : _first;
+    if (!next || next->size < needed) {
+        size_t chunk_size = needed > _chunk_size ? needed : _chunk_size;
+        Chunk* chunk =
+            static_cast<Chunk*>(std::malloc(sizeof(Chunk) + chunk_size));
+        if (!chunk) {
+            throw std::bad_alloc();
+        }
+
+        chunk->size = chunk_size;
+        chunk->next = next;
+        if (_current) {
+            _current->next = chunk;
+        } else {
+            _first = chunk;
+        }
+        next = chunk;
+    }
+
+    _current = next;
+    _cursor = _Data(next);
+    _limit = _cursor + next->size;
+    return Allocate(size, alignment);
+}
+
+/* PUBLIC METHODS */
+
+Arena::Arena(size_t chunk_size)
+    : _first(nullptr),
+      _current(nullptr),
+      _cursor(nullptr),
+      _limit(nullptr),
+      _chunk_size(chunk_size),
+      _used(0),
+      _objects(0) {}
+
+Arena::Arena(Arena&& other) noexcept
+    : _first(other._first),
+      _current(other._current),
+      _cursor(other._cursor),
+      _limit(other._limit),
+      _chunk_size(other._chunk_size),
+      _used(other._used),
+      _objects(other._objects) {
+    other._first = other._current = nullptr;
+    other._cursor = other._limit = nullptr;
+    other._used = 0;
+    other._objects = 0;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        std::swap(_first, other._first);
+        std::swap(_current, other._current);
+        std::swap(_cursor, other._cursor);
+        std::swap(_limit, other._limit);
+        std::swap(_chunk_size, other._chunk_size);
+        std::swap(_used, other._used);
+        std::swap(_objects, other._objects);
+    }
+
+    return *this;
+}
+
+Arena::~Arena() {
+    while (_first) {
+        Chunk* next = _first->next;
+        std::free(_first);
+        _first = next;
+    }
+}
+
+std::string_view Arena::CopyString(std::string_view text) {
+    if (text.empty()) return std::string_view();
+
+    char* copy = static_cast<char*>(Allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+void Arena::Reset() {
+    _current = _first;
+    _cursor = _first ? _Data(_first) : nullptr;
+    _limit = _first ? _cursor + _first->size : nullptr;
+    _used = 0;
+    _objects = 0;
+}
+
+}  // namespace memory
+}  // namespace flecha
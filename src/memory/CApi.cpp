@@ -0,0 +1,15 @@
+#include "memory/CApi.hpp"
+
+#include "memory/Heap.hpp"
+
+using flecha::memory::Block;
+using flecha::memory::Heap;
+using flecha::memory::HeapCache;
+
+void* flecha_allot(size_t size) {
+    return HeapCache::Local().Allocate(size).address;
+}
+
+void flecha_dellot(void* address, size_t size) {
+    HeapCache::Local().Free(Block{address, Heap::ClassOf(size)});
+}
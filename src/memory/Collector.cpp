@@ -0,0 +1,499 @@
+#include "memory/Collector.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief What precedes every object, young or old
+ */
+struct Collector::Header {
+    // The payload bytes, a multiple of 8
+    uint32_t size;
+    uint8_t flags;
+    // Marked when it equals the collector's epoch
+    uint8_t mark;
+    // The block's size class, Heap::LARGE for a large object, 0 if young
+    uint16_t size_class;
+};
+
+// Header::flags
+static constexpr uint8_t HOLDS_POINTERS = 1;
+static constexpr uint8_t FORWARDED = 2;
+static constexpr uint8_t FREED = 4;
+static constexpr uint8_t REMEMBERED = 8;
+
+// Young objects are at least this big, to fit a forwarding pointer
+static constexpr size_t MIN_PAYLOAD = sizeof(void*);
+static constexpr size_t MIN_NURSERY = 4096;
+
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static char* AllocateAligned(size_t bytes, size_t alignment) {
+    void* memory = std::aligned_alloc(alignment, bytes);
+    if (!memory) throw std::bad_alloc();
+    return static_cast<char*>(memory);
+}
+
+/* PRIVATE METHODS */
+
+Collector::Header* Collector::_HeaderOf(const void* object) {
+    return reinterpret_cast<Header*>(const_cast<void*>(object)) - 1;
+}
+
+bool Collector::_IsYoung(const void* object) const {
+    auto address = reinterpret_cast<uintptr_t>(object);
+    return address >= reinterpret_cast<uintptr_t>(_young) &&
+           address < reinterpret_cast<uintptr_t>(_end);
+}
+
+/**
+ * @brief Tells whether a pointer is an old object
+ *
+ * Regions are aligned to their size, and objects are only pointed to at
+ * their start, so one lookup of the region or the large object does.
+ *
+ * @param object - Any pointer
+ *
+ * @return True if it is in a region or a large object
+ */
+bool Collector::_IsOld(const void* object) const {
+    auto address = reinterpret_cast<uintptr_t>(object);
+    return object && (_owned.count(address & ~(REGION_SIZE - 1)) ||
+                      _large.count(address));
+}
+
+/**
+ * @brief Makes a zeroed object in the old generation, marked in the
+ * current epoch so a running cycle keeps it
+ *
+ * @param size - The payload bytes
+ * @param flags - Its Header::flags
+ *
+ * @return The header
+ */
+Collector::Header* Collector::_AllocateOld(size_t size, uint8_t flags) {
+    size_t total = sizeof(Header) + size;
+    uint32_t size_class = Heap::ClassOf(total);
+    size_t block = 0;
+    char* memory;
+
+    if (size_class == Heap::LARGE) {
+        block = total;
+        memory = static_cast<char*>(std::malloc(total));
+        if (!memory) throw std::bad_alloc();
+        _large.insert(reinterpret_cast<uintptr_t>(memory + sizeof(Header)));
+    } else if (_free[size_class]) {
+        block = Heap::ClassSize(size_class);
+        memory = static_cast<char*>(_free[size_class]);
+        _free[size_class] = *reinterpret_cast<void**>(memory);
+    } else {
+        block = Heap::ClassSize(size_class);
+        if (_cursor + block > _limit) {
+            char* region = AllocateAligned(REGION_SIZE, REGION_SIZE);
+            _regions.push_back(region);
+            _owned.insert(reinterpret_cast<uintptr_t>(region));
+            _cursor = region;
+            _limit = region + REGION_SIZE;
+        }
+        memory = _cursor;
+        _cursor += block;
+    }
+
+    auto* header = reinterpret_cast<Header*>(memory);
+    header->size = static_cast<uint32_t>(size);
+    header->flags = flags;
+    header->mark = _epoch;
+    header->size_class = static_cast<uint16_t>(size_class);
+    std::memset(header + 1, 0, size);
+
+    _old.push_back(header);
+    _stats.old_bytes += block;
+    return header;
+}
+
+/**
+ * @brief Gives an old object's block back, to its class or the system
+ *
+ * @param header - The object, no longer listed in _old
+ */
+void Collector::_Release(Header* header) {
+    if (header->flags & REMEMBERED) {
+        _remembered.erase(
+            std::find(_remembered.begin(), _remembered.end(), header));
+    }
+
+    if (header->size_class == Heap::LARGE) {
+        _stats.old_bytes -= sizeof(Header) + header->size;
+        _large.erase(reinterpret_cast<uintptr_t>(header + 1));
+        std::free(header);
+        return;
+    }
+
+    _stats.old_bytes -= Heap::ClassSize(header->size_class);
+    *reinterpret_cast<void**>(header) = _free[header->size_class];
+    _free[header->size_class] = header;
+}
+
+/**
+ * @brief Copies a young object into the old generation, once
+ *
+ * @param object - A young object
+ *
+ * @return Where it lives now, null if it was dellotted
+ */
+void* Collector::_Evacuate(void* object) {
+    Header* header = _HeaderOf(object);
+    if (header->flags & FORWARDED) return *static_cast<void**>(object);
+    if (header->flags & FREED) return nullptr;
+
+    Header* copy = _AllocateOld(header->size, header->flags & HOLDS_POINTERS);
+    std::memcpy(copy + 1, object, header->size);
+    header->flags |= FORWARDED;
+    *static_cast<void**>(object) = copy + 1;
+
+    _stats.promoted_bytes += header->size;
+    if (copy->flags & HOLDS_POINTERS) _promoted.push_back(copy);
+    return copy + 1;
+}
+
+/**
+ * @brief Marks an old object reached while marking, so it gets scanned
+ *
+ * @param object - An old object
+ *
+ * @return False if it was dellotted, the pointer to it should be nulled
+ */
+bool Collector::_Shade(void* object) {
+    Header* header = _HeaderOf(object);
+    if (header->flags & FREED) return false;
+
+    if (_phase == Phase::Marking && header->mark != _epoch) {
+        header->mark = _epoch;
+        if (header->flags & HOLDS_POINTERS) _gray.push_back(header);
+    }
+    return true;
+}
+
+/**
+ * @brief Traces one pointer slot during a minor collection
+ *
+ * @param slot - The slot, updated to where its object moved
+ */
+void Collector::_Forward(void** slot) {
+    void* object = *slot;
+    if (_IsYoung(object)) {
+        *slot = _Evacuate(object);
+    } else if (_IsOld(object) && !_Shade(object)) {
+        *slot = nullptr;
+    }
+}
+
+/**
+ * @brief Empties the nursery, promoting what the roots and the remembered
+ * objects reach
+ *
+ * @param roots - The live slots
+ */
+void Collector::_Minor(const Roots& roots) {
+    for (size_t i = 0; i < roots.count; i++) {
+        _Forward(&roots.slots[roots.indices[i]]);
+    }
+
+    for (Header* header : _remembered) {
+        header->flags &= ~REMEMBERED;
+        auto** words = reinterpret_cast<void**>(header + 1);
+        for (size_t i = 0; i < header->size / sizeof(void*); i++) {
+            _Forward(&words[i]);
+        }
+    }
+    _remembered.clear();
+
+    // Promoted objects point old from now on, so they need no remembering
+    while (!_promoted.empty()) {
+        Header* header = _promoted.back();
+        _promoted.pop_back();
+        auto** words = reinterpret_cast<void**>(header + 1);
+        for (size_t i = 0; i < header->size / sizeof(void*); i++) {
+            _Forward(&words[i]);
+        }
+    }
+
+    _top = _young;
+    _stats.minor_collections++;
+}
+
+/**
+ * @brief Starts a major cycle from an empty nursery
+ *
+ * @param roots - The live slots
+ */
+void Collector::_StartMajor(const Roots& roots) {
+    _Minor(roots);
+
+    // Everything old is unmarked in the new epoch
+    _epoch++;
+    _phase = Phase::Marking;
+    for (size_t i = 0; i < roots.count; i++) {
+        void*& slot = roots.slots[roots.indices[i]];
+        if (_IsOld(slot) && !_Shade(slot)) slot = nullptr;
+    }
+    _stats.major_cycles++;
+}
+
+/**
+ * @brief Scans gray objects
+ *
+ * @param budget - About how many bytes to scan
+ *
+ * @return True if no gray object is left
+ */
+bool Collector::_Mark(size_t budget) {
+    size_t scanned = 0;
+    while (!_gray.empty() && scanned < budget) {
+        Header* header = _gray.back();
+        _gray.pop_back();
+
+        // Young objects are left to the minor collection, which promotes
+        // them marked
+        auto** words = reinterpret_cast<void**>(header + 1);
+        for (size_t i = 0; i < header->size / sizeof(void*); i++) {
+            if (_IsOld(words[i]) && !_Shade(words[i])) words[i] = nullptr;
+        }
+        scanned += sizeof(Header) + header->size;
+    }
+    return _gray.empty();
+}
+
+/**
+ * @brief Frees unmarked old objects and keeps the rest listed
+ *
+ * @param budget - About how many bytes to visit
+ *
+ * @return True once every old object was visited
+ */
+bool Collector::_Sweep(size_t budget) {
+    size_t visited = 0;
+    while (_sweep_cursor < _old.size() && visited < budget) {
+        Header* header = _old[_sweep_cursor++];
+        visited += sizeof(Header) + header->size;
+
+        if (header->mark == _epoch) {
+            _old[_sweep_kept++] = header;
+        } else {
+            _stats.swept_bytes += header->size;
+            _Release(header);
+        }
+    }
+    return _sweep_cursor == _old.size();
+}
+
+/**
+ * @brief Advances a major cycle by about one step
+ *
+ * Marking ends by rescanning the roots, which no barrier watches, and by
+ * emptying the nursery, so no young object points at an object about to
+ * be swept. What that shades is marked in the next steps, each object is
+ * shaded once per cycle, so the rescans run out of work.
+ *
+ * @param roots - The live slots
+ * @param budget - About how many bytes to mark or sweep
+ */
+void Collector::_Step(const Roots& roots, size_t budget) {
+    if (_phase == Phase::Marking) {
+        if (!_Mark(budget)) return;
+        _Minor(roots);
+        if (!_gray.empty()) return;
+
+        _phase = Phase::Sweeping;
+        _sweep_cursor = 0;
+        _sweep_kept = 0;
+        return;
+    }
+
+    if (_phase == Phase::Sweeping && _Sweep(budget)) {
+        _old.resize(_sweep_kept);
+        _phase = Phase::Idle;
+        _next_major = std::max(
+            _options.min_major_bytes,
+            static_cast<size_t>(_stats.old_bytes * _options.growth));
+    }
+}
+
+/* PUBLIC METHODS */
+
+Collector::Collector(CollectorOptions options)
+    : _options(options),
+      _cursor(nullptr),
+      _limit(nullptr),
+      _free(),
+      _phase(Phase::Idle),
+      _epoch(0),
+      _sweep_cursor(0),
+      _sweep_kept(0),
+      _next_major(options.min_major_bytes) {
+    if (!_options.nursery_bytes) {
+        _options.nursery_bytes = DefaultNurseryBytes();
+    }
+    size_t nursery = std::max(_options.nursery_bytes, MIN_NURSERY);
+    _options.nursery_bytes = (nursery + 63) & ~size_t(63);
+
+    _young = AllocateAligned(_options.nursery_bytes, 64);
+    _top = _young;
+    _end = _young + _options.nursery_bytes;
+}
+
+Collector::~Collector() {
+    for (Header* header : _old) {
+        if (header->size_class == Heap::LARGE) std::free(header);
+    }
+    for (char* region : _regions) std::free(region);
+    std::free(_young);
+}
+
+/**
+ * @brief Bump allocates in the nursery, big objects go old directly
+ *
+ * A running major cycle advances first, by one step. The pause of the
+ * call is recorded when it collected at all.
+ *
+ * @param size - The payload bytes
+ * @param holds_pointers - Whether every word of it is a pointer
+ * @param roots - The live slots
+ *
+ * @return The object
+ */
+void* Collector::Allocate(size_t size, bool holds_pointers,
+                          const Roots& roots) {
+    if (size > UINT32_MAX - sizeof(Header)) {
+        throw std::length_error("Collector Error: An allot of " +
+                                std::to_string(size) + " bytes is too big.");
+    }
+    size = std::max((size + 7) & ~size_t(7), MIN_PAYLOAD);
+    uint8_t flags = holds_pointers ? HOLDS_POINTERS : 0;
+    size_t total = sizeof(Header) + size;
+    _stats.allocations++;
+
+    uint64_t start = 0;
+    if (_phase != Phase::Idle) {
+        start = Now();
+        _Step(roots, _options.step_bytes);
+    } else if (_stats.old_bytes >= _next_major) {
+        start = Now();
+        _StartMajor(roots);
+    }
+
+    void* object;
+    if (total > _options.nursery_bytes / 8) {
+        object = _AllocateOld(size, flags) + 1;
+    } else {
+        if (_top + total > _end) {
+            if (!start) start = Now();
+            _Minor(roots);
+        }
+
+        auto* header = reinterpret_cast<Header*>(_top);
+        _top += total;
+        header->size = static_cast<uint32_t>(size);
+        header->flags = flags;
+        header->mark = 0;
+        header->size_class = 0;
+        object = header + 1;
+        std::memset(object, 0, size);
+    }
+
+    if (start) {
+        _stats.max_pause_ns = std::max(_stats.max_pause_ns, Now() - start);
+    }
+    return object;
+}
+
+void Collector::Free(void* object) {
+    if (!Owns(object)) return;
+
+    Header* header = _HeaderOf(object);
+    if (header->flags & FREED) return;
+    _stats.early_frees++;
+
+    // Never taken back at once, even when newest: copies of the pointer
+    // may be left, and the collection nulls them instead of aliasing them
+    header->flags |= FREED;
+}
+
+/**
+ * @brief Remembers old objects pointing young, and shades the stored
+ * object while marking
+ *
+ * Young objects are scanned whole when they are promoted, so writes into
+ * them need nothing.
+ *
+ * @param object - Where the pointer was stored
+ * @param value - The pointer
+ */
+void Collector::Write(void* object, void* value) {
+    if (!_IsOld(object)) return;
+
+    Header* header = _HeaderOf(object);
+    if (_IsYoung(value) && !(header->flags & REMEMBERED)) {
+        header->flags |= REMEMBERED;
+        _remembered.push_back(header);
+    } else if (_phase == Phase::Marking && _IsOld(value)) {
+        _Shade(value);
+    }
+}
+
+void Collector::Dirty(void* object) {
+    if (!_IsOld(object)) return;
+
+    Header* header = _HeaderOf(object);
+    if (!(header->flags & HOLDS_POINTERS)) return;
+
+    auto** words = reinterpret_cast<void**>(header + 1);
+    for (size_t i = 0; i < header->size / sizeof(void*); i++) {
+        Write(object, words[i]);
+    }
+}
+
+void Collector::Collect(const Roots& roots) {
+    // A cycle already marking may have missed what was dellotted since
+    while (_phase != Phase::Idle) _Step(roots, SIZE_MAX);
+    _StartMajor(roots);
+    while (_phase != Phase::Idle) _Step(roots, SIZE_MAX);
+}
+
+void Collector::Report(std::ostream& out) const {
+    out << "Collector statistics:" << std::endl
+        << "  nursery bytes: " << _options.nursery_bytes << std::endl
+        << "  old bytes: " << _stats.old_bytes << std::endl
+        << "  allocations: " << _stats.allocations
+        << ", early frees: " << _stats.early_frees << std::endl
+        << "  minor collections: " << _stats.minor_collections
+        << ", promoted bytes: " << _stats.promoted_bytes << std::endl
+        << "  major cycles: " << _stats.major_cycles
+        << ", swept bytes: " << _stats.swept_bytes << std::endl
+        << "  longest pause: " << _stats.max_pause_ns / 1000 << " us"
+        << std::endl;
+}
+
+size_t Collector::DefaultNurseryBytes() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 > 0) return static_cast<size_t>(l2) / 2;
+#endif
+    return 256 * 1024;
+}
+
+}  // namespace memory
+}  // namespace flecha
@@ -0,0 +1,206 @@
+#include "memory/Heap.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace flecha {
+namespace memory {
+
+// Slab headers are padded so blocks keep 64 byte alignment
+static constexpr size_t SLAB_HEADER = 64;
+// Bytes worth of blocks a cache moves at a time
+static constexpr size_t BATCH_BYTES = 8 * 1024;
+
+/* HEAP PRIVATE METHODS */
+
+/**
+ * @brief Allocates a slab and remembers it for the destructor
+ *
+ * @return - The first usable byte, SLAB_SIZE bytes follow
+ */
+char* Heap::_NewSlab() {
+    auto* slab =
+        static_cast<Slab*>(std::aligned_alloc(64, SLAB_HEADER + SLAB_SIZE));
+    if (!slab) {
+        throw std::bad_alloc();
+    }
+
+    std::lock_guard<std::mutex> guard(_slabs_lock);
+    slab->next = _slabs;
+    _slabs = slab;
+    return reinterpret_cast<char*>(slab) + SLAB_HEADER;
+}
+
+/* HEAP PUBLIC METHODS */
+
+Heap::Heap() : _slabs(nullptr) {}
+
+Heap::~Heap() {
+    while (_slabs) {
+        Slab* next = _slabs->next;
+        std::free(_slabs);
+        _slabs = next;
+    }
+}
+
+size_t Heap::ClassSize(uint32_t size_class) {
+    if (size_class == 0) return 8;
+    if (size_class <= 8) return size_class * 16;
+
+    uint32_t step = size_class - 9;
+    int bit = 7 + static_cast<int>(step / 4);
+    return static_cast<size_t>(4 + step % 4 + 1) << (bit - 2);
+}
+
+/**
+ * @brief Takes blocks of a class, reusing freed ones before carving new
+ *
+ * @param size_class - A class below LARGE
+ * @param count - How many blocks to take
+ *
+ * @return - The first block of a null terminated list
+ */
+void* Heap::Take(uint32_t size_class, size_t count) {
+    Class& c = _classes[size_class];
+    size_t size = ClassSize(size_class);
+
+    std::lock_guard<std::mutex> guard(c.lock);
+
+    FreeBlock* first = nullptr;
+    FreeBlock** tail = &first;
+    for (size_t i = 0; i < count; i++) {
+        FreeBlock* block = c.free;
+        if (block) {
+            c.free = block->next;
+        } else {
+            if (static_cast<size_t>(c.limit - c.cursor) < size) {
+                c.cursor = _NewSlab();
+                c.limit = c.cursor + SLAB_SIZE;
+            }
+            block = reinterpret_cast<FreeBlock*>(c.cursor);
+            c.cursor += size;
+        }
+
+        *tail = block;
+        tail = &block->next;
+    }
+
+    *tail = nullptr;
+    return first;
+}
+
+/**
+ * @brief Puts a list of blocks back on their class's free list
+ *
+ * @param size_class - A class below LARGE
+ * @param first - The first block
+ * @param last - The last block
+ */
+void Heap::Give(uint32_t size_class, void* first, void* last) {
+    Class& c = _classes[size_class];
+
+    std::lock_guard<std::mutex> guard(c.lock);
+    static_cast<FreeBlock*>(last)->next = c.free;
+    c.free = static_cast<FreeBlock*>(first);
+}
+
+/**
+ * @brief Allocates one block without a cache
+ *
+ * @param size - The number of bytes
+ *
+ * @return - The block
+ */
+Block Heap::Allocate(size_t size) {
+    uint32_t size_class = ClassOf(size);
+    if (size_class != LARGE) return Block{Take(size_class, 1), size_class};
+
+    void* address = std::malloc(size);
+    if (!address) {
+        throw std::bad_alloc();
+    }
+    return Block{address, LARGE};
+}
+
+/**
+ * @brief Frees one block without a cache
+ *
+ * @param block - The block
+ */
+void Heap::Free(Block block) {
+    if (!block.address) return;
+
+    if (block.size_class == LARGE) {
+        std::free(block.address);
+    } else {
+        Give(block.size_class, block.address, block.address);
+    }
+}
+
+Heap& Heap::Global() {
+    // Leaked on purpose, thread caches flush into it as threads exit
+    static Heap* global = new Heap();
+    return *global;
+}
+
+/* CACHE PRIVATE METHODS */
+
+/**
+ * @brief Takes a batch for an empty list
+ *
+ * @param size_class - The list's class
+ *
+ * @return - The first block of the list
+ */
+void* HeapCache::_Refill(uint32_t size_class) {
+    List& list = _lists[size_class];
+    list.first = _heap.Take(size_class, list.batch);
+    list.count = list.batch;
+    return list.first;
+}
+
+/**
+ * @brief Gives the newest blocks of a list back
+ *
+ * @param size_class - The list's class
+ * @param keep - How many blocks stay in the cache
+ */
+void HeapCache::_Flush(uint32_t size_class, uint32_t keep) {
+    List& list = _lists[size_class];
+    if (list.count <= keep) return;
+
+    // The newest blocks were just written, so walking them is cheap
+    void* first = list.first;
+    void* last = first;
+    for (uint32_t i = keep + 1; i < list.count; i++) {
+        last = *static_cast<void**>(last);
+    }
+
+    list.first = *static_cast<void**>(last);
+    list.count = keep;
+    _heap.Give(size_class, first, last);
+}
+
+/* CACHE PUBLIC METHODS */
+
+HeapCache::HeapCache(Heap& heap) : _heap(heap) {
+    for (uint32_t c = 0; c < Heap::CLASSES; c++) _lists[c].batch = BatchOf(c);
+}
+
+HeapCache::~HeapCache() {
+    for (uint32_t c = 0; c < Heap::CLASSES; c++) _Flush(c, 0);
+}
+
+uint32_t HeapCache::BatchOf(uint32_t size_class) {
+    size_t batch = BATCH_BYTES / Heap::ClassSize(size_class);
+    return static_cast<uint32_t>(std::clamp<size_t>(batch, 4, 512));
+}
+
+HeapCache& HeapCache::Local() {
+    thread_local HeapCache cache(Heap::Global());
+    return cache;
+}
+
+}  // namespace memory
+}  // namespace flecha
@@ -0,0 +1,132 @@
+#include "memory/MemStats.hpp"
+
+namespace flecha {
+namespace memory {
+
+/**
+ * @brief Prints one site's line
+ *
+ * @param out - The stream
+ * @param site - The site
+ * @param allots - How many allots to report
+ * @param bytes - How many bytes to report
+ */
+static void PrintSite(std::ostream& out, const AllotSite& site, size_t allots,
+                      size_t bytes) {
+    out << "    ";
+    if (site.line) {
+        out << "line " << site.line << ", column " << site.column;
+    } else {
+        out << "unknown location";
+    }
+    out << ": " << allots << (allots == 1 ? " allot, " : " allots, ")
+        << bytes << " bytes" << std::endl;
+}
+
+MemStats::MemStats() { Reset(); }
+
+/**
+ * @brief Adds an allot to the totals, its class and its site
+ *
+ * @param size - The requested bytes
+ * @param size_class - The class of the block
+ * @param site - Where the allot is
+ */
+void MemStats::RecordAllot(size_t size, uint32_t size_class, AllotSite site) {
+    size_t live = _live_bytes.fetch_add(size) + size;
+    size_t peak = _peak_bytes.load();
+    while (live > peak && !_peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+
+    _allots.fetch_add(1);
+    _class_allots[size_class].fetch_add(1);
+
+    std::lock_guard<std::mutex> guard(_sites_lock);
+    SiteStats& stats = _sites[site];
+    stats.allots++;
+    stats.bytes += size;
+    stats.live_allots++;
+    stats.live_bytes += size;
+}
+
+/**
+ * @brief Takes a dellot off the live counters
+ *
+ * @param size - The bytes the allot requested
+ * @param site - Where the allot was
+ */
+void MemStats::RecordDellot(size_t size, AllotSite site) {
+    _live_bytes.fetch_sub(size);
+    _dellots.fetch_add(1);
+
+    std::lock_guard<std::mutex> guard(_sites_lock);
+    SiteStats& stats = _sites[site];
+    stats.live_allots--;
+    stats.live_bytes -= size;
+}
+
+std::map<AllotSite, SiteStats> MemStats::Sites() const {
+    std::lock_guard<std::mutex> guard(_sites_lock);
+    return _sites;
+}
+
+/**
+ * @brief Prints everything recorded
+ *
+ * @param out - The stream to print to
+ */
+void MemStats::Report(std::ostream& out) const {
+    out << "Memory statistics:" << std::endl
+        << "  live bytes: " << LiveBytes() << std::endl
+        << "  peak bytes: " << PeakBytes() << std::endl
+        << "  allots: " << Allots() << ", dellots: " << Dellots()
+        << std::endl;
+
+    out << "  size classes:" << std::endl;
+    for (uint32_t c = 0; c <= Heap::CLASSES; c++) {
+        size_t allots = ClassAllots(c);
+        if (!allots) continue;
+
+        out << "    ";
+        if (c == Heap::LARGE) {
+            out << "large";
+        } else {
+            out << Heap::ClassSize(c) << " bytes";
+        }
+        out << ": " << allots << (allots == 1 ? " allot" : " allots")
+            << std::endl;
+    }
+
+    std::map<AllotSite, SiteStats> sites = Sites();
+    out << "  allot sites:" << std::endl;
+    for (const auto& [site, stats] : sites) {
+        PrintSite(out, site, stats.allots, stats.bytes);
+    }
+
+    out << "  outstanding allots:" << std::endl;
+    for (const auto& [site, stats] : sites) {
+        if (stats.live_allots) {
+            PrintSite(out, site, stats.live_allots, stats.live_bytes);
+        }
+    }
+}
+
+void MemStats::Reset() {
+    _live_bytes = 0;
+    _peak_bytes = 0;
+    _allots = 0;
+    _dellots = 0;
+    for (auto& allots : _class_allots) allots = 0;
+
+    std::lock_guard<std::mutex> guard(_sites_lock);
+    _sites.clear();
+}
+
+MemStats& MemStats::Global() {
+    // Leaked on purpose, nodes outliving main still dellot into it
+    static MemStats* global = new MemStats();
+    return *global;
+}
+
+}  // namespace memory
+}  // namespace flecha
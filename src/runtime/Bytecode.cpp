@@ -0,0 +1,53 @@
+#include "runtime/Bytecode.hpp"
+
+#include <sstream>
+
+namespace flecha {
+namespace runtime {
+
+static constexpr std::string_view OP_NAMES[] = {
+#define FLECHA_OPCODE_NAME(name) #name,
+    FLECHA_OPCODES(FLECHA_OPCODE_NAME)
+#undef FLECHA_OPCODE_NAME
+};
+
+static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) ==
+                  static_cast<size_t>(Op::Count),
+              "Every opcode has a name");
+
+std::string_view OpName(Op op) {
+    return OP_NAMES[static_cast<size_t>(op)];
+}
+
+/**
+ * @brief Finds the latest variable with a name, a redeclaration hides the
+ * older one
+ *
+ * @param name - The variable name
+ *
+ * @return - The variable, nullptr if there is none
+ */
+const Global* Chunk::Find(std::string_view name) const {
+    for (size_t i = globals.size(); i > 0; i--) {
+        if (globals[i - 1].name == name) return &globals[i - 1];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Lists the instructions as "index: Op a, b, c"
+ *
+ * @return - The listing
+ */
+string Chunk::Disassemble() const {
+    std::ostringstream out;
+    for (size_t i = 0; i < code.size(); i++) {
+        const Instruction& instruction = code[i];
+        out << i << ": " << OpName(instruction.op) << " " << instruction.a
+            << ", " << instruction.b << ", " << instruction.c << "\n";
+    }
+    return out.str();
+}
+
+}  // namespace runtime
+}  // namespace flecha
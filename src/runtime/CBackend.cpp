@@ -0,0 +1,363 @@
+#include "runtime/CBackend.hpp"
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "utils/Trace.hpp"
+
+extern char** environ;
+
+namespace flecha {
+namespace runtime {
+
+// What every program starts with, after its path. The integer arithmetic
+// wraps through uint64_t like the VM's, and flecha_pow is core::PowInt.
+static constexpr const char* PRELUDE = R"(
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef union {
+    int64_t i;
+    double f;
+    void* p;
+} flecha_value;
+
+void* flecha_allot(size_t size);
+void flecha_dellot(void* address, size_t size);
+
+#if defined(__GNUC__)
+__attribute__((noreturn, cold, unused))
+#endif
+static void flecha_fail(const char* message, int line, int column) {
+    fprintf(stderr, "%s: Runtime Error: %s at line %d, column %d.\n",
+            flecha_path, message, line, column);
+    exit(1);
+}
+
+static inline int64_t flecha_pow(int64_t base, int64_t exponent) {
+    uint64_t result = 1, factor = (uint64_t)base, e;
+    if (exponent < 0) {
+        if (base == 1) return 1;
+        if (base == -1) return exponent % 2 ? -1 : 1;
+        return 0;
+    }
+    for (e = (uint64_t)exponent; e; e >>= 1) {
+        if (e & 1) result *= factor;
+        factor *= factor;
+    }
+    return (int64_t)result;
+}
+
+int main(void) {
+)";
+
+/**
+ * @brief Quotes text as a C string literal
+ *
+ * @param text - Any bytes
+ *
+ * @return The literal, with octal escapes for what is not printable
+ */
+static string Quote(std::string_view text) {
+    string quoted = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7f || c == '?') {
+            // Three digits always, so a following digit is not taken in,
+            // and ? never starts a trigraph
+            char escape[5];
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            quoted += escape;
+        } else {
+            quoted += static_cast<char>(c);
+        }
+    }
+    return quoted + "\"";
+}
+
+// The most negative int has no literal of its own in C
+static string IntLiteral(int64_t i) {
+    if (i == INT64_MIN) return "INT64_MIN";
+    return "INT64_C(" + std::to_string(i) + ")";
+}
+
+/**
+ * @brief Writes the statements of a chunk's main function
+ */
+class CEmitter {
+   private:
+    const Chunk& _chunk;
+    std::ostringstream& _out;
+    // The string constants by their characters
+    std::unordered_map<const void*, std::string_view> _strings;
+    const Instruction* _ip = nullptr;
+
+    string _R(uint16_t reg) const { return "r" + std::to_string(reg); }
+
+    void _Fail(const string& condition, const char* message) {
+        core::SourceLocation at = _chunk.locations[_ip - _chunk.code.data()];
+        _out << "    if (" << condition << ") flecha_fail(\"" << message
+             << "\", " << at.line << ", " << at.column << ");\n";
+    }
+
+    void _Int(const string& expression) {
+        _out << "    " << _R(_ip->a) << ".i = " << expression << ";\n";
+    }
+
+    void _Float(const string& expression) {
+        _out << "    " << _R(_ip->a) << ".f = " << expression << ";\n";
+    }
+
+    // Wraps like the VM: the operation on uint64_t, converted back
+    void _Wrapping(const char* op) {
+        _Int("(int64_t)((uint64_t)" + _R(_ip->b) + ".i " + op +
+             " (uint64_t)" + _R(_ip->c) + ".i)");
+    }
+
+    // Reads both operands as field, writes result, compares give ints
+    void _Binary(char field, const char* op, char result) {
+        _out << "    " << _R(_ip->a) << "." << result << " = " << _R(_ip->b)
+             << "." << field << " " << op << " " << _R(_ip->c) << "."
+             << field << ";\n";
+    }
+
+    void _LoadConst();
+    void _Instruction();
+
+   public:
+    CEmitter(const Chunk& chunk, std::ostringstream& out)
+        : _chunk(chunk), _out(out) {
+        for (const string& text : chunk.strings) {
+            _strings.emplace(text.data(), text);
+        }
+    }
+
+    void Main();
+};
+
+void CEmitter::_LoadConst() {
+    Value value = _chunk.constants[_ip->b | static_cast<uint32_t>(_ip->c)
+                                                << 16];
+    string a = _R(_ip->a);
+    auto text = _strings.find(value.p);
+    if (text != _strings.end()) {
+        _out << "    " << a << ".p = (void*)" << Quote(text->second) << ";\n";
+    } else {
+        // Float constants too, the compiler folds the bits
+        _out << "    " << a << ".i = " << IntLiteral(value.i) << ";\n";
+    }
+}
+
+/**
+ * @brief Writes the C of one instruction
+ */
+void CEmitter::_Instruction() {
+    string a = _R(_ip->a), b = _R(_ip->b), c = _R(_ip->c);
+    switch (_ip->op) {
+        case Op::Halt: _out << "    return 0;\n"; break;
+        case Op::LoadConst: _LoadConst(); break;
+        case Op::Move: _out << "    " << a << " = " << b << ";\n"; break;
+
+        case Op::AddInt: _Wrapping("+"); break;
+        case Op::SubInt: _Wrapping("-"); break;
+        case Op::MulInt: _Wrapping("*"); break;
+        case Op::DivInt:
+            _Fail(c + ".i == 0", "Division by zero");
+            _Int(c + ".i == -1 ? (int64_t)(0 - (uint64_t)" + b + ".i) : " +
+                 b + ".i / " + c + ".i");
+            break;
+        case Op::ModInt:
+            _Fail(c + ".i == 0", "Division by zero");
+            _Int(c + ".i == -1 ? 0 : " + b + ".i % " + c + ".i");
+            break;
+        case Op::PowInt: _Int("flecha_pow(" + b + ".i, " + c + ".i)"); break;
+        case Op::NegInt: _Int("(int64_t)(0 - (uint64_t)" + b + ".i)"); break;
+
+        case Op::AddFloat: _Binary('f', "+", 'f'); break;
+        case Op::SubFloat: _Binary('f', "-", 'f'); break;
+        case Op::MulFloat: _Binary('f', "*", 'f'); break;
+        case Op::DivFloat: _Binary('f', "/", 'f'); break;
+        case Op::ModFloat: _Float("fmod(" + b + ".f, " + c + ".f)"); break;
+        case Op::PowFloat: _Float("pow(" + b + ".f, " + c + ".f)"); break;
+        case Op::NegFloat: _Float("-" + b + ".f"); break;
+        case Op::IntToFloat: _Float("(double)" + b + ".i"); break;
+
+        case Op::EqInt: _Binary('i', "==", 'i'); break;
+        case Op::NeInt: _Binary('i', "!=", 'i'); break;
+        case Op::LtInt: _Binary('i', "<", 'i'); break;
+        case Op::LeInt: _Binary('i', "<=", 'i'); break;
+        case Op::GtInt: _Binary('i', ">", 'i'); break;
+        case Op::GeInt: _Binary('i', ">=", 'i'); break;
+        case Op::EqFloat: _Binary('f', "==", 'i'); break;
+        case Op::NeFloat: _Binary('f', "!=", 'i'); break;
+        case Op::LtFloat: _Binary('f', "<", 'i'); break;
+        case Op::LeFloat: _Binary('f', "<=", 'i'); break;
+        case Op::GtFloat: _Binary('f', ">", 'i'); break;
+        case Op::GeFloat: _Binary('f', ">=", 'i'); break;
+
+        case Op::And: _Binary('i', "&", 'i'); break;
+        case Op::Or: _Binary('i', "|", 'i'); break;
+        case Op::Xor: _Binary('i', "^", 'i'); break;
+        case Op::Not: _Int(b + ".i == 0"); break;
+
+        case Op::Allot:
+            _out << "    " << a << ".p = flecha_allot(" << _ip->b << ");\n";
+            break;
+        case Op::Dellot:
+            _Fail("!" + a + ".p", "Dellot of a null pointer");
+            _out << "    flecha_dellot(" << a << ".p, " << _ip->b << ");\n"
+                 << "    " << a << ".p = NULL;\n";
+            break;
+        case Op::Store:
+            _Fail("!" + a + ".p", "Write through a null pointer");
+            _out << "    *(flecha_value*)" << a << ".p = " << b << ";\n";
+            break;
+        case Op::Load:
+            _Fail("!" + b + ".p", "Read through a null pointer");
+            _out << "    " << a << " = *(flecha_value*)" << b << ".p;\n";
+            break;
+        case Op::AddressOf:
+            _out << "    " << a << ".p = &" << b << ";\n";
+            break;
+
+        default: {
+            core::SourceLocation at =
+                _chunk.locations[_ip - _chunk.code.data()];
+            throw std::runtime_error(
+                "Build Error: " + string(OpName(_ip->op)) +
+                " can not be lowered to C yet at line " +
+                std::to_string(at.line) + ", column " +
+                std::to_string(at.column) + ".");
+        }
+    }
+}
+
+/**
+ * @brief Writes the registers, zeroed like the VM's, then the code
+ */
+void CEmitter::Main() {
+    for (size_t reg = 0; reg < _chunk.registers; reg++) {
+        if (reg % 8) {
+            _out << ", ";
+        } else {
+            _out << (reg ? ";\n" : "") << "    flecha_value ";
+        }
+        _out << "r" << reg << " = {0}";
+    }
+    if (_chunk.registers) _out << ";\n";
+
+    int line = 0;
+    for (const Instruction& instruction : _chunk.code) {
+        _ip = &instruction;
+        int at = _chunk.locations[_ip - _chunk.code.data()].line;
+        if (at > 0 && at != line) {
+            _out << "#line " << at << "\n";
+            line = at;
+        }
+        _Instruction();
+    }
+    if (_chunk.code.empty() || _chunk.code.back().op != Op::Halt) {
+        _out << "    return 0;\n";
+    }
+    _out << "}\n";
+}
+
+string EmitC(const Chunk& chunk, std::string_view path) {
+    FLECHA_TRACE_SCOPE(trace, "EmitC", "runtime");
+    std::ostringstream out;
+    // The path is only ever written quoted, it may hold anything
+    out << "/* Built by flecha */\n"
+        << "static const char flecha_path[] = " << Quote(path) << ";\n"
+        << PRELUDE << "#line 1 " << Quote(path) << "\n";
+    CEmitter(chunk, out).Main();
+    trace.Rate("instructions", chunk.code.size());
+    return out.str();
+}
+
+/**
+ * @brief Runs a program and waits for it
+ *
+ * @param arguments - The program, then its arguments
+ *
+ * @return Whether it exited with 0
+ */
+static bool RunToCompletion(const vector<string>& arguments) {
+    vector<char*> argv;
+    for (const string& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(),
+                     environ) != 0) {
+        return false;
+    }
+    int status;
+    if (waitpid(pid, &status, 0) != pid) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void Build(const Chunk& chunk, std::string_view path, const string& output,
+           const BuildOptions& options) {
+    FLECHA_TRACE_SCOPE(trace, "Build", "runtime");
+    bool c_only = output.size() > 2 &&
+                  output.compare(output.size() - 2, 2, ".c") == 0;
+
+    // The C of an executable goes to a directory of its own, never over
+    // a file of the user's
+    string directory;
+    if (!c_only) {
+        string scratch =
+            (std::filesystem::temp_directory_path() / "flecha_build_XXXXXX")
+                .string();
+        if (!mkdtemp(scratch.data())) {
+            throw std::runtime_error(
+                "Build Error: Could not make a directory for the C.");
+        }
+        directory = scratch;
+    }
+    string source = c_only ? output : directory + "/program.c";
+    {
+        std::ofstream file(source, std::ios::binary);
+        file << EmitC(chunk, path);
+        if (!file.flush()) {
+            throw std::runtime_error("Build Error: Could not write " +
+                                     source + ".");
+        }
+    }
+    if (c_only) return;
+
+    // A C++ driver compiles the C and links the C++ of flecha_rt
+    string compiler =
+        options.compiler.empty() ? FLECHA_HOST_COMPILER : options.compiler;
+    string runtime =
+        options.runtime.empty() ? FLECHA_RUNTIME_LIBRARY : options.runtime;
+    bool built = RunToCompletion({compiler, "-x", "c",
+                                  options.optimization, "-o", output, source,
+                                  "-x", "none", runtime, "-lm", "-pthread"});
+    // A failed build keeps its C for debugging
+    if (!built) {
+        throw std::runtime_error("Build Error: " + compiler +
+                                 " could not build " + output +
+                                 ", the C is kept in " + source + ".");
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+}  // namespace runtime
+}  // namespace flecha
@@ -0,0 +1,584 @@
+#include "runtime/Compiler.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "core/EscapeAnalysis.hpp"
+#include "core/Types.hpp"
+#include "utils/Trace.hpp"
+
+namespace flecha {
+namespace runtime {
+
+using core::ASTNode;
+using core::NodeKind;
+using core::SourceLocation;
+
+// Registers are 16-bit operands
+static constexpr size_t MAX_REGISTERS = UINT16_MAX + 1;
+// Pointees are stored as one Value
+static constexpr uint16_t POINTEE_SIZE = sizeof(Value);
+
+/**
+ * @brief Gets where a location node starts
+ *
+ * @param location - A LocationNode or StartNode, may be null
+ *
+ * @return - The line and column, 0 when unknown
+ */
+static SourceLocation LocationOf(ASTNode* location) {
+    if (location && location->kind == NodeKind::Location) {
+        location = static_cast<core::LocationNode*>(location)->start;
+    }
+    if (!location || location->kind != NodeKind::Start) return {0, 0};
+
+    auto* start = static_cast<core::StartNode*>(location);
+    return {start->line, start->column};
+}
+
+/**
+ * @brief Gets the kind of values of a type
+ *
+ * @param type - A type node
+ *
+ * @return - The kind, Object for user defined types
+ */
+static ValueKind KindOfType(ASTNode* type) {
+    switch (core::PrimitiveOf(type)) {
+        case core::Primitive::Int: return ValueKind::Int;
+        case core::Primitive::Float: return ValueKind::Float;
+        case core::Primitive::Bool: return ValueKind::Bool;
+        case core::Primitive::Char: return ValueKind::Char;
+        case core::Primitive::String: return ValueKind::String;
+        case core::Primitive::None: break;
+    }
+    return ValueKind::Object;
+}
+
+static const char* KindName(ValueKind kind) {
+    switch (kind) {
+        case ValueKind::Int: return "int";
+        case ValueKind::Float: return "float";
+        case ValueKind::Bool: return "bool";
+        case ValueKind::Char: return "char";
+        case ValueKind::String: return "string";
+        case ValueKind::Pointer: return "pointer";
+        case ValueKind::Object: return "object";
+    }
+    return "value";
+}
+
+// Ints, chars and bools all run on the integer operations
+static bool IsIntegral(ValueKind kind) {
+    return kind == ValueKind::Int || kind == ValueKind::Char ||
+           kind == ValueKind::Bool;
+}
+
+static bool IsNumber(ValueKind kind) {
+    return IsIntegral(kind) || kind == ValueKind::Float;
+}
+
+/**
+ * @brief A compiled expression: the register holding it and its kind
+ */
+struct Operand {
+    uint16_t reg;
+    ValueKind kind;
+    ValueKind pointee;
+    // A promoted allot's pointee register, -1 otherwise
+    int32_t slot = -1;
+};
+
+/**
+ * @brief Walks the tree once, emitting into a chunk
+ */
+class Compiler {
+   private:
+    Chunk& _chunk;
+    const core::EscapeAnalysis* _escapes;
+    // Variable symbols to their latest entry in the chunk's globals
+    std::unordered_map<utils::Symbol, size_t> _variables;
+    std::unordered_map<uint64_t, uint32_t> _constants;
+    size_t _next = 0;
+    // Registers below this outlive their statement
+    size_t _persistent = 0;
+    SourceLocation _at{0, 0};
+
+    [[noreturn]] void _Error(const string& message) const {
+        throw std::runtime_error("Compiler Error: " + message + " at line " +
+                                 std::to_string(_at.line) + ", column " +
+                                 std::to_string(_at.column) + ".");
+    }
+
+    void _Emit(Op op, uint16_t a, uint16_t b = 0, uint16_t c = 0) {
+        _chunk.code.push_back(Instruction{op, a, b, c});
+        _chunk.locations.push_back(_at);
+    }
+
+    uint16_t _Register() {
+        if (_next == MAX_REGISTERS) {
+            _Error("The program needs more than 65536 registers");
+        }
+        if (_next == _chunk.registers) _chunk.registers++;
+        return static_cast<uint16_t>(_next++);
+    }
+
+    uint16_t _Target(int dest) {
+        return dest >= 0 ? static_cast<uint16_t>(dest) : _Register();
+    }
+
+    /**
+     * @brief Loads a constant, equal bit patterns share a slot
+     *
+     * @param dest - The register to load into, or -1 for a new one
+     * @param value - The constant
+     *
+     * @return - The register
+     */
+    uint16_t _Constant(int dest, Value value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        auto [slot, added] = _constants.emplace(
+            bits, static_cast<uint32_t>(_chunk.constants.size()));
+        if (added) _chunk.constants.push_back(value);
+
+        uint16_t reg = _Target(dest);
+        _Emit(Op::LoadConst, reg, static_cast<uint16_t>(slot->second),
+              static_cast<uint16_t>(slot->second >> 16));
+        return reg;
+    }
+
+    /**
+     * @brief Converts an integral operand for float arithmetic
+     *
+     * @param operand - The operand
+     *
+     * @return - A float operand
+     */
+    Operand _ToFloat(Operand operand) {
+        if (operand.kind == ValueKind::Float) return operand;
+
+        uint16_t reg = _Register();
+        _Emit(Op::IntToFloat, reg, operand.reg);
+        return Operand{reg, ValueKind::Float, ValueKind::Int};
+    }
+
+    /**
+     * @brief Makes a value fit a variable or pointee of some kind
+     *
+     * @param value - The value
+     * @param kind - The kind it is stored as
+     *
+     * @return - The value, converted from integral to float if needed
+     */
+    Operand _Convert(Operand value, ValueKind kind) {
+        if (value.kind == kind) return value;
+        if (kind == ValueKind::Float && IsIntegral(value.kind)) {
+            return _ToFloat(value);
+        }
+        if (IsIntegral(kind) && IsIntegral(value.kind)) {
+            value.kind = kind;
+            return value;
+        }
+        _Error(string("Can not store a ") + KindName(value.kind) + " as " +
+               KindName(kind));
+    }
+
+    Operand _Literal(core::ValueNode& node, int dest);
+    Operand _Unary(core::UnaryNode& node, int dest);
+    Operand _Binary(core::BinaryNode& node, int dest);
+    Operand _Expression(ASTNode* node, int dest);
+    void _Declaration(core::VariableDeclarationNode& node);
+    void _Allocation(core::AllocationStatementNode& node);
+    void _Bind(const core::VariableNode& variable, Operand operand);
+
+   public:
+    Compiler(Chunk& chunk, const core::EscapeAnalysis* escapes)
+        : _chunk(chunk), _escapes(escapes) {}
+
+    void Program(core::ProgramNode* program);
+};
+
+/**
+ * @brief Compiles a literal
+ *
+ * @param node - The ValueNode, typed by its declaration or not at all
+ * @param dest - The register to load into, or -1 for a new one
+ *
+ * @return - The operand
+ */
+Operand Compiler::_Literal(core::ValueNode& node, int dest) {
+    const core::Literal& literal = node.literal;
+    using LiteralKind = core::Literal::Kind;
+
+    ValueKind kind;
+    if (node.type) {
+        kind = KindOfType(node.type);
+    } else if (literal.kind == LiteralKind::Int) {
+        kind = ValueKind::Int;
+    } else if (literal.kind == LiteralKind::Float) {
+        kind = ValueKind::Float;
+    } else if (literal.kind == LiteralKind::Char) {
+        kind = ValueKind::Char;
+    } else if (literal.kind == LiteralKind::Bool) {
+        kind = ValueKind::Bool;
+    } else {
+        kind = ValueKind::String;
+    }
+
+    Value value;
+    string copy(node.value);
+    switch (kind) {
+        case ValueKind::Int:
+        case ValueKind::Bool:
+            if (literal.kind != LiteralKind::Int &&
+                literal.kind != LiteralKind::Bool) {
+                _Error(copy + " is not an integer");
+            }
+            value.i = literal.i;
+            if (kind == ValueKind::Bool) value.i = value.i != 0;
+            break;
+        case ValueKind::Float:
+            if (literal.kind == LiteralKind::Int) {
+                value.f = static_cast<double>(literal.i);
+            } else if (literal.kind == LiteralKind::Float) {
+                value.f = literal.f;
+            } else {
+                _Error(copy + " is not a number");
+            }
+            break;
+        case ValueKind::Char:
+            if (literal.kind != LiteralKind::Char) {
+                _Error(copy + " is not a character");
+            }
+            value.i = static_cast<unsigned char>(literal.c);
+            break;
+        case ValueKind::String: {
+            _chunk.strings.push_back(std::move(copy));
+            const string& text = _chunk.strings.back();
+            value.p = const_cast<char*>(text.data());
+            Value length;
+            length.i = static_cast<int64_t>(text.size());
+
+            // Strings are not shared, their addresses differ
+            uint16_t reg = _Target(dest);
+            _chunk.constants.push_back(value);
+            _chunk.constants.push_back(length);
+            uint32_t index = static_cast<uint32_t>(_chunk.constants.size() - 2);
+            _Emit(Op::LoadConst, reg, static_cast<uint16_t>(index),
+                  static_cast<uint16_t>(index >> 16));
+            return Operand{reg, kind, kind};
+        }
+        default:
+            _Error(string("A literal can not be a ") +
+                   string(static_cast<core::TypeNode*>(node.type)
+                              ->GetTypeName()));
+    }
+
+    return Operand{_Constant(dest, value), kind, kind};
+}
+
+/**
+ * @brief Compiles a prefix operator
+ *
+ * @param node - The UnaryNode
+ * @param dest - The result register, or -1 for a new one
+ *
+ * @return - The operand
+ */
+Operand Compiler::_Unary(core::UnaryNode& node, int dest) {
+    if (node.op == TokenType::AddressRef) {
+        if (!node.operand || node.operand->kind != NodeKind::Variable) {
+            _at = LocationOf(node.location);
+            _Error("? needs a variable");
+        }
+        Operand variable = _Expression(node.operand, -1);
+        _at = LocationOf(node.location);
+        uint16_t reg = _Target(dest);
+        _Emit(Op::AddressOf, reg, variable.reg);
+        return Operand{reg, ValueKind::Pointer, variable.kind};
+    }
+
+    Operand operand = _Expression(node.operand, -1);
+    _at = LocationOf(node.location);
+    uint16_t reg = _Target(dest);
+
+    if (node.op == TokenType::Not) {
+        if (!IsIntegral(operand.kind)) _Error("| needs an integer or bool");
+        _Emit(Op::Not, reg, operand.reg);
+        return Operand{reg, ValueKind::Bool, ValueKind::Bool};
+    }
+
+    if (!IsNumber(operand.kind)) _Error("- needs a number");
+    bool is_float = operand.kind == ValueKind::Float;
+    _Emit(is_float ? Op::NegFloat : Op::NegInt, reg, operand.reg);
+    ValueKind kind = is_float ? ValueKind::Float : ValueKind::Int;
+    return Operand{reg, kind, kind};
+}
+
+/**
+ * @brief Compiles an infix operator
+ *
+ * @param node - The BinaryNode
+ * @param dest - The result register, or -1 for a new one
+ *
+ * @return - The operand
+ */
+Operand Compiler::_Binary(core::BinaryNode& node, int dest) {
+    Operand left = _Expression(node.left, -1);
+    Operand right = _Expression(node.right, -1);
+    _at = LocationOf(node.location);
+
+    // ptr -> value writes through the pointer and gives the value
+    if (node.op == TokenType::AssignVal) {
+        if (left.kind != ValueKind::Pointer) _Error("-> needs a pointer");
+        Operand value = _Convert(right, left.pointee);
+        if (left.slot >= 0) {
+            _Emit(Op::Move, static_cast<uint16_t>(left.slot), value.reg);
+        } else {
+            _Emit(Op::Store, left.reg, value.reg,
+                  left.pointee == ValueKind::Pointer);
+        }
+        if (dest >= 0 && dest != value.reg) {
+            _Emit(Op::Move, static_cast<uint16_t>(dest), value.reg);
+            value.reg = static_cast<uint16_t>(dest);
+        }
+        return value;
+    }
+
+    if (node.op == TokenType::And || node.op == TokenType::Or ||
+        node.op == TokenType::Xor) {
+        if (!IsIntegral(left.kind) || !IsIntegral(right.kind)) {
+            _Error("Logical operators need integers or bools");
+        }
+        Op op = node.op == TokenType::And  ? Op::And
+                : node.op == TokenType::Or ? Op::Or
+                                           : Op::Xor;
+        uint16_t reg = _Target(dest);
+        _Emit(op, reg, left.reg, right.reg);
+        ValueKind kind =
+            left.kind == ValueKind::Bool && right.kind == ValueKind::Bool
+                ? ValueKind::Bool
+                : ValueKind::Int;
+        return Operand{reg, kind, kind};
+    }
+
+    if (!IsNumber(left.kind) || !IsNumber(right.kind)) {
+        _Error(string("Can not apply an operator to a ") +
+               KindName(IsNumber(left.kind) ? right.kind : left.kind));
+    }
+
+    bool is_float =
+        left.kind == ValueKind::Float || right.kind == ValueKind::Float;
+    if (is_float) {
+        left = _ToFloat(left);
+        right = _ToFloat(right);
+    }
+
+    // The float opcodes follow the int ones in the same order
+    auto pick = [is_float](Op int_op, Op float_op) {
+        return is_float ? float_op : int_op;
+    };
+    Op op;
+    bool compare = false;
+    switch (node.op) {
+        case TokenType::Add: op = pick(Op::AddInt, Op::AddFloat); break;
+        case TokenType::Sub: op = pick(Op::SubInt, Op::SubFloat); break;
+        case TokenType::Mul: op = pick(Op::MulInt, Op::MulFloat); break;
+        case TokenType::Div: op = pick(Op::DivInt, Op::DivFloat); break;
+        case TokenType::Mod: op = pick(Op::ModInt, Op::ModFloat); break;
+        case TokenType::Pow: op = pick(Op::PowInt, Op::PowFloat); break;
+        default:
+            compare = true;
+            switch (node.op) {
+                case TokenType::Compare: op = pick(Op::EqInt, Op::EqFloat); break;
+                case TokenType::NotEqual: op = pick(Op::NeInt, Op::NeFloat); break;
+                case TokenType::Less: op = pick(Op::LtInt, Op::LtFloat); break;
+                case TokenType::LessEqual: op = pick(Op::LeInt, Op::LeFloat); break;
+                case TokenType::Greater: op = pick(Op::GtInt, Op::GtFloat); break;
+                case TokenType::GreaterEqual: op = pick(Op::GeInt, Op::GeFloat); break;
+                default: _Error("Unknown operator");
+            }
+    }
+
+    uint16_t reg = _Target(dest);
+    _Emit(op, reg, left.reg, right.reg);
+    ValueKind kind = compare    ? ValueKind::Bool
+                     : is_float ? ValueKind::Float
+                                : ValueKind::Int;
+    return Operand{reg, kind, kind};
+}
+
+/**
+ * @brief Compiles an expression
+ *
+ * @param node - The expression
+ * @param dest - The register the result must end up in, or -1 when any
+ * register will do, variables are then used in place
+ *
+ * @return - The operand
+ */
+Operand Compiler::_Expression(ASTNode* node, int dest) {
+    switch (node->kind) {
+        case NodeKind::Value: {
+            auto& value = static_cast<core::ValueNode&>(*node);
+            _at = LocationOf(value.location);
+            return _Literal(value, dest);
+        }
+        case NodeKind::Variable: {
+            auto& variable = static_cast<core::VariableNode&>(*node);
+            _at = LocationOf(variable.location);
+            auto found = _variables.find(variable.symbol);
+            if (found == _variables.end()) {
+                _Error("Undefined variable " + string(variable.name));
+            }
+
+            const Global& global = _chunk.globals[found->second];
+            Operand operand{global.reg, global.kind, global.pointee,
+                            global.slot};
+            if (dest >= 0 && dest != operand.reg) {
+                _Emit(Op::Move, static_cast<uint16_t>(dest), operand.reg);
+                operand.reg = static_cast<uint16_t>(dest);
+                // The copy may be written through, which needs the heap
+                operand.slot = -1;
+            }
+            return operand;
+        }
+        case NodeKind::Unary:
+            return _Unary(static_cast<core::UnaryNode&>(*node), dest);
+        case NodeKind::Binary:
+            return _Binary(static_cast<core::BinaryNode&>(*node), dest);
+        default:
+            _Error("Unexpected node in an expression");
+    }
+}
+
+/**
+ * @brief Makes a name refer to a register from now on
+ *
+ * @param variable - The declared variable
+ * @param operand - The register and kind
+ */
+void Compiler::_Bind(const core::VariableNode& variable, Operand operand) {
+    _chunk.globals.push_back(Global{string(variable.name), operand.reg,
+                                    operand.kind, operand.pointee,
+                                    operand.slot});
+    _variables[variable.symbol] = _chunk.globals.size() - 1;
+}
+
+/**
+ * @brief Compiles int var = value;
+ *
+ * @param node - The VariableDeclarationNode
+ */
+void Compiler::_Declaration(core::VariableDeclarationNode& node) {
+    auto& variable = static_cast<core::VariableNode&>(*node.assignment);
+    _at = LocationOf(node.location);
+
+    // The value is computed into the variable's register, so it may still
+    // read an older variable of the same name
+    uint16_t reg = _Register();
+    _persistent = _next;
+    Operand value = _Expression(variable.value, reg);
+    if (node.type) {
+        // The variable has the declared kind, ints widen to floats
+        _at = LocationOf(node.location);
+        ValueKind declared = KindOfType(node.type);
+        if (declared == ValueKind::Float && IsIntegral(value.kind)) {
+            _Emit(Op::IntToFloat, reg, value.reg);
+        } else {
+            // Only checks, the value already is in the register
+            _Convert(value, declared);
+        }
+        value = Operand{reg, declared, declared};
+    }
+    _Bind(variable, Operand{reg, value.kind, value.pointee});
+}
+
+/**
+ * @brief Compiles int! var = allot(int) -> value;
+ *
+ * @param node - The AllocationStatementNode
+ */
+void Compiler::_Allocation(core::AllocationStatementNode& node) {
+    auto& allocation = static_cast<core::AllocationNode&>(*node.allocation);
+    auto& pointer = static_cast<core::PointerNode&>(*allocation.pointer_node);
+    auto& variable = static_cast<core::VariableNode&>(*pointer.variable);
+    ValueKind pointee = KindOfType(pointer.type);
+
+    uint16_t reg = _Register();
+    _at = LocationOf(allocation.location);
+
+    // A promoted pointee is a register right after the pointer's
+    int32_t slot = -1;
+    if (_escapes && _escapes->IsLocal(&node)) {
+        slot = _Register();
+        _Emit(Op::AddressOf, reg, static_cast<uint16_t>(slot));
+    } else {
+        // The collector traces blocks of pointers and their stores
+        _Emit(Op::Allot, reg, POINTEE_SIZE, pointee == ValueKind::Pointer);
+    }
+    _persistent = _next;
+
+    if (variable.value) {
+        Operand value = _Convert(_Expression(variable.value, slot), pointee);
+        _at = LocationOf(node.location);
+        if (slot >= 0) {
+            if (value.reg != slot) {
+                _Emit(Op::Move, static_cast<uint16_t>(slot), value.reg);
+            }
+        } else {
+            _Emit(Op::Store, reg, value.reg,
+                  pointee == ValueKind::Pointer);
+        }
+    }
+
+    _Bind(variable, Operand{reg, ValueKind::Pointer, pointee, slot});
+}
+
+/**
+ * @brief Compiles every statement, then halts
+ *
+ * @param program - The program
+ */
+void Compiler::Program(core::ProgramNode* program) {
+    auto* body = static_cast<core::BodyNode*>(program->body);
+    if (body) {
+        for (ASTNode* statement : body->expressions) {
+            if (statement->kind == NodeKind::VariableDeclaration) {
+                _Declaration(
+                    static_cast<core::VariableDeclarationNode&>(*statement));
+            } else if (statement->kind == NodeKind::AllocationStatement) {
+                _Allocation(
+                    static_cast<core::AllocationStatementNode&>(*statement));
+            } else {
+                _Error("Unexpected statement");
+            }
+
+            // Temporaries die with their statement
+            _next = _persistent;
+        }
+    }
+
+    _Emit(Op::Halt, 0);
+}
+
+Chunk Compile(core::ProgramNode* program, CompileOptions options) {
+    FLECHA_TRACE_SCOPE(trace, "Compile", "runtime");
+    Chunk chunk;
+    if (options.promote_allots) {
+        core::EscapeAnalysis escapes(program);
+        Compiler(chunk, &escapes).Program(program);
+    } else {
+        Compiler(chunk, nullptr).Program(program);
+    }
+    trace.Rate("instructions", chunk.code.size());
+    trace.Arg("registers", chunk.registers);
+    return chunk;
+}
+
+}  // namespace runtime
+}  // namespace flecha
@@ -0,0 +1,433 @@
+#include "runtime/Jit.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+
+#include "runtime/VM.hpp"
+
+namespace flecha {
+namespace runtime {
+
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#if defined(__x86_64__)
+
+/*
+ * The machine code keeps the registers' base in rbx, the constants' in r12
+ * and the VM in r13, all callee saved, and works in rax, rcx, rdx and
+ * xmm0. Every instruction loads its operands from the registers and
+ * stores its result back, so the interpreter sees the same state wherever
+ * it takes over.
+ */
+
+// The signature the code is entered with, the last argument is the
+// address of the first instruction's code
+using Entry = uint32_t (*)(Value* registers, const Value* constants, VM* vm,
+                           const void* start);
+
+/**
+ * @brief Appends x86-64 machine code
+ */
+class Assembler {
+   private:
+    vector<uint8_t> _code;
+
+   public:
+    void Emit(std::initializer_list<uint8_t> bytes) {
+        _code.insert(_code.end(), bytes);
+    }
+
+    void Emit32(uint32_t value) {
+        for (int i = 0; i < 4; i++) _code.push_back(value >> (8 * i));
+    }
+
+    void Emit64(uint64_t value) {
+        for (int i = 0; i < 8; i++) _code.push_back(value >> (8 * i));
+    }
+
+    /**
+     * @brief Emits an instruction on a VM register, [rbx + 8 * index]
+     *
+     * @param opcode - The prefixes and opcode bytes
+     * @param reg - The machine register of the ModRM reg field
+     * @param index - The VM register
+     */
+    void Register(std::initializer_list<uint8_t> opcode, uint8_t reg,
+                  uint16_t index) {
+        Emit(opcode);
+        Emit({static_cast<uint8_t>(0x83 | reg << 3)});
+        Emit32(static_cast<uint32_t>(index) * 8);
+    }
+
+    void LoadRax(uint16_t index) { Register({0x48, 0x8B}, 0, index); }
+    void LoadRcx(uint16_t index) { Register({0x48, 0x8B}, 1, index); }
+    void StoreRax(uint16_t index) { Register({0x48, 0x89}, 0, index); }
+    void StoreRcx(uint16_t index) { Register({0x48, 0x89}, 1, index); }
+    void StoreRdx(uint16_t index) { Register({0x48, 0x89}, 2, index); }
+    void LoadXmm0(uint16_t index) { Register({0xF2, 0x0F, 0x10}, 0, index); }
+    void StoreXmm0(uint16_t index) { Register({0xF2, 0x0F, 0x11}, 0, index); }
+
+    /**
+     * @brief Emits a jump with its offset left to Patch
+     *
+     * @param opcode - The opcode bytes of the rel32 form
+     *
+     * @return Where the offset goes
+     */
+    size_t Jump(std::initializer_list<uint8_t> opcode) {
+        Emit(opcode);
+        Emit32(0);
+        return _code.size() - 4;
+    }
+
+    void Patch(size_t at, size_t target) {
+        auto offset = static_cast<uint32_t>(target - (at + 4));
+        std::memcpy(&_code[at], &offset, 4);
+    }
+
+    size_t Size() const { return _code.size(); }
+    const uint8_t* Data() const { return _code.data(); }
+};
+
+/**
+ * @brief Emits an integer or float compare as 0 or 1
+ *
+ * Float compares are unordered for NaN, which leaves lt and le false
+ * through ucomisd's carry flag and ne true through its parity flag.
+ *
+ * @param as - The assembler
+ * @param op - The compare
+ * @param ip - Its instruction
+ */
+static void EmitCompare(Assembler& as, Op op, const Instruction& ip) {
+    static const uint8_t INT_CONDITIONS[] = {0x94, 0x95, 0x9C,
+                                             0x9E, 0x9F, 0x9D};
+    if (op >= Op::EqInt && op <= Op::GeInt) {
+        as.LoadRax(ip.b);
+        as.Emit({0x31, 0xD2});
+        as.Register({0x48, 0x3B}, 0, ip.c);
+        uint8_t condition =
+            INT_CONDITIONS[static_cast<size_t>(op) -
+                           static_cast<size_t>(Op::EqInt)];
+        as.Emit({0x0F, condition, 0xC2});
+        as.StoreRdx(ip.a);
+        return;
+    }
+
+    as.Emit({0x31, 0xC0, 0x31, 0xD2});
+    // y > x for lt and y >= x for le, so unordered gives false
+    bool swap = op == Op::LtFloat || op == Op::LeFloat;
+    as.LoadXmm0(swap ? ip.c : ip.b);
+    as.Register({0x66, 0x0F, 0x2E}, 0, swap ? ip.b : ip.c);
+    switch (op) {
+        case Op::EqFloat:
+            // sete al, setnp dl, and edx, eax
+            as.Emit({0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC2, 0x21, 0xC2});
+            break;
+        case Op::NeFloat:
+            // setne al, setp dl, or edx, eax
+            as.Emit({0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC2, 0x09, 0xC2});
+            break;
+        case Op::LtFloat:
+        case Op::GtFloat:
+            as.Emit({0x0F, 0x97, 0xC2});
+            break;
+        default:
+            as.Emit({0x0F, 0x93, 0xC2});
+            break;
+    }
+    as.StoreRdx(ip.a);
+}
+
+std::unique_ptr<NativeCode> Jit::Compile(const Chunk& chunk) {
+    Assembler as;
+    size_t count = chunk.code.size();
+    vector<uint32_t> entries(count + 1);
+    // Jumps out to the interpreter, by the instruction they leave at
+    vector<std::pair<size_t, uint32_t>> exits;
+    vector<size_t> halts;
+    size_t stepped = 0;
+
+    // push rbx, r12, r13, which leaves the stack aligned for calls; move
+    // the arguments there and jump to the first instruction
+    as.Emit({0x53, 0x41, 0x54, 0x41, 0x55});
+    as.Emit({0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5});
+    as.Emit({0xFF, 0xE1});
+
+    auto guard = [&](std::initializer_list<uint8_t> jump, size_t index) {
+        exits.emplace_back(as.Jump(jump), static_cast<uint32_t>(index));
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        const Instruction& ip = chunk.code[i];
+        entries[i] = static_cast<uint32_t>(as.Size());
+        uint32_t constant = ip.b | static_cast<uint32_t>(ip.c) << 16;
+
+        switch (ip.op) {
+            case Op::Halt:
+                as.Emit({0xB8});
+                as.Emit32(static_cast<uint32_t>(i));
+                halts.push_back(as.Jump({0xE9}));
+                continue;
+            case Op::LoadConst:
+                if (constant > INT32_MAX / 8) break;
+                // mov rax, [r12 + 8 * constant]
+                as.Emit({0x49, 0x8B, 0x84, 0x24});
+                as.Emit32(constant * 8);
+                as.StoreRax(ip.a);
+                continue;
+            case Op::Move:
+                as.LoadRax(ip.b);
+                as.StoreRax(ip.a);
+                continue;
+
+            case Op::AddInt:
+            case Op::SubInt:
+            case Op::MulInt:
+            case Op::And:
+            case Op::Or:
+            case Op::Xor:
+                as.LoadRax(ip.b);
+                as.LoadRcx(ip.c);
+                switch (ip.op) {
+                    case Op::AddInt: as.Emit({0x48, 0x01, 0xC8}); break;
+                    case Op::SubInt: as.Emit({0x48, 0x29, 0xC8}); break;
+                    case Op::MulInt: as.Emit({0x48, 0x0F, 0xAF, 0xC1}); break;
+                    case Op::And: as.Emit({0x48, 0x21, 0xC8}); break;
+                    case Op::Or: as.Emit({0x48, 0x09, 0xC8}); break;
+                    default: as.Emit({0x48, 0x31, 0xC8}); break;
+                }
+                as.StoreRax(ip.a);
+                continue;
+            case Op::DivInt:
+            case Op::ModInt:
+                // A zero divisor fails and -1 may overflow idiv, both are
+                // left to the interpreter
+                as.LoadRcx(ip.c);
+                as.Emit({0x48, 0x85, 0xC9});
+                guard({0x0F, 0x84}, i);
+                as.Emit({0x48, 0x83, 0xF9, 0xFF});
+                guard({0x0F, 0x84}, i);
+                as.LoadRax(ip.b);
+                as.Emit({0x48, 0x99, 0x48, 0xF7, 0xF9});
+                if (ip.op == Op::DivInt) {
+                    as.StoreRax(ip.a);
+                } else {
+                    as.StoreRdx(ip.a);
+                }
+                continue;
+            case Op::NegInt:
+                as.LoadRax(ip.b);
+                as.Emit({0x48, 0xF7, 0xD8});
+                as.StoreRax(ip.a);
+                continue;
+            case Op::Not:
+                // xor ecx, ecx; test rax, rax; sete cl
+                as.LoadRax(ip.b);
+                as.Emit({0x31, 0xC9, 0x48, 0x85, 0xC0, 0x0F, 0x94, 0xC1});
+                as.StoreRcx(ip.a);
+                continue;
+
+            case Op::AddFloat:
+            case Op::SubFloat:
+            case Op::MulFloat:
+            case Op::DivFloat: {
+                static const uint8_t OPCODES[] = {0x58, 0x5C, 0x59, 0x5E};
+                as.LoadXmm0(ip.b);
+                as.Register({0xF2, 0x0F,
+                             OPCODES[static_cast<size_t>(ip.op) -
+                                     static_cast<size_t>(Op::AddFloat)]},
+                            0, ip.c);
+                as.StoreXmm0(ip.a);
+                continue;
+            }
+            case Op::NegFloat:
+                // btc rax, 63 flips the sign, NaNs included
+                as.LoadRax(ip.b);
+                as.Emit({0x48, 0x0F, 0xBA, 0xF8, 0x3F});
+                as.StoreRax(ip.a);
+                continue;
+            case Op::IntToFloat:
+                as.Register({0xF2, 0x48, 0x0F, 0x2A}, 0, ip.b);
+                as.StoreXmm0(ip.a);
+                continue;
+
+            case Op::EqInt:
+            case Op::NeInt:
+            case Op::LtInt:
+            case Op::LeInt:
+            case Op::GtInt:
+            case Op::GeInt:
+            case Op::EqFloat:
+            case Op::NeFloat:
+            case Op::LtFloat:
+            case Op::LeFloat:
+            case Op::GtFloat:
+            case Op::GeFloat:
+                EmitCompare(as, ip.op, ip);
+                continue;
+
+            case Op::Load:
+                // test rax, rax; a null pointer is the interpreter's error
+                as.LoadRax(ip.b);
+                as.Emit({0x48, 0x85, 0xC0});
+                guard({0x0F, 0x84}, i);
+                as.Emit({0x48, 0x8B, 0x00});
+                as.StoreRax(ip.a);
+                continue;
+            case Op::Store:
+                // Pointer stores may need the collector's barrier
+                if (ip.c) break;
+                as.LoadRax(ip.a);
+                as.Emit({0x48, 0x85, 0xC0});
+                guard({0x0F, 0x84}, i);
+                as.LoadRcx(ip.b);
+                as.Emit({0x48, 0x89, 0x08});
+                continue;
+            case Op::AddressOf:
+                as.Register({0x48, 0x8D}, 0, ip.b);
+                as.StoreRax(ip.a);
+                continue;
+
+            default:
+                break;
+        }
+
+        // mov rdi, r13; mov esi, i; call VM::_JitStep; test eax, eax and
+        // leave if the step stopped
+        stepped++;
+        as.Emit({0x4C, 0x89, 0xEF, 0xBE});
+        as.Emit32(static_cast<uint32_t>(i));
+        as.Emit({0x48, 0xB8});
+        as.Emit64(reinterpret_cast<uint64_t>(&VM::_JitStep));
+        as.Emit({0xFF, 0xD0, 0x85, 0xC0});
+        guard({0x0F, 0x85}, i);
+    }
+
+    // Past the last instruction, then the common return
+    entries[count] = static_cast<uint32_t>(as.Size());
+    as.Emit({0xB8});
+    as.Emit32(static_cast<uint32_t>(count));
+    size_t epilogue = as.Size();
+    as.Emit({0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+
+    for (size_t at : halts) as.Patch(at, epilogue);
+    for (auto [at, index] : exits) {
+        as.Patch(at, as.Size());
+        as.Emit({0xB8});
+        as.Emit32(index);
+        as.Patch(as.Jump({0xE9}), epilogue);
+    }
+
+    // Written, then made executable and no longer writable
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (as.Size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    std::memcpy(memory, as.Data(), as.Size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<NativeCode>(new NativeCode(
+        static_cast<char*>(memory), size, as.Size(), std::move(entries),
+        stepped));
+}
+
+bool Jit::Supported() { return true; }
+
+size_t NativeCode::Run(Value* registers, const Value* constants, VM* vm,
+                       size_t start) const {
+    auto entry = reinterpret_cast<Entry>(_memory);
+    return entry(registers, constants, vm, _memory + _entries[start]);
+}
+
+NativeCode::~NativeCode() { munmap(_memory, _size); }
+
+#else
+
+std::unique_ptr<NativeCode> Jit::Compile(const Chunk&) { return nullptr; }
+
+bool Jit::Supported() { return false; }
+
+size_t NativeCode::Run(Value*, const Value*, VM*, size_t start) const {
+    return start;
+}
+
+NativeCode::~NativeCode() {}
+
+#endif
+
+const NativeCode* Jit::Prepare(const Chunk& chunk) {
+    if (chunk.native) return chunk.native.get();
+    if (!Supported() || chunk.runs++ < _options.threshold) return nullptr;
+
+    uint64_t start = Now();
+    std::shared_ptr<const NativeCode> native = Compile(chunk);
+    if (!native) return nullptr;
+    _stats.compile_ns += Now() - start;
+    _stats.chunks_compiled++;
+    _stats.instructions_compiled += chunk.code.size();
+    _stats.instructions_stepped += native->Stepped();
+    _stats.code_bytes += native->Size();
+
+    chunk.native = std::move(native);
+    return chunk.native.get();
+}
+
+void Jit::RecordRun(bool native, size_t instructions, uint64_t ns) {
+    if (native) {
+        _stats.native_runs++;
+        _stats.native_instructions += instructions;
+        _stats.native_ns += ns;
+    } else {
+        _stats.interpreted_runs++;
+        _stats.interpreted_instructions += instructions;
+        _stats.interpreted_ns += ns;
+    }
+}
+
+double Jit::Speedup() const {
+    if (!_stats.interpreted_instructions || !_stats.native_instructions ||
+        !_stats.native_ns) {
+        return 0;
+    }
+    double interpreted = static_cast<double>(_stats.interpreted_ns) /
+                         static_cast<double>(_stats.interpreted_instructions);
+    double native = static_cast<double>(_stats.native_ns) /
+                    static_cast<double>(_stats.native_instructions);
+    return interpreted / native;
+}
+
+void Jit::Report(std::ostream& out) const {
+    out << "JIT statistics:" << std::endl
+        << "  chunks compiled: " << _stats.chunks_compiled
+        << ", instructions: " << _stats.instructions_compiled
+        << ", stepped: " << _stats.instructions_stepped << std::endl
+        << "  code bytes: " << _stats.code_bytes
+        << ", compile time: " << _stats.compile_ns / 1000 << " us"
+        << std::endl
+        << "  interpreted runs: " << _stats.interpreted_runs
+        << ", native runs: " << _stats.native_runs
+        << ", deopts: " << _stats.deopts << std::endl;
+
+    double speedup = Speedup();
+    if (speedup > 0) {
+        out << "  speedup: " << speedup << "x" << std::endl;
+    } else {
+        out << "  speedup: unknown until both tiers ran" << std::endl;
+    }
+}
+
+}  // namespace runtime
+}  // namespace flecha
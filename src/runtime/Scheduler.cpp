@@ -0,0 +1,103 @@
+#include "runtime/Scheduler.hpp"
+
+#include <stdexcept>
+
+#include "utils/Trace.hpp"
+
+namespace flecha {
+namespace runtime {
+
+/**
+ * @brief A task: its VM, and the waiter it parks on channels
+ */
+struct Scheduler::Task : stdlib::Waiter {
+    Scheduler* scheduler;
+    VM vm;
+
+    explicit Task(Scheduler* owner) : scheduler(owner), vm(nullptr, owner) {
+        wake = &Scheduler::_Wake;
+    }
+};
+
+/* PRIVATE METHODS */
+
+void Scheduler::_Queue(Task* task) {
+    _pool.Submit([this, task](size_t) { _Resume(task); });
+}
+
+/**
+ * @brief Runs a task on the current worker until it halts or parks
+ *
+ * Once parked, the task may be resumed on another worker right away, so
+ * it is not touched after a successful Park.
+ *
+ * @param task - The task
+ */
+void Scheduler::_Resume(Task* task) {
+    try {
+        while (task->vm.Resume(*_chunk) == VM::Status::Blocked) {
+            stdlib::Channel* channel = task->vm.BlockedOn();
+            if (channel->Park(task, task->vm.BlockedSending())) return;
+            // The channel got ready since the VM stopped, try again
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_error) _error = std::current_exception();
+    }
+    _live.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void Scheduler::_Wake(stdlib::Waiter* waiter) {
+    Task* task = static_cast<Task*>(waiter);
+    task->scheduler->_Queue(task);
+}
+
+/* PUBLIC METHODS */
+
+Scheduler::Scheduler(size_t threads)
+    : _chunk(nullptr), _live(0), _pool(threads) {}
+
+Scheduler::~Scheduler() = default;
+
+void Scheduler::Run(const Chunk& chunk) {
+    FLECHA_TRACE_SCOPE(trace, "Run tasks", "runtime");
+    _tasks.clear();
+    _chunk = &chunk;
+    _error = nullptr;
+    // Tasks an error left parked are dropped with the last run
+    _live.store(0, std::memory_order_relaxed);
+
+    Spawn(0, nullptr);
+    _pool.Wait();
+
+    trace.Arg("tasks", _tasks.size());
+    if (_error) std::rethrow_exception(_error);
+    if (_live.load(std::memory_order_acquire)) {
+        // Nothing runs, so nothing can wake them
+        throw std::runtime_error(
+            "Runtime Error: Every task left waits on a channel.");
+    }
+}
+
+void Scheduler::Spawn(size_t entry, const Value* registers) {
+    Task* task;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _tasks.push_back(std::make_unique<Task>(this));
+        task = _tasks.back().get();
+    }
+    task->vm.Start(*_chunk, entry, registers);
+    _live.fetch_add(1, std::memory_order_relaxed);
+    _Queue(task);
+}
+
+Value Scheduler::Get(const Chunk& chunk, std::string_view name) const {
+    if (_tasks.empty()) {
+        throw std::runtime_error("Runtime Error: No run to read " +
+                                 string(name) + " from.");
+    }
+    return _tasks.front()->vm.Get(chunk, name);
+}
+
+}  // namespace runtime
+}  // namespace flecha
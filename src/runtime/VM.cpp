@@ -0,0 +1,503 @@
+#include "runtime/VM.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "core/Arithmetic.hpp"
+#include "memory/Heap.hpp"
+#include "memory/MemStats.hpp"
+#include "runtime/Jit.hpp"
+#include "runtime/Scheduler.hpp"
+#include "std/Atomic.hpp"
+#include "std/Kernels.hpp"
+#include "utils/Trace.hpp"
+
+#if defined(__GNUC__)
+#define FLECHA_COMPUTED_GOTO 1
+#endif
+
+namespace flecha {
+namespace runtime {
+
+/**
+ * @brief Raises a run time error at an instruction
+ *
+ * @param chunk - The running chunk
+ * @param ip - The failing instruction
+ * @param message - What went wrong
+ */
+[[noreturn]] static void Fail(const Chunk& chunk, const Instruction* ip,
+                              const char* message) {
+    core::SourceLocation at = chunk.locations[ip - chunk.code.data()];
+    throw std::runtime_error(string("Runtime Error: ") + message +
+                             " at line " + std::to_string(at.line) +
+                             ", column " + std::to_string(at.column) + ".");
+}
+
+using core::PowInt;
+using core::WrapInt;
+
+/**
+ * @brief Reads the count operand of an intrinsic
+ *
+ * @param chunk - The running chunk
+ * @param ip - The intrinsic
+ * @param count - The operand
+ *
+ * @return The count, fails if it is negative
+ */
+static size_t CountOf(const Chunk& chunk, const Instruction* ip,
+                      Value count) {
+    if (count.i < 0) Fail(chunk, ip, "Negative count");
+    return static_cast<size_t>(count.i);
+}
+
+/**
+ * @brief Reads the buffer operand of an intrinsic
+ *
+ * @param chunk - The running chunk
+ * @param ip - The intrinsic
+ * @param buffer - The operand
+ * @param count - How much of it the intrinsic touches
+ *
+ * @return The buffer, fails if it is null and count is not zero
+ */
+template <typename T>
+static T* BufferOf(const Chunk& chunk, const Instruction* ip, Value buffer,
+                   size_t count) {
+    if (!buffer.p && count) Fail(chunk, ip, "Null buffer");
+    return static_cast<T*>(buffer.p);
+}
+
+/**
+ * @brief Reads the channel operand of Send or Receive
+ *
+ * @param chunk - The running chunk
+ * @param ip - The instruction
+ * @param channel - The operand
+ *
+ * @return The channel, fails if it is null
+ */
+static stdlib::Channel* ChannelOf(const Chunk& chunk, const Instruction* ip,
+                                  Value channel) {
+    if (!channel.p) Fail(chunk, ip, "Null channel");
+    return static_cast<stdlib::Channel*>(channel.p);
+}
+
+#ifdef FLECHA_MEM_STATS
+static memory::AllotSite SiteOf(const Chunk& chunk, const Instruction* ip) {
+    core::SourceLocation at = chunk.locations[ip - chunk.code.data()];
+    return memory::AllotSite{at.line, at.column};
+}
+#endif
+
+static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void VM::Run(const Chunk& chunk) {
+    // Straight-line code runs every instruction once
+    FLECHA_TRACE_SCOPE(trace, "Run", "runtime");
+    trace.Rate("instructions", chunk.code.size());
+    if (!_jit) {
+        Start(chunk, 0, nullptr);
+        Resume(chunk);
+        return;
+    }
+
+    uint64_t start = Now();
+    Start(chunk, 0, nullptr);
+    bool native = _native;
+    Resume(chunk);
+    _jit->RecordRun(native, chunk.code.size(), Now() - start);
+}
+
+void VM::Start(const Chunk& chunk, size_t entry, const Value* registers) {
+    if (registers) {
+        _registers.assign(registers, registers + chunk.registers);
+    } else {
+        _registers.assign(chunk.registers, Value{0});
+    }
+    _channels.clear();
+    _ip = entry;
+    _blocked_on = nullptr;
+    _native = _jit ? _jit->Prepare(chunk) : nullptr;
+
+    if (_collector) {
+        _roots.clear();
+        for (const Global& global : chunk.globals) {
+            if (global.kind == ValueKind::Pointer) _roots.push_back(global.reg);
+        }
+    }
+}
+
+/**
+ * @brief Interprets from the saved instruction until a Halt or a blocked
+ * channel
+ *
+ * A blocked Send or Receive saves its own index, so it runs again next
+ * time. SINGLE runs one instruction for native code, then returns Halted
+ * with the index of the next one saved.
+ *
+ * @param chunk - The chunk
+ *
+ * @return Whether it halted or blocked
+ */
+template <bool SINGLE>
+VM::Status VM::_Execute(const Chunk& chunk) {
+    if (_ip >= chunk.code.size()) return Status::Halted;
+
+    memory::HeapCache& heap = memory::HeapCache::Local();
+    const stdlib::Kernels& kernels = stdlib::Active();
+
+    memory::Collector* collector = _collector;
+    memory::Roots roots;
+    if (collector) {
+        roots = memory::Roots{reinterpret_cast<void**>(_registers.data()),
+                              _roots.data(), _roots.size()};
+    }
+    const Value* constants = chunk.constants.data();
+    const Instruction* ip = chunk.code.data() + _ip;
+    Value* r = _registers.data();
+
+#ifdef FLECHA_COMPUTED_GOTO
+    static void* const HANDLERS[] = {
+#define FLECHA_OPCODE_LABEL(name) &&op_##name,
+        FLECHA_OPCODES(FLECHA_OPCODE_LABEL)
+#undef FLECHA_OPCODE_LABEL
+    };
+#define DISPATCH() goto* HANDLERS[static_cast<size_t>(ip->op)]
+#define CASE(name) op_##name:
+#else
+#define DISPATCH() goto dispatch
+#define CASE(name) case Op::name:
+#endif
+#define NEXT()                            \
+    do {                                  \
+        ++ip;                             \
+        if (SINGLE) {                     \
+            _ip = ip - chunk.code.data(); \
+            return Status::Halted;        \
+        }                                 \
+        DISPATCH();                       \
+    } while (0)
+
+#define A r[ip->a]
+#define B r[ip->b]
+#define C r[ip->c]
+#define BINARY(name, field, expression) \
+    CASE(name) {                        \
+        int64_t x = B.i, y = C.i;       \
+        (void)x;                        \
+        (void)y;                        \
+        A.field = (expression);         \
+        NEXT();                         \
+    }
+#define REDUCE(name, field, type, kernel)                       \
+    CASE(name) {                                               \
+        size_t count = CountOf(chunk, ip, C);                  \
+        A.field = kernels.kernel(                              \
+            BufferOf<const type>(chunk, ip, B, count), count); \
+        NEXT();                                                \
+    }
+#define BLOCK(channel, sending)          \
+    do {                                 \
+        _ip = ip - chunk.code.data();    \
+        _blocked_on = (channel);         \
+        _blocked_sending = (sending);    \
+        return Status::Blocked;          \
+    } while (0)
+#define FLOAT_BINARY(name, field, expression) \
+    CASE(name) {                              \
+        double x = B.f, y = C.f;              \
+        A.field = (expression);               \
+        NEXT();                               \
+    }
+
+#ifdef FLECHA_COMPUTED_GOTO
+    DISPATCH();
+#else
+dispatch:
+    switch (ip->op) {
+#endif
+
+    CASE(Halt) {
+        _ip = ip - chunk.code.data();
+        return Status::Halted;
+    }
+    CASE(LoadConst) {
+        A = constants[ip->b | static_cast<uint32_t>(ip->c) << 16];
+        NEXT();
+    }
+    CASE(Move) {
+        A = B;
+        NEXT();
+    }
+
+    BINARY(AddInt, i, WrapInt(static_cast<uint64_t>(x) + static_cast<uint64_t>(y)))
+    BINARY(SubInt, i, WrapInt(static_cast<uint64_t>(x) - static_cast<uint64_t>(y)))
+    BINARY(MulInt, i, WrapInt(static_cast<uint64_t>(x) * static_cast<uint64_t>(y)))
+    CASE(DivInt) {
+        int64_t x = B.i, y = C.i;
+        if (y == 0) Fail(chunk, ip, "Division by zero");
+        A.i = y == -1 ? WrapInt(0 - static_cast<uint64_t>(x)) : x / y;
+        NEXT();
+    }
+    CASE(ModInt) {
+        int64_t x = B.i, y = C.i;
+        if (y == 0) Fail(chunk, ip, "Division by zero");
+        A.i = y == -1 ? 0 : x % y;
+        NEXT();
+    }
+    BINARY(PowInt, i, PowInt(x, y))
+    CASE(NegInt) {
+        A.i = WrapInt(0 - static_cast<uint64_t>(B.i));
+        NEXT();
+    }
+
+    FLOAT_BINARY(AddFloat, f, x + y)
+    FLOAT_BINARY(SubFloat, f, x - y)
+    FLOAT_BINARY(MulFloat, f, x * y)
+    FLOAT_BINARY(DivFloat, f, x / y)
+    FLOAT_BINARY(ModFloat, f, std::fmod(x, y))
+    FLOAT_BINARY(PowFloat, f, std::pow(x, y))
+    CASE(NegFloat) {
+        A.f = -B.f;
+        NEXT();
+    }
+    CASE(IntToFloat) {
+        A.f = static_cast<double>(B.i);
+        NEXT();
+    }
+
+    BINARY(EqInt, i, x == y)
+    BINARY(NeInt, i, x != y)
+    BINARY(LtInt, i, x < y)
+    BINARY(LeInt, i, x <= y)
+    BINARY(GtInt, i, x > y)
+    BINARY(GeInt, i, x >= y)
+    FLOAT_BINARY(EqFloat, i, x == y)
+    FLOAT_BINARY(NeFloat, i, x != y)
+    FLOAT_BINARY(LtFloat, i, x < y)
+    FLOAT_BINARY(LeFloat, i, x <= y)
+    FLOAT_BINARY(GtFloat, i, x > y)
+    FLOAT_BINARY(GeFloat, i, x >= y)
+
+    BINARY(And, i, x & y)
+    BINARY(Or, i, x | y)
+    BINARY(Xor, i, x ^ y)
+    CASE(Not) {
+        A.i = B.i == 0;
+        NEXT();
+    }
+
+    CASE(Allot) {
+        memory::Block block;
+        if (collector) {
+            block.address = collector->Allocate(ip->b, ip->c, roots);
+            block.size_class = memory::Heap::ClassOf(ip->b);
+        } else {
+            block = heap.Allocate(ip->b);
+        }
+        A.p = block.address;
+#ifdef FLECHA_MEM_STATS
+        memory::MemStats::Global().RecordAllot(ip->b, block.size_class,
+                                               SiteOf(chunk, ip));
+#endif
+        NEXT();
+    }
+    CASE(Dellot) {
+        if (!A.p) Fail(chunk, ip, "Dellot of a null pointer");
+#ifdef FLECHA_MEM_STATS
+        memory::MemStats::Global().RecordDellot(ip->b, SiteOf(chunk, ip));
+#endif
+        if (collector) {
+            collector->Free(A.p);
+        } else {
+            heap.Free(memory::Block{A.p, memory::Heap::ClassOf(ip->b)});
+        }
+        A.p = nullptr;
+        NEXT();
+    }
+    CASE(Store) {
+        if (!A.p) Fail(chunk, ip, "Write through a null pointer");
+        *static_cast<Value*>(A.p) = B;
+        if (ip->c && collector) collector->Write(A.p, B.p);
+        NEXT();
+    }
+    CASE(Load) {
+        if (!B.p) Fail(chunk, ip, "Read through a null pointer");
+        A = *static_cast<Value*>(B.p);
+        NEXT();
+    }
+    CASE(AddressOf) {
+        A.p = &B;
+        NEXT();
+    }
+
+    CASE(Length) {
+        const char* bytes = BufferOf<const char>(chunk, ip, B, 1);
+        A.i = static_cast<int64_t>(kernels.length(bytes));
+        NEXT();
+    }
+    CASE(Find) {
+        size_t count = CountOf(chunk, ip, A);
+        const char* bytes = BufferOf<const char>(chunk, ip, B, count);
+        size_t index = kernels.find(bytes, count, static_cast<char>(C.i));
+        A.i = index == count ? -1 : static_cast<int64_t>(index);
+        NEXT();
+    }
+    CASE(Compare) {
+        size_t count = CountOf(chunk, ip, A);
+        const char* x = BufferOf<const char>(chunk, ip, B, count);
+        const char* y = BufferOf<const char>(chunk, ip, C, count);
+        size_t index = kernels.compare(x, y, count);
+        if (index == count) {
+            A.i = 0;
+        } else {
+            // Bytes sort unsigned, as memcmp orders them
+            A.i = static_cast<unsigned char>(x[index]) <
+                          static_cast<unsigned char>(y[index])
+                      ? -1
+                      : 1;
+        }
+        NEXT();
+    }
+    CASE(Copy) {
+        size_t count = CountOf(chunk, ip, C);
+        char* to = BufferOf<char>(chunk, ip, A, count);
+        kernels.copy(to, BufferOf<const char>(chunk, ip, B, count), count);
+        if (collector) collector->Dirty(to);
+        NEXT();
+    }
+    CASE(Fill) {
+        size_t count = CountOf(chunk, ip, C);
+        int64_t* to = BufferOf<int64_t>(chunk, ip, A, count);
+        kernels.fill(to, B.i, count);
+        if (collector) collector->Dirty(to);
+        NEXT();
+    }
+    REDUCE(SumInt, i, int64_t, sum_int)
+    REDUCE(MinInt, i, int64_t, min_int)
+    REDUCE(MaxInt, i, int64_t, max_int)
+    REDUCE(SumFloat, f, double, sum_float)
+    REDUCE(MinFloat, f, double, min_float)
+    REDUCE(MaxFloat, f, double, max_float)
+
+    CASE(Spawn) {
+        if (!_scheduler) Fail(chunk, ip, "Spawn without a scheduler");
+        size_t entry = ip->b | static_cast<uint32_t>(ip->c) << 16;
+        if (entry >= chunk.code.size()) Fail(chunk, ip, "Spawn past the code");
+        _scheduler->Spawn(entry, r);
+        NEXT();
+    }
+    CASE(MakeChannel) {
+        if (B.i < 1) Fail(chunk, ip, "Channel without room");
+        _channels.push_back(
+            std::make_unique<stdlib::Channel>(static_cast<size_t>(B.i)));
+        A.p = _channels.back().get();
+        NEXT();
+    }
+    CASE(Send) {
+        stdlib::Channel* channel = ChannelOf(chunk, ip, A);
+        if (!channel->TrySend(B.i)) {
+            if (!_scheduler) Fail(chunk, ip, "Send on a full channel");
+            BLOCK(channel, true);
+        }
+        NEXT();
+    }
+    CASE(Receive) {
+        stdlib::Channel* channel = ChannelOf(chunk, ip, B);
+        if (!channel->TryReceive(A.i)) {
+            if (!_scheduler) Fail(chunk, ip, "Receive on an empty channel");
+            BLOCK(channel, false);
+        }
+        NEXT();
+    }
+    CASE(AtomicAdd) {
+        A.i = stdlib::AtomicAdd(BufferOf<int64_t>(chunk, ip, B, 1), C.i);
+        NEXT();
+    }
+    CASE(AtomicSwap) {
+        A.i = stdlib::AtomicSwap(BufferOf<int64_t>(chunk, ip, B, 1), C.i);
+        NEXT();
+    }
+
+#ifndef FLECHA_COMPUTED_GOTO
+        case Op::Count:
+            break;
+    }
+    Fail(chunk, ip, "Bad opcode");
+#endif
+
+#undef FLOAT_BINARY
+#undef BLOCK
+#undef REDUCE
+#undef BINARY
+#undef C
+#undef B
+#undef A
+#undef NEXT
+#undef CASE
+#undef DISPATCH
+}
+
+VM::Status VM::Resume(const Chunk& chunk) {
+    _blocked_on = nullptr;
+    if (!_native) return _Execute<false>(chunk);
+
+    _running = &chunk;
+    size_t stop = _native->Run(_registers.data(), chunk.constants.data(),
+                               this, _ip);
+    if (_error) {
+        std::exception_ptr error = _error;
+        _error = nullptr;
+        _native = nullptr;
+        std::rethrow_exception(error);
+    }
+    // The step blocked, and saved where
+    if (_blocked_on) return Status::Blocked;
+
+    _ip = stop;
+    if (stop >= chunk.code.size() || chunk.code[stop].op == Op::Halt) {
+        return Status::Halted;
+    }
+    // A guard failed, the interpreter runs what is left
+    _native = nullptr;
+    _jit->RecordDeopt();
+    return _Execute<false>(chunk);
+}
+
+/**
+ * @brief Steps the interpreter for native code, which must not unwind
+ *
+ * @param vm - The VM running native code
+ * @param index - The instruction to run
+ *
+ * @return 0 to go on, 1 if the code must stop: the step blocked or threw,
+ * and the error is kept for Resume
+ */
+int VM::_JitStep(VM* vm, uint32_t index) {
+    vm->_ip = index;
+    try {
+        return vm->_Execute<true>(*vm->_running) == Status::Blocked;
+    } catch (...) {
+        vm->_error = std::current_exception();
+        return 1;
+    }
+}
+
+Value VM::Get(const Chunk& chunk, std::string_view name) const {
+    const Global* global = chunk.Find(name);
+    if (!global) {
+        throw std::runtime_error("Runtime Error: No variable " + string(name) +
+                                 ".");
+    }
+    return _registers[global->reg];
+}
+
+}  // namespace runtime
+}  // namespace flecha
@@ -0,0 +1,81 @@
+#include "std/Channel.hpp"
+
+#include <stdexcept>
+
+namespace flecha {
+namespace stdlib {
+
+/* PRIVATE METHODS */
+
+void Channel::WaitList::Push(Waiter* waiter) {
+    waiter->next = nullptr;
+    if (last) {
+        last->next = waiter;
+    } else {
+        first = waiter;
+    }
+    last = waiter;
+}
+
+Waiter* Channel::WaitList::Pop() {
+    Waiter* waiter = first;
+    if (waiter) {
+        first = waiter->next;
+        if (!first) last = nullptr;
+    }
+    return waiter;
+}
+
+/* PUBLIC METHODS */
+
+Channel::Channel(size_t capacity) : _head(0), _size(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument(
+            "Std Error: A channel needs room for at least one value.");
+    }
+    _values.resize(capacity);
+}
+
+bool Channel::TrySend(int64_t value) {
+    Waiter* receiver;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_size == _values.size()) return false;
+
+        _values[(_head + _size) % _values.size()] = value;
+        _size++;
+        receiver = _receivers.Pop();
+    }
+    if (receiver) receiver->wake(receiver);
+    return true;
+}
+
+bool Channel::TryReceive(int64_t& value) {
+    Waiter* sender;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_size == 0) return false;
+
+        value = _values[_head];
+        _head = (_head + 1) % _values.size();
+        _size--;
+        sender = _senders.Pop();
+    }
+    if (sender) sender->wake(sender);
+    return true;
+}
+
+bool Channel::Park(Waiter* waiter, bool sending) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (sending) {
+        if (_size < _values.size()) return false;
+        _senders.Push(waiter);
+    } else {
+        if (_size > 0) return false;
+        _receivers.Push(waiter);
+    }
+    return true;
+}
+
+}  // namespace stdlib
+}  // namespace flecha
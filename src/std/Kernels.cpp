@@ -0,0 +1,863 @@
+#include "std/Kernels.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FLECHA_KERNELS_X86
+#define TARGET(isa) __attribute__((target(isa)))
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FLECHA_KERNELS_NEON
+#endif
+
+// Length reads whole aligned vectors, which may run past the terminator
+// but never into another page, so it is hidden from AddressSanitizer
+#if defined(__GNUC__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define NO_ASAN
+#endif
+
+namespace flecha {
+namespace stdlib {
+
+/*
+ * Every table is built from the scalar kernels: a vector kernel runs whole
+ * vectors and hands the rest to its scalar counterpart. Vectors are loaded
+ * unaligned, except in Length, which has no count to stop at.
+ */
+
+// Float sums keep one partial sum per index modulo LANES
+static constexpr size_t LANES = 16;
+
+/**
+ * @brief Adds up the partial sums of a float sum, the same way every time
+ *
+ * @param lanes - LANES partial sums
+ *
+ * @return The sum
+ */
+static double CombineLanes(const double* lanes) {
+    double sums[LANES / 2];
+    for (size_t k = 0; k < LANES / 2; k++) sums[k] = lanes[k] + lanes[k + 8];
+    return ((sums[0] + sums[1]) + (sums[2] + sums[3])) +
+           ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+}
+
+static bool Overlap(const char* to, const char* from, size_t count) {
+    return to < from + count && from < to + count;
+}
+
+static int64_t MinOf(int64_t a, int64_t b) { return b < a ? b : a; }
+static int64_t MaxOf(int64_t a, int64_t b) { return b > a ? b : a; }
+// A NaN b leaves a, so NaNs are skipped
+static double MinOf(double a, double b) { return b < a ? b : a; }
+static double MaxOf(double a, double b) { return b > a ? b : a; }
+
+/* SCALAR */
+
+static size_t LengthScalar(const char* bytes) {
+    const char* p = bytes;
+    while (*p) p++;
+    return p - bytes;
+}
+
+static size_t FindScalar(const char* bytes, size_t count, char byte) {
+    for (size_t i = 0; i < count; i++) {
+        if (bytes[i] == byte) return i;
+    }
+    return count;
+}
+
+static size_t CompareScalar(const char* a, const char* b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i] != b[i]) return i;
+    }
+    return count;
+}
+
+static void CopyScalar(char* to, const char* from, size_t count) {
+    std::memmove(to, from, count);
+}
+
+static void FillScalar(int64_t* to, int64_t value, size_t count) {
+    for (size_t i = 0; i < count; i++) to[i] = value;
+}
+
+static int64_t SumIntScalar(const int64_t* values, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) sum += static_cast<uint64_t>(values[i]);
+    return static_cast<int64_t>(sum);
+}
+
+static int64_t MinIntScalar(const int64_t* values, size_t count) {
+    int64_t min = INT64_MAX;
+    for (size_t i = 0; i < count; i++) min = MinOf(min, values[i]);
+    return min;
+}
+
+static int64_t MaxIntScalar(const int64_t* values, size_t count) {
+    int64_t max = INT64_MIN;
+    for (size_t i = 0; i < count; i++) max = MaxOf(max, values[i]);
+    return max;
+}
+
+/**
+ * @brief Sums floats the way the vector kernels do
+ *
+ * @param values - The floats
+ * @param count - How many
+ * @param lanes - Partial sums of the elements before values, whose count
+ * is a multiple of LANES
+ *
+ * @return The sum of both
+ */
+static double SumFloatLanes(const double* values, size_t count,
+                            double* lanes) {
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t k = 0; k < LANES; k++) lanes[k] += values[i + k];
+    }
+
+    double sum = CombineLanes(lanes);
+    for (; i < count; i++) sum += values[i];
+    return sum;
+}
+
+static double SumFloatScalar(const double* values, size_t count) {
+    double lanes[LANES] = {};
+    return SumFloatLanes(values, count, lanes);
+}
+
+static double MinFloatScalar(const double* values, size_t count) {
+    double min = HUGE_VAL;
+    for (size_t i = 0; i < count; i++) min = MinOf(min, values[i]);
+    return min;
+}
+
+static double MaxFloatScalar(const double* values, size_t count) {
+    double max = -HUGE_VAL;
+    for (size_t i = 0; i < count; i++) max = MaxOf(max, values[i]);
+    return max;
+}
+
+static const Kernels SCALAR = {
+    Isa::Scalar,    LengthScalar,   FindScalar,     CompareScalar,
+    CopyScalar,     FillScalar,     SumIntScalar,   MinIntScalar,
+    MaxIntScalar,   SumFloatScalar, MinFloatScalar, MaxFloatScalar,
+};
+
+#if defined(FLECHA_KERNELS_X86)
+
+/* SSE4.2 */
+
+static TARGET("sse4.2") NO_ASAN size_t LengthSse42(const char* bytes) {
+    size_t skip = reinterpret_cast<uintptr_t>(bytes) & 15;
+    const char* p = bytes - skip;
+    __m128i zero = _mm_setzero_si128();
+    uint32_t bits = _mm_movemask_epi8(_mm_cmpeq_epi8(
+                        _mm_load_si128(reinterpret_cast<const __m128i*>(p)),
+                        zero)) >>
+                    skip;
+    if (bits) return __builtin_ctz(bits);
+
+    for (;;) {
+        p += 16;
+        bits = _mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(p)), zero));
+        if (bits) return p - bytes + __builtin_ctz(bits);
+    }
+}
+
+static TARGET("sse4.2") size_t FindSse42(const char* bytes, size_t count,
+                                         char byte) {
+    __m128i needle = _mm_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        uint32_t bits = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (bits) return i + __builtin_ctz(bits);
+    }
+    return i + FindScalar(bytes + i, count - i, byte);
+}
+
+static TARGET("sse4.2") size_t CompareSse42(const char* a, const char* b,
+                                            size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        uint32_t bits = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xFFFF;
+        if (bits) return i + __builtin_ctz(bits);
+    }
+    return i + CompareScalar(a + i, b + i, count - i);
+}
+
+static TARGET("sse4.2") void CopySse42(char* to, const char* from,
+                                       size_t count) {
+    if (Overlap(to, from, count)) return CopyScalar(to, from, count);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(to + i),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i)));
+    }
+    std::memcpy(to + i, from + i, count - i);
+}
+
+static TARGET("sse4.2") void FillSse42(int64_t* to, int64_t value,
+                                       size_t count) {
+    __m128i v = _mm_set1_epi64x(value);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), v);
+    }
+    FillScalar(to + i, value, count - i);
+}
+
+static TARGET("sse4.2") int64_t SumIntSse42(const int64_t* values,
+                                            size_t count) {
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        sum = _mm_add_epi64(
+            sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+    return SumIntScalar(lanes, 2) + SumIntScalar(values + i, count - i);
+}
+
+static TARGET("sse4.2") int64_t MinIntSse42(const int64_t* values,
+                                            size_t count) {
+    __m128i min = _mm_set1_epi64x(INT64_MAX);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i x =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        min = _mm_blendv_epi8(min, x, _mm_cmpgt_epi64(min, x));
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), min);
+    return MinOf(MinIntScalar(lanes, 2), MinIntScalar(values + i, count - i));
+}
+
+static TARGET("sse4.2") int64_t MaxIntSse42(const int64_t* values,
+                                            size_t count) {
+    __m128i max = _mm_set1_epi64x(INT64_MIN);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i x =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        max = _mm_blendv_epi8(max, x, _mm_cmpgt_epi64(x, max));
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), max);
+    return MaxOf(MaxIntScalar(lanes, 2), MaxIntScalar(values + i, count - i));
+}
+
+static TARGET("sse4.2") double SumFloatSse42(const double* values,
+                                             size_t count) {
+    __m128d sum[LANES / 2];
+    for (size_t k = 0; k < LANES / 2; k++) sum[k] = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t k = 0; k < LANES / 2; k++) {
+            sum[k] = _mm_add_pd(sum[k], _mm_loadu_pd(values + i + 2 * k));
+        }
+    }
+
+    double lanes[LANES];
+    for (size_t k = 0; k < LANES / 2; k++) _mm_storeu_pd(lanes + 2 * k, sum[k]);
+    return SumFloatLanes(values + i, count - i, lanes);
+}
+
+// _mm_min_pd(x, m) is x < m ? x : m, the scalar MinOf(m, x)
+static TARGET("sse4.2") double MinFloatSse42(const double* values,
+                                             size_t count) {
+    __m128d min = _mm_set1_pd(HUGE_VAL);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        min = _mm_min_pd(_mm_loadu_pd(values + i), min);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, min);
+    return MinOf(MinFloatScalar(lanes, 2),
+                 MinFloatScalar(values + i, count - i));
+}
+
+static TARGET("sse4.2") double MaxFloatSse42(const double* values,
+                                             size_t count) {
+    __m128d max = _mm_set1_pd(-HUGE_VAL);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        max = _mm_max_pd(_mm_loadu_pd(values + i), max);
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, max);
+    return MaxOf(MaxFloatScalar(lanes, 2),
+                 MaxFloatScalar(values + i, count - i));
+}
+
+static const Kernels SSE42 = {
+    Isa::Sse42,    LengthSse42,   FindSse42,     CompareSse42,
+    CopySse42,     FillSse42,     SumIntSse42,   MinIntSse42,
+    MaxIntSse42,   SumFloatSse42, MinFloatSse42, MaxFloatSse42,
+};
+
+/* AVX2 */
+
+static TARGET("avx2") NO_ASAN size_t LengthAvx2(const char* bytes) {
+    size_t skip = reinterpret_cast<uintptr_t>(bytes) & 31;
+    const char* p = bytes - skip;
+    __m256i zero = _mm256_setzero_si256();
+    uint32_t bits =
+        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(p)), zero))) >>
+        skip;
+    if (bits) return __builtin_ctz(bits);
+
+    for (;;) {
+        p += 32;
+        bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(p)), zero)));
+        if (bits) return p - bytes + __builtin_ctz(bits);
+    }
+}
+
+static TARGET("avx2") size_t FindAvx2(const char* bytes, size_t count,
+                                      char byte) {
+    __m256i needle = _mm256_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        uint32_t bits = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (bits) return i + __builtin_ctz(bits);
+    }
+    return i + FindScalar(bytes + i, count - i, byte);
+}
+
+static TARGET("avx2") size_t CompareAvx2(const char* a, const char* b,
+                                         size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        uint32_t bits = ~static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (bits) return i + __builtin_ctz(bits);
+    }
+    return i + CompareScalar(a + i, b + i, count - i);
+}
+
+static TARGET("avx2") void CopyAvx2(char* to, const char* from,
+                                    size_t count) {
+    if (Overlap(to, from, count)) return CopyScalar(to, from, count);
+
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(to + i),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i)));
+    }
+    std::memcpy(to + i, from + i, count - i);
+}
+
+static TARGET("avx2") void FillAvx2(int64_t* to, int64_t value,
+                                    size_t count) {
+    __m256i v = _mm256_set1_epi64x(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), v);
+    }
+    FillScalar(to + i, value, count - i);
+}
+
+static TARGET("avx2") int64_t SumIntAvx2(const int64_t* values,
+                                         size_t count) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum = _mm256_add_epi64(
+            sum,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return SumIntScalar(lanes, 4) + SumIntScalar(values + i, count - i);
+}
+
+static TARGET("avx2") int64_t MinIntAvx2(const int64_t* values,
+                                         size_t count) {
+    __m256i min = _mm256_set1_epi64x(INT64_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        min = _mm256_blendv_epi8(min, x, _mm256_cmpgt_epi64(min, x));
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), min);
+    return MinOf(MinIntScalar(lanes, 4), MinIntScalar(values + i, count - i));
+}
+
+static TARGET("avx2") int64_t MaxIntAvx2(const int64_t* values,
+                                         size_t count) {
+    __m256i max = _mm256_set1_epi64x(INT64_MIN);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        max = _mm256_blendv_epi8(max, x, _mm256_cmpgt_epi64(x, max));
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), max);
+    return MaxOf(MaxIntScalar(lanes, 4), MaxIntScalar(values + i, count - i));
+}
+
+static TARGET("avx2") double SumFloatAvx2(const double* values,
+                                          size_t count) {
+    __m256d sum[LANES / 4];
+    for (size_t k = 0; k < LANES / 4; k++) sum[k] = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t k = 0; k < LANES / 4; k++) {
+            sum[k] = _mm256_add_pd(sum[k], _mm256_loadu_pd(values + i + 4 * k));
+        }
+    }
+
+    double lanes[LANES];
+    for (size_t k = 0; k < LANES / 4; k++) {
+        _mm256_storeu_pd(lanes + 4 * k, sum[k]);
+    }
+    return SumFloatLanes(values + i, count - i, lanes);
+}
+
+static TARGET("avx2") double MinFloatAvx2(const double* values,
+                                          size_t count) {
+    __m256d min = _mm256_set1_pd(HUGE_VAL);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        min = _mm256_min_pd(_mm256_loadu_pd(values + i), min);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, min);
+    return MinOf(MinFloatScalar(lanes, 4),
+                 MinFloatScalar(values + i, count - i));
+}
+
+static TARGET("avx2") double MaxFloatAvx2(const double* values,
+                                          size_t count) {
+    __m256d max = _mm256_set1_pd(-HUGE_VAL);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        max = _mm256_max_pd(_mm256_loadu_pd(values + i), max);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, max);
+    return MaxOf(MaxFloatScalar(lanes, 4),
+                 MaxFloatScalar(values + i, count - i));
+}
+
+static const Kernels AVX2 = {
+    Isa::Avx2,    LengthAvx2,   FindAvx2,     CompareAvx2,
+    CopyAvx2,     FillAvx2,     SumIntAvx2,   MinIntAvx2,
+    MaxIntAvx2,   SumFloatAvx2, MinFloatAvx2, MaxFloatAvx2,
+};
+
+/* AVX-512 */
+
+#define TARGET_AVX512 TARGET("avx512f,avx512bw")
+
+static TARGET_AVX512 NO_ASAN size_t LengthAvx512(const char* bytes) {
+    size_t skip = reinterpret_cast<uintptr_t>(bytes) & 63;
+    const char* p = bytes - skip;
+    __m512i zero = _mm512_setzero_si512();
+    uint64_t bits = _mm512_cmpeq_epi8_mask(_mm512_load_si512(p), zero) >> skip;
+    if (bits) return __builtin_ctzll(bits);
+
+    for (;;) {
+        p += 64;
+        bits = _mm512_cmpeq_epi8_mask(_mm512_load_si512(p), zero);
+        if (bits) return p - bytes + __builtin_ctzll(bits);
+    }
+}
+
+static TARGET_AVX512 size_t FindAvx512(const char* bytes, size_t count,
+                                       char byte) {
+    __m512i needle = _mm512_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        uint64_t bits =
+            _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(bytes + i), needle);
+        if (bits) return i + __builtin_ctzll(bits);
+    }
+    return i + FindScalar(bytes + i, count - i, byte);
+}
+
+static TARGET_AVX512 size_t CompareAvx512(const char* a, const char* b,
+                                          size_t count) {
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        uint64_t bits = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a + i),
+                                                _mm512_loadu_si512(b + i));
+        if (bits) return i + __builtin_ctzll(bits);
+    }
+    return i + CompareScalar(a + i, b + i, count - i);
+}
+
+static TARGET_AVX512 void CopyAvx512(char* to, const char* from, size_t count) {
+    if (Overlap(to, from, count)) return CopyScalar(to, from, count);
+
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64) {
+        _mm512_storeu_si512(to + i, _mm512_loadu_si512(from + i));
+    }
+    std::memcpy(to + i, from + i, count - i);
+}
+
+static TARGET_AVX512 void FillAvx512(int64_t* to, int64_t value, size_t count) {
+    __m512i v = _mm512_set1_epi64(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) _mm512_storeu_si512(to + i, v);
+    FillScalar(to + i, value, count - i);
+}
+
+static TARGET_AVX512 int64_t SumIntAvx512(const int64_t* values, size_t count) {
+    __m512i sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sum = _mm512_add_epi64(sum, _mm512_loadu_si512(values + i));
+    }
+
+    int64_t lanes[8];
+    _mm512_storeu_si512(lanes, sum);
+    return SumIntScalar(lanes, 8) + SumIntScalar(values + i, count - i);
+}
+
+static TARGET_AVX512 int64_t MinIntAvx512(const int64_t* values, size_t count) {
+    __m512i min = _mm512_set1_epi64(INT64_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        min = _mm512_min_epi64(min, _mm512_loadu_si512(values + i));
+    }
+
+    int64_t lanes[8];
+    _mm512_storeu_si512(lanes, min);
+    return MinOf(MinIntScalar(lanes, 8), MinIntScalar(values + i, count - i));
+}
+
+static TARGET_AVX512 int64_t MaxIntAvx512(const int64_t* values, size_t count) {
+    __m512i max = _mm512_set1_epi64(INT64_MIN);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        max = _mm512_max_epi64(max, _mm512_loadu_si512(values + i));
+    }
+
+    int64_t lanes[8];
+    _mm512_storeu_si512(lanes, max);
+    return MaxOf(MaxIntScalar(lanes, 8), MaxIntScalar(values + i, count - i));
+}
+
+static TARGET_AVX512 double SumFloatAvx512(const double* values, size_t count) {
+    __m512d low = _mm512_setzero_pd(), high = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        low = _mm512_add_pd(low, _mm512_loadu_pd(values + i));
+        high = _mm512_add_pd(high, _mm512_loadu_pd(values + i + 8));
+    }
+
+    double lanes[LANES];
+    _mm512_storeu_pd(lanes, low);
+    _mm512_storeu_pd(lanes + 8, high);
+    return SumFloatLanes(values + i, count - i, lanes);
+}
+
+static TARGET_AVX512 double MinFloatAvx512(const double* values, size_t count) {
+    __m512d min = _mm512_set1_pd(HUGE_VAL);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        min = _mm512_min_pd(_mm512_loadu_pd(values + i), min);
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, min);
+    return MinOf(MinFloatScalar(lanes, 8),
+                 MinFloatScalar(values + i, count - i));
+}
+
+static TARGET_AVX512 double MaxFloatAvx512(const double* values, size_t count) {
+    __m512d max = _mm512_set1_pd(-HUGE_VAL);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        max = _mm512_max_pd(_mm512_loadu_pd(values + i), max);
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, max);
+    return MaxOf(MaxFloatScalar(lanes, 8),
+                 MaxFloatScalar(values + i, count - i));
+}
+
+#undef TARGET_AVX512
+
+static const Kernels AVX512 = {
+    Isa::Avx512,    LengthAvx512,   FindAvx512,     CompareAvx512,
+    CopyAvx512,     FillAvx512,     SumIntAvx512,   MinIntAvx512,
+    MaxIntAvx512,   SumFloatAvx512, MinFloatAvx512, MaxFloatAvx512,
+};
+
+#elif defined(FLECHA_KERNELS_NEON)
+
+/* NEON */
+
+// Four bits per byte of a byte-wise compare, there is no movemask
+static inline uint64_t ByteBits(uint8x16_t match) {
+    return vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+}
+
+static inline uint8x16_t LoadBytes(const char* p) {
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+}
+
+static NO_ASAN size_t LengthNeon(const char* bytes) {
+    size_t skip = reinterpret_cast<uintptr_t>(bytes) & 15;
+    const char* p = bytes - skip;
+    uint8x16_t zero = vdupq_n_u8(0);
+    uint64_t bits = ByteBits(vceqq_u8(LoadBytes(p), zero)) >> (skip * 4);
+    if (bits) return __builtin_ctzll(bits) / 4;
+
+    for (;;) {
+        p += 16;
+        bits = ByteBits(vceqq_u8(LoadBytes(p), zero));
+        if (bits) return p - bytes + __builtin_ctzll(bits) / 4;
+    }
+}
+
+static size_t FindNeon(const char* bytes, size_t count, char byte) {
+    uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(byte));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint64_t bits = ByteBits(vceqq_u8(LoadBytes(bytes + i), needle));
+        if (bits) return i + __builtin_ctzll(bits) / 4;
+    }
+    return i + FindScalar(bytes + i, count - i, byte);
+}
+
+static size_t CompareNeon(const char* a, const char* b, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint64_t bits =
+            ~ByteBits(vceqq_u8(LoadBytes(a + i), LoadBytes(b + i)));
+        if (bits) return i + __builtin_ctzll(bits) / 4;
+    }
+    return i + CompareScalar(a + i, b + i, count - i);
+}
+
+static void CopyNeon(char* to, const char* from, size_t count) {
+    if (Overlap(to, from, count)) return CopyScalar(to, from, count);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(reinterpret_cast<uint8_t*>(to + i), LoadBytes(from + i));
+    }
+    std::memcpy(to + i, from + i, count - i);
+}
+
+static void FillNeon(int64_t* to, int64_t value, size_t count) {
+    int64x2_t v = vdupq_n_s64(value);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) vst1q_s64(to + i, v);
+    FillScalar(to + i, value, count - i);
+}
+
+static int64_t SumIntNeon(const int64_t* values, size_t count) {
+    // Lanes are unsigned so sums wrap
+    uint64x2_t sum = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        sum = vaddq_u64(
+            sum, vld1q_u64(reinterpret_cast<const uint64_t*>(values + i)));
+    }
+
+    int64_t lanes[2];
+    vst1q_u64(reinterpret_cast<uint64_t*>(lanes), sum);
+    return SumIntScalar(lanes, 2) + SumIntScalar(values + i, count - i);
+}
+
+static int64_t MinIntNeon(const int64_t* values, size_t count) {
+    int64x2_t min = vdupq_n_s64(INT64_MAX);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        int64x2_t x = vld1q_s64(values + i);
+        min = vbslq_s64(vcgtq_s64(min, x), x, min);
+    }
+
+    int64_t lanes[2];
+    vst1q_s64(lanes, min);
+    return MinOf(MinIntScalar(lanes, 2), MinIntScalar(values + i, count - i));
+}
+
+static int64_t MaxIntNeon(const int64_t* values, size_t count) {
+    int64x2_t max = vdupq_n_s64(INT64_MIN);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        int64x2_t x = vld1q_s64(values + i);
+        max = vbslq_s64(vcgtq_s64(x, max), x, max);
+    }
+
+    int64_t lanes[2];
+    vst1q_s64(lanes, max);
+    return MaxOf(MaxIntScalar(lanes, 2), MaxIntScalar(values + i, count - i));
+}
+
+static double SumFloatNeon(const double* values, size_t count) {
+    float64x2_t sum[LANES / 2];
+    for (size_t k = 0; k < LANES / 2; k++) sum[k] = vdupq_n_f64(0);
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t k = 0; k < LANES / 2; k++) {
+            sum[k] = vaddq_f64(sum[k], vld1q_f64(values + i + 2 * k));
+        }
+    }
+
+    double lanes[LANES];
+    for (size_t k = 0; k < LANES / 2; k++) vst1q_f64(lanes + 2 * k, sum[k]);
+    return SumFloatLanes(values + i, count - i, lanes);
+}
+
+// vminq_f64 returns NaN for a NaN lane, so compares select instead
+static double MinFloatNeon(const double* values, size_t count) {
+    float64x2_t min = vdupq_n_f64(HUGE_VAL);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t x = vld1q_f64(values + i);
+        min = vbslq_f64(vcltq_f64(x, min), x, min);
+    }
+
+    double lanes[2];
+    vst1q_f64(lanes, min);
+    return MinOf(MinFloatScalar(lanes, 2),
+                 MinFloatScalar(values + i, count - i));
+}
+
+static double MaxFloatNeon(const double* values, size_t count) {
+    float64x2_t max = vdupq_n_f64(-HUGE_VAL);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t x = vld1q_f64(values + i);
+        max = vbslq_f64(vcgtq_f64(x, max), x, max);
+    }
+
+    double lanes[2];
+    vst1q_f64(lanes, max);
+    return MaxOf(MaxFloatScalar(lanes, 2),
+                 MaxFloatScalar(values + i, count - i));
+}
+
+static const Kernels NEON = {
+    Isa::Neon,    LengthNeon,   FindNeon,     CompareNeon,
+    CopyNeon,     FillNeon,     SumIntNeon,   MinIntNeon,
+    MaxIntNeon,   SumFloatNeon, MinFloatNeon, MaxFloatNeon,
+};
+
+#endif
+
+/* DISPATCH */
+
+const char* IsaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Sse42: return "sse4.2";
+        case Isa::Avx2: return "avx2";
+        case Isa::Avx512: return "avx512";
+        case Isa::Neon: return "neon";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Asks the CPU, x86 builds also check the OS saves the registers
+ *
+ * @param isa - The instruction set
+ *
+ * @return True if its kernels can run
+ */
+bool Supports(Isa isa) {
+#if defined(FLECHA_KERNELS_X86)
+    __builtin_cpu_init();
+#endif
+
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#if defined(FLECHA_KERNELS_X86)
+        case Isa::Sse42:
+            return __builtin_cpu_supports("sse4.2");
+        case Isa::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::Avx512:
+            return __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512bw");
+#elif defined(FLECHA_KERNELS_NEON)
+        case Isa::Neon:
+            // Every AArch64 CPU has it
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+Isa BestIsa() {
+    for (Isa isa : {Isa::Avx512, Isa::Avx2, Isa::Sse42, Isa::Neon}) {
+        if (Supports(isa)) return isa;
+    }
+    return Isa::Scalar;
+}
+
+const Kernels& KernelsFor(Isa isa) {
+    if (!Supports(isa)) {
+        throw std::invalid_argument(std::string("Std Error: ") +
+                                    IsaName(isa) +
+                                    " is not supported on this CPU.");
+    }
+
+    switch (isa) {
+#if defined(FLECHA_KERNELS_X86)
+        case Isa::Sse42: return SSE42;
+        case Isa::Avx2: return AVX2;
+        case Isa::Avx512: return AVX512;
+#elif defined(FLECHA_KERNELS_NEON)
+        case Isa::Neon: return NEON;
+#endif
+        default: return SCALAR;
+    }
+}
+
+const Kernels& Active() {
+    static const Kernels& active = KernelsFor(BestIsa());
+    return active;
+}
+
+}  // namespace stdlib
+}  // namespace flecha
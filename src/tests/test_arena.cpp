@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "memory/Arena.hpp"
+
+using flecha::memory::Arena;
+
+TEST(ArenaTests, AllocatesAligned) {
+    Arena arena;
+
+    arena.Allocate(1, 1);
+    void* aligned = arena.Allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arena.Make<double>(1.5)) %
+                  alignof(double),
+              0);
+}
+
+TEST(ArenaTests, ConsecutiveObjectsAreContiguous) {
+    Arena arena;
+
+    int* first = arena.Make<int>(1);
+    int* second = arena.Make<int>(2);
+
+    EXPECT_EQ(second, first + 1);
+    EXPECT_EQ(*first, 1);
+    EXPECT_EQ(*second, 2);
+}
+
+TEST(ArenaTests, GrowsPastChunkSize) {
+    Arena arena(256);
+
+    // Many small allocations and one bigger than a chunk
+    for (int i = 0; i < 1000; i++) *arena.Make<int>(i) = i;
+    char* big = static_cast<char*>(arena.Allocate(4096, 1));
+    big[0] = big[4095] = 'x';
+
+    EXPECT_EQ(arena.BytesUsed(), 1000 * sizeof(int) + 4096);
+}
+
+TEST(ArenaTests, ResetReusesMemory) {
+    Arena arena(1024);
+
+    void* first = arena.Allocate(100);
+    for (int i = 0; i < 50; i++) arena.Allocate(100);
+    arena.Reset();
+
+    EXPECT_EQ(arena.BytesUsed(), 0);
+    EXPECT_EQ(arena.Allocate(100), first);
+}
+
+TEST(ArenaTests, CopiesStrings) {
+    Arena arena;
+    std::string original = "package_name";
+
+    std::string_view copy = arena.CopyString(original);
+    original[0] = 'X';
+
+    EXPECT_EQ(copy, "package_name");
+    EXPECT_TRUE(arena.CopyString("").empty());
+}
+
+TEST(ArenaTests, MakesValueInitializedArrays) {
+    Arena arena;
+
+    int* values = arena.MakeArray<int>(16);
+    for (int i = 0; i < 16; i++) EXPECT_EQ(values[i], 0);
+}
+
+TEST(ArenaTests, MoveTransfersChunks) {
+    Arena arena;
+    int* value = arena.Make<int>(7);
+
+    Arena moved(std::move(arena));
+    EXPECT_EQ(*value, 7);
+    EXPECT_EQ(moved.BytesUsed(), sizeof(int));
+    EXPECT_EQ(arena.BytesUsed(), 0);
+}
@@ -1,22 +1,26 @@
 #include <gtest/gtest.h>
 
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
 #include "core/AST.hpp"
+#include "memory/Arena.hpp"
 
 using namespace flecha::core;
+using flecha::memory::Arena;
 
 /* LOCATION NODE */
 
 TEST(ASTLocationTests, TestLocationNode) {
+    Arena arena;
     /* :main
      *
      * int! var = allot(int);
      */
-    StartNode* start = new StartNode(1, 5);
-    EndNode* end = new EndNode(3, 22);
-    LocationNode* location = new LocationNode(start, end);
+    StartNode* start = arena.Make<StartNode>(1, 5);
+    EndNode* end = arena.Make<EndNode>(3, 22);
+    LocationNode* location = arena.Make<LocationNode>(start, end);
 
     // Validate start node
     ASSERT_EQ(start->line, 1);
@@ -25,61 +29,63 @@ TEST(ASTLocationTests, TestLocationNode) {
     ASSERT_EQ(end->line, 3);
     ASSERT_EQ(end->column, 22);
 
-    delete location;
+    ASSERT_EQ(location->start, start);
+    ASSERT_EQ(location->end, end);
 }
 
-TEST(ASTLocationTests, LocationDestructorReleaseMemory) {
-    StartNode* start = new StartNode(1, 2);
-    EndNode* end = new EndNode(2, 4);
+TEST(ASTLocationTests, ArenaResetReleasesLocation) {
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(1, 2);
+    EndNode* end = arena.Make<EndNode>(2, 4);
 
-    LocationNode* location = new LocationNode(start, end);
+    arena.Make<LocationNode>(start, end);
+    ASSERT_GT(arena.BytesUsed(), 0);
 
-    ASSERT_NO_THROW(delete location);
+    ASSERT_NO_THROW(arena.Reset());
+    ASSERT_EQ(arena.BytesUsed(), 0);
 }
 
 /* RANGE NODE */
 
 TEST(ASTRangeTests, RangeConstructorAndAccessor) {
-    RangeNode* range = new RangeNode(0, 33);
+    Arena arena;
+    RangeNode* range = arena.Make<RangeNode>(0, 33);
 
     ASSERT_EQ(range->range.first, 0);
     ASSERT_EQ(range->range.second, 33);
-
-    delete range;
 }
 
 /* TYPE NODE */
 
 TEST(ASTPrimitiveType, PrimitiveTypeConstructorAndFunctions) {
-    PrimitiveTypeNode* type = new PrimitiveTypeNode("int!");
+    Arena arena;
+    PrimitiveTypeNode* type = arena.Make<PrimitiveTypeNode>("int!");
 
-    string got_name = type->GetTypeName();
+    std::string_view got_name = type->GetTypeName();
     bool got_type = type->IsPrimitive();
 
     ASSERT_EQ(got_name, "int!");
     ASSERT_EQ(got_type, true);
-
-    delete type;
 }
 
 TEST(ASTUserDefinedType, UserDefinedTypeConstructorAndFunctions) {
-    UserDefinedTypeNode* type = new UserDefinedTypeNode("MyType!");
+    Arena arena;
+    UserDefinedTypeNode* type = arena.Make<UserDefinedTypeNode>("MyType!");
 
-    string got_name = type->GetTypeName();
+    std::string_view got_name = type->GetTypeName();
     bool got_type = type->IsPrimitive();
 
     ASSERT_EQ(got_name, "MyType!");
     ASSERT_EQ(got_type, false);
-
-    delete type;
 }
 
 /* MEMORY NODE */
 
 TEST(ASTMemoryNode, MemoryAllocateTest) {
-    StartNode* start = new StartNode(0, 1);
-    EndNode* end = new EndNode(2, 5);
-    LocationNode* location = new LocationNode(start, end);
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 1);
+    EndNode* end = arena.Make<EndNode>(2, 5);
+    LocationNode* location = arena.Make<LocationNode>(start, end);
     size_t alloc_size = sizeof(int);
 
     MemoryNode* mem = new MemoryNode(location, alloc_size);
@@ -94,9 +100,10 @@ TEST(ASTMemoryNode, MemoryAllocateTest) {
 }
 
 TEST(ASTMemoryNode, MemoryDestructorTest) {
-    StartNode* start = new StartNode(0, 2);
-    EndNode* end = new EndNode(3, 7);
-    LocationNode* loc = new LocationNode(start, end);
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 2);
+    EndNode* end = arena.Make<EndNode>(3, 7);
+    LocationNode* loc = arena.Make<LocationNode>(start, end);
     size_t alloc_size = sizeof(int);
 
     MemoryNode* mem = new MemoryNode(loc, alloc_size);
@@ -118,14 +125,14 @@ TEST(ASTMemoryNode, MemoryHandlesNullLocation) {
 }
 
 TEST(ASTMemoryNode, MemoryHandlesZeroSizeAllocation) {
-    StartNode* location = new StartNode(1, 1);
+    Arena arena;
+    StartNode* location = arena.Make<StartNode>(1, 1);
 
     // Construct MemoryNode with zero size
     MemoryNode* memoryNode = nullptr;
     ASSERT_NO_THROW(memoryNode = new MemoryNode(location, 0));
 
-    // Verify address is still non-null (malloc often returns valid address for
-    // zero size)
+    // Zero size allots still get a block of the smallest class
     ASSERT_NE(memoryNode->address, nullptr);
 
     delete memoryNode;  // Cleanup
@@ -134,57 +141,56 @@ TEST(ASTMemoryNode, MemoryHandlesZeroSizeAllocation) {
 /* VARIABLE AND VALUES */
 
 TEST(ASTValueNode, ValueAssignment) {
-    StartNode* start = new StartNode(0, 4);
-    EndNode* end = new EndNode(123, 32);
-    LocationNode* loc = new LocationNode(start, end);
-    PrimitiveTypeNode* type = new PrimitiveTypeNode("int!");
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 4);
+    EndNode* end = arena.Make<EndNode>(123, 32);
+    LocationNode* loc = arena.Make<LocationNode>(start, end);
+    PrimitiveTypeNode* type = arena.Make<PrimitiveTypeNode>("int!");
     string val = "24";
 
-    ValueNode* value = new ValueNode(val, loc, type);
-
-    ASSERT_EQ(std::stoi(value->value), 24);
+    ValueNode* value = arena.Make<ValueNode>(val, loc, type);
 
-    delete value;
+    ASSERT_EQ(std::stoi(std::string(value->value)), 24);
 }
 
 TEST(ASTVariableNode, VariableNameTest) {
-    StartNode* start = new StartNode(0, 2);
-    EndNode* end = new EndNode(0, 5);
-    StartNode* start2 = new StartNode(2, 3);
-    EndNode* end2 = new EndNode(4, 2);
-    LocationNode* loc1 = new LocationNode(start, end);
-    LocationNode* loc2 = new LocationNode(start2, end2);
-    PrimitiveTypeNode* type = new PrimitiveTypeNode("int!");
-    ValueNode* value = new ValueNode("32", loc1, type);
-
-    VariableNode* var = new VariableNode("my_var", loc2, value);
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 2);
+    EndNode* end = arena.Make<EndNode>(0, 5);
+    StartNode* start2 = arena.Make<StartNode>(2, 3);
+    EndNode* end2 = arena.Make<EndNode>(4, 2);
+    LocationNode* loc1 = arena.Make<LocationNode>(start, end);
+    LocationNode* loc2 = arena.Make<LocationNode>(start2, end2);
+    PrimitiveTypeNode* type = arena.Make<PrimitiveTypeNode>("int!");
+    ValueNode* value = arena.Make<ValueNode>("32", loc1, type);
+
+    VariableNode* var = arena.Make<VariableNode>("my_var", loc2, value);
 
     ASSERT_EQ(var->name, "my_var");
-
-    delete var;
 }
 
 /* POINTER NODE */
 TEST(ASTPointerNode, PointerNodeConstructor) {
-    StartNode* start = new StartNode(0, 2);
-    EndNode* end = new EndNode(0, 5);
-    StartNode* start2 = new StartNode(3, 4);
-    EndNode* end2 = new EndNode(4, 2);
-    StartNode* start3 = new StartNode(0, 5);
-    EndNode* end3 = new EndNode(0, 8);
-    StartNode* start4 = new StartNode(0, 7);
-    EndNode* end4 = new EndNode(0, 9);
-    LocationNode* loc = new LocationNode(start, end);
-    LocationNode* loc2 = new LocationNode(start2, end2);
-    LocationNode* loc3 = new LocationNode(start3, end3);
-    LocationNode* loc4 = new LocationNode(start4, end4);
-    PrimitiveTypeNode* type = new PrimitiveTypeNode("int!");
-    ValueNode* val = new ValueNode("-12", loc, type);
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 2);
+    EndNode* end = arena.Make<EndNode>(0, 5);
+    StartNode* start2 = arena.Make<StartNode>(3, 4);
+    EndNode* end2 = arena.Make<EndNode>(4, 2);
+    StartNode* start3 = arena.Make<StartNode>(0, 5);
+    EndNode* end3 = arena.Make<EndNode>(0, 8);
+    StartNode* start4 = arena.Make<StartNode>(0, 7);
+    EndNode* end4 = arena.Make<EndNode>(0, 9);
+    LocationNode* loc = arena.Make<LocationNode>(start, end);
+    LocationNode* loc2 = arena.Make<LocationNode>(start2, end2);
+    LocationNode* loc3 = arena.Make<LocationNode>(start3, end3);
+    LocationNode* loc4 = arena.Make<LocationNode>(start4, end4);
+    PrimitiveTypeNode* type = arena.Make<PrimitiveTypeNode>("int!");
+    ValueNode* val = arena.Make<ValueNode>("-12", loc, type);
     MemoryNode* mem = new MemoryNode(loc2, sizeof(int));
-    VariableNode* var = new VariableNode("my_var", loc3, val);
+    VariableNode* var = arena.Make<VariableNode>("my_var", loc3, val);
 
     // Create PointerNode
-    PointerNode* ptr = new PointerNode(loc4, type, mem, var);
+    PointerNode* ptr = arena.Make<PointerNode>(loc4, type, mem, var);
 
     // Validate initialization
     ASSERT_EQ(ptr->location, loc4);
@@ -195,33 +201,37 @@ TEST(ASTPointerNode, PointerNodeConstructor) {
     // Validate type properties
     ASSERT_EQ(type->GetTypeName(), "int!");
 
-    // Cleanup
-    delete ptr;  // Ensure no leaks or crashes during cleanup
+    // Cleanup, the memory is the only node owning anything
+    delete mem;  // Ensure no leaks or crashes during cleanup
 }
 
-TEST(ASTPointerNode, DestructorFreesMemory) {
-    StartNode* start = new StartNode(0, 2);
-    EndNode* end = new EndNode(0, 5);
-    StartNode* start2 = new StartNode(3, 4);
-    EndNode* end2 = new EndNode(4, 2);
-    StartNode* start3 = new StartNode(0, 5);
-    EndNode* end3 = new EndNode(0, 8);
-    StartNode* start4 = new StartNode(0, 7);
-    EndNode* end4 = new EndNode(0, 9);
-    LocationNode* loc = new LocationNode(start, end);
-    LocationNode* loc2 = new LocationNode(start2, end2);
-    LocationNode* loc3 = new LocationNode(start3, end3);
-    LocationNode* loc4 = new LocationNode(start4, end4);
-    PrimitiveTypeNode* type = new PrimitiveTypeNode("int!");
-    ValueNode* val = new ValueNode("-12", loc, type);
+TEST(ASTPointerNode, ArenaResetReleasesPointer) {
+    Arena arena;
+    StartNode* start = arena.Make<StartNode>(0, 2);
+    EndNode* end = arena.Make<EndNode>(0, 5);
+    StartNode* start2 = arena.Make<StartNode>(3, 4);
+    EndNode* end2 = arena.Make<EndNode>(4, 2);
+    StartNode* start3 = arena.Make<StartNode>(0, 5);
+    EndNode* end3 = arena.Make<EndNode>(0, 8);
+    StartNode* start4 = arena.Make<StartNode>(0, 7);
+    EndNode* end4 = arena.Make<EndNode>(0, 9);
+    LocationNode* loc = arena.Make<LocationNode>(start, end);
+    LocationNode* loc2 = arena.Make<LocationNode>(start2, end2);
+    LocationNode* loc3 = arena.Make<LocationNode>(start3, end3);
+    LocationNode* loc4 = arena.Make<LocationNode>(start4, end4);
+    PrimitiveTypeNode* type = arena.Make<PrimitiveTypeNode>("int!");
+    ValueNode* val = arena.Make<ValueNode>("-12", loc, type);
     MemoryNode* mem = new MemoryNode(loc2, sizeof(int));
-    VariableNode* var = new VariableNode("my_var", loc3, val);
+    VariableNode* var = arena.Make<VariableNode>("my_var", loc3, val);
 
     // Create PointerNode
-    PointerNode* ptr = new PointerNode(loc4, type, mem, var);
+    PointerNode* ptr = arena.Make<PointerNode>(loc4, type, mem, var);
 
-    // Validate initialization
-    ASSERT_NO_THROW(delete ptr);  // Ensure proper cleanup
+    ASSERT_EQ(ptr->memory, mem);
+
+    // The memory goes first, the syntax nodes all at once
+    ASSERT_NO_THROW(delete mem);
+    ASSERT_NO_THROW(arena.Reset());
 }
 
 /*  EXPRESSION NODE */
@@ -230,7 +240,31 @@ TEST(ASTPointerNode, DestructorFreesMemory) {
 
 /* BODY NODE  */
 
+TEST(ASTBodyTests, BodyListsExpressionsInArena) {
+    Arena arena;
+    NodeList expressions;
+    expressions.count = 2;
+    expressions.data = arena.MakeArray<ASTNode*>(expressions.count);
+    expressions[0] = arena.Make<PrimitiveTypeNode>("int");
+    expressions[1] = arena.Make<PrimitiveTypeNode>("char");
+
+    BodyNode* body = arena.Make<BodyNode>(nullptr, expressions);
+
+    ASSERT_EQ(body->expressions.size(), 2);
+    ASSERT_EQ(static_cast<TypeNode*>(body->expressions[1])->GetTypeName(),
+              "char");
+}
+
+TEST(ASTBodyTests, NodesAreTriviallyDestructible) {
+    ASSERT_TRUE(std::is_trivially_destructible<ProgramNode>::value);
+    ASSERT_TRUE(std::is_trivially_destructible<BodyNode>::value);
+    ASSERT_TRUE(std::is_trivially_destructible<PointerNode>::value);
+    ASSERT_TRUE(std::is_trivially_destructible<ValueNode>::value);
+    ASSERT_FALSE(std::is_trivially_destructible<MemoryNode>::value);
+}
+
 // TEST(ASTBodyTests, BodyConstructorAndExpressionAccess) {
+    Arena arena;
 //     ASTNode* init = new ProgramInitializationNode(":main");
 //     vector<ASTNode*> expressions;
 //     expressions.push_back(new
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "core/AstCache.hpp"
+#include "core/Frontend.hpp"
+#include "core/Parser.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+static const char* SOURCE =
+    "int a = 1;\n"
+    "char b = 'x';\n"
+    "int! c = allot(int) -> 5;\n"
+    "int d = -(a + 2) * b ** 2;";
+
+// A fresh directory under /tmp, removed with the fixture
+class AstCacheTests : public ::testing::Test {
+   protected:
+    std::string directory;
+
+    void SetUp() override {
+        char path[] = "/tmp/flecha_cache_XXXXXX";
+        ASSERT_NE(mkdtemp(path), nullptr);
+        directory = path;
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    std::string WriteSource(const std::string& name,
+                            const std::string& contents) {
+        std::string path = directory + "/" + name;
+        std::ofstream(path) << contents;
+        return path;
+    }
+};
+
+static FlatAST flattenSource(Arena& arena, std::string_view source) {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer, arena);
+    return Flatten(parser.Parse());
+}
+
+static void expectSameView(const FlatASTView& view, const FlatAST& flat) {
+    ASSERT_EQ(view.Size(), flat.Size());
+    for (NodeIndex i = 0; i < flat.Size(); i++) {
+        EXPECT_EQ(view.kinds[i], flat.kinds[i]);
+        EXPECT_EQ(view.data0[i], flat.data0[i]);
+        EXPECT_EQ(view.data1[i], flat.data1[i]);
+        ASSERT_EQ(view.Children(i).size(), flat.Children(i).size());
+        for (size_t j = 0; j < flat.Children(i).size(); j++) {
+            EXPECT_EQ(view.Children(i)[j], flat.Children(i)[j]);
+        }
+    }
+    EXPECT_EQ(view.text, flat.text);
+}
+
+TEST_F(AstCacheTests, StoredEntriesMapBack) {
+    AstCache cache(directory + "/cache");
+    Arena arena;
+    FlatAST flat = flattenSource(arena, SOURCE);
+    uint64_t hash = AstCache::ContentHash(SOURCE);
+
+    ASSERT_TRUE(cache.Store("main.fl", hash, flat));
+    auto entry = cache.Load("main.fl", hash);
+    ASSERT_TRUE(entry.has_value());
+    expectSameView(entry->View(), flat);
+
+    // The rebuilt tree flattens to the same arrays
+    Arena rebuilt;
+    FlatAST again = Flatten(Unflatten(entry->View(), rebuilt));
+    EXPECT_EQ(again.kinds, flat.kinds);
+    EXPECT_EQ(again.children, flat.children);
+    EXPECT_EQ(again.text, flat.text);
+}
+
+TEST_F(AstCacheTests, MissesOnOtherTextOrPath) {
+    AstCache cache(directory);
+    Arena arena;
+    uint64_t hash = AstCache::ContentHash(SOURCE);
+    ASSERT_TRUE(cache.Store("main.fl", hash, flattenSource(arena, SOURCE)));
+
+    EXPECT_FALSE(cache.Load("main.fl", AstCache::ContentHash("int a = 2;")));
+    EXPECT_FALSE(cache.Load("other.fl", hash));
+    EXPECT_NE(cache.EntryPath("main.fl"), cache.EntryPath("other.fl"));
+    EXPECT_EQ(cache.EntryPath("main.fl"), cache.EntryPath("./main.fl"));
+}
+
+TEST_F(AstCacheTests, MissesOnMalformedEntries) {
+    AstCache cache(directory);
+    Arena arena;
+    uint64_t hash = AstCache::ContentHash(SOURCE);
+    ASSERT_TRUE(cache.Store("main.fl", hash, flattenSource(arena, SOURCE)));
+
+    // Truncated
+    std::string entry = cache.EntryPath("main.fl");
+    std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 1);
+    EXPECT_FALSE(cache.Load("main.fl", hash));
+
+    // Not an entry at all
+    std::ofstream(entry) << "int a = 1;";
+    EXPECT_FALSE(cache.Load("main.fl", hash));
+}
+
+TEST_F(AstCacheTests, MissesOnFlippedBits) {
+    AstCache cache(directory);
+    Arena arena;
+    uint64_t hash = AstCache::ContentHash(SOURCE);
+    ASSERT_TRUE(cache.Store("main.fl", hash, flattenSource(arena, SOURCE)));
+    ASSERT_TRUE(cache.Load("main.fl", hash));
+
+    // One bit of the text, past the header and every size check
+    std::string entry = cache.EntryPath("main.fl");
+    std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(-1, std::ios::end);
+    char last = static_cast<char>(file.get());
+    file.seekp(-1, std::ios::end);
+    file.put(static_cast<char>(last ^ 1));
+    file.close();
+    EXPECT_FALSE(cache.Load("main.fl", hash));
+}
+
+TEST(AstCacheHashTests, HashesEveryByte) {
+    std::string text(100, 'a');
+    uint64_t hash = AstCache::ContentHash(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        std::string changed = text;
+        changed[i] = 'b';
+        EXPECT_NE(AstCache::ContentHash(changed), hash) << i;
+    }
+    EXPECT_NE(AstCache::ContentHash(text + '\0'), hash);
+    EXPECT_EQ(AstCache::ContentHash(text), hash);
+}
+
+TEST_F(AstCacheTests, FrontendReusesUnchangedFiles) {
+    AstCache cache(directory + "/cache");
+    std::string same = WriteSource("same.fl", SOURCE);
+    std::string edited = WriteSource("edited.fl", "int a = 1;");
+    std::string broken = WriteSource("broken.fl", "int a = ;");
+    vector<string> paths{same, edited, broken};
+
+    Frontend frontend(2, &cache);
+    vector<ParsedFile> first = frontend.ParseFiles(paths);
+    EXPECT_FALSE(first[0].cached);
+    EXPECT_FALSE(first[1].cached);
+    EXPECT_EQ(first[2].program, nullptr);
+
+    WriteSource("edited.fl", "int a = 2;");
+    vector<ParsedFile> second = frontend.ParseFiles(paths);
+    EXPECT_TRUE(second[0].cached);
+    EXPECT_FALSE(second[1].cached);
+    EXPECT_FALSE(second[2].cached);
+    EXPECT_EQ(second[2].program, nullptr);
+    EXPECT_EQ(second[2].diagnostics, first[2].diagnostics);
+
+    // Hits give back the tree the parser built
+    EXPECT_EQ(Flatten(second[0].program).kinds, Flatten(first[0].program).kinds);
+    EXPECT_EQ(Flatten(second[0].program).text, Flatten(first[0].program).text);
+
+    // The edit was stored in turn
+    EXPECT_TRUE(frontend.ParseFiles({edited})[0].cached);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "core/Parser.hpp"
+#include "runtime/CBackend.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+using runtime::Chunk;
+using runtime::Instruction;
+using runtime::Op;
+
+static Chunk compileProgram(std::string_view source,
+                            runtime::CompileOptions options = {}) {
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    return runtime::Compile(parser.Parse(), options);
+}
+
+// Only reaches its division by zero if the arithmetic before is right:
+// the product wraps negative and the float compare holds
+static const char* WRAPPING_SOURCE =
+    "int a = 3037000500;\n"
+    "int w = a * a;\n"
+    "bool negative = w < 0;\n"
+    "float f = 2.5 * 4;\n"
+    "bool ten = f == 10.0;\n"
+    "int! p = allot(int) -> w;\n"
+    "int z = 1 / (negative + ten - 2);";
+
+// A fresh directory under /tmp, removed with the fixture
+class CBackendTests : public ::testing::Test {
+   protected:
+    std::string directory;
+
+    void SetUp() override {
+        char path[] = "/tmp/flecha_build_XXXXXX";
+        ASSERT_NE(mkdtemp(path), nullptr);
+        directory = path;
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    // Runs an executable, its stderr goes to error
+    int Run(const std::string& executable, std::string& error) {
+        std::string log = directory + "/stderr";
+        int status = std::system((executable + " 2> " + log).c_str());
+        std::stringstream text;
+        text << std::ifstream(log).rdbuf();
+        error = text.str();
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+};
+
+TEST(CBackendEmitTests, LowersEveryInstruction) {
+    runtime::CompileOptions options;
+    options.promote_allots = false;
+    Chunk chunk = compileProgram(
+        "int a = 7;\n"
+        "int b = a / 2 ** 3;\n"
+        "string s = \"say \\\"hi\\\"\";\n"
+        "float! q = allot(float) -> a;",
+        options);
+    std::string c = runtime::EmitC(chunk, "dir/prog.fl");
+
+    EXPECT_NE(c.find("static const char flecha_path[] = \"dir/prog.fl\";"),
+              std::string::npos);
+    EXPECT_NE(c.find("flecha_pow("), std::string::npos);
+    EXPECT_NE(c.find("flecha_fail(\"Division by zero\", 2, 9);"),
+              std::string::npos);
+    EXPECT_NE(c.find("(void*)\"say \\\"hi\\\"\";"), std::string::npos);
+    EXPECT_NE(c.find(".p = flecha_allot(8);"), std::string::npos);
+    EXPECT_NE(c.find("#line 4\n"), std::string::npos);
+}
+
+TEST(CBackendEmitTests, RejectsInstructionsWithoutALowering) {
+    Chunk chunk;
+    chunk.registers = 1;
+    chunk.code = {Instruction{Op::Spawn, 0, 1, 0},
+                  Instruction{Op::Halt, 0, 0, 0}};
+    chunk.locations = {{3, 7}, {3, 7}};
+
+    try {
+        runtime::EmitC(chunk, "tasks.fl");
+        FAIL() << "Expected a build error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Build Error: Spawn can not be lowered to C yet at line "
+                     "3, column 7.");
+    }
+}
+
+TEST_F(CBackendTests, BuildsExecutables) {
+    std::string executable = directory + "/app";
+    runtime::Build(compileProgram("int a = 2;\nint b = a ** 10 % 1000;"),
+                   "ok.fl", executable);
+    EXPECT_FALSE(std::filesystem::exists(executable + ".c"));
+
+    std::string error;
+    EXPECT_EQ(Run(executable, error), 0);
+    EXPECT_EQ(error, "");
+}
+
+TEST_F(CBackendTests, FailsLikeTheVM) {
+    Chunk chunk = compileProgram(WRAPPING_SOURCE);
+    std::string message;
+    try {
+        runtime::VM().Run(chunk);
+        FAIL() << "Expected a division by zero error";
+    } catch (const std::runtime_error& error) {
+        message = error.what();
+    }
+
+    std::string executable = directory + "/app";
+    runtime::Build(chunk, "wrap.fl", executable);
+    std::string error;
+    EXPECT_EQ(Run(executable, error), 1);
+    EXPECT_EQ(error, "wrap.fl: " + message + "\n");
+    EXPECT_EQ(message,
+              "Runtime Error: Division by zero at line 7, column 9.");
+}
+
+TEST_F(CBackendTests, QuotesHostilePaths) {
+    // Ends a comment, holds a string and splits a line if not quoted
+    std::string path = "x*/ \"oops\" /*\n?\?=.fl";
+    std::string executable = directory + "/app";
+    runtime::Build(compileProgram("int a = 0;\nint b = 1 / a;"), path,
+                   executable);
+
+    std::string error;
+    EXPECT_EQ(Run(executable, error), 1);
+    EXPECT_EQ(error, path +
+                         ": Runtime Error: Division by zero at line 2, "
+                         "column 9.\n");
+}
+
+TEST_F(CBackendTests, WritesOnlyTheC) {
+    std::string source = directory + "/app.c";
+    runtime::Build(compileProgram("int a = 1;"), "one.fl", source);
+    EXPECT_TRUE(std::filesystem::exists(source));
+    EXPECT_FALSE(std::filesystem::exists(directory + "/app"));
+}
+
+TEST_F(CBackendTests, LeavesFilesNextToTheOutputAlone) {
+    std::string mine = directory + "/app.c";
+    std::ofstream(mine) << "not flecha's";
+    runtime::Build(compileProgram("int a = 1;"), "one.fl",
+                   directory + "/app");
+
+    std::stringstream text;
+    text << std::ifstream(mine).rdbuf();
+    EXPECT_EQ(text.str(), "not flecha's");
+    EXPECT_TRUE(std::filesystem::exists(directory + "/app"));
+}
+
+TEST_F(CBackendTests, KeepsTheCOfAFailedBuild) {
+    runtime::BuildOptions options;
+    options.compiler = directory + "/no-such-cc";
+    try {
+        runtime::Build(compileProgram("int a = 1;"), "one.fl",
+                       directory + "/app", options);
+        FAIL() << "Expected a build error";
+    } catch (const std::runtime_error& error) {
+        std::string message = error.what();
+        size_t kept = message.find(", the C is kept in ");
+        ASSERT_NE(kept, std::string::npos) << message;
+
+        // The path runs to the final period
+        std::string source = message.substr(kept + 19);
+        source.pop_back();
+        EXPECT_TRUE(std::filesystem::exists(source)) << source;
+        std::filesystem::remove_all(
+            std::filesystem::path(source).parent_path());
+    }
+    EXPECT_FALSE(std::filesystem::exists(directory + "/app.c"));
+}
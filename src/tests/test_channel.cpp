@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "std/Atomic.hpp"
+#include "std/Channel.hpp"
+
+using namespace flecha::stdlib;
+
+// Counts its wakes
+struct CountingWaiter : Waiter {
+    int wakes = 0;
+
+    CountingWaiter() {
+        wake = [](Waiter* waiter) {
+            static_cast<CountingWaiter*>(waiter)->wakes++;
+        };
+    }
+};
+
+TEST(ChannelTests, QueuesValuesInOrder) {
+    Channel channel(2);
+    EXPECT_EQ(channel.Capacity(), 2);
+
+    int64_t value = 0;
+    EXPECT_FALSE(channel.TryReceive(value));
+    EXPECT_TRUE(channel.TrySend(1));
+    EXPECT_TRUE(channel.TrySend(2));
+    EXPECT_FALSE(channel.TrySend(3));
+
+    EXPECT_TRUE(channel.TryReceive(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(channel.TrySend(3));
+    EXPECT_TRUE(channel.TryReceive(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(channel.TryReceive(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_FALSE(channel.TryReceive(value));
+
+    EXPECT_THROW(Channel(0), std::invalid_argument);
+}
+
+TEST(ChannelTests, WakesParkedWaitersOnce) {
+    Channel channel(1);
+    CountingWaiter receiver, sender;
+
+    // Ready channels do not park
+    EXPECT_FALSE(channel.Park(&sender, true));
+    EXPECT_TRUE(channel.Park(&receiver, false));
+    EXPECT_TRUE(channel.TrySend(7));
+    EXPECT_EQ(receiver.wakes, 1);
+    EXPECT_FALSE(channel.Park(&receiver, false));
+
+    EXPECT_TRUE(channel.Park(&sender, true));
+    int64_t value = 0;
+    EXPECT_TRUE(channel.TryReceive(value));
+    EXPECT_EQ(value, 7);
+    EXPECT_EQ(sender.wakes, 1);
+
+    // Nobody is parked any more
+    EXPECT_TRUE(channel.TrySend(8));
+    EXPECT_TRUE(channel.TryReceive(value));
+    EXPECT_EQ(receiver.wakes, 1);
+    EXPECT_EQ(sender.wakes, 1);
+}
+
+TEST(ChannelTests, PassesValuesBetweenThreads) {
+    constexpr int64_t VALUES = 20000;
+    constexpr int PRODUCERS = 4;
+    Channel channel(16);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&channel, p] {
+            for (int64_t i = p; i < VALUES; i += PRODUCERS) {
+                while (!channel.TrySend(i)) std::this_thread::yield();
+            }
+        });
+    }
+
+    int64_t sum = 0, value = 0;
+    for (int64_t i = 0; i < VALUES; i++) {
+        while (!channel.TryReceive(value)) std::this_thread::yield();
+        sum += value;
+    }
+    for (auto& producer : producers) producer.join();
+    EXPECT_EQ(sum, VALUES * (VALUES - 1) / 2);
+}
+
+TEST(AtomicTests, AddsAndSwapsAcrossThreads) {
+    int64_t counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < 10000; i++) AtomicAdd(&counter, 3);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(counter, 120000);
+
+    EXPECT_EQ(AtomicSwap(&counter, -1), 120000);
+    EXPECT_EQ(AtomicAdd(&counter, INT64_MIN), -1);
+    EXPECT_EQ(counter, INT64_MAX);
+}
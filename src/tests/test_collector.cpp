@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "core/Parser.hpp"
+#include "memory/Collector.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+using memory::Collector;
+using memory::CollectorOptions;
+using memory::Roots;
+
+// A few root slots, standing in for VM registers
+struct Slots {
+    void* slots[4] = {};
+    uint16_t indices[4] = {0, 1, 2, 3};
+
+    Roots roots() { return Roots{slots, indices, 4}; }
+};
+
+static CollectorOptions smallHeap() {
+    CollectorOptions options;
+    options.nursery_bytes = 4096;
+    options.min_major_bytes = 256 * 1024;
+    options.step_bytes = 4096;
+    return options;
+}
+
+// Allocates unreachable objects until the nursery was collected
+static void churn(Collector& collector, Slots& slots, size_t count = 2000) {
+    for (size_t i = 0; i < count; i++) {
+        collector.Allocate(24, false, slots.roots());
+    }
+}
+
+static int64_t& word(void* object, size_t index = 0) {
+    return static_cast<int64_t*>(object)[index];
+}
+
+static void*& pointer(void* object, size_t index = 0) {
+    return static_cast<void**>(object)[index];
+}
+
+TEST(CollectorTests, AllocatesZeroedYoungObjects) {
+    Collector collector(smallHeap());
+    Slots slots;
+    void* object = collector.Allocate(12, false, slots.roots());
+
+    EXPECT_TRUE(collector.Owns(object));
+    EXPECT_FALSE(collector.Owns(&slots));
+    EXPECT_EQ(word(object, 0), 0);
+    EXPECT_EQ(word(object, 1), 0);
+    EXPECT_EQ(collector.Stats().allocations, 1);
+    EXPECT_GT(Collector::DefaultNurseryBytes(), 0);
+}
+
+TEST(CollectorTests, PromotesWhatTheRootsReach) {
+    Collector collector(smallHeap());
+    Slots slots;
+    slots.slots[0] = collector.Allocate(8, false, slots.roots());
+    word(slots.slots[0]) = 42;
+    void* young = slots.slots[0];
+
+    churn(collector, slots);
+    EXPECT_GT(collector.Stats().minor_collections, 0);
+    EXPECT_NE(slots.slots[0], young);
+    EXPECT_EQ(word(slots.slots[0]), 42);
+    // Only the root survived, once
+    EXPECT_EQ(collector.Stats().promoted_bytes, 8);
+}
+
+TEST(CollectorTests, MovesPointersInsideObjects) {
+    Collector collector(smallHeap());
+    Slots slots;
+    slots.slots[0] = collector.Allocate(16, true, slots.roots());
+    void* child = collector.Allocate(8, false, slots.roots());
+    word(child) = 7;
+    pointer(slots.slots[0]) = child;
+
+    churn(collector, slots);
+    void* moved = pointer(slots.slots[0]);
+    EXPECT_NE(moved, child);
+    EXPECT_TRUE(collector.Owns(moved));
+    EXPECT_EQ(word(moved), 7);
+    EXPECT_EQ(pointer(slots.slots[0], 1), nullptr);
+}
+
+TEST(CollectorTests, RemembersOldObjectsPointingYoung) {
+    Collector collector(smallHeap());
+    Slots slots;
+    slots.slots[0] = collector.Allocate(8, true, slots.roots());
+    churn(collector, slots);
+
+    // The holder is old now, only the barrier tells about the store
+    void* child = collector.Allocate(8, false, slots.roots());
+    word(child) = 9;
+    pointer(slots.slots[0]) = child;
+    collector.Write(slots.slots[0], child);
+
+    churn(collector, slots);
+    EXPECT_NE(pointer(slots.slots[0]), child);
+    EXPECT_EQ(word(pointer(slots.slots[0])), 9);
+}
+
+// Builds a list of count nodes at slot 0 through the write barrier
+static void buildList(Collector& collector, Slots& slots, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        slots.slots[1] = collector.Allocate(8, true, slots.roots());
+        pointer(slots.slots[1]) = slots.slots[0];
+        collector.Write(slots.slots[1], slots.slots[0]);
+        slots.slots[0] = slots.slots[1];
+        // Garbage between the nodes
+        collector.Allocate(64, false, slots.roots());
+    }
+    slots.slots[1] = nullptr;
+}
+
+static size_t listLength(void* node) {
+    size_t length = 0;
+    for (; node; node = pointer(node)) length++;
+    return length;
+}
+
+TEST(CollectorTests, CollectsUnreachableOldObjects) {
+    Collector collector(smallHeap());
+    Slots slots;
+    buildList(collector, slots, 5000);
+    collector.Collect(slots.roots());
+
+    EXPECT_EQ(collector.CurrentPhase(), Collector::Phase::Idle);
+    EXPECT_EQ(listLength(slots.slots[0]), 5000);
+    // Only the nodes were promoted, the garbage died young
+    EXPECT_EQ(collector.Stats().swept_bytes, 0);
+    EXPECT_GT(collector.Stats().old_bytes, 0);
+
+    // Dropping the list frees it on the next cycle
+    size_t before = collector.Stats().old_bytes;
+    slots.slots[0] = nullptr;
+    collector.Collect(slots.roots());
+    EXPECT_GT(collector.Stats().swept_bytes, 0);
+    EXPECT_LT(collector.Stats().old_bytes, before);
+    EXPECT_EQ(collector.Stats().old_bytes, 0);
+}
+
+TEST(CollectorTests, MarksIncrementallyWhileTheProgramRuns) {
+    Collector collector(smallHeap());
+    Slots slots;
+    buildList(collector, slots, 20000);
+
+    // Splice new nodes in after the head until a major cycle has marked
+    size_t spliced = 0;
+    size_t marking = 0;
+    while (marking == 0 ||
+           collector.CurrentPhase() == Collector::Phase::Marking) {
+        void* node = collector.Allocate(8, true, slots.roots());
+        pointer(node) = pointer(slots.slots[0]);
+        collector.Write(node, pointer(node));
+        pointer(slots.slots[0]) = node;
+        collector.Write(slots.slots[0], node);
+        spliced++;
+        if (collector.CurrentPhase() == Collector::Phase::Marking) marking++;
+    }
+
+    // Marking took many allocations and lost none of the nodes
+    EXPECT_GT(marking, 1);
+    EXPECT_GE(collector.Stats().major_cycles, 1);
+    EXPECT_EQ(listLength(slots.slots[0]), 20000 + spliced);
+    collector.Collect(slots.roots());
+    EXPECT_EQ(listLength(slots.slots[0]), 20000 + spliced);
+}
+
+TEST(CollectorTests, TakesDellotsAsHints) {
+    Collector collector(smallHeap());
+    Slots slots;
+
+    // Not even the newest object is taken back at once, a copy of its
+    // pointer must not alias the next allot
+    slots.slots[2] = collector.Allocate(8, false, slots.roots());
+    void* copy = slots.slots[2];
+    collector.Free(slots.slots[2]);
+    slots.slots[3] = collector.Allocate(8, false, slots.roots());
+    EXPECT_NE(slots.slots[3], copy);
+    slots.slots[3] = nullptr;
+
+    // Others are dropped by the collection, which nulls their pointers
+    slots.slots[0] = collector.Allocate(8, false, slots.roots());
+    slots.slots[1] = collector.Allocate(8, false, slots.roots());
+    collector.Free(slots.slots[0]);
+    churn(collector, slots);
+    EXPECT_EQ(slots.slots[0], nullptr);
+    EXPECT_NE(slots.slots[1], nullptr);
+    EXPECT_EQ(slots.slots[2], nullptr);
+    EXPECT_EQ(collector.Stats().early_frees, 2);
+
+    // As are old ones, on the next major cycle
+    collector.Free(slots.slots[1]);
+    collector.Collect(slots.roots());
+    EXPECT_EQ(slots.slots[1], nullptr);
+    EXPECT_EQ(collector.Stats().old_bytes, 0);
+}
+
+TEST(CollectorTests, KeepsLargeObjectsOld) {
+    Collector collector(smallHeap());
+    Slots slots;
+    slots.slots[0] = collector.Allocate(10000, false, slots.roots());
+    word(slots.slots[0], 1249) = 5;
+    void* large = slots.slots[0];
+
+    churn(collector, slots);
+    EXPECT_EQ(slots.slots[0], large);
+    EXPECT_EQ(word(large, 1249), 5);
+
+    slots.slots[0] = nullptr;
+    collector.Collect(slots.roots());
+    EXPECT_FALSE(collector.Owns(large));
+}
+
+TEST(CollectorTests, RunsProgramsInTheVM) {
+    std::string source;
+    for (int i = 0; i < 3000; i++) {
+        source += "int! p" + std::to_string(i) + " = allot(int) -> " +
+                  std::to_string(i) + ";\n";
+    }
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    runtime::CompileOptions options;
+    options.promote_allots = false;
+    runtime::Chunk chunk = runtime::Compile(parser.Parse(), options);
+
+    Collector collector(smallHeap());
+    runtime::VM vm(&collector);
+    vm.Run(chunk);
+
+    EXPECT_GT(collector.Stats().minor_collections, 0);
+    for (int i : {0, 1234, 2999}) {
+        void* p = vm.Get(chunk, "p" + std::to_string(i)).p;
+        EXPECT_TRUE(collector.Owns(p));
+        EXPECT_EQ(word(p), i);
+    }
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/Parser.hpp"
+#include "runtime/Compiler.hpp"
+
+using namespace flecha;
+using flecha::memory::Arena;
+using runtime::Chunk;
+using runtime::Op;
+using runtime::ValueKind;
+
+static Chunk compileSource(std::string_view source,
+                           runtime::CompileOptions options = {}) {
+    Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    return runtime::Compile(parser.Parse(), options);
+}
+
+static std::vector<Op> opsOf(const Chunk& chunk) {
+    std::vector<Op> ops;
+    for (const auto& instruction : chunk.code) ops.push_back(instruction.op);
+    return ops;
+}
+
+TEST(CompilerTests, ResolvesNamesOfAnyInterner) {
+    // Variables and types are told apart by symbol, presets name the types
+    Arena arena;
+    core::Tokenizer tokenizer("float f = 1;\nint a = 2;\nfloat g = f + a;");
+    core::Diagnostics diagnostics;
+    utils::Interner symbols;
+    core::Parser parser(tokenizer, arena, diagnostics, symbols);
+    Chunk chunk = runtime::Compile(parser.Parse());
+
+    EXPECT_EQ(chunk.Find("f")->kind, ValueKind::Float);
+    EXPECT_EQ(chunk.Find("a")->kind, ValueKind::Int);
+    EXPECT_EQ(chunk.Find("g")->kind, ValueKind::Float);
+}
+
+TEST(CompilerTests, ExpressionsWriteIntoTheirVariable) {
+    Chunk chunk = compileSource("int a = 1;\nint b = a + 2;");
+
+    EXPECT_EQ(opsOf(chunk), (std::vector<Op>{Op::LoadConst, Op::LoadConst,
+                                             Op::AddInt, Op::Halt}));
+    // a + 2 reads a in place and adds straight into b
+    const auto& add = chunk.code[2];
+    EXPECT_EQ(add.a, chunk.Find("b")->reg);
+    EXPECT_EQ(add.b, chunk.Find("a")->reg);
+    EXPECT_EQ(chunk.globals.size(), 2);
+    EXPECT_EQ(chunk.registers, 3);
+}
+
+TEST(CompilerTests, PointerOperationsHaveTheirOwnOpcodes) {
+    Chunk chunk = compileSource(
+        "int! p = allot(int) -> 7;\n"
+        "int x = 1;\n"
+        "int y = ?x -> 5;",
+        runtime::CompileOptions{false});
+
+    EXPECT_EQ(opsOf(chunk),
+              (std::vector<Op>{Op::Allot, Op::LoadConst, Op::Store,
+                               Op::LoadConst, Op::AddressOf, Op::LoadConst,
+                               Op::Store, Op::Move, Op::Halt}));
+    EXPECT_EQ(chunk.Find("p")->kind, ValueKind::Pointer);
+    EXPECT_EQ(chunk.Find("p")->pointee, ValueKind::Int);
+}
+
+TEST(CompilerTests, PromotesAllotsThatDoNotEscape) {
+    Chunk chunk = compileSource(
+        "int! p = allot(int) -> 7;\n"
+        "int y = p -> 5;\n"
+        "int! q = allot(int);\n"
+        "int r = q -> 1;");
+
+    EXPECT_EQ(opsOf(chunk),
+              (std::vector<Op>{Op::AddressOf, Op::LoadConst, Op::LoadConst,
+                               Op::Move, Op::Move, Op::AddressOf,
+                               Op::LoadConst, Op::Move, Op::Move, Op::Halt}));
+    // 7 goes straight into the pointee register, 5 is moved into it
+    const auto* p = chunk.Find("p");
+    ASSERT_GE(p->slot, 0);
+    EXPECT_EQ(chunk.code[0].b, p->slot);
+    EXPECT_EQ(chunk.code[1].a, p->slot);
+    EXPECT_EQ(chunk.code[3].a, p->slot);
+    EXPECT_GE(chunk.Find("q")->slot, 0);
+}
+
+TEST(CompilerTests, FloatsPromoteIntegers) {
+    Chunk chunk = compileSource("float f = 1.5;\nint i = 2;\nfloat g = f * i;");
+
+    EXPECT_EQ(opsOf(chunk),
+              (std::vector<Op>{Op::LoadConst, Op::LoadConst, Op::IntToFloat,
+                               Op::MulFloat, Op::Halt}));
+    EXPECT_EQ(chunk.Find("g")->kind, ValueKind::Float);
+}
+
+TEST(CompilerTests, ComparisonsAreBools) {
+    Chunk chunk = compileSource("int a = 3;\nbool b = a < 4 && a >= 1;");
+
+    EXPECT_EQ(chunk.Find("b")->kind, ValueKind::Bool);
+}
+
+TEST(CompilerTests, ConstantsAreShared) {
+    Chunk chunk = compileSource("int a = 7;\nint b = 7;\nint c = a + 7;");
+
+    EXPECT_EQ(chunk.constants.size(), 1);
+    EXPECT_EQ(chunk.constants[0].i, 7);
+}
+
+TEST(CompilerTests, RedeclarationsReadTheOlderVariable) {
+    Chunk chunk = compileSource("int a = 1;\nint a = a + 1;");
+
+    EXPECT_EQ(chunk.globals.size(), 2);
+    EXPECT_EQ(chunk.Find("a")->reg, 1);
+    EXPECT_EQ(chunk.code[1].b, 0);
+}
+
+TEST(CompilerTests, RecordsInstructionLocations) {
+    Chunk chunk = compileSource("int a = 1;\n\nint b = a / 2;");
+
+    ASSERT_EQ(chunk.locations.size(), chunk.code.size());
+    EXPECT_EQ(chunk.locations[2].line, 3);
+}
+
+TEST(CompilerTests, RejectsUndefinedVariables) {
+    try {
+        compileSource("int a = 1;\nint b = c;");
+        FAIL() << "Expected a compiler error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Compiler Error: Undefined variable c at line 2, "
+                     "column 9.");
+    }
+}
+
+TEST(CompilerTests, RejectsKindErrors) {
+    EXPECT_THROW(compileSource("int a = 1.5;"), std::runtime_error);
+    EXPECT_THROW(compileSource("char c = 7;"), std::runtime_error);
+    EXPECT_THROW(compileSource("int a = 'x';"), std::runtime_error);
+    EXPECT_THROW(compileSource("string s = \"x\";\nint b = s + 1;"),
+                 std::runtime_error);
+    EXPECT_THROW(compileSource("int a = 1;\nint b = a -> 2;"),
+                 std::runtime_error);
+}
+
+TEST(CompilerTests, DeclarationsTakeTheDeclaredKind) {
+    Chunk chunk = compileSource("float f = 1 + 2;\nint c = 'a' + 1;");
+
+    EXPECT_EQ(opsOf(chunk),
+              (std::vector<Op>{Op::LoadConst, Op::LoadConst, Op::AddInt,
+                               Op::IntToFloat, Op::LoadConst, Op::LoadConst,
+                               Op::AddInt, Op::Halt}));
+    EXPECT_EQ(chunk.Find("f")->kind, ValueKind::Float);
+    EXPECT_EQ(chunk.Find("c")->kind, ValueKind::Int);
+}
+
+TEST(CompilerTests, RejectsValuesOfAnotherDeclaredKind) {
+    try {
+        compileSource("float f = 1 + 2;\nint g = f / 2;");
+        FAIL() << "Expected a compiler error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Compiler Error: Can not store a float as int at line "
+                     "2, column 1.");
+    }
+
+    // Pointers only come from allot, a declared int is never one
+    try {
+        compileSource("int! p = allot(int) -> 1;\nint a = ?p;");
+        FAIL() << "Expected a compiler error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Compiler Error: Can not store a pointer as int at "
+                     "line 2, column 1.");
+    }
+}
+
+TEST(CompilerTests, DisassemblesByName) {
+    Chunk chunk = compileSource("int a = 1;");
+
+    EXPECT_EQ(chunk.Disassemble(), "0: LoadConst 0, 0, 0\n1: Halt 0, 0, 0\n");
+}
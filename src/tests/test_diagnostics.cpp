@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "core/Parser.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+// Parses with an engine attached, so nothing throws
+static ProgramNode* parseCollecting(Arena& arena, Tokenizer& tokenizer,
+                                    Diagnostics& diagnostics) {
+    Parser parser(tokenizer, arena, diagnostics);
+    return parser.Parse();
+}
+
+static size_t statementCount(ProgramNode* program) {
+    return static_cast<BodyNode*>(program->body)->expressions.size();
+}
+
+TEST(DiagnosticsTests, ReportsEveryErrorInOnePass) {
+    Arena arena;
+    Tokenizer tokenizer("int a = ;\nint b = 2;\nint c 3;\nint d = 4;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 2);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::ExpectedExpression);
+    EXPECT_EQ(diagnostics[0].offset, 8);
+    EXPECT_EQ(diagnostics[0].found, ";");
+    EXPECT_EQ(diagnostics[1].code, DiagnosticCode::ExpectedEqual);
+    EXPECT_EQ(diagnostics[1].found, "3");
+
+    // The broken statements are left out, the rest still parse
+    ASSERT_NE(program, nullptr);
+    EXPECT_EQ(statementCount(program), 2);
+}
+
+TEST(DiagnosticsTests, ResynchronizesAtTheNextDeclaration) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 1 + \nint b = 2;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    // The missing ';' does not swallow the next statement
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::ExpectedExpression);
+    EXPECT_EQ(statementCount(program), 1);
+}
+
+TEST(DiagnosticsTests, ResynchronizesAtClosingBrace) {
+    Arena arena;
+    Tokenizer tokenizer("int a = ( 1 } int b = 2;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::ExpectedCloseParen);
+    EXPECT_EQ(diagnostics[0].found, "}");
+    EXPECT_EQ(statementCount(program), 1);
+}
+
+TEST(DiagnosticsTests, ReportsEndOfFile) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 1");
+    Diagnostics diagnostics;
+    parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::ExpectedSemiColon);
+    EXPECT_EQ(diagnostics[0].found, "end of file");
+}
+
+TEST(DiagnosticsTests, CollectsLexicalErrors) {
+    Arena arena;
+    Tokenizer tokenizer("char c = 'ab';\nchar d = '\\x';\nint e = 1;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 2);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::UnterminatedChar);
+    EXPECT_EQ(diagnostics[1].code, DiagnosticCode::InvalidEscape);
+
+    // Recovered literals still make well formed statements
+    EXPECT_EQ(statementCount(program), 3);
+}
+
+TEST(DiagnosticsTests, ReportsNumbersOutOfRange) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 99999999999999999999;\nint b = 1;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::NumberOutOfRange);
+    EXPECT_EQ(diagnostics[0].offset, 8);
+
+    // The literal is clamped and the statement kept
+    EXPECT_EQ(statementCount(program), 2);
+}
+
+TEST(DiagnosticsTests, UnterminatedStringRunsToTheEndOfItsLine) {
+    Arena arena;
+    Tokenizer tokenizer("string s = \"open;\nint a = 1;\nint = 2;");
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    // The later lines still parse and report their own errors
+    ASSERT_GE(diagnostics.Count(), 2);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::UnterminatedString);
+    EXPECT_EQ(diagnostics[0].offset, 11);
+    const Diagnostic& last = diagnostics[diagnostics.Count() - 1];
+    EXPECT_EQ(last.code, DiagnosticCode::ExpectedVariableName);
+    EXPECT_EQ(tokenizer.Locate(last.offset).line, 3);
+    EXPECT_EQ(statementCount(program), 1);
+}
+
+TEST(DiagnosticsTests, SortsBySourceOffset) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 1 'ab' ;\nint = 2;\nchar c = ';\n");
+    Diagnostics diagnostics;
+    parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_GE(diagnostics.Count(), 3);
+    for (size_t i = 1; i < diagnostics.Count(); i++) {
+        EXPECT_LE(diagnostics[i - 1].offset, diagnostics[i].offset);
+    }
+}
+
+TEST(DiagnosticsTests, ReportsAllotTypeMismatch) {
+    Arena arena;
+    Tokenizer tokenizer("int! p = allot(char);");
+    Diagnostics diagnostics;
+    parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::AllotTypeMismatch);
+    EXPECT_EQ(Format(diagnostics[0], tokenizer.Locate(diagnostics[0].offset)),
+              "Parser Error [E210]: Allotted type does not match the declared "
+              "type int. Found: char at line 1, column 16");
+}
+
+TEST(DiagnosticsTests, FormatsCodeMessageAndLocation) {
+    Tokenizer tokenizer("int a = 1;\nint b = 2 x;");
+    Diagnostic diagnostic{DiagnosticCode::ExpectedSemiColon, 21, "x", ""};
+
+    EXPECT_EQ(Format(diagnostic, tokenizer.Locate(diagnostic.offset)),
+              "Parser Error [E204]: Expected ';' after value. Found: x at "
+              "line 2, column 11");
+}
+
+TEST(DiagnosticsTests, ThrowsFirstErrorWithoutAnEngine) {
+    Arena arena;
+    Tokenizer tokenizer("int a = ;\nint b = ;");
+    Parser parser(tokenizer, arena);
+
+    try {
+        parser.Parse();
+        FAIL() << "expected a parser error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_NE(std::string(error.what()).find("at line 1, column 9"),
+                  std::string::npos);
+    }
+}
+
+TEST(DiagnosticsTests, DeepNestingIsReportedOnce) {
+    Arena arena;
+    std::string source = "int a = " + std::string(5000, '(') + "1" +
+                         std::string(5000, ')') + ";\nint b = 2;";
+    Tokenizer tokenizer(source);
+    Diagnostics diagnostics;
+    ProgramNode* program = parseCollecting(arena, tokenizer, diagnostics);
+
+    ASSERT_EQ(diagnostics.Count(), 1);
+    EXPECT_EQ(diagnostics[0].code, DiagnosticCode::NestingTooDeep);
+    EXPECT_EQ(statementCount(program), 1);
+}
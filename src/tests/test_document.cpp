@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "core/Document.hpp"
+#include "core/Parser.hpp"
+#include "core/StaticVisitor.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+// Prints a tree with every location, so two trees compare as strings
+static void dumpNode(ASTNode* node, std::string& out) {
+    if (!node) {
+        out += "-";
+        return;
+    }
+
+    out += std::to_string(static_cast<int>(node->kind));
+    switch (node->kind) {
+        case NodeKind::Start: {
+            auto* start = static_cast<StartNode*>(node);
+            out += "@" + std::to_string(start->line) + ":" +
+                   std::to_string(start->column);
+            break;
+        }
+        case NodeKind::End: {
+            auto* end = static_cast<EndNode*>(node);
+            out += "@" + std::to_string(end->line) + ":" +
+                   std::to_string(end->column);
+            break;
+        }
+        case NodeKind::Range: {
+            auto range = static_cast<RangeNode*>(node)->range;
+            out += "[" + std::to_string(range.first) + "," +
+                   std::to_string(range.second) + "]";
+            break;
+        }
+        case NodeKind::Value:
+            out += "'" + std::string(static_cast<ValueNode*>(node)->value) + "'";
+            break;
+        case NodeKind::Variable:
+            out += "'" + std::string(static_cast<VariableNode*>(node)->name) +
+                   "'";
+            break;
+        case NodeKind::Unary:
+            out += "op" +
+                   std::to_string(static_cast<int>(
+                       static_cast<UnaryNode*>(node)->op));
+            break;
+        case NodeKind::Binary:
+            out += "op" +
+                   std::to_string(static_cast<int>(
+                       static_cast<BinaryNode*>(node)->op));
+            break;
+        default:
+            break;
+    }
+
+    out += "(";
+    ForEachChild(*node, [&](ASTNode* child) { dumpNode(child, out); });
+    out += ")";
+}
+
+static std::string dumpDiagnostics(const vector<Diagnostic>& diagnostics) {
+    std::string out;
+    for (const Diagnostic& d : diagnostics) {
+        out += std::to_string(static_cast<int>(d.code)) + "@" +
+               std::to_string(d.offset) + ":" + std::string(d.found) + ":" +
+               std::string(d.detail) + "\n";
+    }
+    return out;
+}
+
+// Checks a document against parsing its text from scratch
+static void expectMatchesFullParse(Document& document) {
+    Arena arena;
+    Tokenizer tokenizer(document.Text());
+    Diagnostics diagnostics;
+    Parser parser(tokenizer, arena, diagnostics);
+    ProgramNode* program = parser.Parse();
+
+    std::string expected, actual;
+    dumpNode(program, expected);
+    dumpNode(document.Program(), actual);
+    EXPECT_EQ(actual, expected) << "text:\n" << document.Text();
+    EXPECT_EQ(dumpDiagnostics(document.Errors()),
+              dumpDiagnostics(diagnostics.Entries()))
+        << "text:\n" << document.Text();
+}
+
+static std::string manyStatements(int count) {
+    std::string text;
+    for (int i = 0; i < count; i++) {
+        text += "int v" + std::to_string(i) + " = " + std::to_string(i) +
+                " * 2;\n";
+    }
+    return text;
+}
+
+TEST(DocumentTests, InitialParseMatchesParser) {
+    Document document("int a = 1;\nchar c = 'x';\nint! p = allot(int) -> a;");
+    EXPECT_EQ(document.Reparsed(), 3);
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, EditInsideAStatementReparsesOnlyIt) {
+    Document document(manyStatements(100));
+    size_t offset = document.Text().find("v50 = 50") + 6;
+
+    document.Edit(offset, 2, "123");
+    EXPECT_EQ(document.Reparsed(), 1);
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, NewLinesMoveFollowingLocations) {
+    Document document(manyStatements(20));
+    size_t offset = document.Text().find("int v5");
+
+    document.Edit(offset, 0, "\n\n  ");
+    EXPECT_LE(document.Reparsed(), 2);
+    expectMatchesFullParse(document);
+
+    // Joining two lines moves columns too
+    offset = document.Text().find("int v10");
+    document.Edit(offset - 1, 1, " ");
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, UnterminatedStringReparsesItsLine) {
+    Document document(manyStatements(20));
+    size_t offset = document.Text().find("v3 = 3") + 5;
+
+    // The string recovers at the end of its line, the rest is kept
+    document.Edit(offset, 1, "\"3");
+    EXPECT_EQ(document.Reparsed(), 1);
+    EXPECT_FALSE(document.Errors().empty());
+    expectMatchesFullParse(document);
+
+    // A quote further down closes it, over the statements in between
+    size_t later = document.Text().find("v10 = 10") + 6;
+    document.Edit(later, 0, "\"");
+    EXPECT_EQ(document.Reparsed(), 1);
+    expectMatchesFullParse(document);
+
+    // Taking it out again parses them once more
+    document.Edit(later, 1, "");
+    EXPECT_EQ(document.Reparsed(), 8);
+    expectMatchesFullParse(document);
+
+    document.Edit(offset + 2, 0, "\"");
+    EXPECT_EQ(document.Reparsed(), 1);
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, FixingAnErrorRemovesIt) {
+    Document document("int a = ;\nint b = 2;\n");
+    ASSERT_EQ(document.Errors().size(), 1);
+    EXPECT_EQ(document.Errors()[0].code, DiagnosticCode::ExpectedExpression);
+
+    document.Edit(8, 0, "1");
+    EXPECT_TRUE(document.Errors().empty());
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, EditsAtTheEdges) {
+    Document document("");
+    expectMatchesFullParse(document);
+
+    document.Edit(0, 0, "int a = 1;");
+    expectMatchesFullParse(document);
+    document.Edit(0, 0, "  \n");
+    expectMatchesFullParse(document);
+    document.Edit(document.Text().size(), 0, "\nint b = a;");
+    expectMatchesFullParse(document);
+    document.Edit(0, document.Text().size(), "");
+    expectMatchesFullParse(document);
+}
+
+TEST(DocumentTests, EditOutsideTheTextThrows) {
+    Document document("int a = 1;");
+    EXPECT_THROW(document.Edit(11, 0, "x"), std::out_of_range);
+    EXPECT_THROW(document.Edit(5, 6, ""), std::out_of_range);
+}
+
+TEST(DocumentTests, RandomEditsMatchFullParse) {
+    static const char* const fragments[] = {
+        "int ", "char ", "a", "b1", " = ", "=", ";", "\n", " ", "'", "'x'",
+        "\"", "\"s\"", "1", "2.5", " + ", " * ", "-", "(", ")", "allot(int)",
+        "!", " -> ", "}", "in", "t", "\\",
+    };
+    std::mt19937 random(7);
+    Document document(manyStatements(30));
+
+    for (int round = 0; round < 400; round++) {
+        const std::string& text = document.Text();
+        size_t offset = random() % (text.size() + 1);
+        size_t removed = random() % 3 == 0
+                             ? random() % (std::min<size_t>(text.size() - offset,
+                                                            12) +
+                                           1)
+                             : 0;
+        std::string inserted;
+        for (size_t i = random() % 3; i > 0; i--) {
+            inserted += fragments[random() % std::size(fragments)];
+        }
+
+        document.Edit(offset, removed, inserted);
+        expectMatchesFullParse(document);
+        if (HasFailure()) break;
+    }
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <string_view>
+
+#include "core/EscapeAnalysis.hpp"
+#include "core/Parser.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+// The allot statement declaring the nth statement of a program
+static const AllocationStatementNode* statementAt(ProgramNode* program,
+                                                  size_t index) {
+    auto* body = static_cast<BodyNode*>(program->body);
+    return static_cast<const AllocationStatementNode*>(
+        body->expressions[index]);
+}
+
+TEST(EscapeAnalysisTests, WritesThroughDoNotEscape) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int! p = allot(int) -> 1;\n"
+        "int a = p -> 2;\n"
+        "int b = p -> a + 1;");
+    Parser parser(tokenizer, arena);
+    ProgramNode* program = parser.Parse();
+
+    EscapeAnalysis escapes(program);
+    EXPECT_TRUE(escapes.IsLocal(statementAt(program, 0)));
+    EXPECT_EQ(escapes.LocalCount(), 1);
+    EXPECT_EQ(escapes.AllocationCount(), 1);
+}
+
+TEST(EscapeAnalysisTests, OtherUsesEscape) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int! p = allot(int);\n"
+        "int! q = allot(int);\n"
+        "int! r = allot(int);\n"
+        "int! s = allot(int) -> 0;\n"
+        "int a = ?p;\n"
+        "int b = q + 1;\n"
+        "int! t = allot(int) -> r;");
+    Parser parser(tokenizer, arena);
+    ProgramNode* program = parser.Parse();
+
+    EscapeAnalysis escapes(program);
+    EXPECT_FALSE(escapes.IsLocal(statementAt(program, 0)));
+    EXPECT_FALSE(escapes.IsLocal(statementAt(program, 1)));
+    EXPECT_FALSE(escapes.IsLocal(statementAt(program, 2)));
+    EXPECT_TRUE(escapes.IsLocal(statementAt(program, 3)));
+    EXPECT_TRUE(escapes.IsLocal(statementAt(program, 6)));
+    EXPECT_EQ(escapes.LocalCount(), 2);
+    EXPECT_EQ(escapes.AllocationCount(), 5);
+}
+
+TEST(EscapeAnalysisTests, RedeclarationsHideOlderPointers) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int! p = allot(int);\n"
+        "int p = 1;\n"
+        "int a = p + 1;");
+    Parser parser(tokenizer, arena);
+    ProgramNode* program = parser.Parse();
+
+    EscapeAnalysis escapes(program);
+    EXPECT_TRUE(escapes.IsLocal(statementAt(program, 0)));
+}
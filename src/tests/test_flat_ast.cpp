@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "core/FlatAST.hpp"
+#include "core/Parser.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+static const char* SOURCE =
+    "int a = 1;\n"
+    "char b = 'x';\n"
+    "int! c = allot(int) -> 5;\n"
+    "Point! p = allot(Point);\n"
+    "int d = -(a + 2) * b ** 2;";
+
+static ASTNode* parseTree(Arena& arena, std::string_view source) {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer, arena);
+    return parser.Parse();
+}
+
+static void expectSameArrays(const FlatAST& a, const FlatAST& b) {
+    EXPECT_EQ(a.kinds, b.kinds);
+    EXPECT_EQ(a.data0, b.data0);
+    EXPECT_EQ(a.data1, b.data1);
+    EXPECT_EQ(a.first_child, b.first_child);
+    EXPECT_EQ(a.children, b.children);
+    EXPECT_EQ(a.text, b.text);
+}
+
+TEST(FlatASTTests, RootIsFirst) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+
+    ASSERT_GT(flat.Size(), 0);
+    EXPECT_EQ(flat.kinds[0], NodeKind::Program);
+    EXPECT_EQ(flat.first_child.size(), flat.Size() + 1);
+    EXPECT_EQ(flat.Children(0).size(), 3);
+}
+
+TEST(FlatASTTests, ChildrenFollowTheirParent) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+
+    // Pre-order numbering: a node is first reached through a lower index
+    vector<bool> reached(flat.Size(), false);
+    reached[0] = true;
+    for (NodeIndex i = 0; i < flat.Size(); i++) {
+        EXPECT_TRUE(reached[i]);
+        for (NodeIndex child : flat.Children(i)) {
+            if (child == NO_NODE) continue;
+            ASSERT_LT(child, flat.Size());
+            if (!reached[child]) {
+                EXPECT_GT(child, i);
+            }
+            reached[child] = true;
+        }
+    }
+}
+
+TEST(FlatASTTests, KeepsPayloads) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, "int answer = 42;"));
+
+    vector<std::string_view> names;
+    vector<std::string_view> values;
+    for (NodeIndex i = 0; i < flat.Size(); i++) {
+        if (flat.kinds[i] == NodeKind::Variable) names.push_back(flat.Text(i));
+        if (flat.kinds[i] == NodeKind::Value) values.push_back(flat.Text(i));
+    }
+
+    // The program location starts at line 1, column 1
+    NodeIndex location = flat.Children(0)[1];
+    NodeIndex start = flat.Children(location)[0];
+    ASSERT_EQ(flat.kinds[start], NodeKind::Start);
+    EXPECT_EQ(flat.data0[start], 1);
+    EXPECT_EQ(flat.data1[start], 1);
+
+    EXPECT_EQ(names, vector<std::string_view>{"answer"});
+    EXPECT_EQ(values, vector<std::string_view>{"42"});
+}
+
+TEST(FlatASTTests, RoundTrips) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+
+    Arena rebuilt;
+    ASTNode* root = Unflatten(flat, rebuilt);
+    auto* program = dynamic_cast<ProgramNode*>(root);
+    ASSERT_NE(program, nullptr);
+
+    auto* body = dynamic_cast<BodyNode*>(program->body);
+    ASSERT_NE(body, nullptr);
+    ASSERT_EQ(body->expressions.size(), 5);
+
+    expectSameArrays(flat, Flatten(root));
+}
+
+TEST(FlatASTTests, RebuildsDecodedLiterals) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+
+    Arena rebuilt;
+    auto* program = static_cast<ProgramNode*>(Unflatten(flat, rebuilt));
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* declaration =
+        static_cast<VariableDeclarationNode*>(body->expressions[1]);
+    auto* variable = static_cast<VariableNode*>(declaration->assignment);
+    auto* value = static_cast<ValueNode*>(variable->value);
+
+    EXPECT_EQ(value->value, "x");
+    EXPECT_EQ(value->literal.kind, Literal::Kind::Char);
+    EXPECT_EQ(value->literal.c, 'x');
+}
+
+TEST(FlatASTTests, SharedNodesStayShared) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, "int! c = allot(int) -> 5;"));
+
+    Arena rebuilt;
+    auto* program = static_cast<ProgramNode*>(Unflatten(flat, rebuilt));
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* statement = dynamic_cast<AllocationStatementNode*>(
+        body->expressions[0]);
+    ASSERT_NE(statement, nullptr);
+
+    auto* allocation = static_cast<AllocationNode*>(statement->allocation);
+    auto* initialization =
+        static_cast<InitializationStatementNode*>(statement->initialization);
+    ASSERT_NE(initialization, nullptr);
+    EXPECT_EQ(allocation->pointer_node, initialization->pointer_node);
+}
+
+TEST(FlatASTTests, EmptyProgram) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, ""));
+    Arena rebuilt;
+    expectSameArrays(flat, Flatten(Unflatten(flat, rebuilt)));
+
+    EXPECT_EQ(Unflatten(FlatAST{}, rebuilt), nullptr);
+}
+
+TEST(FlatASTTests, SmallerThanTheTree) {
+    Arena arena;
+    ASTNode* root = parseTree(arena, SOURCE);
+    FlatAST flat = Flatten(root);
+
+    EXPECT_LT(flat.MemoryBytes(), arena.BytesUsed());
+}
+
+TEST(FlatASTTests, RejectsMalformedArrays) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+    Arena rebuilt;
+
+    FlatAST out_of_range = flat;
+    out_of_range.children.back() = static_cast<NodeIndex>(flat.Size());
+    EXPECT_THROW(Unflatten(out_of_range, rebuilt), std::invalid_argument);
+
+    // A program node with fewer child slots than a program has
+    FlatAST too_few = flat;
+    for (size_t i = 1; i < too_few.first_child.size(); i++) {
+        too_few.first_child[i] = 0;
+    }
+    too_few.first_child.back() = static_cast<uint32_t>(flat.children.size());
+    EXPECT_THROW(Unflatten(too_few, rebuilt), std::invalid_argument);
+}
+
+TEST(FlatASTTests, RejectsCycles) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, SOURCE));
+
+    // The negation's operand points back at the product holding it
+    FlatAST cycle = flat;
+    for (NodeIndex i = 0; i < flat.Size(); i++) {
+        if (flat.kinds[i] != NodeKind::Binary) continue;
+        NodeIndex left = flat.Children(i)[1];
+        if (flat.kinds[left] != NodeKind::Unary) continue;
+        cycle.children[flat.first_child[left] + 1] = i;
+    }
+    ASSERT_NE(cycle.children, flat.children);
+
+    Arena rebuilt;
+    EXPECT_THROW(Unflatten(cycle, rebuilt), std::invalid_argument);
+}
+
+TEST(FlatASTTests, RejectsChildrenOfTheWrongKind) {
+    Arena arena;
+    FlatAST flat = Flatten(parseTree(arena, "int a = 1;"));
+
+    // The declared type slot holds the declaration's location instead
+    FlatAST wrong = flat;
+    for (NodeIndex i = 0; i < flat.Size(); i++) {
+        if (flat.kinds[i] != NodeKind::VariableDeclaration) continue;
+        wrong.children[flat.first_child[i] + 2] = flat.Children(i)[0];
+    }
+    ASSERT_NE(wrong.children, flat.children);
+
+    Arena rebuilt;
+    EXPECT_THROW(Unflatten(wrong, rebuilt), std::invalid_argument);
+}
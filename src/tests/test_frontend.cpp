@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+#include "core/Frontend.hpp"
+
+using namespace flecha::core;
+
+// Writes a temporary source file and returns its path
+static std::string writeSource(const std::string& contents) {
+    char path[] = "/tmp/flecha_frontend_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(write(fd, contents.data(), contents.size()),
+              static_cast<ssize_t>(contents.size()));
+    close(fd);
+    return path;
+}
+
+TEST(FrontendTests, ParsesEveryFile) {
+    vector<string> paths;
+    for (int i = 0; i < 64; i++) {
+        paths.push_back(writeSource("int a = " + std::to_string(i) +
+                                    ";\nint! p = allot(int) -> a * 2;\n"));
+    }
+
+    Frontend frontend(4);
+    vector<ParsedFile> files = frontend.ParseFiles(paths);
+
+    ASSERT_EQ(files.size(), paths.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        EXPECT_EQ(files[i].path, paths[i]);
+        ASSERT_NE(files[i].program, nullptr);
+        EXPECT_TRUE(files[i].diagnostics.empty());
+
+        auto* body = static_cast<BodyNode*>(files[i].program->body);
+        auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+        auto* value = static_cast<ValueNode*>(
+            static_cast<VariableNode*>(decl->assignment)->value);
+        EXPECT_EQ(value->value, std::to_string(i));
+
+        // One interner for every file
+        EXPECT_EQ(static_cast<VariableNode*>(decl->assignment)->symbol,
+                  frontend.Symbols().Find("a"));
+    }
+
+    for (const auto& path : paths) std::remove(path.c_str());
+}
+
+TEST(FrontendTests, DiagnosticsFollowInputOrder) {
+    vector<string> paths;
+    for (int i = 0; i < 32; i++) {
+        paths.push_back(writeSource(i % 3 ? "int a = 1;" : "int a = ;"));
+    }
+    paths.push_back("/nonexistent/flecha/file.fl");
+
+    // The same results with any number of threads
+    for (size_t threads : {1, 3, 8}) {
+        Frontend frontend(threads);
+        vector<ParsedFile> files = frontend.ParseFiles(paths);
+
+        for (int i = 0; i < 32; i++) {
+            bool broken = i % 3 == 0;
+            EXPECT_EQ(files[i].program == nullptr, broken);
+            ASSERT_EQ(files[i].diagnostics.size(), broken ? 1 : 0);
+            if (broken) {
+                EXPECT_EQ(files[i].diagnostics[0].rfind(paths[i] + ": ", 0), 0);
+                EXPECT_NE(files[i].diagnostics[0].find("at line 1, column 9"),
+                          string::npos);
+            }
+        }
+
+        EXPECT_EQ(files.back().program, nullptr);
+        EXPECT_EQ(files.back().diagnostics.size(), 1);
+    }
+
+    for (int i = 0; i < 32; i++) std::remove(paths[i].c_str());
+}
+
+TEST(FrontendTests, TreesOutliveTheirFiles) {
+    string path = writeSource("string s = \"kept\";");
+
+    Frontend frontend(2);
+    vector<ParsedFile> files = frontend.ParseFiles({path});
+    std::remove(path.c_str());
+
+    ASSERT_NE(files[0].program, nullptr);
+    auto* body = static_cast<BodyNode*>(files[0].program->body);
+    auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+    auto* value = static_cast<ValueNode*>(
+        static_cast<VariableNode*>(decl->assignment)->value);
+    EXPECT_EQ(value->value, "kept");
+}
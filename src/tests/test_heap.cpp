@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "core/AST.hpp"
+#include "memory/Heap.hpp"
+#include "utils/ThreadPool.hpp"
+
+using flecha::core::MemoryNode;
+using flecha::memory::Block;
+using flecha::memory::Heap;
+using flecha::memory::HeapCache;
+
+TEST(HeapTests, ClassesFitTheirRequests) {
+    EXPECT_EQ(Heap::ClassOf(0), 0);
+    EXPECT_EQ(Heap::ClassSize(Heap::ClassOf(sizeof(int))), 8);
+    EXPECT_EQ(Heap::ClassOf(sizeof(char)), Heap::ClassOf(sizeof(double)));
+    EXPECT_EQ(Heap::ClassOf(Heap::MAX_SMALL + 1), Heap::LARGE);
+
+    uint32_t previous = 0;
+    for (size_t size = 1; size <= Heap::MAX_SMALL; size++) {
+        uint32_t size_class = Heap::ClassOf(size);
+        size_t block = Heap::ClassSize(size_class);
+
+        ASSERT_LT(size_class, Heap::CLASSES);
+        ASSERT_GE(block, size);
+        ASSERT_GE(size_class, previous);
+        // The class below is too small, so no class wastes a fit
+        if (size_class > 0) {
+            ASSERT_LT(Heap::ClassSize(size_class - 1), size);
+        }
+        previous = size_class;
+    }
+    EXPECT_EQ(previous, Heap::CLASSES - 1);
+}
+
+TEST(HeapTests, FreedBlocksAreReused) {
+    Heap heap;
+    HeapCache cache(heap);
+
+    Block first = cache.Allocate(sizeof(int));
+    void* address = first.address;
+    cache.Free(first);
+
+    Block second = cache.Allocate(sizeof(float));
+    EXPECT_EQ(second.address, address);
+    cache.Free(second);
+}
+
+TEST(HeapTests, BlocksDoNotOverlap) {
+    Heap heap;
+    HeapCache cache(heap);
+    std::vector<Block> blocks;
+    std::set<uintptr_t> addresses;
+
+    // Enough blocks of each kind to span several slabs
+    for (int i = 0; i < 20000; i++) {
+        size_t size = i % 3 == 0 ? 24 : (i % 3 == 1 ? 1 : 200);
+        Block block = cache.Allocate(size);
+        std::memset(block.address, i & 0xff, size);
+        ASSERT_TRUE(addresses.insert(
+            reinterpret_cast<uintptr_t>(block.address)).second);
+        blocks.push_back(block);
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        ASSERT_EQ(*static_cast<unsigned char*>(blocks[i].address), i & 0xff);
+        cache.Free(blocks[i]);
+    }
+}
+
+TEST(HeapTests, BlocksAreAligned) {
+    Heap heap;
+    HeapCache cache(heap);
+
+    for (size_t size : {1, 8, 16, 48, 160, 4096}) {
+        Block block = cache.Allocate(size);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(block.address) %
+                      (size <= 8 ? 8 : 16),
+                  0)
+            << size;
+        cache.Free(block);
+    }
+}
+
+TEST(HeapTests, LargeBlocksGoToTheSystem) {
+    Heap heap;
+    HeapCache cache(heap);
+
+    Block block = cache.Allocate(1 << 20);
+    EXPECT_EQ(block.size_class, Heap::LARGE);
+    static_cast<char*>(block.address)[(1 << 20) - 1] = 'x';
+    cache.Free(block);
+}
+
+TEST(HeapTests, CachesShareTheirHeap) {
+    Heap heap;
+    std::vector<Block> blocks;
+    {
+        HeapCache cache(heap);
+        for (int i = 0; i < 1000; i++) blocks.push_back(cache.Allocate(8));
+    }
+
+    // Blocks may be freed through another cache, and reach the heap once
+    // that cache goes away
+    {
+        HeapCache other(heap);
+        for (Block block : blocks) other.Free(block);
+    }
+
+    HeapCache last(heap);
+    std::set<void*> reused;
+    for (int i = 0; i < 1000; i++) reused.insert(last.Allocate(8).address);
+    for (Block block : blocks) EXPECT_EQ(reused.count(block.address), 1);
+}
+
+TEST(HeapTests, ThreadsAllotConcurrently) {
+    Heap heap;
+    flecha::utils::ThreadPool pool(4);
+
+    for (int task = 0; task < 8; task++) {
+        pool.Submit([&heap, task](size_t) {
+            HeapCache cache(heap);
+            std::vector<Block> blocks;
+            for (int round = 0; round < 20; round++) {
+                for (int i = 0; i < 500; i++) {
+                    Block block = cache.Allocate(16);
+                    *static_cast<int*>(block.address) = task;
+                    blocks.push_back(block);
+                }
+                for (Block block : blocks) {
+                    ASSERT_EQ(*static_cast<int*>(block.address), task);
+                    cache.Free(block);
+                }
+                blocks.clear();
+            }
+        });
+    }
+    pool.Wait();
+}
+
+TEST(HeapTests, MemoryNodeIsAHandle) {
+    auto* node = new MemoryNode(nullptr, sizeof(int));
+    EXPECT_EQ(node->size_class, Heap::ClassOf(sizeof(int)));
+    *static_cast<int*>(node->address) = 7;
+
+    void* address = node->address;
+    node->Release();
+    EXPECT_EQ(node->address, nullptr);
+    delete node;
+
+    // The thread's cache hands the freed block out again
+    MemoryNode next(nullptr, sizeof(char));
+    EXPECT_EQ(next.address, address);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "core/Frontend.hpp"
+#include "core/Parser.hpp"
+#include "utils/Interner.hpp"
+#include "utils/ThreadPool.hpp"
+
+using namespace flecha;
+using flecha::memory::Arena;
+using utils::Interner;
+using utils::Symbol;
+
+TEST(InternerTests, EqualNamesShareASymbol) {
+    Interner interner;
+    std::string first = "counter";
+    std::string second = "counter";
+
+    Symbol a = interner.Intern(first);
+    Symbol b = interner.Intern(second);
+    Symbol c = interner.Intern("count");
+
+    EXPECT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(interner.Size(), 2);
+}
+
+TEST(InternerTests, PresetsHaveTheSameSymbolEverywhere) {
+    Interner first;
+    first.Intern("before");
+    Interner second;
+
+    for (size_t i = 0; i < Interner::PRESET_COUNT; i++) {
+        Symbol preset = Interner::Preset(i);
+        EXPECT_EQ(first.Find(Interner::PRESETS[i]), preset);
+        EXPECT_EQ(second.Intern(Interner::PRESETS[i]), preset);
+        EXPECT_EQ(Interner::Global().Find(Interner::PRESETS[i]), preset);
+        EXPECT_EQ(second.Name(preset), Interner::PRESETS[i]);
+    }
+    EXPECT_EQ(first.Size(), 1);
+    EXPECT_EQ(second.Size(), 0);
+}
+
+TEST(InternerTests, NamesAreStoredOnce) {
+    Interner interner;
+    std::string_view first, second;
+    interner.Intern(std::string("shared"), &first);
+    interner.Intern(std::string("shared"), &second);
+
+    EXPECT_EQ(first, "shared");
+    EXPECT_EQ(first.data(), second.data());
+}
+
+TEST(InternerTests, ResolvesSymbols) {
+    Interner interner;
+    Symbol empty = interner.Intern("");
+    Symbol name = interner.Intern("name");
+
+    EXPECT_TRUE(empty);
+    EXPECT_EQ(interner.Name(empty), "");
+    EXPECT_EQ(interner.Name(name), "name");
+    EXPECT_EQ(interner.Name(Symbol()), "");
+}
+
+TEST(InternerTests, FindDoesNotAdd) {
+    Interner interner;
+    EXPECT_FALSE(interner.Find("missing"));
+    EXPECT_EQ(interner.Size(), 0);
+
+    Symbol added = interner.Intern("present");
+    EXPECT_EQ(interner.Find("present"), added);
+    EXPECT_FALSE(interner.Find("missing"));
+    EXPECT_EQ(interner.Size(), 1);
+}
+
+TEST(InternerTests, NamesSurviveGrowth) {
+    Interner interner;
+    std::vector<Symbol> symbols;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 100000; i++) {
+        std::string_view view;
+        symbols.push_back(interner.Intern("name" + std::to_string(i), &view));
+        views.push_back(view);
+    }
+
+    EXPECT_EQ(interner.Size(), 100000);
+    for (int i = 0; i < 100000; i += 997) {
+        EXPECT_EQ(views[i], "name" + std::to_string(i));
+        EXPECT_EQ(interner.Name(symbols[i]), views[i]);
+        EXPECT_EQ(interner.Intern(views[i]), symbols[i]);
+    }
+}
+
+TEST(InternerTests, ThreadsAgreeOnSymbols) {
+    Interner interner;
+    constexpr int NAMES = 2000;
+    std::vector<std::vector<Symbol>> seen(8, std::vector<Symbol>(NAMES));
+
+    utils::ThreadPool pool(4);
+    for (int task = 0; task < 8; task++) {
+        pool.Submit([&, task](size_t) {
+            // Every task interns the same names in a different order
+            for (int i = 0; i < NAMES; i++) {
+                int name = (i * 7 + task * 131) % NAMES;
+                seen[task][name] = interner.Intern("n" + std::to_string(name));
+            }
+        });
+    }
+    pool.Wait();
+
+    EXPECT_EQ(interner.Size(), NAMES);
+    for (int task = 1; task < 8; task++) EXPECT_EQ(seen[task], seen[0]);
+}
+
+TEST(InternerTests, LocalInternerAgreesWithShared) {
+    Interner interner;
+    Symbol before = interner.Intern("outer");
+
+    utils::LocalInterner local(interner);
+    std::vector<Symbol> symbols;
+    for (int i = 0; i < 1000; i++) {
+        symbols.push_back(local.Intern("v" + std::to_string(i % 300)));
+    }
+
+    std::string_view stored;
+    EXPECT_EQ(local.Intern("outer", &stored), before);
+    EXPECT_EQ(stored.data(), interner.Name(before).data());
+    EXPECT_EQ(interner.Size(), 301);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(symbols[i], interner.Find("v" + std::to_string(i % 300)));
+    }
+}
+
+TEST(InternerTests, ParserInternsNames) {
+    Arena arena;
+    Interner interner;
+    core::Tokenizer tokenizer("int a = 1;\nint b = a;\nint! p = allot(int);");
+    core::Diagnostics diagnostics;
+    core::Parser parser(tokenizer, arena, diagnostics, interner);
+    core::ProgramNode* program = parser.Parse();
+
+    auto* body = static_cast<core::BodyNode*>(program->body);
+    auto declared = [&](size_t i) {
+        auto* decl =
+            static_cast<core::VariableDeclarationNode*>(body->expressions[i]);
+        return static_cast<core::VariableNode*>(decl->assignment);
+    };
+
+    core::VariableNode* a = declared(0);
+    auto* use = static_cast<core::VariableNode*>(declared(1)->value);
+    EXPECT_EQ(a->symbol, interner.Find("a"));
+    EXPECT_EQ(use->symbol, a->symbol);
+    EXPECT_EQ(use->name.data(), a->name.data());
+    EXPECT_NE(declared(1)->symbol, a->symbol);
+
+    auto* allocation =
+        static_cast<core::AllocationStatementNode*>(body->expressions[2]);
+    auto* pointer = static_cast<core::PointerNode*>(
+        static_cast<core::AllocationNode*>(allocation->allocation)
+            ->pointer_node);
+    auto* type = static_cast<core::TypeNode*>(pointer->type);
+    EXPECT_EQ(type->GetTypeSymbol(), interner.Find("int"));
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "core/Parser.hpp"
+#include "memory/Collector.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/Jit.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+using runtime::Chunk;
+using runtime::Instruction;
+using runtime::Jit;
+using runtime::JitOptions;
+using runtime::Op;
+using runtime::Value;
+using runtime::VM;
+
+static Chunk compileProgram(const std::string& source,
+                            runtime::CompileOptions options = {}) {
+    memory::Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    return runtime::Compile(parser.Parse(), options);
+}
+
+static Value intValue(int64_t i) {
+    Value value;
+    value.i = i;
+    return value;
+}
+
+static Value floatValue(double f) {
+    Value value;
+    value.f = f;
+    return value;
+}
+
+// Runs a chunk in both tiers and expects the same bits in every register
+static void expectSameRegisters(const Chunk& chunk) {
+    VM interpreter;
+    interpreter.Run(chunk);
+
+    Jit jit(JitOptions{0});
+    VM native(nullptr, nullptr, &jit);
+    native.Run(chunk);
+    ASSERT_EQ(jit.Stats().native_runs, 1);
+
+    for (size_t i = 0; i < chunk.registers; i++) {
+        EXPECT_EQ(interpreter.Registers()[i].i, native.Registers()[i].i)
+            << "register " << i;
+    }
+}
+
+TEST(JitTests, MatchesTheInterpreterOnEveryTemplate) {
+    if (!Jit::Supported()) GTEST_SKIP() << "No JIT on this machine";
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    Chunk chunk;
+    chunk.constants = {intValue(INT64_MAX), intValue(-7), intValue(3),
+                       floatValue(2.5), floatValue(nan), floatValue(-0.0),
+                       intValue(0)};
+
+    // Registers 0 to 6 hold the constants, the rest the results
+    for (uint16_t k = 0; k < 7; k++) {
+        chunk.code.push_back(Instruction{Op::LoadConst, k, k, 0});
+    }
+    uint16_t out = 7;
+    auto emit = [&](Op op, uint16_t b, uint16_t c) {
+        chunk.code.push_back(Instruction{op, out++, b, c});
+    };
+    for (Op op : {Op::AddInt, Op::SubInt, Op::MulInt, Op::DivInt, Op::ModInt,
+                  Op::And, Op::Or, Op::Xor}) {
+        emit(op, 0, 1);
+        emit(op, 1, 2);
+    }
+    emit(Op::NegInt, 1, 0);
+    emit(Op::Not, 6, 0);
+    emit(Op::Not, 1, 0);
+    emit(Op::IntToFloat, 1, 0);
+    emit(Op::Move, 3, 0);
+    for (Op op : {Op::AddFloat, Op::SubFloat, Op::MulFloat, Op::DivFloat}) {
+        emit(op, 3, 5);
+        emit(op, 3, 4);
+    }
+    emit(Op::NegFloat, 5, 0);
+    emit(Op::NegFloat, 4, 0);
+    for (Op op : {Op::EqInt, Op::NeInt, Op::LtInt, Op::LeInt, Op::GtInt,
+                  Op::GeInt}) {
+        emit(op, 1, 2);
+        emit(op, 2, 1);
+        emit(op, 2, 2);
+    }
+    // Every float compare against itself, a smaller value and NaN
+    for (Op op : {Op::EqFloat, Op::NeFloat, Op::LtFloat, Op::LeFloat,
+                  Op::GtFloat, Op::GeFloat}) {
+        emit(op, 3, 3);
+        emit(op, 3, 5);
+        emit(op, 5, 3);
+        emit(op, 3, 4);
+        emit(op, 4, 3);
+    }
+    uint16_t address = out;
+    emit(Op::AddressOf, 2, 0);
+    chunk.code.push_back(Instruction{Op::Store, address, 1, 0});
+    emit(Op::Load, address, 0);
+    chunk.code.push_back(Instruction{Op::Halt, 0, 0, 0});
+    chunk.registers = out;
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{1, 1});
+
+    // AddressOf points into each VM's own registers
+    VM interpreter;
+    interpreter.Run(chunk);
+    Jit jit(JitOptions{0});
+    VM native(nullptr, nullptr, &jit);
+    native.Run(chunk);
+
+    EXPECT_EQ(jit.Stats().instructions_stepped, 0);
+    EXPECT_EQ(jit.Stats().deopts, 0);
+    for (size_t i = 0; i < chunk.registers; i++) {
+        if (i == address) continue;
+        EXPECT_EQ(interpreter.Registers()[i].i, native.Registers()[i].i)
+            << "register " << i;
+    }
+    EXPECT_EQ(native.Registers()[2].i, -7);
+}
+
+TEST(JitTests, RunsCompiledPrograms) {
+    if (!Jit::Supported()) GTEST_SKIP() << "No JIT on this machine";
+
+    std::string source = "int i0 = 3;\nfloat f0 = 0.5;\nbool b0 = i0 > 1;\n";
+    for (int n = 1; n < 300; n++) {
+        std::string i = std::to_string(n), p = std::to_string(n - 1);
+        source += "int i" + i + " = (i" + p + " * 7 - " + i + ") % 1009;\n";
+        source += "float f" + i + " = f" + p + " * 0.5 + i" + i + " / 3;\n";
+        source += "bool b" + i + " = |b" + p + " || i" + i + " < f" + i +
+                  ";\n";
+    }
+    expectSameRegisters(compileProgram(source));
+}
+
+TEST(JitTests, StepsTheInterpreterForAllots) {
+    if (!Jit::Supported()) GTEST_SKIP() << "No JIT on this machine";
+
+    std::string source;
+    for (int i = 0; i < 100; i++) {
+        source += "int! p" + std::to_string(i) + " = allot(int) -> " +
+                  std::to_string(i * 3) + ";\n";
+    }
+    runtime::CompileOptions options;
+    options.promote_allots = false;
+    Chunk chunk = compileProgram(source, options);
+
+    memory::Collector collector;
+    Jit jit(JitOptions{0});
+    VM vm(&collector, nullptr, &jit);
+    vm.Run(chunk);
+
+    EXPECT_EQ(jit.Stats().instructions_stepped, 100);
+    EXPECT_EQ(collector.Stats().allocations, 100);
+    for (int i : {0, 42, 99}) {
+        void* p = vm.Get(chunk, "p" + std::to_string(i)).p;
+        EXPECT_EQ(static_cast<Value*>(p)->i, i * 3);
+    }
+}
+
+TEST(JitTests, CompilesOnceHot) {
+    Chunk chunk = compileProgram("int a = 2;\nint b = a * 21;\n");
+    Jit jit;
+    VM vm(nullptr, nullptr, &jit);
+
+    for (int run = 0; run < 5; run++) {
+        vm.Run(chunk);
+        EXPECT_EQ(vm.Get(chunk, "b").i, 42);
+    }
+
+    const runtime::JitStats& stats = jit.Stats();
+    if (!Jit::Supported()) {
+        EXPECT_EQ(stats.chunks_compiled, 0);
+        EXPECT_EQ(stats.interpreted_runs, 5);
+        return;
+    }
+    EXPECT_EQ(stats.chunks_compiled, 1);
+    EXPECT_EQ(stats.interpreted_runs, 2);
+    EXPECT_EQ(stats.native_runs, 3);
+    EXPECT_EQ(stats.instructions_compiled, chunk.code.size());
+    EXPECT_GT(stats.code_bytes, 0);
+    ASSERT_NE(chunk.native, nullptr);
+    // The machine code, not the pages mapped for it
+    EXPECT_LT(stats.code_bytes, 4096);
+    EXPECT_EQ(stats.code_bytes, chunk.native->Size());
+    EXPECT_GT(jit.Speedup(), 0);
+}
+
+TEST(JitTests, DeoptimizesWhenAGuardFails) {
+    if (!Jit::Supported()) GTEST_SKIP() << "No JIT on this machine";
+
+    // The most negative int over -1 wraps, which idiv would trap on
+    Chunk chunk;
+    chunk.registers = 5;
+    chunk.constants = {intValue(INT64_MIN), intValue(-1), intValue(5)};
+    chunk.code = {
+        Instruction{Op::LoadConst, 0, 0, 0},
+        Instruction{Op::LoadConst, 1, 1, 0},
+        Instruction{Op::LoadConst, 2, 2, 0},
+        Instruction{Op::DivInt, 3, 0, 1},
+        Instruction{Op::AddInt, 4, 3, 2},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{6, 9});
+    expectSameRegisters(chunk);
+
+    Jit jit(JitOptions{0});
+    VM vm(nullptr, nullptr, &jit);
+    vm.Run(chunk);
+    EXPECT_EQ(jit.Stats().deopts, 1);
+    EXPECT_EQ(vm.Registers()[4].i, INT64_MIN + 5);
+
+    // A zero divisor is the interpreter's error
+    chunk.constants[1] = intValue(0);
+    try {
+        vm.Run(chunk);
+        FAIL() << "Expected a division by zero error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Division by zero at line 6, column 9.");
+    }
+    EXPECT_EQ(jit.Stats().deopts, 2);
+}
+
+TEST(JitTests, KeepsTheErrorsOfSteps) {
+    if (!Jit::Supported()) GTEST_SKIP() << "No JIT on this machine";
+
+    // The intrinsics have no template, their step fails
+    Chunk chunk;
+    chunk.registers = 3;
+    chunk.constants = {intValue(2)};
+    chunk.code = {
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::SumInt, 2, 0, 1},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{3, 5});
+
+    Jit jit(JitOptions{0});
+    VM vm(nullptr, nullptr, &jit);
+    try {
+        vm.Run(chunk);
+        FAIL() << "Expected a null buffer error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Null buffer at line 3, column 5.");
+    }
+
+    // And the next run still starts natively
+    chunk.constants = {intValue(0)};
+    vm.Run(chunk);
+    EXPECT_EQ(vm.Registers()[2].i, 0);
+    EXPECT_EQ(jit.Stats().native_runs, 1);
+    EXPECT_EQ(jit.Stats().chunks_compiled, 1);
+}
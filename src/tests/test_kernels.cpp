@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "std/Kernels.hpp"
+
+using namespace flecha::stdlib;
+
+static const Isa ISAS[] = {Isa::Scalar, Isa::Sse42, Isa::Avx2, Isa::Avx512,
+                           Isa::Neon};
+
+// Every table this CPU can run, the scalar one first
+static std::vector<const Kernels*> supportedKernels() {
+    std::vector<const Kernels*> kernels;
+    for (Isa isa : ISAS) {
+        if (Supports(isa)) kernels.push_back(&KernelsFor(isa));
+    }
+    return kernels;
+}
+
+// Sizes around every vector width, and a few more
+static const size_t COUNTS[] = {0,  1,  2,  3,  7,  8,  9,  15, 16,  17, 31,
+                                32, 33, 63, 64, 65, 100, 127, 128, 129, 1000};
+
+TEST(KernelsTests, PicksASupportedIsa) {
+    EXPECT_TRUE(Supports(Isa::Scalar));
+    EXPECT_TRUE(Supports(BestIsa()));
+    EXPECT_EQ(Active().isa, BestIsa());
+    EXPECT_EQ(&Active(), &KernelsFor(BestIsa()));
+    EXPECT_STREQ(IsaName(Isa::Avx2), "avx2");
+
+    for (Isa isa : ISAS) {
+        if (!Supports(isa)) {
+            EXPECT_THROW(KernelsFor(isa), std::invalid_argument);
+        }
+    }
+}
+
+TEST(KernelsTests, MeasuresLengthsAtEveryAlignment) {
+    alignas(64) char buffer[256];
+    for (const Kernels* kernels : supportedKernels()) {
+        for (size_t start = 0; start < 64; start++) {
+            for (size_t length : {0, 1, 15, 16, 31, 32, 63, 64, 65, 150}) {
+                std::memset(buffer, 'x', sizeof(buffer));
+                buffer[start + length] = '\0';
+                EXPECT_EQ(kernels->length(buffer + start), length)
+                    << IsaName(kernels->isa) << " at " << start;
+            }
+        }
+    }
+}
+
+TEST(KernelsTests, FindsAndComparesBytes) {
+    std::vector<char> haystack(1100, 'a');
+    for (const Kernels* kernels : supportedKernels()) {
+        for (size_t count : COUNTS) {
+            for (size_t offset : {0, 1, 5}) {
+                const char* bytes = haystack.data() + offset;
+                EXPECT_EQ(kernels->find(bytes, count, 'b'), count);
+                EXPECT_EQ(kernels->compare(bytes, bytes, count), count);
+                if (count == 0) continue;
+
+                // The last byte, and one past the end is never read
+                haystack[offset + count - 1] = 'b';
+                haystack[offset + count] = 'c';
+                EXPECT_EQ(kernels->find(bytes, count, 'b'), count - 1)
+                    << IsaName(kernels->isa) << " " << count;
+                EXPECT_EQ(kernels->find(bytes, count, 'c'), count);
+
+                std::vector<char> other(bytes, bytes + count);
+                other[count / 2] = 'z';
+                EXPECT_EQ(kernels->compare(bytes, other.data(), count),
+                          count / 2)
+                    << IsaName(kernels->isa) << " " << count;
+                haystack[offset + count - 1] = 'a';
+                haystack[offset + count] = 'a';
+            }
+        }
+    }
+}
+
+TEST(KernelsTests, CopiesAndFills) {
+    for (const Kernels* kernels : supportedKernels()) {
+        for (size_t count : COUNTS) {
+            std::vector<char> from(count + 3), to(count + 3, '-');
+            for (size_t i = 0; i < from.size(); i++) from[i] = char(i * 7);
+            kernels->copy(to.data() + 1, from.data() + 2, count);
+            EXPECT_EQ(to[0], '-');
+            EXPECT_EQ(std::memcmp(to.data() + 1, from.data() + 2, count), 0);
+            EXPECT_EQ(to[count + 1], '-');
+
+            std::vector<int64_t> words(count + 1, 7);
+            kernels->fill(words.data(), -2, count);
+            for (size_t i = 0; i < count; i++) ASSERT_EQ(words[i], -2);
+            EXPECT_EQ(words[count], 7);
+        }
+
+        // Overlapping ranges copy like memmove
+        char text[] = "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnop";
+        kernels->copy(text + 1, text, 40);
+        EXPECT_EQ(std::string(text, 8), "aabcdefg");
+    }
+}
+
+TEST(KernelsTests, ReducesIntsLikeTheScalarKernels) {
+    std::mt19937_64 random(7);
+    std::vector<int64_t> values(1100);
+    for (int64_t& value : values) value = static_cast<int64_t>(random());
+    const Kernels& scalar = KernelsFor(Isa::Scalar);
+
+    for (const Kernels* kernels : supportedKernels()) {
+        for (size_t count : COUNTS) {
+            const int64_t* data = values.data() + 1;
+            EXPECT_EQ(kernels->sum_int(data, count),
+                      scalar.sum_int(data, count));
+            EXPECT_EQ(kernels->min_int(data, count),
+                      scalar.min_int(data, count));
+            EXPECT_EQ(kernels->max_int(data, count),
+                      scalar.max_int(data, count));
+        }
+        EXPECT_EQ(kernels->min_int(nullptr, 0), INT64_MAX);
+        EXPECT_EQ(kernels->max_int(nullptr, 0), INT64_MIN);
+
+        // Sums wrap
+        int64_t big[] = {INT64_MAX, 1, 0, 0, 0, 0, 0, 0, 0};
+        EXPECT_EQ(kernels->sum_int(big, 9), INT64_MIN);
+    }
+}
+
+TEST(KernelsTests, ReducesFloatsTheSameOnEveryIsa) {
+    std::mt19937_64 random(11);
+    std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+    std::vector<double> values(1100);
+    for (double& value : values) value = distribution(random);
+    const Kernels& scalar = KernelsFor(Isa::Scalar);
+
+    for (const Kernels* kernels : supportedKernels()) {
+        for (size_t count : COUNTS) {
+            const double* data = values.data() + 3;
+            // Bit for bit, the lanes are combined in one order
+            EXPECT_EQ(kernels->sum_float(data, count),
+                      scalar.sum_float(data, count))
+                << IsaName(kernels->isa) << " " << count;
+            EXPECT_EQ(kernels->min_float(data, count),
+                      scalar.min_float(data, count));
+            EXPECT_EQ(kernels->max_float(data, count),
+                      scalar.max_float(data, count));
+        }
+
+        double with_nan[] = {3, NAN, -1, 2, NAN, 5, 0, 1, 4, NAN};
+        EXPECT_EQ(kernels->min_float(with_nan, 10), -1.0);
+        EXPECT_EQ(kernels->max_float(with_nan, 10), 5.0);
+        EXPECT_EQ(kernels->min_float(nullptr, 0), HUGE_VAL);
+        EXPECT_EQ(kernels->sum_float(nullptr, 0), 0.0);
+    }
+
+    // Exact sums agree with a sequential one
+    std::vector<double> halves(37, 0.5);
+    EXPECT_EQ(Active().sum_float(halves.data(), halves.size()), 18.5);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "core/LineIndex.hpp"
+#include "core/Tokenizer.hpp"
+
+using namespace flecha::core;
+
+TEST(LineIndexTests, LocatesFirstLine) {
+    LineIndex index("int a;");
+
+    SourceLocation location = index.Locate(0);
+    EXPECT_EQ(location.line, 1);
+    EXPECT_EQ(location.column, 1);
+
+    location = index.Locate(4);
+    EXPECT_EQ(location.line, 1);
+    EXPECT_EQ(location.column, 5);
+}
+
+TEST(LineIndexTests, LocatesAcrossLines) {
+    LineIndex index("a\nbc\n\nd");
+
+    EXPECT_EQ(index.Locate(1).line, 1);  // The newline ends its own line
+    EXPECT_EQ(index.Locate(2).line, 2);
+    EXPECT_EQ(index.Locate(3).column, 2);
+    EXPECT_EQ(index.Locate(5).line, 3);
+    EXPECT_EQ(index.Locate(6).line, 4);
+    EXPECT_EQ(index.Locate(6).column, 1);
+}
+
+TEST(LineIndexTests, LocatesOutOfOrder) {
+    LineIndex index("one\ntwo\nthree\nfour");
+
+    EXPECT_EQ(index.Locate(14).line, 4);
+    EXPECT_EQ(index.Locate(0).line, 1);
+    EXPECT_EQ(index.Locate(9).line, 3);
+    EXPECT_EQ(index.Locate(9).column, 2);
+}
+
+TEST(LineIndexTests, LocatesEndOfSource) {
+    LineIndex index("x\n");
+
+    SourceLocation location = index.Locate(2);
+    EXPECT_EQ(location.line, 2);
+    EXPECT_EQ(location.column, 1);
+}
+
+TEST(LineIndexTests, TokenizerResolvesTokenOffsets) {
+    Tokenizer tokenizer("int a;\n  char! b;");
+
+    Token token;
+    while ((token = tokenizer.Next()).type != TokenType::Char) {
+    }
+    EXPECT_EQ(token.offset, 9);
+
+    SourceLocation location = tokenizer.Locate(token.offset);
+    EXPECT_EQ(location.line, 2);
+    EXPECT_EQ(location.column, 3);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "core/AST.hpp"
+#include "memory/Arena.hpp"
+#include "memory/MemStats.hpp"
+
+using flecha::core::LocationNode;
+using flecha::core::MemoryNode;
+using flecha::core::StartNode;
+using flecha::memory::AllotSite;
+using flecha::memory::Arena;
+using flecha::memory::Heap;
+using flecha::memory::MemStats;
+
+TEST(MemStatsTests, TracksLiveAndPeakBytes) {
+    MemStats stats;
+    stats.RecordAllot(4, Heap::ClassOf(4), AllotSite{1, 1});
+    stats.RecordAllot(100, Heap::ClassOf(100), AllotSite{2, 5});
+    stats.RecordDellot(100, AllotSite{2, 5});
+    stats.RecordAllot(8, Heap::ClassOf(8), AllotSite{1, 1});
+
+    EXPECT_EQ(stats.LiveBytes(), 12);
+    EXPECT_EQ(stats.PeakBytes(), 104);
+    EXPECT_EQ(stats.Allots(), 3);
+    EXPECT_EQ(stats.Dellots(), 1);
+    EXPECT_EQ(stats.ClassAllots(0), 2);
+    EXPECT_EQ(stats.ClassAllots(Heap::ClassOf(100)), 1);
+}
+
+TEST(MemStatsTests, GroupsAllotsBySite) {
+    MemStats stats;
+    for (int i = 0; i < 3; i++) stats.RecordAllot(4, 0, AllotSite{7, 3});
+    stats.RecordAllot(1, 0, AllotSite{2, 9});
+    stats.RecordDellot(4, AllotSite{7, 3});
+
+    auto sites = stats.Sites();
+    ASSERT_EQ(sites.size(), 2);
+    EXPECT_EQ(sites.begin()->first.line, 2);
+
+    const auto& hot = sites[AllotSite{7, 3}];
+    EXPECT_EQ(hot.allots, 3);
+    EXPECT_EQ(hot.bytes, 12);
+    EXPECT_EQ(hot.live_allots, 2);
+    EXPECT_EQ(hot.live_bytes, 8);
+}
+
+TEST(MemStatsTests, ReportsOutstandingAllots) {
+    MemStats stats;
+    stats.RecordAllot(4, 0, AllotSite{3, 10});
+    stats.RecordAllot(16, 1, AllotSite{4, 2});
+    stats.RecordDellot(16, AllotSite{4, 2});
+    stats.RecordAllot(1 << 20, Heap::LARGE, AllotSite{});
+
+    std::ostringstream out;
+    stats.Report(out);
+    std::string report = out.str();
+
+    EXPECT_NE(report.find("peak bytes: 1048580"), std::string::npos);
+    EXPECT_NE(report.find("8 bytes: 1 allot"), std::string::npos);
+    EXPECT_NE(report.find("large: 1 allot"), std::string::npos);
+
+    std::string outstanding =
+        report.substr(report.find("outstanding allots:"));
+    EXPECT_NE(outstanding.find("line 3, column 10: 1 allot, 4 bytes"),
+              std::string::npos);
+    EXPECT_NE(outstanding.find("unknown location"), std::string::npos);
+    EXPECT_EQ(outstanding.find("line 4"), std::string::npos);
+}
+
+TEST(MemStatsTests, ResetForgetsEverything) {
+    MemStats stats;
+    stats.RecordAllot(4, 0, AllotSite{1, 1});
+    stats.Reset();
+
+    EXPECT_EQ(stats.LiveBytes(), 0);
+    EXPECT_EQ(stats.PeakBytes(), 0);
+    EXPECT_EQ(stats.ClassAllots(0), 0);
+    EXPECT_TRUE(stats.Sites().empty());
+}
+
+#ifdef FLECHA_MEM_STATS
+TEST(MemStatsTests, MemoryNodesRecordTheirSite) {
+    Arena arena;
+    auto* location = arena.Make<LocationNode>(arena.Make<StartNode>(12, 4),
+                                              nullptr);
+    MemStats& stats = MemStats::Global();
+    size_t sites = stats.Sites().size();
+    size_t live = stats.LiveBytes();
+
+    auto* node = new MemoryNode(location, sizeof(int));
+    EXPECT_EQ(stats.LiveBytes(), live + sizeof(int));
+    AllotSite site{12, 4};
+    EXPECT_EQ(stats.Sites()[site].live_allots, 1);
+
+    node->Release();
+    delete node;
+    EXPECT_EQ(stats.LiveBytes(), live);
+    EXPECT_EQ(stats.Sites()[site].live_allots, 0);
+    EXPECT_EQ(stats.Sites().size(), sites + 1);
+}
+#endif
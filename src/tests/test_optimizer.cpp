@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/Document.hpp"
+#include "core/Optimizer.hpp"
+#include "core/Parser.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+static ProgramNode* parseProgram(Arena& arena, Tokenizer& tokenizer) {
+    Parser parser(tokenizer, arena);
+    return parser.Parse();
+}
+
+// The value the nth statement declares
+static ASTNode* valueAt(ProgramNode* program, size_t index) {
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* declaration =
+        static_cast<VariableDeclarationNode*>(body->expressions[index]);
+    return static_cast<VariableNode*>(declaration->assignment)->value;
+}
+
+static size_t statementCount(ProgramNode* program) {
+    return static_cast<BodyNode*>(program->body)->expressions.size();
+}
+
+// Runs a program as written and optimized, both must agree on a variable
+static void expectSameResult(std::string_view source, std::string_view name) {
+    Arena arena;
+    Tokenizer plain_tokens(source);
+    ProgramNode* plain = parseProgram(arena, plain_tokens);
+    runtime::Chunk expected = runtime::Compile(plain);
+
+    Tokenizer folded_tokens(source);
+    ProgramNode* folded = parseProgram(arena, folded_tokens);
+    Optimizer().Run(folded, arena);
+    runtime::Chunk actual = runtime::Compile(folded);
+
+    runtime::VM expected_vm, actual_vm;
+    expected_vm.Run(expected);
+    actual_vm.Run(actual);
+    EXPECT_EQ(expected.Find(name)->kind, actual.Find(name)->kind) << source;
+    EXPECT_EQ(expected_vm.Get(expected, name).i,
+              actual_vm.Get(actual, name).i)
+        << source;
+}
+
+TEST(OptimizerTests, FoldsConstantExpressions) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int a = (1 + 2) * 3 ** 2;\n"
+        "bool b = 2 < 3 && |0;\n"
+        "float c = 1.5 * 2;\n"
+        "int d = -(4 ^ 1);");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+
+    OptimizeReport report = Optimizer().Run(program, arena);
+    EXPECT_GT(report.Eliminated(), 0);
+
+    auto literalAt = [&](size_t index) {
+        ASTNode* value = valueAt(program, index);
+        EXPECT_EQ(value->kind, NodeKind::Value);
+        return static_cast<ValueNode*>(value)->literal;
+    };
+    EXPECT_EQ(literalAt(0).i, 27);
+    EXPECT_EQ(literalAt(1).kind, Literal::Kind::Bool);
+    EXPECT_EQ(literalAt(1).i, 1);
+    EXPECT_DOUBLE_EQ(literalAt(2).f, 3.0);
+    EXPECT_EQ(literalAt(3).i, -5);
+}
+
+TEST(OptimizerTests, FoldsLikeTheVM) {
+    expectSameResult("int a = 9223372036854775807 + 1;", "a");
+    expectSameResult("int a = 2 ** 70;", "a");
+    expectSameResult("int a = 7 / -1 + 7 % -1;", "a");
+    expectSameResult("int a = 'a' + 1;", "a");
+    expectSameResult("bool a = 1 < 2 || 0;", "a");
+    expectSameResult("int a = 3 || 4;", "a");
+    expectSameResult("bool a = 1.5 >= 1;", "a");
+    expectSameResult("bool a = |'x';", "a");
+}
+
+TEST(OptimizerTests, LeavesRuntimeErrorsToTheVM) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 1 / (2 - 2);");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+    Optimizer().Run(program, arena);
+
+    ASSERT_EQ(valueAt(program, 0)->kind, NodeKind::Binary);
+    runtime::Chunk chunk = runtime::Compile(program);
+    EXPECT_THROW(runtime::VM().Run(chunk), std::runtime_error);
+}
+
+TEST(OptimizerTests, LeavesNonFiniteFloatsUnfolded) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "float a = 1.5 / 0;\n"
+        "float b = 0.0 / 0;\n"
+        "float c = 10.0 ** 400;\n"
+        "float d = 1.5 / 2;");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+    Optimizer().Run(program, arena);
+
+    EXPECT_EQ(valueAt(program, 0)->kind, NodeKind::Binary);
+    EXPECT_EQ(valueAt(program, 1)->kind, NodeKind::Binary);
+    EXPECT_EQ(valueAt(program, 2)->kind, NodeKind::Binary);
+    EXPECT_EQ(valueAt(program, 3)->kind, NodeKind::Value);
+}
+
+TEST(OptimizerTests, LeavesKindErrorsToTheCompiler) {
+    Arena arena;
+    Tokenizer tokenizer("int a = \"x\" + 1;\nint b = 1.5 && 1;");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+    Optimizer().Run(program, arena);
+
+    EXPECT_EQ(valueAt(program, 0)->kind, NodeKind::Binary);
+    EXPECT_EQ(valueAt(program, 1)->kind, NodeKind::Binary);
+}
+
+TEST(OptimizerTests, DropsHiddenDeclarations) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int a = 1;\n"
+        "int a = 2;\n"
+        "int b = 1 + 1;\n"
+        "int c = b;\n"
+        "int b = 3;\n"
+        "int d = a;\n"
+        "int d = 4;");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+
+    Optimizer optimizer = Optimizer::Empty();
+    optimizer.Add(std::make_unique<ConstantFolding>());
+    optimizer.Add(std::make_unique<DeadStoreElimination>());
+    OptimizeReport report = optimizer.Run(program, arena);
+
+    // The first a and d are hidden unread, b is read by c first
+    EXPECT_EQ(statementCount(program), 5);
+    ASSERT_EQ(report.passes.size(), 2);
+    EXPECT_GT(report.passes[1].second, 0);
+
+    runtime::Chunk chunk = runtime::Compile(program);
+    runtime::VM vm;
+    vm.Run(chunk);
+    EXPECT_EQ(vm.Get(chunk, "a").i, 2);
+    EXPECT_EQ(vm.Get(chunk, "c").i, 2);
+    EXPECT_EQ(vm.Get(chunk, "d").i, 4);
+}
+
+TEST(OptimizerTests, KeepsDeclarationsThatCanFail) {
+    Arena arena;
+    Tokenizer tokenizer(
+        "int a = 1.5;\n"
+        "int a = 1;\n"
+        "int b = undefined;\n"
+        "int b = 2;\n"
+        "int c = 1 / 0;\n"
+        "int c = 3;");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+    Optimizer().Run(program, arena);
+
+    EXPECT_EQ(statementCount(program), 6);
+}
+
+TEST(OptimizerTests, RefoldsOnlyEditedStatements) {
+    Document document("int a = 1 + 2;\nint b = 3 * 4;\nint c = 5 - 6;\n");
+    Arena arena;
+    ConstantFolding folding;
+
+    folding.Run(*document.Program(), arena);
+    EXPECT_EQ(folding.Visited(), 3);
+    EXPECT_EQ(folding.Run(*document.Program(), arena), 0);
+    EXPECT_EQ(folding.Visited(), 0);
+
+    // Replaces "3 * 4" with "7 * 8"
+    document.Edit(23, 5, "7 * 8");
+    EXPECT_GT(folding.Run(*document.Program(), arena), 0);
+    EXPECT_EQ(folding.Visited(), 1);
+
+    auto* value = static_cast<ValueNode*>(valueAt(document.Program(), 1));
+    ASSERT_EQ(value->kind, NodeKind::Value);
+    EXPECT_EQ(value->literal.i, 56);
+}
+
+TEST(OptimizerTests, CountsEliminatedNodes) {
+    Arena arena;
+    Tokenizer tokenizer("int a = 1 + 2;");
+    ProgramNode* program = parseProgram(arena, tokenizer);
+    size_t before = CountNodes(program);
+
+    OptimizeReport report = Optimizer().Run(program, arena);
+    EXPECT_EQ(report.Eliminated(), before - CountNodes(program));
+    EXPECT_EQ(report.passes[0].first, std::string_view("ConstantFolding"));
+}
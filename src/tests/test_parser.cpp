@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <stdexcept>
+
+#include "core/Parser.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+ProgramNode* parse(Arena& arena, std::string_view source) {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer, arena);
+    return parser.Parse();
+}
+
+/* PROGRAM */
+
+TEST(ParserTests, EmptyProgram) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "");
+    ASSERT_NE(program, nullptr);
+
+    auto* body = dynamic_cast<BodyNode*>(program->body);
+    ASSERT_NE(body, nullptr);
+    EXPECT_TRUE(body->expressions.empty());
+}
+
+TEST(ParserTests, ParsesStatementsInOrder) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "int a = 1;\nchar b = 'x';\nint! c = allot(int);");
+    auto* body = dynamic_cast<BodyNode*>(
+        program->body);
+    ASSERT_EQ(body->expressions.size(), 3);
+
+    EXPECT_NE(dynamic_cast<VariableDeclarationNode*>(body->expressions[0]),
+              nullptr);
+    EXPECT_NE(dynamic_cast<VariableDeclarationNode*>(body->expressions[1]),
+              nullptr);
+    EXPECT_NE(dynamic_cast<AllocationStatementNode*>(body->expressions[2]),
+              nullptr);
+}
+
+/* DECLARATIONS */
+
+TEST(ParserTests, ParsesVariableDeclaration) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "float ratio = 3.14;");
+    auto* body = static_cast<BodyNode*>(
+        program->body);
+    auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+
+    auto* var = dynamic_cast<VariableNode*>(decl->assignment);
+    ASSERT_NE(var, nullptr);
+    EXPECT_EQ(var->name, "ratio");
+
+    auto* value = dynamic_cast<ValueNode*>(var->value);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->value, "3.14");
+    EXPECT_EQ(static_cast<TypeNode*>(value->type)->GetTypeName(), "float");
+}
+
+TEST(ParserTests, ParsesAllocationStatement) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "int! my_var = allot(int)->42;");
+    auto* body = static_cast<BodyNode*>(
+        program->body);
+    auto* stmt = dynamic_cast<AllocationStatementNode*>(body->expressions[0]);
+    ASSERT_NE(stmt, nullptr);
+
+    auto* alloc = dynamic_cast<AllocationNode*>(stmt->allocation);
+    ASSERT_NE(alloc, nullptr);
+    auto* ptr = dynamic_cast<PointerNode*>(alloc->pointer_node);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(ptr->memory, nullptr);
+
+    auto* var = static_cast<VariableNode*>(ptr->variable);
+    EXPECT_EQ(var->name, "my_var");
+
+    auto* value = static_cast<ValueNode*>(var->value);
+    EXPECT_EQ(value->value, "42");
+    EXPECT_EQ(value->type, ptr->type);
+    EXPECT_TRUE(static_cast<TypeNode*>(ptr->type)->IsPrimitive());
+}
+
+TEST(ParserTests, ParsesUserDefinedPointer) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "Node! head = allot(Node);");
+    auto* body = static_cast<BodyNode*>(
+        program->body);
+    auto* stmt = static_cast<AllocationStatementNode*>(body->expressions[0]);
+    auto* ptr = static_cast<PointerNode*>(
+        static_cast<AllocationNode*>(stmt->allocation)->pointer_node);
+
+    auto* type = dynamic_cast<UserDefinedTypeNode*>(ptr->type);
+    ASSERT_NE(type, nullptr);
+    EXPECT_EQ(type->GetTypeName(), "Node");
+}
+
+/* EXPRESSIONS */
+
+// Renders an expression fully parenthesized, e.g. (a + (b * c))
+static std::string render(ASTNode* node) {
+    static const std::map<TokenType, std::string> symbols = {
+        {TokenType::Add, "+"},        {TokenType::Sub, "-"},
+        {TokenType::Mul, "*"},        {TokenType::Div, "/"},
+        {TokenType::Mod, "%"},        {TokenType::Pow, "**"},
+        {TokenType::Xor, "^"},        {TokenType::Compare, "=="},
+        {TokenType::NotEqual, "|="},  {TokenType::Less, "<"},
+        {TokenType::LessEqual, "<="}, {TokenType::Greater, ">"},
+        {TokenType::And, "&&"},       {TokenType::Or, "||"},
+        {TokenType::Not, "|"},        {TokenType::AddressRef, "?"},
+        {TokenType::AssignVal, "->"},
+    };
+
+    switch (node->kind) {
+        case NodeKind::Value:
+            return std::string(static_cast<ValueNode*>(node)->value);
+        case NodeKind::Variable:
+            return std::string(static_cast<VariableNode*>(node)->name);
+        case NodeKind::Unary: {
+            auto* unary = static_cast<UnaryNode*>(node);
+            return "(" + symbols.at(unary->op) + render(unary->operand) + ")";
+        }
+        case NodeKind::Binary: {
+            auto* binary = static_cast<BinaryNode*>(node);
+            return "(" + render(binary->left) + " " + symbols.at(binary->op) +
+                   " " + render(binary->right) + ")";
+        }
+        default:
+            return "?";
+    }
+}
+
+// Parses int x = <expression>; and renders the value
+static std::string renderValue(Arena& arena, const std::string& expression) {
+    ProgramNode* program = parse(arena, "int x = " + expression + ";");
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+    return render(static_cast<VariableNode*>(decl->assignment)->value);
+}
+
+TEST(ParserTests, BinaryPrecedence) {
+    Arena arena;
+    EXPECT_EQ(renderValue(arena, "a + b * c"), "(a + (b * c))");
+    EXPECT_EQ(renderValue(arena, "a * b + c % d"), "((a * b) + (c % d))");
+    EXPECT_EQ(renderValue(arena, "a < b == c <= d"), "((a < b) == (c <= d))");
+    EXPECT_EQ(renderValue(arena, "a || b && c == 1"),
+              "(a || (b && (c == 1)))");
+    EXPECT_EQ(renderValue(arena, "a ^ b && c"), "((a ^ b) && c)");
+}
+
+TEST(ParserTests, Associativity) {
+    Arena arena;
+    EXPECT_EQ(renderValue(arena, "a - b - c"), "((a - b) - c)");
+    EXPECT_EQ(renderValue(arena, "a / b * c"), "((a / b) * c)");
+    EXPECT_EQ(renderValue(arena, "a ** b ** c"), "(a ** (b ** c))");
+    EXPECT_EQ(renderValue(arena, "p -> q -> 1"), "(p -> (q -> 1))");
+}
+
+TEST(ParserTests, UnaryAndParentheses) {
+    Arena arena;
+    EXPECT_EQ(renderValue(arena, "-a * b"), "((-a) * b)");
+    EXPECT_EQ(renderValue(arena, "-a ** 2"), "(-(a ** 2))");
+    EXPECT_EQ(renderValue(arena, "|done && ?ptr"), "((|done) && (?ptr))");
+    EXPECT_EQ(renderValue(arena, "(a + b) * c"), "((a + b) * c)");
+    EXPECT_EQ(renderValue(arena, "- -a"), "(-(-a))");
+}
+
+TEST(ParserTests, ExpressionLocationSpansOperands) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "int x = (a + 1) * b;");
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+    auto* binary = dynamic_cast<BinaryNode*>(
+        static_cast<VariableNode*>(decl->assignment)->value);
+    ASSERT_NE(binary, nullptr);
+
+    auto* location = static_cast<LocationNode*>(binary->location);
+    EXPECT_EQ(static_cast<StartNode*>(location->start)->column, 9);
+    EXPECT_EQ(static_cast<EndNode*>(location->end)->column, 19);
+}
+
+TEST(ParserTests, AllocationValueIsAnExpression) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "int! p = allot(int) -> 2 * n + 1;");
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* stmt = static_cast<AllocationStatementNode*>(body->expressions[0]);
+    auto* ptr = static_cast<PointerNode*>(
+        static_cast<AllocationNode*>(stmt->allocation)->pointer_node);
+
+    EXPECT_EQ(render(static_cast<VariableNode*>(ptr->variable)->value),
+              "((2 * n) + 1)");
+    EXPECT_NE(stmt->initialization, nullptr);
+}
+
+TEST(ParserTests, LongChainsDoNotRecurse) {
+    Arena arena;
+    std::string expression = "a";
+    for (int i = 0; i < 100000; i++) expression += " + a";
+
+    ProgramNode* program = parse(arena, "int x = " + expression + ";");
+    auto* body = static_cast<BodyNode*>(program->body);
+    EXPECT_EQ(body->expressions.size(), 1);
+}
+
+TEST(ParserTests, DeepNesting) {
+    Arena arena;
+    std::string nested = std::string(1000, '(') + "1" + std::string(1000, ')');
+    EXPECT_EQ(renderValue(arena, nested), "1");
+
+    std::string too_deep =
+        std::string(100000, '(') + "1" + std::string(100000, ')');
+    EXPECT_THROW(renderValue(arena, too_deep), std::runtime_error);
+}
+
+/* ERRORS */
+
+TEST(ParserTests, IncompleteExpressionThrows) {
+    Arena arena;
+    EXPECT_THROW(parse(arena, "int a = 1 +;"), std::runtime_error);
+    EXPECT_THROW(parse(arena, "int a = (1 + 2;"), std::runtime_error);
+    EXPECT_THROW(parse(arena, "int a = * 2;"), std::runtime_error);
+}
+
+
+TEST(ParserTests, MissingSemiColonThrows) {
+    Arena arena;
+    EXPECT_THROW(parse(arena, "int a = 1"), std::runtime_error);
+}
+
+TEST(ParserTests, MismatchedAllotTypeThrows) {
+    Arena arena;
+    EXPECT_THROW(parse(arena, "int! a = allot(char);"), std::runtime_error);
+}
+
+TEST(ParserTests, StatementWithoutTypeThrows) {
+    Arena arena;
+    EXPECT_THROW(parse(arena, "1;"), std::runtime_error);
+}
+
+TEST(ParserTests, ErrorReportsLineAndColumn) {
+    Arena arena;
+    try {
+        parse(arena, "int a = 1;\n  int b = ;");
+        FAIL() << "Expected a parser error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_NE(std::string(error.what()).find("at line 2, column 11"),
+                  std::string::npos)
+            << error.what();
+    }
+}
+
+TEST(ParserTests, ProgramRangeSpansSource) {
+    Arena arena;
+    ProgramNode* program = parse(arena, "  int a = 1;  ");
+    auto* range =
+        static_cast<RangeNode*>(program->range);
+
+    EXPECT_EQ(range->range.first, 2);
+    EXPECT_EQ(range->range.second, 14);
+}
+
+/* ARENA OWNERSHIP */
+
+TEST(ParserTests, TreeOutlivesSourceAndTokenizer) {
+    Arena arena;
+    ProgramNode* program;
+    {
+        std::string source = "string greeting = \"hi\\tthere\";";
+        program = parse(arena, source);
+        source.assign(source.size(), '#');
+    }
+
+    auto* body = static_cast<BodyNode*>(program->body);
+    auto* decl = static_cast<VariableDeclarationNode*>(body->expressions[0]);
+    auto* var = static_cast<VariableNode*>(decl->assignment);
+    EXPECT_EQ(var->name, "greeting");
+    EXPECT_EQ(static_cast<ValueNode*>(var->value)->value, "hi\tthere");
+}
+
+TEST(ParserTests, InitializationSharesPointer) {
+    Arena arena;
+    ProgramNode* program =
+        parse(arena, "int! a = allot(int)->1; int! b = allot(int);");
+    auto* body = static_cast<BodyNode*>(program->body);
+
+    auto* initialized =
+        static_cast<AllocationStatementNode*>(body->expressions[0]);
+    auto* init = dynamic_cast<InitializationStatementNode*>(
+        initialized->initialization);
+    ASSERT_NE(init, nullptr);
+    EXPECT_EQ(init->pointer_node,
+              static_cast<AllocationNode*>(initialized->allocation)
+                  ->pointer_node);
+
+    auto* uninitialized =
+        static_cast<AllocationStatementNode*>(body->expressions[1]);
+    EXPECT_EQ(uninitialized->initialization, nullptr);
+    auto* ptr = static_cast<PointerNode*>(
+        static_cast<AllocationNode*>(uninitialized->allocation)->pointer_node);
+    EXPECT_EQ(static_cast<VariableNode*>(ptr->variable)->value, nullptr);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <string>
+
+#include "core/CharClass.hpp"
+#include "core/Scan.hpp"
+#include "core/Tokenizer.hpp"
+
+using namespace flecha::core;
+
+// Offset where a scanner stops on the given text
+template <typename Scanner>
+size_t scanLength(Scanner scanner, const std::string& text) {
+    return scanner(text.data(), text.data() + text.size()) - text.data();
+}
+
+/* CHARACTER CLASSES */
+
+TEST(CharClassTests, MatchesCTypeForEveryByte) {
+    for (int c = 0; c < 256; c++) {
+        char ch = static_cast<char>(c);
+        bool ascii = c < 128;
+
+        EXPECT_EQ(IsSpace(ch), ascii && std::isspace(c) != 0) << c;
+        EXPECT_EQ(IsDigit(ch), ascii && std::isdigit(c) != 0) << c;
+        EXPECT_EQ(IsIdentStart(ch), ascii && (std::isalpha(c) || c == '_'))
+            << c;
+        EXPECT_EQ(IsIdentBody(ch), ascii && (std::isalnum(c) || c == '_'))
+            << c;
+    }
+}
+
+/* RUN SCANNERS */
+
+TEST(ScanTests, StopsAtEveryOffsetAcrossStrides) {
+    // Walk the stopping byte through several vector strides
+    for (size_t length = 0; length < 80; length++) {
+        EXPECT_EQ(scanLength(ScanWhitespace, std::string(length, ' ') + "x"),
+                  length);
+        EXPECT_EQ(scanLength(ScanIdentifier, std::string(length, 'a') + ";"),
+                  length);
+        EXPECT_EQ(scanLength(ScanDigits, std::string(length, '7') + "."),
+                  length);
+        EXPECT_EQ(scanLength(ScanStringBody, std::string(length, 'q') + "\""),
+                  length);
+    }
+}
+
+TEST(ScanTests, ConsumesWholeTextWithoutStop) {
+    std::string spaces(70, '\t');
+    EXPECT_EQ(scanLength(ScanWhitespace, spaces), spaces.size());
+    EXPECT_EQ(scanLength(ScanWhitespace, ""), 0);
+}
+
+TEST(ScanTests, RecognizesMixedRuns) {
+    std::string ident = "abcXYZ_019_zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz";
+    EXPECT_EQ(scanLength(ScanIdentifier, ident + "-"), ident.size());
+
+    std::string spaces = " \t\n\v\f\r \r\n\t\t\t                    \n";
+    EXPECT_EQ(scanLength(ScanWhitespace, spaces + "#"), spaces.size());
+
+    std::string body = "Hello, World! 'quotes' and more text past a stride";
+    EXPECT_EQ(scanLength(ScanStringBody, body + "\\n"), body.size());
+}
+
+TEST(ScanTests, NonAsciiBytesStopRuns) {
+    EXPECT_EQ(scanLength(ScanIdentifier, std::string(40, 'a') + "\xC3\xA9"),
+              40);
+    EXPECT_EQ(scanLength(ScanWhitespace, std::string(20, ' ') + "\xA0"), 20);
+    EXPECT_EQ(scanLength(ScanStringBody, std::string(20, 'a') + "\xC3\xA9\""),
+              22);
+}
+
+/* TOKENIZER RUNS */
+
+TEST(ScanTests, TokenizerOffsetsSurviveSkippedRuns) {
+    Tokenizer tokenizer(
+        "int a;\n\n      \n                                  b\n\"x\ny\" c");
+
+    Token token;
+    while (tokenizer.Text(token = tokenizer.Next()) != "b") {
+    }
+    EXPECT_EQ(tokenizer.Locate(token.offset).line, 4);
+
+    EXPECT_EQ(tokenizer.Next().type, TokenType::StringLiteral);
+    EXPECT_EQ(tokenizer.Locate(tokenizer.Next().offset).line, 6);
+}
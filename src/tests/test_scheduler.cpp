@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "runtime/Scheduler.hpp"
+
+using namespace flecha;
+using runtime::Chunk;
+using runtime::Global;
+using runtime::Instruction;
+using runtime::Op;
+using runtime::Scheduler;
+using runtime::Value;
+using runtime::ValueKind;
+
+/*
+ * Spawns tasks that each take a number from a shared counter and send it
+ * on a channel of one value, which the main task sums up. The tasks have
+ * no syntax yet, so the chunk is assembled by hand:
+ *   r0 channel, r1 counter, r2 one, r3 a task's number, r4 received,
+ *   r5 sum, r6 the counter at the end
+ */
+static Chunk fanIn(uint16_t tasks) {
+    Chunk chunk;
+    chunk.registers = 7;
+    chunk.constants = {Value{1}};
+    chunk.globals = {Global{"sum", 5, ValueKind::Int, ValueKind::Int},
+                     Global{"count", 6, ValueKind::Int, ValueKind::Int}};
+
+    chunk.code = {
+        Instruction{Op::LoadConst, 2, 0, 0},
+        Instruction{Op::MakeChannel, 0, 2, 0},
+        Instruction{Op::Allot, 1, 8, 0},
+        Instruction{Op::Store, 1, 5, 0},
+    };
+    for (uint16_t i = 0; i < tasks; i++) {
+        chunk.code.push_back(Instruction{Op::Spawn, 0, 0, 0});
+    }
+    for (uint16_t i = 0; i < tasks; i++) {
+        chunk.code.push_back(Instruction{Op::Receive, 4, 0, 0});
+        chunk.code.push_back(Instruction{Op::AddInt, 5, 5, 4});
+    }
+    chunk.code.push_back(Instruction{Op::Load, 6, 1, 0});
+    chunk.code.push_back(Instruction{Op::Dellot, 1, 8, 0});
+    chunk.code.push_back(Instruction{Op::Halt, 0, 0, 0});
+
+    // The tasks' code follows the main task's Halt
+    auto entry = static_cast<uint16_t>(chunk.code.size());
+    for (uint16_t i = 0; i < tasks; i++) chunk.code[4 + i].b = entry;
+    chunk.code.push_back(Instruction{Op::AtomicAdd, 3, 1, 2});
+    chunk.code.push_back(Instruction{Op::Send, 0, 3, 0});
+    chunk.code.push_back(Instruction{Op::Halt, 0, 0, 0});
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{1, 1});
+    return chunk;
+}
+
+TEST(SchedulerTests, RunsSpawnedTasks) {
+    Chunk chunk = fanIn(100);
+    Scheduler scheduler(4);
+    EXPECT_EQ(scheduler.Size(), 4);
+
+    // Again and again, to shake out lost wakes
+    for (int run = 0; run < 50; run++) {
+        scheduler.Run(chunk);
+        ASSERT_EQ(scheduler.Get(chunk, "count").i, 100);
+        ASSERT_EQ(scheduler.Get(chunk, "sum").i, 99 * 100 / 2);
+    }
+}
+
+TEST(SchedulerTests, RunsOnOneWorker) {
+    // Every blocked task must leave the only worker to the others
+    Chunk chunk = fanIn(20);
+    Scheduler scheduler(1);
+    scheduler.Run(chunk);
+    EXPECT_EQ(scheduler.Get(chunk, "sum").i, 19 * 20 / 2);
+}
+
+TEST(SchedulerTests, ReportsTasksWaitingForever) {
+    Chunk chunk;
+    chunk.registers = 3;
+    chunk.constants = {Value{1}};
+    chunk.code = {
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::MakeChannel, 0, 1, 0},
+        Instruction{Op::Receive, 2, 0, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{1, 1});
+
+    Scheduler scheduler(2);
+    try {
+        scheduler.Run(chunk);
+        FAIL() << "Expected a wait forever error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Every task left waits on a channel.");
+    }
+}
+
+TEST(SchedulerTests, RethrowsErrorsOfTasks) {
+    Chunk chunk;
+    chunk.registers = 2;
+    chunk.code = {
+        Instruction{Op::Spawn, 0, 2, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+        Instruction{Op::DivInt, 0, 1, 1},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations = {{1, 1}, {1, 1}, {2, 3}, {2, 3}};
+
+    Scheduler scheduler(2);
+    try {
+        scheduler.Run(chunk);
+        FAIL() << "Expected a division by zero error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Division by zero at line 2, column 3.");
+    }
+
+    EXPECT_THROW(Scheduler(1).Get(chunk, "x"), std::runtime_error);
+}
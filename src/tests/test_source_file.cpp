@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "core/Tokenizer.hpp"
+#include "utils/SourceFile.hpp"
+
+using namespace flecha;
+
+// Writes a temporary file and returns its path
+std::string writeTempFile(const std::string& contents) {
+    char path[] = "/tmp/flecha_source_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(write(fd, contents.data(), contents.size()),
+              static_cast<ssize_t>(contents.size()));
+    close(fd);
+    return path;
+}
+
+TEST(SourceFileTests, MapsRegularFile) {
+    std::string path = writeTempFile("int! var = allot(int);\n");
+    utils::SourceFile file(path);
+
+    EXPECT_TRUE(file.IsMapped());
+    EXPECT_EQ(file.Text(), "int! var = allot(int);\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(SourceFileTests, EmptyFileHasEmptyText) {
+    std::string path = writeTempFile("");
+    utils::SourceFile file(path);
+
+    EXPECT_TRUE(file.Text().empty());
+
+    std::remove(path.c_str());
+}
+
+TEST(SourceFileTests, ReadsPipesIntoBuffer) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::string contents = "char c = 'x';";
+    ASSERT_EQ(write(fds[1], contents.data(), contents.size()),
+              static_cast<ssize_t>(contents.size()));
+    close(fds[1]);
+
+    utils::SourceFile file(fds[0]);
+    close(fds[0]);
+
+    EXPECT_FALSE(file.IsMapped());
+    EXPECT_EQ(file.Text(), contents);
+}
+
+TEST(SourceFileTests, MissingFileThrows) {
+    EXPECT_THROW(utils::SourceFile("/nonexistent/flecha/source.fl"),
+                 std::runtime_error);
+}
+
+TEST(SourceFileTests, MovedFileKeepsMapping) {
+    std::string path = writeTempFile("bool b = 1;");
+    utils::SourceFile file(path);
+    const char* data = file.Text().data();
+
+    utils::SourceFile moved(std::move(file));
+    EXPECT_EQ(moved.Text().data(), data);
+    EXPECT_TRUE(file.Text().empty());
+
+    std::remove(path.c_str());
+}
+
+TEST(SourceFileTests, TokenizesMappedTextInPlace) {
+    std::string path = writeTempFile("int my_var = 42;");
+    utils::SourceFile file(path);
+    core::Tokenizer tokenizer(file.Text());
+
+    core::Token name = tokenizer.Peek(1);
+    EXPECT_EQ(tokenizer.Text(name), "my_var");
+    EXPECT_EQ(tokenizer.Text(name).data(), file.Text().data() + 4);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "core/Parser.hpp"
+#include "core/StaticVisitor.hpp"
+
+using namespace flecha::core;
+using flecha::memory::Arena;
+
+static ProgramNode* parseProgram(Arena& arena, std::string_view source) {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer, arena);
+    return parser.Parse();
+}
+
+// Every node without an overload falls back to visiting its children
+struct NameCollector : StaticVisitor<NameCollector> {
+    using StaticVisitor<NameCollector>::Visit;
+
+    vector<std::string_view> names;
+    int starts = 0;
+
+    void Visit(VariableNode& node) {
+        names.push_back(node.name);
+        VisitChildren(node);
+    }
+
+    void Visit(StartNode&) { starts++; }
+};
+
+struct KindOf : StaticVisitor<KindOf, int> {
+    using StaticVisitor<KindOf, int>::Visit;
+
+    int Visit(VariableNode&) { return 1; }
+    int Visit(PrimitiveTypeNode&) { return 2; }
+};
+
+TEST(StaticVisitorTests, ReachesEveryVariable) {
+    Arena arena;
+    ProgramNode* program =
+        parseProgram(arena, "int a = 1;\nchar b = 'x';\nint! c = allot(int);");
+
+    NameCollector collector;
+    collector.Dispatch(*program);
+
+    EXPECT_EQ(collector.names, (vector<std::string_view>{"a", "b", "c"}));
+    EXPECT_GT(collector.starts, 0);
+}
+
+TEST(StaticVisitorTests, SelectsTheMostSpecificOverload) {
+    VariableNode variable("x", nullptr, nullptr);
+    PrimitiveTypeNode type("int");
+    StartNode start(1, 1);
+
+    KindOf kind;
+    EXPECT_EQ(kind.Dispatch(variable), 1);
+    EXPECT_EQ(kind.Dispatch(type), 2);
+    EXPECT_EQ(kind.Dispatch(start), 0);
+}
+
+TEST(StaticVisitorTests, ForEachChildSeesNullSlots) {
+    PointerNode pointer(nullptr, nullptr, nullptr, nullptr);
+
+    int slots = 0;
+    ForEachChild(pointer, [&](ASTNode* child) {
+        EXPECT_EQ(child, nullptr);
+        slots++;
+    });
+    EXPECT_EQ(slots, 4);
+}
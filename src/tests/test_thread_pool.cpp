@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <mutex>
+
+#include "utils/ThreadPool.hpp"
+
+using namespace flecha;
+
+TEST(ThreadPoolTests, RunsEveryTask) {
+    utils::ThreadPool pool(4);
+    std::atomic<int> count{0};
+
+    for (int i = 0; i < 1000; i++) {
+        pool.Submit([&](size_t) { count++; });
+    }
+    pool.Wait();
+
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPoolTests, WaitsForNestedTasks) {
+    utils::ThreadPool pool(4);
+    std::atomic<int> count{0};
+
+    // A binary tree of tasks, 2^10 leaves
+    std::function<void(int)> spawn = [&](int depth) {
+        if (depth == 0) {
+            count++;
+            return;
+        }
+        for (int i = 0; i < 2; i++) {
+            pool.Submit([&spawn, depth](size_t) { spawn(depth - 1); });
+        }
+    };
+    pool.Submit([&](size_t) { spawn(10); });
+    pool.Wait();
+
+    EXPECT_EQ(count, 1024);
+}
+
+TEST(ThreadPoolTests, WorkerIndicesAreInRange) {
+    utils::ThreadPool pool(3);
+    EXPECT_EQ(pool.Size(), 3);
+
+    std::mutex lock;
+    std::set<size_t> workers;
+    for (int i = 0; i < 300; i++) {
+        pool.Submit([&](size_t worker) {
+            std::lock_guard<std::mutex> guard(lock);
+            workers.insert(worker);
+        });
+    }
+    pool.Wait();
+
+    ASSERT_FALSE(workers.empty());
+    EXPECT_LT(*workers.rbegin(), 3);
+}
+
+TEST(ThreadPoolTests, IsReusableAfterWait) {
+    utils::ThreadPool pool(2);
+    std::atomic<int> count{0};
+
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 10; i++) pool.Submit([&](size_t) { count++; });
+        pool.Wait();
+        EXPECT_EQ(count, (round + 1) * 10);
+    }
+}
+
+TEST(ThreadPoolTests, DefaultsToHardwareThreads) {
+    utils::ThreadPool pool;
+    EXPECT_GE(pool.Size(), 1);
+}
@@ -1,28 +1,46 @@
 #include "core/Tokenizer.hpp"
 #include <gtest/gtest.h>
+#include <deque>
+#include <limits>
+#include <string>
 #include <vector>
 
 using namespace flecha::core;
 
-std::vector<Token> tokenize(const std::string& source) {
-    Tokenizer tokenizer(source);
-    std::vector<Token> tokens = tokenizer.Tokenize(); 
+// Token texts live in the tokenizer that produced them, so every tokenizer
+// is kept alive until the test binary exits
+static std::deque<Tokenizer> tokenizers;
+
+std::vector<Token> tokenize(std::string_view source) {
+    std::vector<Token> tokens = tokenizers.emplace_back(source).Tokenize(); 
     return tokens;
 }
 
+// Gets the text of a token from the last tokenize call
+std::string_view text(const Token& token) {
+    return tokenizers.back().Text(token);
+}
+
+// Checks whether a token's text points into the given source text
+bool viewsInto(const Token& token, std::string_view source) {
+    std::string_view value = text(token);
+    return value.data() >= source.data() &&
+           value.data() + value.size() <= source.data() + source.size();
+}
+
 
 TEST(TokenizerTests, RecognizesKeywords) {
     auto tokens = tokenize("int char bool");
     ASSERT_EQ(tokens.size(), 4); // 3 keywords + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::Int);
-    EXPECT_EQ(tokens[0].value, "int");
+    EXPECT_EQ(text(tokens[0]), "int");
 
     EXPECT_EQ(tokens[1].type, TokenType::Char);
-    EXPECT_EQ(tokens[1].value, "char");
+    EXPECT_EQ(text(tokens[1]), "char");
 
     EXPECT_EQ(tokens[2].type, TokenType::Bool);
-    EXPECT_EQ(tokens[2].value, "bool");
+    EXPECT_EQ(text(tokens[2]), "bool");
 
     EXPECT_EQ(tokens[3].type, TokenType::EOF_TOKEN);
 }
@@ -32,16 +50,16 @@ TEST(TokenizerTests, RecognizesMultiCharacterOperators) {
     ASSERT_EQ(tokens.size(), 5); // 4 operators + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::AssignVal);
-    EXPECT_EQ(tokens[0].value, "->");
+    EXPECT_EQ(text(tokens[0]), "->");
 
     EXPECT_EQ(tokens[1].type, TokenType::Pow);
-    EXPECT_EQ(tokens[1].value, "**");
+    EXPECT_EQ(text(tokens[1]), "**");
 
     EXPECT_EQ(tokens[2].type, TokenType::Compare);
-    EXPECT_EQ(tokens[2].value, "==");
+    EXPECT_EQ(text(tokens[2]), "==");
 
     EXPECT_EQ(tokens[3].type, TokenType::LessEqual);
-    EXPECT_EQ(tokens[3].value, "<=");
+    EXPECT_EQ(text(tokens[3]), "<=");
 
     EXPECT_EQ(tokens[4].type, TokenType::EOF_TOKEN);
 }
@@ -51,10 +69,10 @@ TEST(TokenizerTests, RecognizesIdentifiers) {
     ASSERT_EQ(tokens.size(), 3); // 2 identifiers + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::Identifier);
-    EXPECT_EQ(tokens[0].value, "variable1");
+    EXPECT_EQ(text(tokens[0]), "variable1");
 
     EXPECT_EQ(tokens[1].type, TokenType::Identifier);
-    EXPECT_EQ(tokens[1].value, "_v_ar2");
+    EXPECT_EQ(text(tokens[1]), "_v_ar2");
 
     EXPECT_EQ(tokens[2].type, TokenType::EOF_TOKEN);
 }
@@ -64,13 +82,13 @@ TEST(TokenizerTests, RecognizesNumbers) {
     ASSERT_EQ(tokens.size(), 4); // 3 numbers + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::NumberLiteral);
-    EXPECT_EQ(tokens[0].value, "123");
+    EXPECT_EQ(text(tokens[0]), "123");
 
     EXPECT_EQ(tokens[1].type, TokenType::NumberLiteral);
-    EXPECT_EQ(tokens[1].value, "0");
+    EXPECT_EQ(text(tokens[1]), "0");
 
     EXPECT_EQ(tokens[2].type, TokenType::FloatLiteral); // If floating-point numbers are supported
-    EXPECT_EQ(tokens[2].value, "3.14");
+    EXPECT_EQ(text(tokens[2]), "3.14");
 
     EXPECT_EQ(tokens[3].type, TokenType::EOF_TOKEN);
 }
@@ -80,28 +98,28 @@ TEST(TokenizerTests, RecognizesSpecialCharacters) {
     ASSERT_EQ(tokens.size(), 9); // 8 characters + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::Bang);
-    EXPECT_EQ(tokens[0].value, "!");
+    EXPECT_EQ(text(tokens[0]), "!");
 
     EXPECT_EQ(tokens[1].type, TokenType::AddressRef);
-    EXPECT_EQ(tokens[1].value, "?");
+    EXPECT_EQ(text(tokens[1]), "?");
 
     EXPECT_EQ(tokens[2].type, TokenType::LParen);
-    EXPECT_EQ(tokens[2].value, "(");
+    EXPECT_EQ(text(tokens[2]), "(");
 
     EXPECT_EQ(tokens[3].type, TokenType::RParen);
-    EXPECT_EQ(tokens[3].value, ")");
+    EXPECT_EQ(text(tokens[3]), ")");
 
     EXPECT_EQ(tokens[4].type, TokenType::LBracket);
-    EXPECT_EQ(tokens[4].value, "[");
+    EXPECT_EQ(text(tokens[4]), "[");
 
     EXPECT_EQ(tokens[5].type, TokenType::RBracket);
-    EXPECT_EQ(tokens[5].value, "]");
+    EXPECT_EQ(text(tokens[5]), "]");
 
     EXPECT_EQ(tokens[6].type, TokenType::LCurly);
-    EXPECT_EQ(tokens[6].value, "{");
+    EXPECT_EQ(text(tokens[6]), "{");
 
     EXPECT_EQ(tokens[7].type, TokenType::RCurly);
-    EXPECT_EQ(tokens[7].value, "}");
+    EXPECT_EQ(text(tokens[7]), "}");
 
     EXPECT_EQ(tokens[8].type, TokenType::EOF_TOKEN);
 }
@@ -111,37 +129,37 @@ TEST(TokenizerTests, RecognizesComplexStatements) {
     ASSERT_EQ(tokens.size(), 12); // Tokens + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::Int);
-    EXPECT_EQ(tokens[0].value, "int");
+    EXPECT_EQ(text(tokens[0]), "int");
 
     EXPECT_EQ(tokens[1].type, TokenType::Bang);
-    EXPECT_EQ(tokens[1].value, "!");
+    EXPECT_EQ(text(tokens[1]), "!");
 
     EXPECT_EQ(tokens[2].type, TokenType::Identifier);
-    EXPECT_EQ(tokens[2].value, "my_var");
+    EXPECT_EQ(text(tokens[2]), "my_var");
 
     EXPECT_EQ(tokens[3].type, TokenType::Equal);
-    EXPECT_EQ(tokens[3].value, "=");
+    EXPECT_EQ(text(tokens[3]), "=");
 
     EXPECT_EQ(tokens[4].type, TokenType::Allot);
-    EXPECT_EQ(tokens[4].value, "allot");
+    EXPECT_EQ(text(tokens[4]), "allot");
 
     EXPECT_EQ(tokens[5].type, TokenType::LParen);
-    EXPECT_EQ(tokens[5].value, "(");
+    EXPECT_EQ(text(tokens[5]), "(");
 
     EXPECT_EQ(tokens[6].type, TokenType::Int);
-    EXPECT_EQ(tokens[6].value, "int");
+    EXPECT_EQ(text(tokens[6]), "int");
 
     EXPECT_EQ(tokens[7].type, TokenType::RParen);
-    EXPECT_EQ(tokens[7].value, ")");
+    EXPECT_EQ(text(tokens[7]), ")");
 
     EXPECT_EQ(tokens[8].type, TokenType::AssignVal);
-    EXPECT_EQ(tokens[8].value, "->");
+    EXPECT_EQ(text(tokens[8]), "->");
 
     EXPECT_EQ(tokens[9].type, TokenType::NumberLiteral);
-    EXPECT_EQ(tokens[9].value, "42");
+    EXPECT_EQ(text(tokens[9]), "42");
 
     EXPECT_EQ(tokens[10].type, TokenType::SemiColon);
-    EXPECT_EQ(tokens[10].value, ";");
+    EXPECT_EQ(text(tokens[10]), ";");
 
     EXPECT_EQ(tokens[11].type, TokenType::EOF_TOKEN);
 }
@@ -151,13 +169,13 @@ TEST(TokenizerTests, RecognizesStringLiterals) {
     ASSERT_EQ(tokens.size(), 4); // 3 string literals + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[0].value, "Hello, World!");
+    EXPECT_EQ(text(tokens[0]), "Hello, World!");
 
     EXPECT_EQ(tokens[1].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[1].value, "This is a test.");
+    EXPECT_EQ(text(tokens[1]), "This is a test.");
 
     EXPECT_EQ(tokens[2].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[2].value, "Escape \"quote\"");
+    EXPECT_EQ(text(tokens[2]), "Escape \"quote\"");
 
     EXPECT_EQ(tokens[3].type, TokenType::EOF_TOKEN);
 }
@@ -173,7 +191,7 @@ TEST(TokenizerTests, RecognizesEmptyStringLiteral) {
     ASSERT_EQ(tokens.size(), 2); // 1 empty string + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[0].value, "");
+    EXPECT_EQ(text(tokens[0]), "");
 
     EXPECT_EQ(tokens[1].type, TokenType::EOF_TOKEN);
 }
@@ -183,7 +201,7 @@ TEST(TokenizerTests, StringWithNewlineEscape) {
     ASSERT_EQ(tokens.size(), 2); // 1 string + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[0].value, "Line1\nLine2");
+    EXPECT_EQ(text(tokens[0]), "Line1\nLine2");
 
     EXPECT_EQ(tokens[1].type, TokenType::EOF_TOKEN);
 }
@@ -193,13 +211,13 @@ TEST(TokenizerTests, RecognizesCharacterLiterals) {
     ASSERT_EQ(tokens.size(), 4); // 3 char literals + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::CharLiteral);
-    EXPECT_EQ(tokens[0].value, "a");
+    EXPECT_EQ(text(tokens[0]), "a");
 
     EXPECT_EQ(tokens[1].type, TokenType::CharLiteral);
-    EXPECT_EQ(tokens[1].value, "\n");
+    EXPECT_EQ(text(tokens[1]), "\n");
 
     EXPECT_EQ(tokens[2].type, TokenType::CharLiteral);
-    EXPECT_EQ(tokens[2].value, "'");
+    EXPECT_EQ(text(tokens[2]), "'");
 
     EXPECT_EQ(tokens[3].type, TokenType::EOF_TOKEN);
 }
@@ -227,7 +245,7 @@ TEST(TokenizerTests, StringWithEscapedCharacters) {
     ASSERT_EQ(tokens.size(), 2); // 1 string + EOF
 
     EXPECT_EQ(tokens[0].type, TokenType::StringLiteral);
-    EXPECT_EQ(tokens[0].value, "This is a \"test\" with \n and \t.");
+    EXPECT_EQ(text(tokens[0]), "This is a \"test\" with \n and \t.");
 
     EXPECT_EQ(tokens[1].type, TokenType::EOF_TOKEN);
 }
@@ -238,3 +256,179 @@ TEST(TokenizerTests, CharacterWithInvalidEscapeSequence) {
     }, std::runtime_error);
 }
 
+
+TEST(TokenizerTests, TokenValuesViewIntoSource) {
+    std::string_view source = "int! my_var = allot(int)->42; \"plain\"";
+    auto tokens = tokenize(source);
+    ASSERT_EQ(tokens.size(), 13); // Tokens + EOF
+
+    // Keywords, identifiers and literals are slices of the source
+    for (size_t i : {0, 2, 4, 6, 9, 11}) {
+        EXPECT_TRUE(viewsInto(tokens[i], source)) << "token " << i;
+    }
+
+    EXPECT_EQ(tokens[11].type, TokenType::StringLiteral);
+    EXPECT_EQ(text(tokens[11]), "plain");
+}
+
+TEST(TokenizerTests, EscapedStringLiteralIsDecodedCopy) {
+    std::string_view source = "\"a\\tb\" 'x' '\\n'";
+    auto tokens = tokenize(source);
+    ASSERT_EQ(tokens.size(), 4); // 3 literals + EOF
+
+    EXPECT_EQ(text(tokens[0]), "a\tb");
+    EXPECT_FALSE(viewsInto(tokens[0], source));
+
+    EXPECT_EQ(text(tokens[1]), "x");
+    EXPECT_TRUE(viewsInto(tokens[1], source));
+
+    EXPECT_EQ(text(tokens[2]), "\n");
+}
+
+TEST(TokenizerTests, UnknownCharacterDoesNotSkipNext) {
+    auto tokens = tokenize("&x");
+    ASSERT_EQ(tokens.size(), 3); // Unknown + identifier + EOF
+
+    EXPECT_EQ(tokens[0].type, TokenType::NoToken);
+    EXPECT_EQ(text(tokens[0]), "&");
+
+    EXPECT_EQ(tokens[1].type, TokenType::Identifier);
+    EXPECT_EQ(text(tokens[1]), "x");
+}
+
+TEST(TokenizerTests, PeekDoesNotConsume) {
+    Tokenizer tokenizer("int! var;");
+
+    EXPECT_EQ(tokenizer.Peek().type, TokenType::Int);
+    EXPECT_EQ(tokenizer.Peek(2).type, TokenType::Identifier);
+    EXPECT_EQ(tokenizer.Peek(3).type, TokenType::SemiColon);
+
+    EXPECT_EQ(tokenizer.Next().type, TokenType::Int);
+    EXPECT_EQ(tokenizer.Next().type, TokenType::Bang);
+    EXPECT_EQ(tokenizer.Text(tokenizer.Peek()), "var");
+    EXPECT_EQ(tokenizer.Text(tokenizer.Next()), "var");
+    EXPECT_EQ(tokenizer.Next().type, TokenType::SemiColon);
+}
+
+TEST(TokenizerTests, NextKeepsReturningEOF) {
+    Tokenizer tokenizer("x");
+
+    EXPECT_EQ(tokenizer.Next().type, TokenType::Identifier);
+    EXPECT_EQ(tokenizer.Next().type, TokenType::EOF_TOKEN);
+    EXPECT_EQ(tokenizer.Peek(1).type, TokenType::EOF_TOKEN);
+    EXPECT_EQ(tokenizer.Next().type, TokenType::EOF_TOKEN);
+}
+
+TEST(TokenizerTests, PeekBeyondLookaheadThrows) {
+    Tokenizer tokenizer("a b c d e");
+
+    EXPECT_THROW(tokenizer.Peek(Tokenizer::LOOKAHEAD), std::out_of_range);
+}
+
+TEST(TokenizerTests, RecognizesEveryKeyword) {
+    auto tokens = tokenize(
+        "int char bool float string void strict method class construct "
+        "destruct return allot dellot");
+    std::vector<TokenType> expected = {
+        TokenType::Int,      TokenType::Char,      TokenType::Bool,
+        TokenType::Float,    TokenType::String,    TokenType::Void,
+        TokenType::Strict,   TokenType::Method,    TokenType::Class,
+        TokenType::Construct, TokenType::Destruct, TokenType::Return,
+        TokenType::Allot,    TokenType::Dellot,    TokenType::EOF_TOKEN,
+    };
+    ASSERT_EQ(tokens.size(), expected.size());
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(tokens[i].type, expected[i]) << text(tokens[i]);
+    }
+}
+
+TEST(TokenizerTests, KeywordLookalikesAreIdentifiers) {
+    auto tokens = tokenize(
+        "in integer chars boo floats strin stricter methods klass "
+        "constructs destructs returns allots dellots strinG stri_t Int");
+    ASSERT_EQ(tokens.size(), 18);
+
+    for (size_t i = 0; i + 1 < tokens.size(); i++) {
+        EXPECT_EQ(tokens[i].type, TokenType::Identifier) << text(tokens[i]);
+    }
+}
+
+TEST(TokenizerTests, TokensAreEightBytes) {
+    EXPECT_EQ(sizeof(Token), 8);
+    EXPECT_EQ(sizeof(TokenType), 1);
+}
+
+TEST(TokenizerTests, TokensRecordTheirSpan) {
+    auto tokens = tokenize("int! abc = \"q\" -> 'c';");
+    ASSERT_EQ(tokens.size(), 9);
+
+    EXPECT_EQ(tokens[2].offset, 5);
+    EXPECT_EQ(tokens[2].length, 3);
+    EXPECT_FALSE(tokens[2].in_table);
+
+    // Literal spellings start past the opening quote
+    EXPECT_EQ(tokens[4].offset, 11);
+    EXPECT_EQ(tokens[4].length, 1);
+    EXPECT_EQ(text(tokens[4]), "q");
+
+    EXPECT_EQ(tokens[5].length, 2);
+    EXPECT_EQ(text(tokens[6]), "c");
+}
+
+TEST(TokenizerTests, EscapedLiteralsGoToTheTable) {
+    auto tokens = tokenize("\"a\\nb\" '\\t' \"plain\"");
+    ASSERT_EQ(tokens.size(), 4);
+
+    EXPECT_TRUE(tokens[0].in_table);
+    EXPECT_EQ(tokens[0].length, 0); // First table entry
+    EXPECT_EQ(text(tokens[0]), "a\nb");
+
+    EXPECT_TRUE(tokens[1].in_table);
+    EXPECT_EQ(tokens[1].length, 1);
+    EXPECT_EQ(text(tokens[1]), "\t");
+
+    EXPECT_FALSE(tokens[2].in_table);
+    EXPECT_EQ(text(tokens[2]), "plain");
+}
+
+TEST(TokenizerTests, DecodesNumberAndCharLiterals) {
+    Tokenizer tokenizer("9007199254740993 2.5 'z' \"7\" x");
+
+    Literal number = tokenizer.Value(tokenizer.Next());
+    EXPECT_EQ(number.kind, Literal::Kind::Int);
+    EXPECT_EQ(number.i, 9007199254740993);
+
+    Literal real = tokenizer.Value(tokenizer.Next());
+    EXPECT_EQ(real.kind, Literal::Kind::Float);
+    EXPECT_DOUBLE_EQ(real.f, 2.5);
+
+    Literal character = tokenizer.Value(tokenizer.Next());
+    EXPECT_EQ(character.kind, Literal::Kind::Char);
+    EXPECT_EQ(character.c, 'z');
+
+    // Strings and names have no payload
+    EXPECT_EQ(tokenizer.Value(tokenizer.Next()).kind, Literal::Kind::None);
+    EXPECT_EQ(tokenizer.Value(tokenizer.Next()).kind, Literal::Kind::None);
+}
+
+TEST(TokenizerTests, NumbersOutOfRangeThrow) {
+    EXPECT_NO_THROW(tokenize("9223372036854775807"));
+    EXPECT_THROW(tokenize("9223372036854775808"), std::runtime_error);
+}
+
+TEST(TokenizerTests, TinyFloatsUnderflowQuietly) {
+    // Too small for a double, unlike too large, is not an error
+    std::string tiny = "0." + std::string(400, '0') + "1";
+    Tokenizer tokenizer(tiny);
+    EXPECT_DOUBLE_EQ(tokenizer.Value(tokenizer.Next()).f, 0.0);
+
+    std::string denormal = "0." + std::string(310, '0') + "1";
+    Tokenizer rounded(denormal);
+    double value = rounded.Value(rounded.Next()).f;
+    EXPECT_GT(value, 0.0);
+    EXPECT_LT(value, std::numeric_limits<double>::min());
+
+    EXPECT_THROW(tokenize("1" + std::string(400, '0') + ".0"),
+                 std::runtime_error);
+}
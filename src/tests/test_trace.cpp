@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "core/Parser.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/VM.hpp"
+#include "utils/Trace.hpp"
+
+using namespace flecha;
+using flecha::utils::TraceEvent;
+using flecha::utils::Tracer;
+using flecha::utils::TraceScope;
+
+// Finds the first event of a phase
+static const TraceEvent* findEvent(const vector<TraceEvent>& events,
+                                   const std::string& name) {
+    for (const TraceEvent& event : events) {
+        if (name == event.name) return &event;
+    }
+    return nullptr;
+}
+
+static uint64_t argOf(const TraceEvent& event, const std::string& key) {
+    for (size_t i = 0; i < event.arg_count; i++) {
+        if (key == event.args[i].key) return event.args[i].value;
+    }
+    return UINT64_MAX;
+}
+
+TEST(TraceTests, ScopesRecordOnlyWhileRecording) {
+    Tracer& tracer = Tracer::Global();
+    tracer.Stop();
+    { TraceScope scope("Idle", "test"); }
+
+    tracer.Start();
+    {
+        TraceScope scope("Busy", "test");
+        scope.Arg("items", 3);
+        scope.Detail("input.fl");
+    }
+    tracer.Stop();
+    { TraceScope scope("Late", "test"); }
+
+    vector<TraceEvent> events = tracer.Events();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_STREQ(events[0].name, "Busy");
+    EXPECT_STREQ(events[0].category, "test");
+    EXPECT_EQ(events[0].detail, "input.fl");
+    EXPECT_EQ(argOf(events[0], "items"), 3);
+}
+
+TEST(TraceTests, NestedScopesFitInsideTheirParent) {
+    Tracer& tracer = Tracer::Global();
+    tracer.Start();
+    {
+        TraceScope outer("Outer", "test");
+        TraceScope inner("Inner", "test");
+    }
+    tracer.Stop();
+
+    vector<TraceEvent> events = tracer.Events();
+    const TraceEvent* outer = findEvent(events, "Outer");
+    const TraceEvent* inner = findEvent(events, "Inner");
+    ASSERT_NE(outer, nullptr);
+    ASSERT_NE(inner, nullptr);
+    EXPECT_LE(outer->start, inner->start);
+    EXPECT_GE(outer->start + outer->duration, inner->start + inner->duration);
+    EXPECT_EQ(outer->thread, inner->thread);
+}
+
+TEST(TraceTests, WritesChromeTraceJson) {
+    Tracer& tracer = Tracer::Global();
+    tracer.Start();
+    {
+        TraceScope scope("Phase \"one\"", "test");
+        scope.Rate("tokens", 1000);
+        scope.Arg("files", 2);
+    }
+    tracer.Stop();
+
+    std::ostringstream out;
+    tracer.WriteJson(out);
+    std::string json = out.str();
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0),
+              0);
+    EXPECT_NE(json.find("\"name\":\"Phase \\\"one\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"tokens\":1000"), std::string::npos);
+    EXPECT_NE(json.find("\"tokens_per_second\":"), std::string::npos);
+    EXPECT_NE(json.find("\"files\":2"), std::string::npos);
+    EXPECT_EQ(json.find("\"files_per_second\""), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+}
+
+TEST(TraceTests, PhasesReportTheirCounts) {
+    if (!Tracer::Enabled()) GTEST_SKIP() << "Built without FLECHA_TRACE";
+
+    std::string source = "int a = 1;\nint b = a + 2;";
+    Tracer& tracer = Tracer::Global();
+    tracer.Start();
+    {
+        memory::Arena arena;
+        core::Tokenizer tokens(source);
+        tokens.Tokenize();
+
+        core::Tokenizer tokenizer(source);
+        core::Parser parser(tokenizer, arena);
+        runtime::Chunk chunk = runtime::Compile(parser.Parse());
+        runtime::VM().Run(chunk);
+    }
+    tracer.Stop();
+
+    vector<TraceEvent> events = tracer.Events();
+    const TraceEvent* tokenize = findEvent(events, "Tokenize");
+    const TraceEvent* parse = findEvent(events, "Parse");
+    const TraceEvent* compile = findEvent(events, "Compile");
+    const TraceEvent* run = findEvent(events, "Run");
+    ASSERT_NE(tokenize, nullptr);
+    ASSERT_NE(parse, nullptr);
+    ASSERT_NE(compile, nullptr);
+    ASSERT_NE(run, nullptr);
+
+    // int a = 1 ; int b = a + 2 ; EOF
+    EXPECT_EQ(argOf(*tokenize, "tokens"), 13);
+    EXPECT_EQ(argOf(*tokenize, "bytes"), source.size());
+    EXPECT_EQ(argOf(*parse, "bytes"), source.size());
+    EXPECT_EQ(argOf(*parse, "statements"), 2);
+    EXPECT_GT(argOf(*parse, "nodes"), 2);
+    EXPECT_EQ(argOf(*compile, "instructions"), argOf(*run, "instructions"));
+}
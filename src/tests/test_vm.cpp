@@ -0,0 +1,316 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "core/Parser.hpp"
+#include "memory/Heap.hpp"
+#include "runtime/Compiler.hpp"
+#include "runtime/VM.hpp"
+
+using namespace flecha;
+using flecha::memory::Arena;
+using runtime::Chunk;
+using runtime::Instruction;
+using runtime::Op;
+using runtime::Value;
+using runtime::VM;
+
+static Chunk compileProgram(std::string_view source,
+                            runtime::CompileOptions options = {}) {
+    Arena arena;
+    core::Tokenizer tokenizer(source);
+    core::Parser parser(tokenizer, arena);
+    return runtime::Compile(parser.Parse(), options);
+}
+
+TEST(VMTests, RunsArithmetic) {
+    Chunk chunk = compileProgram(
+        "int a = 7;\n"
+        "int b = (a + 3) * 2 - a % 4;\n"
+        "int c = 2 ** 10 / -a;\n"
+        "float f = 1.5 * a;\n"
+        "float g = f ** 2.0;");
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_EQ(vm.Get(chunk, "b").i, 17);
+    EXPECT_EQ(vm.Get(chunk, "c").i, 1024 / -7);
+    EXPECT_DOUBLE_EQ(vm.Get(chunk, "f").f, 10.5);
+    EXPECT_DOUBLE_EQ(vm.Get(chunk, "g").f, 110.25);
+}
+
+TEST(VMTests, ConvertsToTheDeclaredKind) {
+    Chunk chunk = compileProgram("float f = 1 + 2;\nfloat h = f / 2;");
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_DOUBLE_EQ(vm.Get(chunk, "f").f, 3.0);
+    EXPECT_DOUBLE_EQ(vm.Get(chunk, "h").f, 1.5);
+}
+
+TEST(VMTests, RunsComparisonsAndLogic) {
+    Chunk chunk = compileProgram(
+        "int a = 5;\n"
+        "bool lt = a < 6;\n"
+        "bool both = a > 1 && a == 4;\n"
+        "bool either = a |= 5 || a >= 5;\n"
+        "bool flipped = |both;");
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_EQ(vm.Get(chunk, "lt").i, 1);
+    EXPECT_EQ(vm.Get(chunk, "both").i, 0);
+    EXPECT_EQ(vm.Get(chunk, "either").i, 1);
+    EXPECT_EQ(vm.Get(chunk, "flipped").i, 1);
+}
+
+TEST(VMTests, LoadsDecodedLiterals) {
+    Chunk chunk = compileProgram(
+        "char c = '7';\n"
+        "float f = 3;\n"
+        "int big = 4611686018427387904;\n"
+        "bool b = 2;");
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_EQ(vm.Get(chunk, "c").i, '7');
+    EXPECT_DOUBLE_EQ(vm.Get(chunk, "f").f, 3.0);
+    EXPECT_EQ(vm.Get(chunk, "big").i, int64_t{1} << 62);
+    EXPECT_EQ(vm.Get(chunk, "b").i, 1);
+}
+
+TEST(VMTests, StringsPointAtTheirCharacters) {
+    Chunk chunk = compileProgram("string s = \"say \\\"hi\\\"\";");
+    VM vm;
+    vm.Run(chunk);
+
+    // The decoded text, its length in the constant after it
+    const char* text = static_cast<const char*>(vm.Get(chunk, "s").p);
+    ASSERT_EQ(chunk.constants.size(), 2);
+    EXPECT_EQ(text, chunk.constants[0].p);
+    EXPECT_EQ(std::string(text, chunk.constants[1].i), "say \"hi\"");
+}
+
+TEST(VMTests, AllotsAndWritesThroughPointers) {
+    Chunk chunk = compileProgram(
+        "int! p = allot(int) -> 40 + 2;\n"
+        "float! q = allot(float) -> 3;\n"
+        "int x = 1;\n"
+        "int y = ?x -> 9;",
+        runtime::CompileOptions{false});
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_EQ(static_cast<Value*>(vm.Get(chunk, "p").p)->i, 42);
+    EXPECT_DOUBLE_EQ(static_cast<Value*>(vm.Get(chunk, "q").p)->f, 3.0);
+    EXPECT_EQ(vm.Get(chunk, "x").i, 9);
+    EXPECT_EQ(vm.Get(chunk, "y").i, 9);
+
+    memory::HeapCache::Local().Free(
+        memory::Block{vm.Get(chunk, "p").p, memory::Heap::ClassOf(8)});
+    memory::HeapCache::Local().Free(
+        memory::Block{vm.Get(chunk, "q").p, memory::Heap::ClassOf(8)});
+}
+
+TEST(VMTests, PromotedAllotsPointAtRegisters) {
+    Chunk chunk = compileProgram(
+        "int! p = allot(int) -> 40 + 2;\n"
+        "float! q = allot(float) -> 3;\n"
+        "int y = p -> p -> 5;");
+    VM vm;
+    vm.Run(chunk);
+
+    const auto* p = chunk.Find("p");
+    const auto* q = chunk.Find("q");
+    ASSERT_GE(p->slot, 0);
+    ASSERT_GE(q->slot, 0);
+    EXPECT_EQ(vm.Get(chunk, "p").p, &vm.Registers()[p->slot]);
+    EXPECT_EQ(vm.Registers()[p->slot].i, 5);
+    EXPECT_DOUBLE_EQ(vm.Registers()[q->slot].f, 3.0);
+    EXPECT_EQ(vm.Get(chunk, "y").i, 5);
+}
+
+TEST(VMTests, WrapsIntegerOverflow) {
+    Chunk chunk = compileProgram(
+        "int big = 9223372036854775807;\n"
+        "int wrapped = big + 1;\n"
+        "int huge = 3 ** 64;");
+    VM vm;
+    vm.Run(chunk);
+
+    EXPECT_EQ(vm.Get(chunk, "wrapped").i, INT64_MIN);
+    EXPECT_EQ(static_cast<uint64_t>(vm.Get(chunk, "huge").i),
+              8733086111712066817ull);
+}
+
+TEST(VMTests, ReportsDivisionByZero) {
+    Chunk chunk = compileProgram("int a = 0;\nint b = 1 / a;");
+    VM vm;
+
+    try {
+        vm.Run(chunk);
+        FAIL() << "Expected a runtime error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Division by zero at line 2, column 9.");
+    }
+}
+
+TEST(VMTests, DellotsBlocks) {
+    // The compiler has no dellot statement yet, so it is assembled by hand
+    Chunk chunk;
+    chunk.registers = 2;
+    chunk.code = {
+        Instruction{Op::Allot, 0, 8, 0},
+        Instruction{Op::Dellot, 0, 8, 0},
+        Instruction{Op::Store, 0, 1, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{4, 2});
+
+    VM vm;
+    EXPECT_THROW(vm.Run(chunk), std::runtime_error);
+    EXPECT_EQ(vm.Registers()[0].p, nullptr);
+
+    // The freed block is the next one handed out
+    Chunk again = chunk;
+    again.code.erase(again.code.begin() + 1, again.code.begin() + 3);
+    void* freed = memory::HeapCache::Local().Allocate(8).address;
+    memory::HeapCache::Local().Free(
+        memory::Block{freed, memory::Heap::ClassOf(8)});
+    vm.Run(again);
+    EXPECT_EQ(vm.Registers()[0].p, freed);
+    memory::HeapCache::Local().Free(
+        memory::Block{freed, memory::Heap::ClassOf(8)});
+}
+
+TEST(VMTests, RunsStdIntrinsics) {
+    // Like Dellot, the intrinsics have no syntax yet
+    static const char NAME[] = "flecha";
+    static const char OTHER[] = "flechb";
+    Chunk chunk;
+    chunk.registers = 11;
+    chunk.constants = {Value{3}, Value{8}, Value{'c'}};
+    chunk.constants.push_back(Value{});
+    chunk.constants.back().p = const_cast<char*>(NAME);
+    chunk.constants.push_back(Value{});
+    chunk.constants.back().p = const_cast<char*>(OTHER);
+    chunk.code = {
+        Instruction{Op::Allot, 0, 64, 0},
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::LoadConst, 2, 1, 0},
+        Instruction{Op::Fill, 0, 1, 2},
+        Instruction{Op::SumInt, 3, 0, 2},
+        Instruction{Op::MaxInt, 4, 0, 2},
+        Instruction{Op::LoadConst, 5, 3, 0},
+        Instruction{Op::Length, 6, 5, 0},
+        Instruction{Op::LoadConst, 8, 2, 0},
+        Instruction{Op::Move, 7, 6, 0},
+        Instruction{Op::Find, 7, 5, 8},
+        Instruction{Op::LoadConst, 9, 4, 0},
+        Instruction{Op::Move, 10, 6, 0},
+        Instruction{Op::Compare, 10, 5, 9},
+        // Over the first word, the 3 leaves zero bytes after the name
+        Instruction{Op::Copy, 0, 5, 6},
+        Instruction{Op::Length, 1, 0, 0},
+        Instruction{Op::Dellot, 0, 64, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{1, 1});
+
+    VM vm;
+    vm.Run(chunk);
+    const auto& r = vm.Registers();
+    EXPECT_EQ(r[3].i, 24);
+    EXPECT_EQ(r[4].i, 3);
+    EXPECT_EQ(r[6].i, 6);
+    EXPECT_EQ(r[7].i, 3);
+    EXPECT_EQ(r[10].i, -1);
+    EXPECT_EQ(r[1].i, 6);
+}
+
+TEST(VMTests, ChecksIntrinsicOperands) {
+    Chunk chunk;
+    chunk.registers = 3;
+    chunk.constants = {Value{2}};
+    chunk.code = {
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::SumInt, 2, 0, 1},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{3, 5});
+
+    try {
+        VM().Run(chunk);
+        FAIL() << "Expected a null buffer error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(error.what(),
+                     "Runtime Error: Null buffer at line 3, column 5.");
+    }
+
+    // Nothing is read for no values, even through null
+    chunk.constants = {Value{0}};
+    VM vm;
+    vm.Run(chunk);
+    EXPECT_EQ(vm.Registers()[2].i, 0);
+
+    chunk.constants = {Value{-1}};
+    EXPECT_THROW(vm.Run(chunk), std::runtime_error);
+}
+
+TEST(VMTests, RunsChannelsWithoutAScheduler) {
+    // One VM is one task: channels buffer, and waiting is an error
+    Chunk chunk;
+    chunk.registers = 5;
+    chunk.constants = {Value{2}, Value{40}};
+    chunk.code = {
+        Instruction{Op::LoadConst, 1, 0, 0},
+        Instruction{Op::MakeChannel, 0, 1, 0},
+        Instruction{Op::LoadConst, 2, 1, 0},
+        Instruction{Op::Send, 0, 2, 0},
+        Instruction{Op::Send, 0, 1, 0},
+        Instruction{Op::Receive, 3, 0, 0},
+        Instruction{Op::Receive, 4, 0, 0},
+        Instruction{Op::AddInt, 3, 3, 4},
+        Instruction{Op::Receive, 4, 0, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    chunk.locations.assign(chunk.code.size(), core::SourceLocation{4, 2});
+
+    VM vm;
+    try {
+        vm.Run(chunk);
+        FAIL() << "Expected an empty channel error";
+    } catch (const std::runtime_error& error) {
+        EXPECT_STREQ(
+            error.what(),
+            "Runtime Error: Receive on an empty channel at line 4, column 2.");
+    }
+    EXPECT_EQ(vm.Registers()[3].i, 42);
+
+    chunk.code = {
+        Instruction{Op::Spawn, 0, 1, 0},
+        Instruction{Op::Halt, 0, 0, 0},
+    };
+    EXPECT_THROW(vm.Run(chunk), std::runtime_error);
+}
+
+TEST(VMTests, RunsStraightLineProgramsOfAnySize) {
+    std::string source = "int v0 = 1;\n";
+    for (int i = 1; i < 2000; i++) {
+        source += "int v" + std::to_string(i) + " = v" +
+                  std::to_string(i - 1) + " * 3 + " + std::to_string(i) +
+                  " % 7;\n";
+    }
+    Chunk chunk = compileProgram(source);
+    VM vm;
+    vm.Run(chunk);
+
+    int64_t expected = 1;
+    for (int i = 1; i < 2000; i++) {
+        expected = static_cast<int64_t>(static_cast<uint64_t>(expected) * 3 +
+                                        i % 7);
+    }
+    EXPECT_EQ(vm.Get(chunk, "v1999").i, expected);
+}
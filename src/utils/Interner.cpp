@@ -0,0 +1,260 @@
+#include "utils/Interner.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace flecha {
+namespace utils {
+
+// Bytes of name storage allocated at a time
+static constexpr size_t CHUNK_SIZE = 4096;
+static constexpr size_t FIRST_SLOTS = 64;
+
+// Shards are picked by the top bits of the hash, slots by the low ones
+static constexpr int SHARD_SHIFT = sizeof(size_t) * 8 - 4;
+static_assert(Interner::SHARDS == 16, "SHARD_SHIFT picks one of 16 shards");
+
+// A symbol is its index within its shard, then the shard, plus one so 0
+// stays free for no symbol
+static uint32_t MakeId(size_t shard, size_t index) {
+    return static_cast<uint32_t>((index << 4 | shard) + 1);
+}
+
+static size_t ShardOf(uint32_t id) { return (id - 1) & 15; }
+static size_t IndexOf(uint32_t id) { return (id - 1) >> 4; }
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Copies a name into the shard's storage
+ *
+ * @param shard - The shard, locked
+ * @param name - The name
+ *
+ * @return - The stable copy
+ */
+std::string_view Interner::_Store(Shard& shard, std::string_view name) {
+    if (name.size() > shard.left) {
+        size_t size = std::max(CHUNK_SIZE, name.size());
+        shard.chunks.push_back(std::make_unique<char[]>(size));
+        shard.cursor = shard.chunks.back().get();
+        shard.left = size;
+    }
+
+    char* copy = shard.cursor;
+    std::memcpy(copy, name.data(), name.size());
+    shard.cursor += name.size();
+    shard.left -= name.size();
+    return std::string_view(copy, name.size());
+}
+
+/**
+ * @brief Doubles the shard's table
+ *
+ * @param shard - The shard, locked
+ */
+void Interner::_Grow(Shard& shard) {
+    vector<Slot> slots(shard.slots.empty() ? FIRST_SLOTS
+                                           : shard.slots.size() * 2);
+    size_t mask = slots.size() - 1;
+
+    for (const Slot& slot : shard.slots) {
+        if (!slot.id) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+
+    shard.slots.swap(slots);
+}
+
+/**
+ * @brief Probes the shard's table for a name
+ *
+ * @param shard - The shard, locked, with a table
+ * @param name - The name
+ * @param hash - Its hash
+ *
+ * @return - The id in the name's slot, pointing at 0 when the name is new
+ */
+uint32_t* Interner::_Find(Shard& shard, std::string_view name, size_t hash) {
+    size_t mask = shard.slots.size() - 1;
+    auto low = static_cast<uint32_t>(hash);
+
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& slot = shard.slots[i];
+        if (!slot.id) {
+            slot.hash = low;
+            return &slot.id;
+        }
+        if (slot.hash == low && shard.names[IndexOf(slot.id)] == name) {
+            return &slot.id;
+        }
+    }
+}
+
+/**
+ * @brief Gets the symbol of a name whose hash is known
+ *
+ * @param name - The name
+ * @param hash - Hash(name)
+ * @param stored - Receives the stored copy of the name, if given
+ *
+ * @return - The symbol
+ */
+Symbol Interner::_Intern(std::string_view name, size_t hash,
+                         std::string_view* stored) {
+    size_t index = hash >> SHARD_SHIFT;
+    Shard& shard = _shards[index];
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+
+    // Kept at most three quarters full
+    if ((shard.names.size() + 1) * 4 > shard.slots.size() * 3) _Grow(shard);
+
+    uint32_t* id = _Find(shard, name, hash);
+    if (!*id) {
+        *id = MakeId(index, shard.names.size());
+        shard.names.push_back(_Store(shard, name));
+    }
+
+    if (stored) *stored = shard.names[IndexOf(*id)];
+    return Symbol(*id);
+}
+
+/* PUBLIC METHODS */
+
+Interner::Interner() {
+    for (std::string_view name : PRESETS) Intern(name);
+}
+
+/**
+ * @brief Gets the symbol of a name, adding the name if it is new
+ *
+ * @param name - The name
+ * @param stored - Receives the stored copy of the name, if given
+ *
+ * @return - The symbol
+ */
+Symbol Interner::Intern(std::string_view name, std::string_view* stored) {
+    return _Intern(name, Hash(name), stored);
+}
+
+/**
+ * @brief Looks a name up without adding it
+ *
+ * @param name - The name
+ *
+ * @return - Its symbol, or no symbol
+ */
+Symbol Interner::Find(std::string_view name) {
+    size_t hash = Hash(name);
+    Shard& shard = _shards[hash >> SHARD_SHIFT];
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.slots.empty()) return Symbol();
+
+    // A miss leaves the probed empty slot empty
+    return Symbol(*_Find(shard, name, hash));
+}
+
+/**
+ * @brief Resolves a symbol
+ *
+ * @param symbol - A symbol of this interner
+ *
+ * @return - Its name
+ */
+std::string_view Interner::Name(Symbol symbol) {
+    if (!symbol) return std::string_view();
+
+    Shard& shard = _shards[ShardOf(symbol.id)];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.names[IndexOf(symbol.id)];
+}
+
+size_t Interner::Size() {
+    size_t size = 0;
+    for (Shard& shard : _shards) {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        size += shard.names.size();
+    }
+    return size - PRESET_COUNT;
+}
+
+Symbol Interner::Preset(size_t index) {
+    // Any interner gives them, a fresh one is as good as another
+    static const std::array<Symbol, PRESET_COUNT> presets = [] {
+        Interner fresh;
+        std::array<Symbol, PRESET_COUNT> symbols;
+        for (size_t i = 0; i < PRESET_COUNT; i++) {
+            symbols[i] = fresh.Find(PRESETS[i]);
+        }
+        return symbols;
+    }();
+    return presets[index];
+}
+
+Interner& Interner::Global() {
+    // Leaked on purpose, trees may name its symbols until exit
+    static Interner* global = new Interner();
+    return *global;
+}
+
+/* LOCAL INTERNER */
+
+LocalInterner::LocalInterner(Interner& shared)
+    : _shared(shared), _slots(FIRST_SLOTS), _count(0) {}
+
+/**
+ * @brief Doubles the table
+ */
+void LocalInterner::_Grow() {
+    vector<Slot> slots(_slots.size() * 2);
+    size_t mask = slots.size() - 1;
+
+    for (const Slot& slot : _slots) {
+        if (!slot.symbol) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].symbol) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+
+    _slots.swap(slots);
+}
+
+/**
+ * @brief Gets the symbol of a name, asking the shared interner only for
+ * names not seen before
+ *
+ * @param name - The name
+ * @param stored - Receives the shared copy of the name, if given
+ *
+ * @return - The symbol
+ */
+Symbol LocalInterner::Intern(std::string_view name, std::string_view* stored) {
+    size_t hash = Interner::Hash(name);
+    size_t mask = _slots.size() - 1;
+
+    size_t i = hash & mask;
+    for (; _slots[i].symbol; i = (i + 1) & mask) {
+        const Slot& slot = _slots[i];
+        if (slot.hash == hash && slot.name == name) {
+            if (stored) *stored = slot.name;
+            return slot.symbol;
+        }
+    }
+
+    Slot& slot = _slots[i];
+    slot.hash = hash;
+    slot.symbol = _shared._Intern(name, hash, &slot.name);
+    if (stored) *stored = slot.name;
+
+    Symbol symbol = slot.symbol;
+    if (++_count * 4 > _slots.size() * 3) _Grow();
+    return symbol;
+}
+
+}  // namespace utils
+}  // namespace flecha
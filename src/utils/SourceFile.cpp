@@ -0,0 +1,160 @@
+#include "utils/SourceFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief Builds the error for a failed system call
+ *
+ * @param what - What was being done
+ * @param name - The file name
+ *
+ * @return - The error, with errno's description
+ */
+static std::runtime_error SystemError(const string& what, const string& name) {
+    return std::runtime_error("Source Error: Could not " + what + " " + name +
+                              ": " + std::strerror(errno));
+}
+
+/* PRIVATE METHODS */
+
+/**
+ * @brief Maps regular files and reads anything else
+ *
+ * @param fd - The open descriptor
+ * @param name - The name used in errors
+ */
+void SourceFile::_Load(int fd, const string& name) {
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        throw SystemError("stat", name);
+    }
+
+    // Empty files can't be mapped and have nothing to read
+    if (S_ISREG(info.st_mode) && info.st_size == 0) return;
+
+    if (S_ISREG(info.st_mode)) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size),
+                             PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            // Lexing walks the file front to back once
+            madvise(mapping, static_cast<size_t>(info.st_size),
+                    MADV_SEQUENTIAL);
+            _mapping = static_cast<const char*>(mapping);
+            _size = static_cast<size_t>(info.st_size);
+            return;
+        }
+    }
+
+    _Read(fd, name);
+}
+
+/**
+ * @brief Reads a descriptor into the buffer until end of file
+ *
+ * @param fd - The open descriptor
+ * @param name - The name used in errors
+ */
+void SourceFile::_Read(int fd, const string& name) {
+    constexpr size_t CHUNK = 64 * 1024;
+    size_t used = 0;
+
+    while (true) {
+        _buffer.resize(used + CHUNK);
+        ssize_t got = read(fd, &_buffer[used], CHUNK);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            throw SystemError("read", name);
+        }
+        if (got == 0) break;
+        used += static_cast<size_t>(got);
+    }
+
+    _buffer.resize(used);
+    _buffer.shrink_to_fit();
+}
+
+/**
+ * @brief Unmaps the file, if mapped
+ */
+void SourceFile::_Release() {
+    if (_mapping) {
+        munmap(const_cast<char*>(_mapping), _size);
+        _mapping = nullptr;
+    }
+    _size = 0;
+}
+
+/* PUBLIC METHODS */
+
+SourceFile::SourceFile(const string& path) : _mapping(nullptr), _size(0) {
+    if (path == "-") {
+        _Load(STDIN_FILENO, "stdin");
+        return;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw SystemError("open", path);
+    }
+
+    try {
+        _Load(fd, path);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+
+    // A mapping stays valid after its descriptor is closed
+    close(fd);
+}
+
+SourceFile::SourceFile(int fd) : _mapping(nullptr), _size(0) {
+    _Load(fd, "descriptor " + std::to_string(fd));
+}
+
+SourceFile::SourceFile(SourceFile&& other) noexcept
+    : _mapping(other._mapping),
+      _size(other._size),
+      _buffer(std::move(other._buffer)) {
+    other._mapping = nullptr;
+    other._size = 0;
+}
+
+SourceFile& SourceFile::operator=(SourceFile&& other) noexcept {
+    if (this != &other) {
+        _Release();
+        _mapping = other._mapping;
+        _size = other._size;
+        _buffer = std::move(other._buffer);
+        other._mapping = nullptr;
+        other._size = 0;
+    }
+
+    return *this;
+}
+
+SourceFile::~SourceFile() { _Release(); }
+
+/**
+ * @brief Gets the source text
+ *
+ * @return - The mapped bytes, or the buffered ones
+ */
+std::string_view SourceFile::Text() const {
+    if (_mapping) return std::string_view(_mapping, _size);
+
+    return _buffer;
+}
+
+}  // namespace utils
+}  // namespace flecha
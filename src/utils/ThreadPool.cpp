@@ -0,0 +1,126 @@
+#include "utils/ThreadPool.hpp"
+
+namespace flecha {
+namespace utils {
+
+// The pool and worker the current thread belongs to, if any
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+
+/**
+ * @brief Takes the newest own task, or else steals the oldest task of
+ * another worker
+ *
+ * @param index - The worker looking for work
+ * @param task - Receives the task
+ *
+ * @return - True if a task was taken
+ */
+bool ThreadPool::_Take(size_t index, Task& task) {
+    {
+        Worker& own = *_workers[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker& victim = *_workers[(index + i) % _workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief The worker loop: run tasks until stopped and out of work
+ *
+ * @param index - The worker index
+ */
+void ThreadPool::_Run(size_t index) {
+    current_pool = this;
+    current_worker = index;
+
+    Task task;
+    while (true) {
+        if (_Take(index, task)) {
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            task(index);
+            task = nullptr;
+
+            if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> guard(_lock);
+                _idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(_lock);
+        _wake.wait(guard, [this] {
+            return _stopping || _queued.load(std::memory_order_relaxed) > 0;
+        });
+        if (_stopping && _queued.load(std::memory_order_relaxed) == 0) return;
+    }
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (size_t i = 0; i < threads; i++) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        _threads.emplace_back(&ThreadPool::_Run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    _wake.notify_all();
+
+    for (auto& thread : _threads) thread.join();
+}
+
+void ThreadPool::Submit(Task task) {
+    size_t index = current_pool == this
+                       ? current_worker
+                       : _next.fetch_add(1, std::memory_order_relaxed) %
+                             _workers.size();
+
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // Counted first and under the lock, so the count never drops below
+        // zero and a worker going to sleep can't miss the task
+        std::lock_guard<std::mutex> guard(_lock);
+        _queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        Worker& worker = *_workers[index];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        worker.tasks.push_back(std::move(task));
+    }
+    _wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+    std::unique_lock<std::mutex> guard(_lock);
+    _idle.wait(guard, [this] {
+        return _pending.load(std::memory_order_acquire) == 0;
+    });
+}
+
+}  // namespace utils
+}  // namespace flecha
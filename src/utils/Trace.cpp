@@ -0,0 +1,173 @@
+#include "utils/Trace.hpp"
+
+#include <chrono>
+#include <fstream>
+
+namespace flecha {
+namespace utils {
+
+/**
+ * @brief Gets a small, stable id for the calling thread
+ *
+ * @return - 0 for the first thread to ask, then 1, 2...
+ */
+static uint32_t ThreadId() {
+    static std::atomic<uint32_t> next{0};
+    thread_local uint32_t id = next.fetch_add(1);
+    return id;
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ *
+ * @param out - The stream
+ * @param text - The string
+ */
+static void WriteString(std::ostream& out, const string& text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char* HEX = "0123456789abcdef";
+                    out << "\\u00" << HEX[c >> 4] << HEX[c & 0xf];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+/**
+ * @brief Writes nanoseconds as the microseconds Chrome expects
+ *
+ * @param out - The stream
+ * @param nanoseconds - The time
+ */
+static void WriteMicroseconds(std::ostream& out, uint64_t nanoseconds) {
+    out << nanoseconds / 1000 << '.';
+    uint64_t fraction = nanoseconds % 1000;
+    out << fraction / 100 << fraction / 10 % 10 << fraction % 10;
+}
+
+Tracer::Tracer() : _recording(false), _epoch(0) { _epoch = Now(); }
+
+void Tracer::Start() {
+    std::lock_guard<std::mutex> guard(_lock);
+    _events.clear();
+    _recording.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop() { _recording.store(false, std::memory_order_relaxed); }
+
+uint64_t Tracer::Now() const {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(now)
+                   .count()) -
+           _epoch;
+}
+
+void Tracer::Record(TraceEvent event) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _events.push_back(std::move(event));
+}
+
+vector<TraceEvent> Tracer::Events() const {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _events;
+}
+
+/**
+ * @brief Writes one complete event per phase, with its args and rates
+ *
+ * @param out - The stream to write to
+ */
+void Tracer::WriteJson(std::ostream& out) const {
+    vector<TraceEvent> events = Events();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\"flecha\"}}";
+
+    for (const TraceEvent& event : events) {
+        out << "," << std::endl << "{\"name\":";
+        WriteString(out, event.name);
+        out << ",\"cat\":";
+        WriteString(out, event.category);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":";
+        WriteMicroseconds(out, event.start);
+        out << ",\"dur\":";
+        WriteMicroseconds(out, event.duration);
+
+        out << ",\"args\":{";
+        const char* separator = "";
+        if (!event.detail.empty()) {
+            out << "\"detail\":";
+            WriteString(out, event.detail);
+            separator = ",";
+        }
+        for (size_t i = 0; i < event.arg_count; i++) {
+            const TraceArg& arg = event.args[i];
+            out << separator << '"' << arg.key << "\":" << arg.value;
+            separator = ",";
+            if (arg.rate && event.duration) {
+                out << ",\"" << arg.key << "_per_second\":"
+                    << static_cast<uint64_t>(static_cast<double>(arg.value) *
+                                             1e9 / event.duration);
+            }
+        }
+        out << "}}";
+    }
+
+    out << std::endl << "]}" << std::endl;
+}
+
+bool Tracer::WriteJson(const string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    WriteJson(out);
+    out.close();
+    return !out.fail();
+}
+
+Tracer& Tracer::Global() {
+    // Leaked on purpose, like the other process wide singletons
+    static Tracer* global = new Tracer();
+    return *global;
+}
+
+TraceScope::TraceScope(const char* name, const char* category)
+    : _active(Tracer::Global().Recording()) {
+    if (!_active) return;
+
+    _event.name = name;
+    _event.category = category;
+    _event.thread = ThreadId();
+    _event.start = Tracer::Global().Now();
+}
+
+TraceScope::~TraceScope() {
+    if (!_active) return;
+
+    _event.duration = Tracer::Global().Now() - _event.start;
+    Tracer::Global().Record(std::move(_event));
+}
+
+}  // namespace utils
+}  // namespace flecha